@@ -3,24 +3,28 @@
 #include <iomanip>
 #include <cstring>
 #include <iostream>
-#include <ctime>
-#include <cstdlib>
 #include <algorithm>
+#include <random>
+#include <thread>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 
 std::string Authenticator::generateSalt() {
-    // Инициализация генератора случайных чисел
-    static bool initialized = false;
-    if (!initialized) {
-        srand(time(nullptr));
-        initialized = true;
-    }
-    
     uint64_t salt = 0;
     
-    // Генерация 64-битной соли (8 байт)
-    for (int i = 0; i < 8; i++) {
-        salt = (salt << 8) | (rand() & 0xFF);
+    // Генерация 64-битной соли (8 байт).
+    // RAND_bytes потокобезопасен, в отличие от rand()
+    unsigned char bytes[8];
+    if (RAND_bytes(bytes, sizeof(bytes)) == 1) {
+        for (int i = 0; i < 8; i++) {
+            salt = (salt << 8) | bytes[i];
+        }
+    } else {
+        // Резервный вариант: собственный генератор у каждого потока
+        static thread_local std::mt19937_64 generator(
+            std::random_device{}() ^ 
+            std::hash<std::thread::id>()(std::this_thread::get_id()));
+        salt = generator();
     }
     
     // Преобразование в hex строку с ведущими нулями
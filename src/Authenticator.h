@@ -17,7 +17,7 @@
 class Authenticator {
 public:
     /**
-     * @brief Сгенерировать соль
+     * @brief Сгенерировать соль (потокобезопасно)
      * @return Соль в hex формате (16 символов)
      */
     static std::string generateSalt();
@@ -3,8 +3,94 @@
 #include <cstring>
 #include <getopt.h>
 #include <limits>
+#include <algorithm>
 
-Config::Config() : port_(33333) {
+/**
+ * @brief Коды длинных опций без короткого эквивалента
+ */
+enum LongOnlyOption {
+    OPT_SHARDS = 256,
+    OPT_BACKLOG,
+    OPT_PIN_CPU,
+    OPT_IO_BACKEND,
+    OPT_KEEPALIVE_TIMEOUT,
+    OPT_FLUSH,
+    OPT_FLUSH_BYTES,
+    OPT_FLUSH_DELAY,
+    OPT_SIMD,
+    OPT_COMPUTE_THREADS,
+    OPT_CACHE_ENTRIES,
+    OPT_STORE_MB,
+    OPT_STORE_FILE
+};
+
+/**
+ * @brief Разобрать целочисленный параметр с проверкой диапазона
+ * @param text Текст параметра
+ * @param minValue Минимальное значение
+ * @param maxValue Максимальное значение
+ * @param what Название параметра для сообщения об ошибке
+ * @param value Значение (выходной параметр)
+ * @return true - значение корректно
+ */
+static bool parseNumber(const char* text, long minValue, long maxValue,
+                        const char* what, long& value) {
+    try {
+        value = std::stol(text);
+    } catch (const std::invalid_argument&) {
+        std::cerr << "Ошибка: некорректное значение параметра " << what 
+                  << " (не число)" << std::endl;
+        return false;
+    } catch (const std::out_of_range&) {
+        std::cerr << "Ошибка: некорректное значение параметра " << what 
+                  << " (выход за диапазон)" << std::endl;
+        return false;
+    }
+    
+    if (value < minValue || value > maxValue) {
+        std::cerr << "Ошибка: параметр " << what << " должен быть в диапазоне " 
+                  << minValue << "-" << maxValue << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Разобрать список режимов отправки ответов
+ * @param text Режимы через запятую (immediate, batch)
+ * @param modes Режимы (выходной параметр)
+ * @return true - список корректен
+ */
+static bool parseFlushModes(const char* text, std::vector<ResponseFlush>& modes) {
+    modes.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string mode = list.substr(start, end - start);
+        if (mode == "immediate") {
+            modes.push_back(ResponseFlush::IMMEDIATE);
+        } else if (mode == "batch") {
+            modes.push_back(ResponseFlush::BATCH);
+        } else {
+            std::cerr << "Ошибка: неизвестный режим отправки ответов: '" << mode 
+                      << "' (допустимо: immediate, batch)" << std::endl;
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+Config::Config() : port_(33333), threads_(1), shards_(0), backlog_(10), pinCpu_(false),
+                   ioBackend_(IoBackend::EPOLL), keepAliveTimeout_(30),
+                   flushModes_(1, ResponseFlush::IMMEDIATE), flushBytes_(65536),
+                   flushDelayMs_(5), simdLevel_(SimdLevel::AUTO), computeThreads_(0),
+                   cacheEntries_(0), storeMegabytes_(0) {
     setDefaults();
 }
 
@@ -12,6 +98,20 @@ void Config::setDefaults() {
     clientDbPath_ = "/etc/vealc.conf";
     logFilePath_ = "/var/log/vealc.log";
     port_ = 33333;
+    threads_ = 1;
+    shards_ = 0;
+    backlog_ = 10;
+    pinCpu_ = false;
+    ioBackend_ = IoBackend::EPOLL;
+    keepAliveTimeout_ = 30;
+    flushModes_.assign(1, ResponseFlush::IMMEDIATE);
+    flushBytes_ = 65536;
+    flushDelayMs_ = 5;
+    simdLevel_ = SimdLevel::AUTO;
+    computeThreads_ = 0;
+    cacheEntries_ = 0;
+    storeMegabytes_ = 0;
+    storeFilePath_.clear();
 }
 
 bool Config::parseCommandLine(int argc, char** argv) {
@@ -19,6 +119,20 @@ bool Config::parseCommandLine(int argc, char** argv) {
         {"config", required_argument, 0, 'c'},
         {"log", required_argument, 0, 'l'},
         {"port", required_argument, 0, 'p'},
+        {"threads", required_argument, 0, 't'},
+        {"shards", required_argument, 0, OPT_SHARDS},
+        {"backlog", required_argument, 0, OPT_BACKLOG},
+        {"pin-cpu", no_argument, 0, OPT_PIN_CPU},
+        {"io-backend", required_argument, 0, OPT_IO_BACKEND},
+        {"keepalive-timeout", required_argument, 0, OPT_KEEPALIVE_TIMEOUT},
+        {"flush", required_argument, 0, OPT_FLUSH},
+        {"flush-bytes", required_argument, 0, OPT_FLUSH_BYTES},
+        {"flush-delay", required_argument, 0, OPT_FLUSH_DELAY},
+        {"simd", required_argument, 0, OPT_SIMD},
+        {"compute-threads", required_argument, 0, OPT_COMPUTE_THREADS},
+        {"cache-entries", required_argument, 0, OPT_CACHE_ENTRIES},
+        {"store-mb", required_argument, 0, OPT_STORE_MB},
+        {"store-file", required_argument, 0, OPT_STORE_FILE},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0}
@@ -26,8 +140,9 @@ bool Config::parseCommandLine(int argc, char** argv) {
 
     int option;
     int optionIndex = 0;
+    long number = 0;
     
-    while ((option = getopt_long(argc, argv, "c:l:p:hv", longOptions, &optionIndex)) != -1) {
+    while ((option = getopt_long(argc, argv, "c:l:p:t:hv", longOptions, &optionIndex)) != -1) {
         switch (option) {
             case 'c':
                 clientDbPath_ = optarg;
@@ -55,6 +170,99 @@ bool Config::parseCommandLine(int argc, char** argv) {
                     return false;
                 }
                 break;
+            case 't':
+                if (!parseNumber(optarg, 1, MAX_THREADS, "--threads", number)) {
+                    return false;
+                }
+                threads_ = static_cast<unsigned int>(number);
+                break;
+            case OPT_SHARDS:
+                if (!parseNumber(optarg, 0, MAX_THREADS, "--shards", number)) {
+                    return false;
+                }
+                shards_ = static_cast<unsigned int>(number);
+                break;
+            case OPT_BACKLOG:
+                if (!parseNumber(optarg, 1, 65535, "--backlog", number)) {
+                    return false;
+                }
+                backlog_ = static_cast<int>(number);
+                break;
+            case OPT_PIN_CPU:
+                pinCpu_ = true;
+                break;
+            case OPT_IO_BACKEND:
+                if (strcmp(optarg, "epoll") == 0) {
+                    ioBackend_ = IoBackend::EPOLL;
+                } else if (strcmp(optarg, "io_uring") == 0) {
+                    ioBackend_ = IoBackend::IO_URING;
+                } else {
+                    std::cerr << "Ошибка: неизвестный бэкенд ввода-вывода: " << optarg 
+                              << " (допустимо: epoll, io_uring)" << std::endl;
+                    return false;
+                }
+                break;
+            case OPT_KEEPALIVE_TIMEOUT:
+                if (!parseNumber(optarg, 1, MAX_KEEPALIVE_TIMEOUT, "--keepalive-timeout", number)) {
+                    return false;
+                }
+                keepAliveTimeout_ = static_cast<int>(number);
+                break;
+            case OPT_FLUSH:
+                if (!parseFlushModes(optarg, flushModes_)) {
+                    return false;
+                }
+                break;
+            case OPT_FLUSH_BYTES:
+                if (!parseNumber(optarg, 1, MAX_FLUSH_BYTES, "--flush-bytes", number)) {
+                    return false;
+                }
+                flushBytes_ = static_cast<size_t>(number);
+                break;
+            case OPT_FLUSH_DELAY:
+                if (!parseNumber(optarg, 0, MAX_FLUSH_DELAY_MS, "--flush-delay", number)) {
+                    return false;
+                }
+                flushDelayMs_ = static_cast<int>(number);
+                break;
+            case OPT_SIMD:
+                if (strcmp(optarg, "auto") == 0) {
+                    simdLevel_ = SimdLevel::AUTO;
+                } else if (strcmp(optarg, "scalar") == 0) {
+                    simdLevel_ = SimdLevel::SCALAR;
+                } else if (strcmp(optarg, "sse4.1") == 0) {
+                    simdLevel_ = SimdLevel::SSE41;
+                } else if (strcmp(optarg, "avx2") == 0) {
+                    simdLevel_ = SimdLevel::AVX2;
+                } else if (strcmp(optarg, "avx512") == 0) {
+                    simdLevel_ = SimdLevel::AVX512;
+                } else {
+                    std::cerr << "Ошибка: неизвестное ядро суммирования: " << optarg 
+                              << " (допустимо: auto, scalar, sse4.1, avx2, avx512)" << std::endl;
+                    return false;
+                }
+                break;
+            case OPT_COMPUTE_THREADS:
+                if (!parseNumber(optarg, 0, MAX_THREADS, "--compute-threads", number)) {
+                    return false;
+                }
+                computeThreads_ = static_cast<unsigned int>(number);
+                break;
+            case OPT_CACHE_ENTRIES:
+                if (!parseNumber(optarg, 0, MAX_CACHE_ENTRIES, "--cache-entries", number)) {
+                    return false;
+                }
+                cacheEntries_ = static_cast<size_t>(number);
+                break;
+            case OPT_STORE_MB:
+                if (!parseNumber(optarg, 0, MAX_STORE_MEGABYTES, "--store-mb", number)) {
+                    return false;
+                }
+                storeMegabytes_ = static_cast<size_t>(number);
+                break;
+            case OPT_STORE_FILE:
+                storeFilePath_ = optarg;
+                break;
             case 'h':
                 showHelp(argv[0]);
                 return false;
@@ -67,6 +275,16 @@ bool Config::parseCommandLine(int argc, char** argv) {
         }
     }
     
+    if (!storeFilePath_.empty() && storeMegabytes_ == 0) {
+        std::cerr << "Ошибка: --store-file требует --store-mb" << std::endl;
+        return false;
+    }
+    
+    if (shards_ > 0 && threads_ > 1) {
+        std::cerr << "Ошибка: --shards и --threads нельзя использовать вместе" << std::endl;
+        return false;
+    }
+    
     if (optind < argc) {
         std::cerr << "Неизвестные аргументы: ";
         for (int i = optind; i < argc; i++) {
@@ -88,12 +306,50 @@ void Config::showHelp(const char* programName) {
     std::cout << "  -l, --log FILE       Файл журнала для записи ошибок\n";
     std::cout << "  -p, --port PORT      Порт сервера (1024-65535)\n\n";
     std::cout << "Дополнительные опции:\n";
+    std::cout << "  -t, --threads N      Количество рабочих потоков (1-" << MAX_THREADS << ")\n";
+    std::cout << "      --shards N       Количество слушающих сокетов SO_REUSEPORT,\n";
+    std::cout << "                       у каждого свой поток (0 - выключено)\n";
+    std::cout << "      --backlog N      Длина очереди listen() (1-65535)\n";
+    std::cout << "      --pin-cpu        Закрепить потоки шардов за ядрами процессора\n";
+    std::cout << "      --io-backend B   Бэкенд ввода-вывода: epoll или io_uring\n";
+    std::cout << "                       (без поддержки в ядре - epoll)\n";
+    std::cout << "      --keepalive-timeout SEC\n";
+    std::cout << "                       Сколько сеанс keep-alive ждет следующий пакет\n";
+    std::cout << "                       векторов (1-" << MAX_KEEPALIVE_TIMEOUT << " сек)\n";
+    std::cout << "      --flush M[,M...] Когда отправлять ответы: immediate - после каждой\n";
+    std::cout << "                       принятой порции, batch - в конце пакета; i-й режим\n";
+    std::cout << "                       для i-го шарда, последний - для остальных\n";
+    std::cout << "      --flush-bytes N  Порог размера отложенного ответа (режим batch)\n";
+    std::cout << "      --flush-delay MS Порог задержки отложенного ответа (режим batch, 0-"
+              << MAX_FLUSH_DELAY_MS << ")\n";
+    std::cout << "      --simd K         Ядро суммирования: auto (по cpuid), scalar,\n";
+    std::cout << "                       sse4.1, avx2, avx512\n";
+    std::cout << "      --compute-threads N\n";
+    std::cout << "                       Потоки пула для пакетов с флагом параллельной\n";
+    std::cout << "                       обработки (0 - в потоке сеанса)\n";
+    std::cout << "      --cache-entries N\n";
+    std::cout << "                       Емкость кэша результатов для пакетов с флагом\n";
+    std::cout << "                       кэширования (0 - выключен, до " << MAX_CACHE_ENTRIES << ")\n";
+    std::cout << "      --store-mb N     Память хранилища именованных векторов, МБ\n";
+    std::cout << "                       (0 - выключено, до " << MAX_STORE_MEGABYTES << ")\n";
+    std::cout << "      --store-file FILE\n";
+    std::cout << "                       Файл хранилища векторов: векторы сохраняются\n";
+    std::cout << "                       между запусками (без параметра - только в памяти)\n";
     std::cout << "  -h, --help           Показать эту справку\n";
     std::cout << "  -v, --version        Показать информацию о версии\n\n";
     std::cout << "Значения по умолчанию:\n";
     std::cout << "  --config " << clientDbPath_ << "\n";
     std::cout << "  --log   " << logFilePath_ << "\n";
-    std::cout << "  --port  " << port_ << "\n\n";
+    std::cout << "  --port  " << port_ << "\n";
+    std::cout << "  --threads " << threads_ << "\n";
+    std::cout << "  --shards  " << shards_ << "\n";
+    std::cout << "  --backlog " << backlog_ << "\n";
+    std::cout << "  --keepalive-timeout " << keepAliveTimeout_ << "\n";
+    std::cout << "  --flush immediate --flush-bytes " << flushBytes_ 
+              << " --flush-delay " << flushDelayMs_ << "\n";
+    std::cout << "  --simd auto --compute-threads " << computeThreads_
+              << " --cache-entries " << cacheEntries_
+              << " --store-mb " << storeMegabytes_ << "\n\n";
     std::cout << "Примеры:\n";
     std::cout << "  " << programName << " -c /etc/my.conf -l /var/log/my.log -p 30000\n";
     std::cout << "  " << programName << " --config ~/server.conf --log /tmp/server.log --port 33333\n";
@@ -120,3 +376,59 @@ const std::string& Config::getLogFilePath() const {
 uint16_t Config::getPort() const {
     return port_;
 }
+
+unsigned int Config::getThreads() const {
+    return threads_;
+}
+
+unsigned int Config::getShards() const {
+    return shards_;
+}
+
+int Config::getBacklog() const {
+    return backlog_;
+}
+
+bool Config::getPinCpu() const {
+    return pinCpu_;
+}
+
+IoBackend Config::getIoBackend() const {
+    return ioBackend_;
+}
+
+int Config::getKeepAliveTimeout() const {
+    return keepAliveTimeout_;
+}
+
+size_t Config::getFlushBytes() const {
+    return flushBytes_;
+}
+
+int Config::getFlushDelayMs() const {
+    return flushDelayMs_;
+}
+
+SimdLevel Config::getSimdLevel() const {
+    return simdLevel_;
+}
+
+unsigned int Config::getComputeThreads() const {
+    return computeThreads_;
+}
+
+size_t Config::getCacheEntries() const {
+    return cacheEntries_;
+}
+
+size_t Config::getStoreMegabytes() const {
+    return storeMegabytes_;
+}
+
+const std::string& Config::getStoreFilePath() const {
+    return storeFilePath_;
+}
+
+ResponseFlush Config::getFlushMode(size_t listener) const {
+    return flushModes_[std::min(listener, flushModes_.size() - 1)];
+}
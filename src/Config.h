@@ -9,8 +9,11 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "SimdLevel.h"
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <vector>
 
 /**
  * @brief Уровни логирования
@@ -22,6 +25,22 @@ enum class LogLevel {
     CRITICAL    ///< Критическая ошибка
 };
 
+/**
+ * @brief Бэкенд ввода-вывода для сеансов
+ */
+enum class IoBackend {
+    EPOLL,      ///< epoll + recv/send (по умолчанию)
+    IO_URING    ///< io_uring, при отсутствии поддержки - epoll
+};
+
+/**
+ * @brief Момент отправки накопленных ответов
+ */
+enum class ResponseFlush {
+    IMMEDIATE,  ///< После разбора каждой принятой порции (по умолчанию)
+    BATCH       ///< В конце пакета или по порогу размера/времени
+};
+
 /**
  * @brief Класс конфигурации сервера
  */
@@ -30,6 +49,20 @@ private:
     std::string clientDbPath_;
     std::string logFilePath_;
     uint16_t port_;
+    unsigned int threads_;
+    unsigned int shards_;
+    int backlog_;
+    bool pinCpu_;
+    IoBackend ioBackend_;
+    int keepAliveTimeout_;
+    std::vector<ResponseFlush> flushModes_;
+    size_t flushBytes_;
+    int flushDelayMs_;
+    SimdLevel simdLevel_;
+    unsigned int computeThreads_;
+    size_t cacheEntries_;
+    size_t storeMegabytes_;
+    std::string storeFilePath_;
     
 public:
     /**
@@ -54,6 +87,31 @@ public:
     const std::string& getClientDbPath() const;
     const std::string& getLogFilePath() const;
     uint16_t getPort() const;
+    unsigned int getThreads() const;
+    unsigned int getShards() const;
+    int getBacklog() const;
+    bool getPinCpu() const;
+    IoBackend getIoBackend() const;
+    int getKeepAliveTimeout() const;
+    size_t getFlushBytes() const;
+    int getFlushDelayMs() const;
+    SimdLevel getSimdLevel() const;
+    unsigned int getComputeThreads() const;
+    size_t getCacheEntries() const;
+    size_t getStoreMegabytes() const;
+    const std::string& getStoreFilePath() const;
+    
+    /**
+     * @brief Режим отправки ответов для слушающего сокета
+     *
+     * Режимы задаются списком через запятую: i-й режим относится
+     * к i-му слушающему сокету (шарду), последний распространяется
+     * на остальные.
+     *
+     * @param listener Номер слушающего сокета
+     * @return Режим отправки ответов
+     */
+    ResponseFlush getFlushMode(size_t listener) const;
     
     /**
      * @brief Показать справку
@@ -65,6 +123,24 @@ public:
      * @brief Показать информацию о версии программы
      */
     void showVersion();
+    
+    /// Максимальное количество рабочих потоков
+    static const unsigned int MAX_THREADS = 256;
+    
+    /// Максимальный таймаут ожидания следующего пакета в сеансе keep-alive (сек)
+    static const int MAX_KEEPALIVE_TIMEOUT = 3600;
+    
+    /// Максимальный порог размера отложенного ответа (байт)
+    static const long MAX_FLUSH_BYTES = 16L * 1024 * 1024;
+    
+    /// Максимальный порог задержки отложенного ответа (мс)
+    static const int MAX_FLUSH_DELAY_MS = 1000;
+    
+    /// Максимальная емкость кэша результатов (записей)
+    static const long MAX_CACHE_ENTRIES = 16L * 1024 * 1024;
+    
+    /// Максимальный объем памяти хранилища именованных векторов (МБ)
+    static const long MAX_STORE_MEGABYTES = 64L * 1024;
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,155 @@
+#include "ConnectionReader.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/uio.h>
+
+/**
+ * @brief Округлить вверх до степени двойки
+ */
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+ConnectionReader::ConnectionReader(size_t capacity)
+    : buffer_(roundUpPowerOfTwo(capacity < 2 ? 2 : capacity)),
+      mask_(buffer_.size() - 1),
+      head_(0),
+      tail_(0) {
+}
+
+ssize_t ConnectionReader::fill(int socket, bool& drained) {
+    if (space() == 0) {
+        grow(buffer_.size() * 2);
+    }
+
+    // Свободное место кольца - не более двух непрерывных участков
+    size_t offered = space();
+    size_t start = tail_ & mask_;
+    size_t first = std::min(offered, buffer_.size() - start);
+
+    struct iovec parts[2];
+    parts[0].iov_base = buffer_.data() + start;
+    parts[0].iov_len = first;
+    parts[1].iov_base = buffer_.data();
+    parts[1].iov_len = offered - first;
+
+    ssize_t received = readv(socket, parts, parts[1].iov_len > 0 ? 2 : 1);
+    if (received > 0) {
+        tail_ += static_cast<uint64_t>(received);
+        // Короткое чтение потокового сокета: ядро отдало все, что было
+        drained = static_cast<size_t>(received) < offered;
+    } else {
+        drained = received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    return received;
+}
+
+void ConnectionReader::append(const char* data, size_t size) {
+    if (size > space()) {
+        grow(available() + size);
+    }
+
+    size_t start = tail_ & mask_;
+    size_t first = std::min(size, buffer_.size() - start);
+    memcpy(buffer_.data() + start, data, first);
+    memcpy(buffer_.data(), data + first, size - first);
+    tail_ += size;
+}
+
+bool ConnectionReader::readUntil(const std::string& delimiters, size_t maxLength,
+                                 std::string& str) {
+    size_t window = std::min(available(), maxLength + 1);
+    for (size_t i = 0; i < window; i++) {
+        if (delimiters.find(at(i)) != std::string::npos) {
+            str.resize(i);
+            copyOut(&str[0], i);
+            head_ += i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConnectionReader::readExact(void* data, size_t size) {
+    if (available() < size) {
+        return false;
+    }
+    copyOut(data, size);
+    head_ += size;
+    return true;
+}
+
+bool ConnectionReader::readU32LE(uint32_t& value) {
+    if (!peekU32LE(0, value)) {
+        return false;
+    }
+    head_ += sizeof(value);
+    return true;
+}
+
+bool ConnectionReader::peekU32LE(size_t offset, uint32_t& value) const {
+    if (available() < offset + 4) {
+        return false;
+    }
+    value = static_cast<uint32_t>(static_cast<unsigned char>(at(offset))) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(at(offset + 1))) << 8) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(at(offset + 2))) << 16) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(at(offset + 3))) << 24);
+    return true;
+}
+
+const char* ConnectionReader::contiguous(size_t& size) const {
+    size_t start = head_ & mask_;
+    size = std::min(available(), buffer_.size() - start);
+    return buffer_.data() + start;
+}
+
+size_t ConnectionReader::readSome(std::string& str, size_t maxLength) {
+    size_t size = peek(str, maxLength);
+    head_ += size;
+    return size;
+}
+
+size_t ConnectionReader::peek(std::string& str, size_t maxLength) const {
+    size_t size = std::min(available(), maxLength);
+    str.resize(size);
+    copyOut(&str[0], size);
+    return size;
+}
+
+void ConnectionReader::discard(size_t size) {
+    head_ += std::min(size, available());
+}
+
+size_t ConnectionReader::skip(const std::string& chars) {
+    size_t count = 0;
+    while (count < available() && chars.find(at(count)) != std::string::npos) {
+        count++;
+    }
+    head_ += count;
+    return count;
+}
+
+void ConnectionReader::grow(size_t minimum) {
+    std::vector<char> larger(roundUpPowerOfTwo(minimum));
+    size_t size = available();
+    copyOut(larger.data(), size);
+
+    buffer_.swap(larger);
+    mask_ = buffer_.size() - 1;
+    head_ = 0;
+    tail_ = size;
+}
+
+void ConnectionReader::copyOut(void* data, size_t size) const {
+    size_t start = head_ & mask_;
+    size_t first = std::min(size, buffer_.size() - start);
+    char* out = static_cast<char*>(data);
+    memcpy(out, buffer_.data() + start, first);
+    memcpy(out + first, buffer_.data(), size - first);
+}
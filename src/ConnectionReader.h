@@ -0,0 +1,175 @@
+/**
+ * @file ConnectionReader.h
+ * @brief Кольцевой буфер приема данных соединения
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef CONNECTIONREADER_H
+#define CONNECTIONREADER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+/**
+ * @brief Буферизованный читатель соединения
+ *
+ * Принятые байты попадают в кольцевой буфер одним readv на событие
+ * готовности и затем разбираются примитивами readUntil/readExact/readU32LE.
+ * Каждый байт копируется из ядра один раз, а разделитель или поле,
+ * пришедшие в разных сегментах TCP, собираются в буфере.
+ * При нехватке места буфер увеличивается вдвое.
+ */
+class ConnectionReader {
+public:
+    /**
+     * @brief Конструктор
+     * @param capacity Начальная емкость (округляется до степени двойки)
+     */
+    explicit ConnectionReader(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Прочитать данные сокета в свободное место буфера (один readv)
+     * @param socket Неблокирующий сокет
+     * @param drained Выходной параметр: true - в сокете больше нет данных
+     *                (прочитано меньше свободного места или EAGAIN)
+     * @return Как у recv: количество байт, 0 - соединение закрыто, -1 - ошибка (errno)
+     */
+    ssize_t fill(int socket, bool& drained);
+
+    /**
+     * @brief Добавить байты, принятые внешним механизмом ввода-вывода
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void append(const char* data, size_t size);
+
+    /**
+     * @brief Прочитать строку до разделителя
+     *
+     * Разделитель поглощается, но в строку не входит.
+     *
+     * @param delimiters Допустимые разделители (может содержать '\0')
+     * @param maxLength Максимальная длина строки без разделителя
+     * @param str Строка (выходной параметр)
+     * @return true - разделитель найден среди первых maxLength + 1 байт
+     */
+    bool readUntil(const std::string& delimiters, size_t maxLength, std::string& str);
+
+    /**
+     * @brief Прочитать ровно size байт
+     * @param data Буфер назначения
+     * @param size Количество байт
+     * @return true - данные прочитаны, false - байт пока недостаточно
+     */
+    bool readExact(void* data, size_t size);
+
+    /**
+     * @brief Прочитать uint32 в little-endian
+     * @param value Значение в хостовом порядке (выходной параметр)
+     * @return true - значение прочитано
+     */
+    bool readU32LE(uint32_t& value);
+
+    /**
+     * @brief Прочитать uint32 в little-endian, не продвигая позицию чтения
+     * @param offset Смещение от позиции чтения
+     * @param value Значение в хостовом порядке (выходной параметр)
+     * @return true - байты по смещению уже приняты
+     */
+    bool peekU32LE(size_t offset, uint32_t& value) const;
+
+    /**
+     * @brief Непрерывный участок непрочитанных данных
+     *
+     * Данные в кольце лежат не более чем двумя участками; возвращается
+     * первый из них. Позволяет обработать байты прямо в буфере приема
+     * и затем отбросить их методом discard().
+     *
+     * @param size Размер участка (выходной параметр)
+     * @return Указатель на первый непрочитанный байт
+     */
+    const char* contiguous(size_t& size) const;
+
+    /**
+     * @brief Прочитать все доступные байты, но не больше maxLength
+     * @param str Строка (выходной параметр)
+     * @param maxLength Максимальная длина
+     * @return Количество прочитанных байт
+     */
+    size_t readSome(std::string& str, size_t maxLength);
+
+    /**
+     * @brief Скопировать доступные байты, не продвигая позицию чтения
+     * @param str Строка (выходной параметр)
+     * @param maxLength Максимальная длина
+     * @return Количество скопированных байт
+     */
+    size_t peek(std::string& str, size_t maxLength) const;
+
+    /**
+     * @brief Отбросить начальные байты
+     * @param size Количество байт (не больше available())
+     */
+    void discard(size_t size);
+
+    /**
+     * @brief Пропустить начальные байты из заданного набора
+     * @param chars Набор пропускаемых байт
+     * @return Количество пропущенных байт
+     */
+    size_t skip(const std::string& chars);
+
+    /**
+     * @brief Количество непрочитанных байт
+     * @return Количество байт
+     */
+    size_t available() const { return static_cast<size_t>(tail_ - head_); }
+
+    /**
+     * @brief Свободное место в буфере
+     * @return Количество байт
+     */
+    size_t space() const { return buffer_.size() - available(); }
+
+    /**
+     * @brief Текущая емкость буфера
+     * @return Количество байт
+     */
+    size_t capacity() const { return buffer_.size(); }
+
+    /// Начальная емкость по умолчанию (вмещает пакет прежнего формата целиком)
+    static const size_t DEFAULT_CAPACITY = 16384;
+
+private:
+    std::vector<char> buffer_;
+    size_t mask_;
+    uint64_t head_;     ///< Позиция чтения (монотонно растет)
+    uint64_t tail_;     ///< Позиция записи (монотонно растет)
+
+    /**
+     * @brief Байт по смещению от позиции чтения
+     * @param offset Смещение
+     * @return Байт
+     */
+    char at(size_t offset) const { return buffer_[(head_ + offset) & mask_]; }
+
+    /**
+     * @brief Увеличить емкость, сохранив непрочитанные данные
+     * @param minimum Минимальная требуемая емкость
+     */
+    void grow(size_t minimum);
+
+    /**
+     * @brief Скопировать байты из буфера без продвижения позиции чтения
+     * @param data Буфер назначения
+     * @param size Количество байт (не больше available())
+     */
+    void copyOut(void* data, size_t size) const;
+};
+
+#endif // CONNECTIONREADER_H
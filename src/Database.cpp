@@ -13,7 +13,7 @@ bool Database::loadFromFile(const std::string& filename) {
         return false;
     }
     
-    clients_.clear();
+    std::unordered_map<std::string, std::string> clients;
     std::string line;
     int lineNum = 0;
     
@@ -46,28 +46,39 @@ bool Database::loadFromFile(const std::string& filename) {
             continue;
         }
         
-        clients_[login] = password;
+        clients[login] = password;
     }
     
-    std::cout << "Загружено клиентов: " << clients_.size() << std::endl;
+    std::cout << "Загружено клиентов: " << clients.size() << std::endl;
     
     // Вывод загруженных пользователей для отладки
     std::cout << "Загруженные пользователи:" << std::endl;
-    for (const auto& client : clients_) {
+    for (const auto& client : clients) {
         std::cout << "  " << client.first << " : " << client.second << std::endl;
     }
     
+    // Подменяем базу целиком, чтобы читатели не видели ее частично загруженной
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients_.swap(clients);
+    
     return true;
 }
 
 bool Database::userExists(const std::string& login) const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return clients_.find(login) != clients_.end();
 }
 
 std::string Database::getPassword(const std::string& login) const {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = clients_.find(login);
     if (it != clients_.end()) {
         return it->second;
     }
     return "";
 }
+
+size_t Database::getClientCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
@@ -11,13 +11,18 @@
 
 #include <string>
 #include <unordered_map>
+#include <mutex>
 
 /**
  * @brief Класс базы данных клиентов
+ *
+ * Потокобезопасен: обращения рабочих потоков и перезагрузка
+ * базы синхронизированы мьютексом.
  */
 class Database {
 private:
     std::unordered_map<std::string, std::string> clients_; // login -> password (open text)
+    mutable std::mutex mutex_;
     
 public:
     /**
@@ -45,7 +50,7 @@ public:
      * @brief Получить количество клиентов
      * @return Количество клиентов
      */
-    size_t getClientCount() const { return clients_.size(); }
+    size_t getClientCount() const;
 };
 
 #endif // DATABASE_H
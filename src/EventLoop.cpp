@@ -0,0 +1,270 @@
+#include "EventLoop.h"
+#include <iostream>
+#include <cerrno>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * @brief Перевести сокет в неблокирующий режим
+ */
+static bool setNonBlocking(int socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    return fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+EventLoop::EventLoop(const Database& database, Logger& logger)
+    : database_(database),
+      logger_(logger),
+      epollFd_(epoll_create1(EPOLL_CLOEXEC)),
+      listenSocket_(-1),
+      wakeFd_(-1),
+      queue_(nullptr),
+      flushPollMs_(0),
+      deferredOutput_(false),
+      pendingWork_(false) {
+    if (epollFd_ < 0) {
+        logger_.logSystemError("Ошибка создания epoll");
+    }
+}
+
+EventLoop::~EventLoop() {
+    sessions_.clear();
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+    }
+    if (epollFd_ >= 0) {
+        close(epollFd_);
+    }
+}
+
+bool EventLoop::addListener(int socket, const SessionOptions& options) {
+    if (!setNonBlocking(socket)) {
+        logger_.logSystemError("Ошибка перевода сокета в неблокирующий режим");
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = socket;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event) < 0) {
+        logger_.logSystemError("Ошибка регистрации слушающего сокета в epoll");
+        return false;
+    }
+
+    listenSocket_ = socket;
+    listenerOptions_ = options;
+    noteFlushMode(options);
+    return true;
+}
+
+bool EventLoop::attachQueue(ConnectionQueue* queue, const SessionOptions& options) {
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        logger_.logSystemError("Ошибка создания eventfd");
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = wakeFd_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event) < 0) {
+        logger_.logSystemError("Ошибка регистрации eventfd в epoll");
+        return false;
+    }
+
+    queue_ = queue;
+    queueOptions_ = options;
+    noteFlushMode(options);
+    return true;
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void EventLoop::run(const std::atomic<bool>& running) {
+    std::vector<struct epoll_event> events(MAX_EVENTS);
+
+    while (running) {
+        // Пока есть отложенные ответы, просыпаемся к сроку их отправки;
+        // пока есть незавершенный разбор, только забираем готовые события
+        int timeout = pendingWork_ ? 0 : deferredOutput_ ? flushPollMs_ : TICK_MS;
+        int count = epoll_wait(epollFd_, events.data(), MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            logger_.logSystemError("Ошибка ожидания событий epoll");
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int socket = events[i].data.fd;
+            if (socket == listenSocket_) {
+                acceptConnections();
+            } else if (socket == wakeFd_) {
+                drainQueue();
+            } else {
+                handleSessionEvent(socket, events[i].events);
+            }
+        }
+
+        if (pendingWork_) {
+            resumeSessions();
+        }
+        if (flushPollMs_ > 0) {
+            flushDeferredOutput();
+        }
+        closeIdleSessions();
+    }
+}
+
+void EventLoop::acceptConnections() {
+    while (true) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+
+        int clientSocket = accept4(listenSocket_,
+                                   (struct sockaddr*)&clientAddr,
+                                   &clientLen,
+                                   SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSocket < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logger_.logSystemError("Ошибка принятия соединения");
+            }
+            return;
+        }
+
+        // Получение IP клиента
+        char clientIP[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, sizeof(clientIP));
+
+        logger_.log(LogLevel::INFO, "Новое подключение", clientIP);
+
+        addSession(clientSocket, clientIP, listenerOptions_);
+    }
+}
+
+void EventLoop::drainQueue() {
+    uint64_t pending = 0;
+    if (read(wakeFd_, &pending, sizeof(pending)) != sizeof(pending)) {
+        return;
+    }
+
+    // Забираем не больше соединений, чем было сигналов для этого цикла:
+    // остальные достанутся другим рабочим потокам
+    AcceptedConnection connection;
+    while (pending > 0 && queue_->pop(connection)) {
+        addSession(connection.socket, connection.peer, queueOptions_);
+        pending--;
+    }
+}
+
+void EventLoop::addSession(int socket, const std::string& peer,
+                          const SessionOptions& options) {
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = socket;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event) < 0) {
+        logger_.logSystemError("Ошибка регистрации клиента в epoll");
+        close(socket);
+        return;
+    }
+
+    sessions_[socket].reset(new Session(socket, peer, database_, logger_, options));
+}
+
+void EventLoop::handleSessionEvent(int socket, uint32_t events) {
+    auto it = sessions_.find(socket);
+    if (it == sessions_.end()) {
+        return;
+    }
+    Session& session = *it->second;
+
+    bool alive = true;
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        alive = session.onReadable();
+    }
+    if (alive && (events & EPOLLOUT)) {
+        alive = session.onWritable();
+    }
+
+    if (!alive || session.isFinished()) {
+        // Деструктор сеанса закрывает сокет, epoll снимает его сам
+        sessions_.erase(it);
+    } else if (session.hasPendingWork()) {
+        pendingWork_ = true;
+    }
+}
+
+void EventLoop::resumeSessions() {
+    // Каждый сеанс с незавершенным разбором делает по одному шагу
+    // между проверками событий, поэтому остальные сеансы не ждут
+    pendingWork_ = false;
+    for (auto it = sessions_.begin(); it != sessions_.end(); ) {
+        Session& session = *it->second;
+        if (!session.hasPendingWork()) {
+            ++it;
+            continue;
+        }
+        session.resume();
+        if (!session.onWritable() || session.isFinished()) {
+            it = sessions_.erase(it);
+            continue;
+        }
+        if (session.hasPendingWork()) {
+            pendingWork_ = true;
+        }
+        ++it;
+    }
+}
+
+void EventLoop::noteFlushMode(const SessionOptions& options) {
+    if (options.flushMode != ResponseFlush::BATCH) {
+        return;
+    }
+    int pollMs = std::max(1, std::min(options.flushDelayMs, static_cast<int>(TICK_MS)));
+    flushPollMs_ = (flushPollMs_ == 0) ? pollMs : std::min(flushPollMs_, pollMs);
+}
+
+void EventLoop::flushDeferredOutput() {
+    auto now = std::chrono::steady_clock::now();
+    deferredOutput_ = false;
+    for (auto it = sessions_.begin(); it != sessions_.end(); ) {
+        Session& session = *it->second;
+        if (session.pollFlushDeadline(now) && !session.onWritable()) {
+            it = sessions_.erase(it);
+            continue;
+        }
+        if (session.hasDeferredOutput()) {
+            deferredOutput_ = true;
+        }
+        ++it;
+    }
+}
+
+void EventLoop::closeIdleSessions() {
+    time_t now = time(nullptr);
+    for (auto it = sessions_.begin(); it != sessions_.end(); ) {
+        if (it->second->isTimedOut(now)) {
+            logger_.log(LogLevel::WARNING, "Таймаут клиента",
+                       "socket: " + std::to_string(it->first));
+            it = sessions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file EventLoop.h
+ * @brief Цикл обработки событий на основе epoll
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include "Database.h"
+#include "Logger.h"
+#include "IoLoop.h"
+#include "Session.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * @brief Реактор: неблокирующий прием соединений и обслуживание сеансов
+ *
+ * Все сокеты регистрируются в epoll в режиме edge-triggered.
+ * Один поток обслуживает любое количество одновременных сеансов.
+ */
+class EventLoop : public IoLoop {
+public:
+    /**
+     * @brief Конструктор
+     * @param database База клиентов
+     * @param logger Журнал
+     */
+    EventLoop(const Database& database, Logger& logger);
+
+    /**
+     * @brief Деструктор (закрывает все сеансы)
+     */
+    ~EventLoop() override;
+
+    /**
+     * @brief Проверить, создан ли epoll
+     * @return true - цикл готов к работе
+     */
+    bool isValid() const override { return epollFd_ >= 0; }
+
+    /**
+     * @brief Зарегистрировать слушающий сокет
+     * @param socket Слушающий сокет (переводится в неблокирующий режим)
+     * @param options Параметры сеансов, принятых через этот сокет
+     * @return true - успешно
+     */
+    bool addListener(int socket, const SessionOptions& options) override;
+
+    /**
+     * @brief Подключить очередь принятых соединений
+     * @param queue Очередь, общая для всех рабочих потоков
+     * @param options Параметры сеансов, полученных из очереди
+     * @return true - успешно
+     */
+    bool attachQueue(ConnectionQueue* queue, const SessionOptions& options) override;
+
+    /**
+     * @brief Сообщить циклу о новом соединении в очереди
+     *
+     * Вызывается из потока приема после push в очередь.
+     */
+    void wakeup() override;
+
+    /**
+     * @brief Выполнять цикл, пока установлен флаг
+     * @param running Флаг работы сервера
+     */
+    void run(const std::atomic<bool>& running) override;
+
+    /**
+     * @brief Количество открытых сеансов
+     * @return Количество сеансов
+     */
+    size_t getSessionCount() const override { return sessions_.size(); }
+
+private:
+    const Database& database_;
+    Logger& logger_;
+    SessionOptions listenerOptions_;
+    SessionOptions queueOptions_;
+    int epollFd_;
+    int listenSocket_;
+    int wakeFd_;
+    ConnectionQueue* queue_;
+    int flushPollMs_;           ///< Период проверки отложенных ответов (0 - режима BATCH нет)
+    bool deferredOutput_;       ///< Есть сеансы с отложенным ответом
+    bool pendingWork_;          ///< Есть сеансы с разбором, остановленным бюджетом шага
+    std::unordered_map<int, std::unique_ptr<Session>> sessions_;
+
+    /// Максимальное число событий за один вызов epoll_wait
+    static const int MAX_EVENTS = 256;
+    /// Период проверки таймаутов в миллисекундах
+    static const int TICK_MS = 1000;
+
+    /**
+     * @brief Принять все ожидающие соединения
+     */
+    void acceptConnections();
+
+    /**
+     * @brief Забрать соединения из очереди
+     */
+    void drainQueue();
+
+    /**
+     * @brief Создать сеанс для нового соединения
+     * @param socket Неблокирующий сокет клиента
+     * @param peer IP адрес клиента
+     * @param options Параметры сеанса
+     */
+    void addSession(int socket, const std::string& peer, const SessionOptions& options);
+
+    /**
+     * @brief Обработать событие сокета клиента
+     * @param socket Сокет клиента
+     * @param events Маска событий epoll
+     */
+    void handleSessionEvent(int socket, uint32_t events);
+
+    /**
+     * @brief Продолжить разбор сеансов, остановленный бюджетом шага
+     */
+    void resumeSessions();
+
+    /**
+     * @brief Учесть режим отправки ответов нового источника сеансов
+     * @param options Параметры сеансов
+     */
+    void noteFlushMode(const SessionOptions& options);
+
+    /**
+     * @brief Отправить отложенные ответы, срок которых наступил
+     */
+    void flushDeferredOutput();
+
+    /**
+     * @brief Закрыть сеансы, превысившие таймаут бездействия
+     */
+    void closeIdleSessions();
+};
+
+#endif // EVENTLOOP_H
@@ -0,0 +1,29 @@
+#include "IoLoop.h"
+#include "EventLoop.h"
+#include "UringLoop.h"
+
+IoLoop* IoLoop::create(IoBackend backend, const Database& database, Logger& logger) {
+#ifdef VEALC_HAVE_IO_URING
+    if (backend == IoBackend::IO_URING && UringLoop::isSupported()) {
+        UringLoop* loop = new UringLoop(database, logger);
+        if (loop->isValid()) {
+            return loop;
+        }
+        delete loop;
+    }
+#else
+    (void)backend;
+#endif
+    return new EventLoop(database, logger);
+}
+
+bool IoLoop::isBackendAvailable(IoBackend backend) {
+    if (backend == IoBackend::EPOLL) {
+        return true;
+    }
+#ifdef VEALC_HAVE_IO_URING
+    return UringLoop::isSupported();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,102 @@
+/**
+ * @file IoLoop.h
+ * @brief Общий интерфейс циклов ввода-вывода (epoll, io_uring)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef IOLOOP_H
+#define IOLOOP_H
+
+#include "Config.h"
+#include "Database.h"
+#include "Logger.h"
+#include "MpmcQueue.h"
+#include "Session.h"
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Принятое соединение, передаваемое рабочему потоку
+ */
+struct AcceptedConnection {
+    int socket;                 ///< Неблокирующий сокет клиента
+    char peer[16];              ///< IP адрес клиента (INET_ADDRSTRLEN)
+};
+
+/// Очередь передачи соединений от потока приема рабочим потокам
+typedef MpmcQueue<AcceptedConnection> ConnectionQueue;
+
+/**
+ * @brief Цикл ввода-вывода, обслуживающий сеансы одного потока
+ *
+ * Цикл либо сам принимает соединения (addListener), либо получает их
+ * из общей очереди от потока приема (attachQueue + wakeup).
+ */
+class IoLoop {
+public:
+    virtual ~IoLoop() {}
+
+    /**
+     * @brief Проверить, готов ли цикл к работе
+     * @return true - ресурсы ядра созданы
+     */
+    virtual bool isValid() const = 0;
+
+    /**
+     * @brief Зарегистрировать слушающий сокет
+     * @param socket Слушающий сокет
+     * @param options Параметры сеансов, принятых через этот сокет
+     * @return true - успешно
+     */
+    virtual bool addListener(int socket, const SessionOptions& options) = 0;
+
+    /**
+     * @brief Подключить очередь принятых соединений
+     * @param queue Очередь, общая для всех рабочих потоков
+     * @param options Параметры сеансов, полученных из очереди
+     * @return true - успешно
+     */
+    virtual bool attachQueue(ConnectionQueue* queue, const SessionOptions& options) = 0;
+
+    /**
+     * @brief Сообщить циклу о новом соединении в очереди
+     *
+     * Вызывается из потока приема после push в очередь.
+     */
+    virtual void wakeup() = 0;
+
+    /**
+     * @brief Выполнять цикл, пока установлен флаг
+     * @param running Флаг работы сервера
+     */
+    virtual void run(const std::atomic<bool>& running) = 0;
+
+    /**
+     * @brief Количество открытых сеансов
+     * @return Количество сеансов
+     */
+    virtual size_t getSessionCount() const = 0;
+
+    /**
+     * @brief Создать цикл для выбранного бэкенда
+     *
+     * Если io_uring недоступен в ядре, создается цикл epoll.
+     *
+     * @param backend Бэкенд ввода-вывода
+     * @param database База клиентов
+     * @param logger Журнал
+     * @return Новый цикл (владение переходит к вызывающему)
+     */
+    static IoLoop* create(IoBackend backend, const Database& database, Logger& logger);
+
+    /**
+     * @brief Проверить, доступен ли бэкенд в текущем ядре
+     * @param backend Бэкенд ввода-вывода
+     * @return true - бэкенд можно использовать
+     */
+    static bool isBackendAvailable(IoBackend backend);
+};
+
+#endif // IOLOOP_H
@@ -29,16 +29,19 @@ std::string Logger::levelToString(LogLevel level) const {
 
 std::string Logger::getCurrentDateTime() const {
     time_t now = time(nullptr);
-    struct tm* timeinfo = localtime(&now);
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
     
     char buffer[80];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo);
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
     
     return std::string(buffer);
 }
 
 void Logger::log(LogLevel level, const std::string& message, 
                 const std::string& details) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
     if (!logFile_.is_open()) {
         return;
     }
@@ -71,5 +74,7 @@ void Logger::log(LogLevel level, const std::string& message,
 }
 
 void Logger::logSystemError(const std::string& context) {
-    log(LogLevel::ERROR, context, strerror(errno));
+    // strerror_r вместо strerror: журнал пишут несколько потоков
+    char buffer[256];
+    log(LogLevel::ERROR, context, strerror_r(errno, buffer, sizeof(buffer)));
 }
@@ -12,15 +12,19 @@
 #include <string>
 #include <fstream>
 #include <ctime>
+#include <mutex>
 #include "Config.h"
 
 /**
  * @brief Класс логирования
+ *
+ * Потокобезопасен: запись одного сообщения выполняется под мьютексом.
  */
 class Logger {
 private:
     std::string logFilePath_;
     std::ofstream logFile_;
+    std::mutex mutex_;
     
     std::string levelToString(LogLevel level) const;
     std::string getCurrentDateTime() const;
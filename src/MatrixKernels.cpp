@@ -0,0 +1,129 @@
+#include "MatrixKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MATRIXKERNELS_X86 1
+#endif
+
+#ifdef MATRIXKERNELS_X86
+
+using MatrixKernels::DOT_ROWS;
+
+/**
+ * @brief Скалярное произведение, 8 элементов за шаг
+ *
+ * _mm256_mul_epi32 умножает четные 32-битные полосы со знаком;
+ * нечетные полосы сдвигаются на их место.
+ */
+__attribute__((target("avx2")))
+static size_t dotAvx2(const int32_t* x, const int32_t* const* rows, size_t count, int64_t* dots) {
+    const size_t group = 8;
+    size_t done = count - count % group;
+
+    __m256i total[DOT_ROWS];
+    for (size_t r = 0; r < DOT_ROWS; r++) {
+        total[r] = _mm256_setzero_si256();
+    }
+    for (size_t i = 0; i < done; i += group) {
+        __m256i even = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        __m256i odd = _mm256_srli_epi64(even, 32);
+        for (size_t r = 0; r < DOT_ROWS; r++) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[r] + i));
+            total[r] = _mm256_add_epi64(total[r], _mm256_mul_epi32(even, v));
+            total[r] = _mm256_add_epi64(total[r], _mm256_mul_epi32(odd, _mm256_srli_epi64(v, 32)));
+        }
+    }
+
+    for (size_t r = 0; r < DOT_ROWS; r++) {
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total[r]),
+                                     _mm256_extracti128_si256(total[r], 1));
+        dots[r] = static_cast<int64_t>(static_cast<uint64_t>(dots[r]) +
+                                       static_cast<uint64_t>(_mm_cvtsi128_si64(half)) +
+                                       static_cast<uint64_t>(_mm_extract_epi64(half, 1)));
+    }
+    return done;
+}
+
+// Интринсики AVX-512 в GCC 12 используют заведомо неинициализированные
+// регистры-заглушки (_mm512_undefined_*), на что ложно срабатывает -Wextra
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+/**
+ * @brief Скалярное произведение, 16 элементов за шаг
+ */
+__attribute__((target("avx512f")))
+static size_t dotAvx512(const int32_t* x, const int32_t* const* rows, size_t count, int64_t* dots) {
+    const size_t group = 16;
+    size_t done = count - count % group;
+
+    __m512i total[DOT_ROWS];
+    for (size_t r = 0; r < DOT_ROWS; r++) {
+        total[r] = _mm512_setzero_si512();
+    }
+    for (size_t i = 0; i < done; i += group) {
+        __m512i even = _mm512_loadu_si512(x + i);
+        __m512i odd = _mm512_srli_epi64(even, 32);
+        for (size_t r = 0; r < DOT_ROWS; r++) {
+            __m512i v = _mm512_loadu_si512(rows[r] + i);
+            total[r] = _mm512_add_epi64(total[r], _mm512_mul_epi32(even, v));
+            total[r] = _mm512_add_epi64(total[r], _mm512_mul_epi32(odd, _mm512_srli_epi64(v, 32)));
+        }
+    }
+
+    for (size_t r = 0; r < DOT_ROWS; r++) {
+        dots[r] = static_cast<int64_t>(static_cast<uint64_t>(dots[r]) +
+                                       static_cast<uint64_t>(_mm512_reduce_add_epi64(total[r])));
+    }
+    return done;
+}
+
+#pragma GCC diagnostic pop
+
+/**
+ * @brief Сумма по столбцам: строка расширяется до int64 и прибавляется
+ */
+__attribute__((target("avx2")))
+static size_t addRowAvx2(const int32_t* row, size_t count, int64_t* sums) {
+    const size_t group = 8;
+    size_t done = count - count % group;
+
+    for (size_t i = 0; i < done; i += group) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        __m256i* low = reinterpret_cast<__m256i*>(sums + i);
+        __m256i* high = reinterpret_cast<__m256i*>(sums + i + 4);
+        _mm256_storeu_si256(low, _mm256_add_epi64(_mm256_loadu_si256(low),
+                                 _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v))));
+        _mm256_storeu_si256(high, _mm256_add_epi64(_mm256_loadu_si256(high),
+                                  _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1))));
+    }
+    return done;
+}
+
+#endif // MATRIXKERNELS_X86
+
+MatrixKernels::DotKernel MatrixKernels::dot(SimdLevel level) {
+#ifdef MATRIXKERNELS_X86
+    if (level == SimdLevel::AVX512) {
+        return dotAvx512;
+    }
+    if (level == SimdLevel::AVX2) {
+        return dotAvx2;
+    }
+#else
+    (void)level;
+#endif
+    return nullptr;
+}
+
+MatrixKernels::AddRowKernel MatrixKernels::addRow(SimdLevel level) {
+#ifdef MATRIXKERNELS_X86
+    if (level == SimdLevel::AVX2 || level == SimdLevel::AVX512) {
+        return addRowAvx2;
+    }
+#else
+    (void)level;
+#endif
+    return nullptr;
+}
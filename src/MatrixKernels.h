@@ -0,0 +1,72 @@
+/**
+ * @file MatrixKernels.h
+ * @brief SIMD-ядра операций над пакетом как матрицей
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef MATRIXKERNELS_H
+#define MATRIXKERNELS_H
+
+#include "SimdLevel.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Ядра скалярного произведения и суммы по столбцам
+ *
+ * Ядра работают с элементами int32 и 64-битными накопителями:
+ * произведение int32 точно помещается в int64, суммы произведений
+ * берутся по модулю 2^64. Ядро обрабатывает только полные группы
+ * элементов и возвращает их количество; хвост остается поэлементному
+ * циклу VectorProcessor.
+ *
+ * Скалярное произведение считается сразу для DOT_ROWS строк с одним
+ * и тем же вектором: каждая загрузка общего вектора используется
+ * DOT_ROWS раз. Ядро умножения есть для AVX2 и AVX-512 (умножение
+ * упирается в вычисления, а не в память), сложение строк - только
+ * для AVX2.
+ */
+namespace MatrixKernels {
+
+/// Количество строк, обрабатываемых ядром скалярного произведения за вызов
+const size_t DOT_ROWS = 4;
+
+/**
+ * @brief Ядро скалярного произведения вектора с DOT_ROWS строками
+ * @param x Общий вектор
+ * @param rows Строки (допускаются совпадающие указатели)
+ * @param count Количество элементов
+ * @param dots Накопители произведений, по строкам (увеличиваются по модулю 2^64)
+ * @return Количество обработанных элементов
+ */
+typedef size_t (*DotKernel)(const int32_t* x, const int32_t* const* rows,
+                            size_t count, int64_t* dots);
+
+/**
+ * @brief Ядро прибавления строки к суммам столбцов
+ * @param row Строка
+ * @param count Количество элементов
+ * @param sums Суммы столбцов (sums[k] += row[k])
+ * @return Количество обработанных элементов
+ */
+typedef size_t (*AddRowKernel)(const int32_t* row, size_t count, int64_t* sums);
+
+/**
+ * @brief Получить ядро скалярного произведения
+ * @param level Набор инструкций (кроме AUTO), поддерживаемый процессором
+ * @return Ядро или nullptr, если для набора ядра нет
+ */
+DotKernel dot(SimdLevel level);
+
+/**
+ * @brief Получить ядро суммы по столбцам
+ * @param level Набор инструкций (кроме AUTO), поддерживаемый процессором
+ * @return Ядро или nullptr, если для набора ядра нет
+ */
+AddRowKernel addRow(SimdLevel level);
+
+} // namespace MatrixKernels
+
+#endif // MATRIXKERNELS_H
@@ -0,0 +1,127 @@
+/**
+ * @file MpmcQueue.h
+ * @brief Ограниченная lock-free очередь MPMC
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Ограниченная очередь для многих производителей и потребителей
+ *
+ * Кольцевой буфер с порядковым номером в каждой ячейке (схема Д. Вьюкова).
+ * Операции не используют мьютексов: производители и потребители
+ * захватывают ячейки через compare_exchange на общих счетчиках.
+ *
+ * @tparam T Тип элемента (копируемый)
+ */
+template <typename T>
+class MpmcQueue {
+public:
+    /**
+     * @brief Конструктор
+     * @param capacity Емкость (округляется вверх до степени двойки)
+     */
+    explicit MpmcQueue(size_t capacity)
+        : buffer_(roundUpPow2(capacity)),
+          mask_(buffer_.size() - 1),
+          head_(0),
+          tail_(0) {
+        for (size_t i = 0; i < buffer_.size(); i++) {
+            buffer_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * @brief Добавить элемент
+     * @param value Элемент
+     * @return false - очередь заполнена
+     */
+    bool push(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Извлечь элемент
+     * @param value Элемент (выходной параметр)
+     * @return false - очередь пуста
+     */
+    bool pop(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Получить емкость очереди
+     * @return Емкость
+     */
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+
+        Cell() : sequence(0), value() {}
+        Cell(const Cell&) : sequence(0), value() {}
+    };
+
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<Cell> buffer_;
+    const size_t mask_;
+
+    // Счетчики разнесены по разным кэш-линиям, чтобы не мешать друг другу
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+};
+
+#endif // MPMCQUEUE_H
@@ -0,0 +1,87 @@
+#include "PackedKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PACKEDKERNELS_X86 1
+#endif
+
+#ifdef PACKEDKERNELS_X86
+
+using PackedKernels::GROUP_ELEMENTS;
+
+/**
+ * @brief Маски перестановки и размеры групп для всех 256 ключей
+ */
+struct ShuffleTable {
+    unsigned char masks[256][16];   ///< Байт данных для каждого байта результата (0x80 - ноль)
+    unsigned char lengths[256];     ///< Байт данных группы (без ключа)
+
+    ShuffleTable() {
+        for (unsigned key = 0; key < 256; key++) {
+            unsigned char offset = 0;
+            for (size_t k = 0; k < GROUP_ELEMENTS; k++) {
+                unsigned length = ((key >> (2 * k)) & 3u) + 1;
+                for (unsigned b = 0; b < sizeof(uint32_t); b++) {
+                    masks[key][k * sizeof(uint32_t) + b] =
+                        (b < length) ? static_cast<unsigned char>(offset + b) : 0x80;
+                }
+                offset = static_cast<unsigned char>(offset + length);
+            }
+            lengths[key] = offset;
+        }
+    }
+};
+
+static const ShuffleTable& shuffleTable() {
+    static const ShuffleTable table;
+    return table;
+}
+
+/**
+ * @brief Распаковка группы за шаг: перестановка, zigzag, префиксная сумма
+ */
+__attribute__((target("ssse3")))
+static size_t decodeSsse3(const unsigned char* in, size_t size, size_t groups,
+                          uint32_t& previous, int32_t* out, size_t& consumed) {
+    const ShuffleTable& table = shuffleTable();
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i last = _mm_set1_epi32(static_cast<int>(previous));
+
+    size_t position = 0;
+    size_t done = 0;
+    while (done < groups && size - position >= PackedKernels::MAX_GROUP_BYTES) {
+        unsigned char key = in[position];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + position + 1));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.masks[key]));
+        __m128i zigzag = _mm_shuffle_epi8(bytes, mask);
+
+        // (z >> 1) ^ -(z & 1)
+        __m128i delta = _mm_xor_si128(_mm_srli_epi32(zigzag, 1),
+                                      _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(zigzag, one)));
+        delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+        delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+        __m128i values = _mm_add_epi32(delta, last);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done * GROUP_ELEMENTS), values);
+        last = _mm_shuffle_epi32(values, 0xFF);
+        position += 1 + table.lengths[key];
+        done++;
+    }
+
+    previous = static_cast<uint32_t>(_mm_cvtsi128_si32(last));
+    consumed = position;
+    return done;
+}
+
+#endif // PACKEDKERNELS_X86
+
+PackedKernels::DecodeKernel PackedKernels::decoder(SimdLevel level) {
+#ifdef PACKEDKERNELS_X86
+    if (level == SimdLevel::SSE41 || level == SimdLevel::AVX2 || level == SimdLevel::AVX512) {
+        return decodeSsse3;
+    }
+#else
+    (void)level;
+#endif
+    return nullptr;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file PackedKernels.h
+ * @brief SIMD-ядро распаковки сжатых значений (zigzag-дельты в group varint)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef PACKEDKERNELS_H
+#define PACKEDKERNELS_H
+
+#include "SimdLevel.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Распаковка сжатого вектора int32
+ *
+ * Элементы передаются группами по GROUP_ELEMENTS: байт-ключ, затем
+ * байты элементов группы. Два бита ключа на элемент (младшие - первый
+ * элемент) задают длину элемента минус 1, элемент - младшие байты
+ * беззнакового числа в little-endian. Число - zigzag-код разности
+ * с предыдущим элементом вектора (первый элемент - разность с нулем),
+ * разности складываются по модулю 2^32.
+ *
+ * Ядро распаковывает только полные группы, после ключа которых в буфере
+ * есть 16 байт (одна невыровненная загрузка на группу): перестановка
+ * байт по ключу (pshufb), zigzag-декодирование и префиксная сумма
+ * в регистре. Остаток буфера и неполная последняя группа вектора
+ * остаются поэлементному циклу PackedDecoder. Ядро есть только для
+ * SSE4.1 (на деле нужен SSSE3), процессоры с AVX2 и AVX-512 используют
+ * его же: за шаг обрабатывается одна группа, ширина регистра не помогает.
+ */
+namespace PackedKernels {
+
+/// Количество элементов в группе
+const size_t GROUP_ELEMENTS = 4;
+
+/// Наибольший размер группы в байтах (ключ и четыре элемента по 4 байта)
+const size_t MAX_GROUP_BYTES = 1 + GROUP_ELEMENTS * sizeof(uint32_t);
+
+/**
+ * @brief Размер группы по ключу
+ * @param key Байт-ключ
+ * @param elements Количество элементов в группе (у последней группы вектора может быть меньше)
+ * @return Размер в байтах вместе с ключом
+ */
+inline size_t groupBytes(unsigned char key, size_t elements) {
+    size_t bytes = 1;
+    for (size_t k = 0; k < elements; k++) {
+        bytes += ((key >> (2 * k)) & 3u) + 1;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Ядро распаковки полных групп
+ * @param in Сжатые байты, начиная с ключа группы
+ * @param size Количество доступных байт
+ * @param groups Наибольшее количество групп
+ * @param previous Предыдущий элемент вектора (обновляется)
+ * @param out Элементы в хостовом порядке байт (GROUP_ELEMENTS на группу)
+ * @param consumed Использовано байт
+ * @return Количество распакованных групп
+ */
+typedef size_t (*DecodeKernel)(const unsigned char* in, size_t size, size_t groups,
+                               uint32_t& previous, int32_t* out, size_t& consumed);
+
+/**
+ * @brief Получить ядро распаковки
+ * @param level Набор инструкций (кроме AUTO), поддерживаемый процессором
+ * @return Ядро или nullptr, если для набора ядра нет
+ */
+DecodeKernel decoder(SimdLevel level);
+
+} // namespace PackedKernels
+
+#endif // PACKEDKERNELS_H
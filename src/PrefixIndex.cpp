@@ -0,0 +1,62 @@
+#include "PrefixIndex.h"
+#include "VectorProcessor.h"
+#include <algorithm>
+
+const size_t PrefixIndex::LINEAR_ELEMENTS;
+
+void PrefixIndex::build(const int32_t* values) {
+    std::fill(nodes_, nodes_ + count_ + 1, Node());
+    for (size_t i = 1; i <= count_; i++) {
+        int32_t value = values[i - 1];
+        nodes_[i].total += value;
+        nodes_[i].positive += (value > 0) ? value : 0;
+        // Узел передает свою сумму родителю: построение за O(n)
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= count_) {
+            nodes_[parent].total += nodes_[i].total;
+            nodes_[parent].positive += nodes_[i].positive;
+        }
+    }
+}
+
+void PrefixIndex::update(size_t index, int32_t before, int32_t after) {
+    int64_t total = static_cast<int64_t>(after) - before;
+    int64_t positive = static_cast<int64_t>(after > 0 ? after : 0) - (before > 0 ? before : 0);
+    for (size_t i = index + 1; i <= count_; i += i & (~i + 1)) {
+        nodes_[i].total += total;
+        nodes_[i].positive += positive;
+    }
+}
+
+void PrefixIndex::prefix(size_t end, int64_t& total, int64_t& positive) const {
+    total = 0;
+    positive = 0;
+    for (size_t i = end; i > 0; i &= i - 1) {
+        total += nodes_[i].total;
+        positive += nodes_[i].positive;
+    }
+}
+
+void PrefixIndex::range(size_t begin, size_t end, int64_t& total, int64_t& positive) const {
+    int64_t beginTotal, beginPositive;
+    prefix(end, total, positive);
+    prefix(begin, beginTotal, beginPositive);
+    total -= beginTotal;
+    positive -= beginPositive;
+}
+
+void PrefixIndex::addRange(const int32_t* values, size_t begin, size_t end,
+                           SumAccumulator& sum) const {
+    if (end - begin <= LINEAR_ELEMENTS) {
+        sum.add(values + begin, end - begin);
+        return;
+    }
+    int64_t total, positive;
+    range(begin, end, total, positive);
+    if (sum.addBounded(total, positive, total - positive)) {
+        return;
+    }
+    size_t middle = begin + (end - begin) / 2;
+    addRange(values, begin, middle, sum);
+    addRange(values, middle, end, sum);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file PrefixIndex.h
+ * @brief Индекс сумм диапазонов вектора (дерево Фенвика)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef PREFIXINDEX_H
+#define PREFIXINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+class SumAccumulator;
+
+/**
+ * @brief Дерево Фенвика над вектором int32
+ *
+ * Узел хранит точную сумму своего отрезка и сумму его положительных
+ * элементов (отрицательная часть - их разность). Сумма диапазона и
+ * изменение элемента стоят O(log n). Сумма положительных и
+ * отрицательных элементов ограничивает частичные суммы диапазона, что
+ * позволяет добавить диапазон в SumAccumulator с насыщением целиком
+ * (addBounded), не проходя его поэлементно.
+ *
+ * Накопители int64: вектор не длиннее 2^32 элементов, сумма не
+ * превышает 2^63 по модулю.
+ *
+ * Индекс не владеет памятью узлов: она выделяется вместе с вектором
+ * (bytes(count) байт, выравнивание 8), в том числе в файле хранилища.
+ */
+class PrefixIndex {
+public:
+    /**
+     * @brief Узел дерева (отрезок (i - lowbit(i), i])
+     */
+    struct Node {
+        int64_t total;
+        int64_t positive;
+    };
+
+    /**
+     * @brief Конструктор
+     * @param nodes Память узлов (count + 1 узел)
+     * @param count Количество элементов вектора
+     */
+    PrefixIndex(Node* nodes, size_t count) : nodes_(nodes), count_(count) {}
+
+    /**
+     * @brief Построить индекс по значениям за O(n)
+     * @param values Значения (count элементов)
+     */
+    void build(const int32_t* values);
+
+    /**
+     * @brief Учесть изменение элемента
+     * @param index Номер элемента
+     * @param before Прежнее значение
+     * @param after Новое значение
+     */
+    void update(size_t index, int32_t before, int32_t after);
+
+    /**
+     * @brief Сумма диапазона [begin, end)
+     * @param begin Первый элемент
+     * @param end Элемент за последним
+     * @param total Сумма (выходной параметр)
+     * @param positive Сумма положительных элементов (выходной параметр)
+     */
+    void range(size_t begin, size_t end, int64_t& total, int64_t& positive) const;
+
+    /**
+     * @brief Добавить диапазон значений в сумму с ее политикой переполнения
+     *
+     * Результат совпадает с поэлементным sum.add(values + begin, end - begin).
+     * Диапазон добавляется целиком, если частичные суммы не могут выйти
+     * за пределы int32, иначе делится пополам; поэлементно проходятся
+     * только короткие отрезки рядом с точкой насыщения.
+     *
+     * @param values Значения, по которым построен индекс
+     * @param begin Первый элемент
+     * @param end Элемент за последним
+     * @param sum Накопитель
+     */
+    void addRange(const int32_t* values, size_t begin, size_t end, SumAccumulator& sum) const;
+
+    /**
+     * @brief Память индекса
+     * @param count Количество элементов вектора
+     * @return Байт
+     */
+    static size_t bytes(size_t count) { return (count + 1) * sizeof(Node); }
+
+    /// Отрезок, который addRange складывает поэлементно, а не делит дальше
+    static const size_t LINEAR_ELEMENTS = 64;
+
+private:
+    Node* nodes_;       ///< nodes_[0] не используется
+    size_t count_;
+
+    /**
+     * @brief Сумма префикса [0, end)
+     */
+    void prefix(size_t end, int64_t& total, int64_t& positive) const;
+};
+
+#endif // PREFIXINDEX_H
@@ -0,0 +1,425 @@
+/**
+ * @file Protocol.h
+ * @brief Константы сетевого протокола обработки векторов
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+
+/**
+ * @brief Формат пакетов векторов после аутентификации
+ *
+ * Прежний формат (по умолчанию): uint32 numVectors (1-100), затем векторы;
+ * после ответа на последний вектор сервер закрывает соединение.
+ *
+ * Расширенный формат начинается с магического числа вместо numVectors:
+ * @code
+ *   uint32 BATCH_MAGIC
+ *   uint32 control      - слово управления: биты 0-7 - флаги,
+ *                         биты 8-15 - операция свертки,
+ *                         биты 16-23 - политика переполнения,
+ *                         биты 24-31 - тип элементов
+ *   uint32 numVectors   - количество векторов (1-100)
+ *   векторы: uint32 размер (в элементах), затем элементы типа пакета
+ * @endcode
+ * Тип элементов (ElementCode) по умолчанию - int32; узкие типы
+ * пропорционально сокращают объем передаваемых данных, вещественные
+ * передаются в IEEE 754.
+ * Неизвестные (зарезервированные) биты слова управления должны быть нулевыми.
+ *
+ * С флагом FLAG_KEEP_ALIVE соединение после пакета остается открытым:
+ * клиент присылает следующий расширенный заголовок или END_OF_SESSION.
+ *
+ * С флагом FLAG_STREAMING ограничения MAX_VECTORS и MAX_VECTOR_SIZE
+ * не действуют: допускается до 2^32-1 векторов по MAX_STREAMING_SIZE
+ * (2^32-2) элементов; размер HASH_REF не бывает длиной вектора.
+ * Значения в любом режиме суммируются по мере поступления прямо в буфере
+ * приема, вектор целиком не накапливается.
+ *
+ * С флагом FLAG_PARALLEL пакет, наоборот, принимается целиком в плоский
+ * буфер (не более MAX_PARALLEL_ELEMENTS значений на пакет), а суммы
+ * векторов считаются параллельно в пуле потоков сервера; ответы
+ * отправляются после последнего вектора в прежнем порядке. Флаг допустим
+ * только для OP_SUM и TYPE_INT32, политика переполнения - любая; без пула
+ * пакет обрабатывается в потоке сеанса с тем же результатом.
+ *
+ * С флагом FLAG_SPARSE каждый вектор передается в одной из кодировок
+ * (VectorEncoding), выбираемой клиентом для каждого вектора отдельно:
+ * @code
+ *   uint32 size         - длина вектора (в элементах)
+ *   uint32 encoding     - ENC_DENSE, ENC_COO или ENC_BITMAP
+ *   uint32 nnz          - количество явно переданных значений (не больше size)
+ *   ENC_DENSE:  values[size]                        (nnz = size)
+ *   ENC_COO:    uint32 indices[nnz], values[nnz]    (индексы строго возрастают)
+ *   ENC_BITMAP: uint8 bitmap[(size+7)/8], values[nnz]
+ * @endcode
+ * В маске бит k (младший бит байта k/8 - первый) отмечает переданный
+ * элемент k, количество единиц равно nnz, лишние биты последнего байта
+ * нулевые. Не переданные элементы - нули; сервер их не восстанавливает,
+ * а сворачивает только переданные значения. Флаг допустим для операций
+ * над отдельными векторами (не выше OP_COUNT_NZ) любого типа элементов,
+ * кроме пакетов FLAG_PARALLEL; ответ такой же, как для плотного вектора.
+ *
+ * С флагом FLAG_PACKED значения каждого вектора сжаты: после uint32 size
+ * следуют (size+3)/4 групп - байт-ключ и от 1 до 4 байт на элемент
+ * (формат - PackedKernels.h). Элемент - zigzag-код разности с предыдущим,
+ * поэтому медленно меняющиеся ряды и малые значения занимают 1-2 байта
+ * вместо 4 (наихудший случай - 17 байт на 4 элемента). Сервер распаковывает
+ * байты по мере приема сразу в свертку. Флаг допустим для операций над
+ * отдельными векторами (не выше OP_COUNT_NZ) с TYPE_INT32, кроме пакетов
+ * FLAG_PARALLEL и FLAG_SPARSE; ответ такой же, как для несжатого вектора.
+ *
+ * С флагом FLAG_GENERATED вместо значений передается описание вектора,
+ * который сервер строит сам (VectorGenerator в VectorProcessor.h):
+ * @code
+ *   uint32 size         - длина вектора (в элементах)
+ *   uint32 generator    - GEN_CONSTANT, GEN_ARANGE или GEN_RANDOM
+ *   int32  first        - значение / начало / нижняя граница
+ *   int32  second       - 0 / шаг / верхняя граница (не меньше first)
+ *   uint64 seed         - 0 / 0 / зерно
+ * @endcode
+ * Неиспользуемые параметры нулевые. Постоянный вектор и прогрессия без
+ * переполнения элементов сворачиваются в замкнутой форме за O(1),
+ * остальные строятся блоками по мере свертки (не длиннее
+ * MAX_GENERATED_SIZE, всего не больше MAX_BATCH_GENERATED элементов
+ * на пакет). Флаг допустим для операций над отдельными
+ * векторами (не выше OP_COUNT_NZ) с TYPE_INT32, кроме пакетов
+ * FLAG_PARALLEL, FLAG_SPARSE и FLAG_PACKED; ответ такой же, как для
+ * переданных значений.
+ *
+ * С флагом FLAG_CACHED сервер запоминает ответы в кэше результатов
+ * (если кэш включен), а клиент может вместо значений вектора сослаться
+ * на уже отправленный вектор по ключу:
+ * @code
+ *   uint32 size         - длина вектора или HASH_REF
+ *   size != HASH_REF:   values[size]       - значения, как обычно
+ *   size == HASH_REF:   uint64 key         - ключ ранее отправленного вектора
+ * @endcode
+ * Длина вектора не превышает MAX_STREAMING_SIZE, поэтому HASH_REF
+ * однозначно означает ссылку и в потоковом пакете.
+ * Ключ - XXH64 байт значений в том виде, в каком они передаются, с зерном
+ * ((control & (OPCODE_MASK | POLICY_MASK | TYPE_MASK)) << 32) | size,
+ * поэтому одни и те же значения с другой операцией, политикой или типом
+ * дают другой ключ. Ссылка находит только векторы, отправленные под тем
+ * же логином. Ответ на каждый вектор начинается байтом CacheStatus:
+ * за CACHE_COMPUTED и CACHE_HIT следует обычный ответ, за CACHE_UNKNOWN -
+ * ничего (значения нужно отправить заново). Флаг допустим для операций
+ * над отдельными векторами (не выше OP_COUNT_NZ) любого типа, кроме
+ * пакетов FLAG_PARALLEL, FLAG_SPARSE, FLAG_PACKED и FLAG_GENERATED.
+ *
+ * С флагом FLAG_STORE пакет состоит из команд хранилища именованных
+ * векторов (если оно включено на сервере). Пространство имен у каждого
+ * логина свое. Вектор создается один раз, затем изменяется заплатками,
+ * а агрегаты поддерживаются сервером при каждом изменении, поэтому
+ * повторный запрос стоит O(1). Каждая команда передается так:
+ * @code
+ *   uint32 command      - StoreCommand
+ *   uint32 nameLength   - длина имени, 1..MAX_STORE_NAME
+ *   char name[nameLength]
+ *   STORE_CREATE:       uint32 size (1..MAX_STORED_SIZE), int32 values[size]
+ *   STORE_PATCH:        uint32 count (1..MAX_STORE_PATCH),
+ *                       count x {uint32 index, int32 value}
+ *   STORE_RANGE:        uint32 begin, uint32 end
+ *   STORE_QUERY, STORE_DELETE, STORE_INDEX: ничего
+ * @endcode
+ * Ответ на команду - байт StoreStatus; за STORE_OK в ответ на STORE_QUERY
+ * следуют агрегаты вектора:
+ * @code
+ *   uint32 size, int64 sum, uint64 l1, uint64 nonZero, float64 l2
+ * @endcode
+ * а в ответ на STORE_RANGE - сумма элементов [begin, end) в формате
+ * политики переполнения пакета, как у суммы вектора int32 (с насыщением
+ * на том же элементе, что и при последовательном суммировании).
+ * STORE_INDEX строит для вектора индекс сумм диапазонов (дерево Фенвика,
+ * 16 байт на элемент в памяти хранилища), после чего STORE_RANGE
+ * отвечает за O(log n), а заплатки обновляют индекс за O(log n) на
+ * изменение; без индекса диапазон суммируется проходом.
+ * Заплатка применяется целиком или не применяется вовсе (STORE_BAD_INDEX).
+ * Создание вектора с существующим именем заменяет его. Когда вектор не
+ * помещается в память хранилища, вытесняются давно не использованные
+ * векторы пользователя, занимающего больше всех памяти. Если сервер
+ * запущен с файлом хранилища, векторы и индексы сохраняются между
+ * запусками. Слово управления
+ * пакета FLAG_STORE не содержит других флагов, кроме FLAG_KEEP_ALIVE,
+ * и нулевые операцию и тип; политика переполнения относится к STORE_RANGE.
+ *
+ * Ответ на вектор зависит от операции (OpCode) и типа элементов:
+ * @code
+ *                    целые типы                    вещественные типы
+ *   OP_SUM           по политике переполнения      float64
+ *   OP_MIN, OP_MAX   int32 (TYPE_INT64 - int64)    float64
+ *   OP_MEAN          float64                       float64
+ *   OP_L1            uint64 (насыщение)            float64
+ *   OP_L2            float64                       float64
+ *   OP_COUNT_NZ      uint64                        uint64
+ * @endcode
+ * Целые накопители точные, вещественные суммы считаются в double
+ * с компенсацией ошибки округления. OP_MEAN - сумма, деленная на размер,
+ * OP_L2 - евклидова норма.
+ *
+ * Матричные операции (OP_COLUMN_SUM и далее) рассматривают пакет векторов
+ * одинаковой длины как матрицу по строкам. Пакет принимается целиком
+ * (не более MAX_PARALLEL_ELEMENTS значений), ответ на пакет один:
+ * @code
+ *   uint32 count        - количество значений
+ *   int64 values[count]
+ * @endcode
+ *   OP_COLUMN_SUM - суммы по столбцам (count - длина векторов), точные;
+ *   OP_DOT        - попарные скалярные произведения векторов, верхний
+ *                   треугольник с диагональю по строкам: (0,0), (0,1) ...
+ *                   (0,n-1), (1,1) ... (n-1,n-1), count = n*(n+1)/2,
+ *                   не более MAX_GRAM_VECTORS векторов, а без пула
+ *                   вычислительных потоков - не более
+ *                   MAX_INLINE_GRAM_PRODUCTS произведений n*(n+1)/2*длина;
+ *   OP_MATVEC     - первый вектор x, остальные - строки матрицы,
+ *                   ответ - произведения строк на x (count = n-1).
+ * Произведения берутся по модулю 2^64. Матричные операции допустимы
+ * только для TYPE_INT32; при запуске сервера с пулом вычислительных
+ * потоков они выполняются в нем.
+ *
+ * Операции преобразования (OP_PREFIX_SUM и далее) отвечают на каждый
+ * вектор вектором той же длины:
+ * @code
+ *   uint32 count        - количество элементов
+ *   int32/int64 values[count]
+ * @endcode
+ * Ответ формируется и отправляется по мере приема вектора, поэтому
+ * клиент может читать результат, еще не дослав вектор. У OP_ADD,
+ * OP_SCALE и OP_CLAMP первый вектор пакета - операнд, ответа на него
+ * нет: OP_ADD - слагаемое той же длины, что и остальные векторы,
+ * OP_SCALE - {множитель}, OP_CLAMP - {low, high}, low <= high.
+ * Элементы - только TYPE_INT32. Политика переполнения применяется
+ * к каждому элементу результата: POLICY_SATURATE - насыщение,
+ * POLICY_WRAP - по модулю 2^32, POLICY_INT64 - элементы int64;
+ * POLICY_ERROR не допускается.
+ *
+ * Политика переполнения (OverflowCode) задается только для OP_SUM
+ * целых элементов, в остальных случаях поле должно быть нулевым.
+ * Ответ OP_SUM для целых элементов:
+ * @code
+ *   POLICY_SATURATE, POLICY_WRAP  - int32 сумма
+ *   POLICY_INT64                  - int64 точная сумма
+ *   POLICY_ERROR                  - uint8 статус (STATUS_OK или STATUS_OVERFLOW),
+ *                                   затем int32: точная сумма или, при
+ *                                   переполнении, INT_MAX/INT_MIN
+ * @endcode
+ * Для TYPE_INT64 сумма POLICY_INT64 берется по модулю 2^64.
+ *
+ * Неизвестный код операции, политики или типа - ошибка протокола,
+ * соединение закрывается. Прежний формат всегда использует OP_SUM,
+ * POLICY_SATURATE и TYPE_INT32.
+ * Все целые числа передаются в little-endian.
+ */
+namespace Protocol {
+
+/// Признак расширенного заголовка пакета ("VBH1" в little-endian)
+const uint32_t BATCH_MAGIC = 0x31484256;
+
+/// Маркер завершения сеанса keep-alive вместо очередного заголовка
+const uint32_t END_OF_SESSION = 0;
+
+/**
+ * @brief Флаги слова управления (биты 0-7)
+ */
+enum BatchFlag : uint32_t {
+    FLAG_KEEP_ALIVE = 1u << 0,  ///< Не закрывать соединение после пакета
+    FLAG_STREAMING  = 1u << 1,  ///< Потоковое суммирование без ограничений размера
+    FLAG_PARALLEL   = 1u << 2,  ///< Прием пакета целиком и параллельное суммирование
+    FLAG_SPARSE     = 1u << 3,  ///< Векторы с кодировкой (VectorEncoding)
+    FLAG_PACKED     = 1u << 4,  ///< Сжатые значения (zigzag-дельты в group varint)
+    FLAG_GENERATED  = 1u << 5,  ///< Описания векторов вместо значений (GeneratorCode)
+    FLAG_CACHED     = 1u << 6,  ///< Кэш результатов и ссылки на векторы по ключу
+    FLAG_STORE      = 1u << 7   ///< Команды хранилища именованных векторов (StoreCommand)
+};
+
+/// Сдвиг поля операции в слове управления
+const uint32_t OPCODE_SHIFT = 8;
+
+/// Маска поля операции
+const uint32_t OPCODE_MASK = 0xFFu << OPCODE_SHIFT;
+
+/**
+ * @brief Операция свертки вектора (биты 8-15 слова управления)
+ */
+enum OpCode : uint32_t {
+    OP_SUM      = 0,    ///< Сумма (по умолчанию)
+    OP_MIN      = 1,    ///< Минимум
+    OP_MAX      = 2,    ///< Максимум
+    OP_MEAN     = 3,    ///< Среднее арифметическое
+    OP_L1       = 4,    ///< Сумма модулей
+    OP_L2       = 5,    ///< Евклидова норма
+    OP_COUNT_NZ = 6,    ///< Количество ненулевых элементов
+    OP_COLUMN_SUM = 7,  ///< Суммы по столбцам пакета
+    OP_DOT      = 8,    ///< Попарные скалярные произведения векторов пакета
+    OP_MATVEC   = 9,    ///< Произведение матрицы на первый вектор пакета
+    OP_PREFIX_SUM = 10, ///< Префиксные суммы вектора
+    OP_ADD      = 11,   ///< Поэлементная сумма с первым вектором пакета
+    OP_SCALE    = 12,   ///< Умножение на число из первого вектора пакета
+    OP_CLAMP    = 13    ///< Ограничение диапазоном из первого вектора пакета
+};
+
+/// Последний код операции над отдельным вектором
+const uint32_t MAX_REDUCE_OPCODE = OP_COUNT_NZ;
+
+/// Последний код матричной операции
+const uint32_t MAX_MATRIX_OPCODE = OP_MATVEC;
+
+/// Последний известный код операции
+const uint32_t MAX_OPCODE = OP_CLAMP;
+
+/// Сдвиг поля политики переполнения в слове управления
+const uint32_t POLICY_SHIFT = 16;
+
+/// Маска поля политики переполнения
+const uint32_t POLICY_MASK = 0xFFu << POLICY_SHIFT;
+
+/**
+ * @brief Политика переполнения суммы (биты 16-23 слова управления)
+ */
+enum OverflowCode : uint32_t {
+    POLICY_SATURATE = 0,    ///< Насыщение до INT_MAX/INT_MIN (по умолчанию)
+    POLICY_WRAP     = 1,    ///< Сумма по модулю 2^32
+    POLICY_INT64    = 2,    ///< Точная сумма, ответ 8 байт
+    POLICY_ERROR    = 3     ///< Статус переполнения перед суммой
+};
+
+/// Последний известный код политики
+const uint32_t MAX_POLICY = POLICY_ERROR;
+
+/// Сдвиг поля типа элементов в слове управления
+const uint32_t TYPE_SHIFT = 24;
+
+/// Маска поля типа элементов
+const uint32_t TYPE_MASK = 0xFFu << TYPE_SHIFT;
+
+/**
+ * @brief Тип элементов векторов (биты 24-31 слова управления)
+ */
+enum ElementCode : uint32_t {
+    TYPE_INT32   = 0,   ///< int32 (по умолчанию)
+    TYPE_INT8    = 1,   ///< int8
+    TYPE_INT16   = 2,   ///< int16
+    TYPE_INT64   = 3,   ///< int64
+    TYPE_FLOAT32 = 4,   ///< float32 (IEEE 754)
+    TYPE_FLOAT64 = 5    ///< float64 (IEEE 754)
+};
+
+/// Последний известный код типа
+const uint32_t MAX_TYPE = TYPE_FLOAT64;
+
+/**
+ * @brief Кодировка вектора в пакете FLAG_SPARSE
+ */
+enum VectorEncoding : uint32_t {
+    ENC_DENSE  = 0,     ///< Все элементы подряд
+    ENC_COO    = 1,     ///< Индексы ненулевых элементов, затем их значения
+    ENC_BITMAP = 2      ///< Битовая маска ненулевых элементов, затем их значения
+};
+
+/// Последний известный код кодировки
+const uint32_t MAX_ENCODING = ENC_BITMAP;
+
+/**
+ * @brief Генератор вектора в пакете FLAG_GENERATED
+ */
+enum GeneratorCode : uint32_t {
+    GEN_CONSTANT = 0,   ///< Постоянный вектор
+    GEN_ARANGE   = 1,   ///< Арифметическая прогрессия
+    GEN_RANDOM   = 2    ///< Псевдослучайные значения (splitmix64)
+};
+
+/// Последний известный код генератора
+const uint32_t MAX_GENERATOR = GEN_RANDOM;
+
+/// Размер вектора в пакете FLAG_CACHED, означающий ссылку на вектор по ключу
+const uint32_t HASH_REF = 0xFFFFFFFF;
+
+/**
+ * @brief Первый байт ответа на вектор в пакете FLAG_CACHED
+ */
+enum CacheStatus : uint8_t {
+    CACHE_COMPUTED = 0,     ///< Результат вычислен по переданным значениям
+    CACHE_HIT      = 1,     ///< Результат найден в кэше по ключу
+    CACHE_UNKNOWN  = 2      ///< Ключа нет в кэше (или кэш выключен), результата нет
+};
+
+/**
+ * @brief Команда хранилища в пакете FLAG_STORE
+ */
+enum StoreCommand : uint32_t {
+    STORE_CREATE = 0,   ///< Создать или заменить вектор
+    STORE_PATCH  = 1,   ///< Изменить элементы вектора
+    STORE_QUERY  = 2,   ///< Получить агрегаты вектора
+    STORE_DELETE = 3,   ///< Удалить вектор
+    STORE_INDEX  = 4,   ///< Построить индекс сумм диапазонов
+    STORE_RANGE  = 5    ///< Получить сумму диапазона элементов
+};
+
+/// Последний известный код команды хранилища
+const uint32_t MAX_STORE_COMMAND = STORE_RANGE;
+
+/**
+ * @brief Ответ на команду хранилища
+ */
+enum StoreStatus : uint8_t {
+    STORE_OK        = 0,    ///< Команда выполнена
+    STORE_NOT_FOUND = 1,    ///< Вектора с таким именем нет
+    STORE_BAD_INDEX = 2,    ///< Индекс или диапазон за пределами вектора, вектор не изменен
+    STORE_NO_SPACE  = 3,    ///< Вектор (с индексом) больше всей памяти хранилища
+    STORE_DISABLED  = 4     ///< Хранилище на сервере выключено
+};
+
+/// Максимальная длина имени вектора в хранилище
+const uint32_t MAX_STORE_NAME = 64;
+
+/// Максимальный размер вектора в хранилище (элементов)
+const uint32_t MAX_STORED_SIZE = 1u << 24;
+
+/// Максимальное количество изменений в одной заплатке
+const uint32_t MAX_STORE_PATCH = 1u << 20;
+
+/**
+ * @brief Статус ответа в политике POLICY_ERROR
+ */
+enum ResultStatus : uint8_t {
+    STATUS_OK       = 0,    ///< Сумма точная
+    STATUS_OVERFLOW = 1     ///< Частичная сумма вышла за пределы int32
+};
+
+/// Биты слова управления, известные серверу
+const uint32_t KNOWN_CONTROL_BITS =
+    FLAG_KEEP_ALIVE | FLAG_STREAMING | FLAG_PARALLEL | FLAG_SPARSE | FLAG_PACKED |
+    FLAG_GENERATED | FLAG_CACHED | FLAG_STORE | OPCODE_MASK | POLICY_MASK | TYPE_MASK;
+
+/// Максимальное количество векторов в пакете
+const uint32_t MAX_VECTORS = 100;
+
+/// Максимальный размер вектора (элементов)
+const uint32_t MAX_VECTOR_SIZE = 1000;
+
+/// Максимальный размер вектора с флагом FLAG_STREAMING (ниже HASH_REF)
+const uint32_t MAX_STREAMING_SIZE = HASH_REF - 1;
+
+/// Максимальный размер вектора FLAG_GENERATED, который строится поэлементно
+const uint32_t MAX_GENERATED_SIZE = 1u << 26;
+
+/// Максимальное количество элементов, строящихся поэлементно, в одном пакете FLAG_GENERATED
+const uint32_t MAX_BATCH_GENERATED = 1u << 28;
+
+/// Максимальное количество значений в пакете с флагом FLAG_PARALLEL или матричной операцией
+const uint32_t MAX_PARALLEL_ELEMENTS = 1u << 24;
+
+/// Максимальное количество векторов в пакете OP_DOT
+const uint32_t MAX_GRAM_VECTORS = 1024;
+
+/// Максимальное количество произведений элементов OP_DOT в потоке сеанса (без пула)
+const uint64_t MAX_INLINE_GRAM_PRODUCTS = 1ull << 28;
+
+} // namespace Protocol
+
+#endif // PROTOCOL_H
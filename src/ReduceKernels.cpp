@@ -0,0 +1,138 @@
+#include "ReduceKernels.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define REDUCEKERNELS_X86 1
+#endif
+
+#ifdef REDUCEKERNELS_X86
+
+/**
+ * @brief Экстремум вектора (Max - максимум, иначе минимум)
+ */
+template <bool Max>
+__attribute__((target("avx2")))
+static size_t extremeAvx2(const void* values, size_t count, ReduceState& state) {
+    const char* data = static_cast<const char*>(values);
+    size_t done = count - count % ReduceKernels::GROUP_ELEMENTS;
+    if (done == 0) {
+        return 0;
+    }
+
+    __m256i extreme = _mm256_set1_epi32(Max ? INT_MIN : INT_MAX);
+    for (size_t i = 0; i < done; i += ReduceKernels::GROUP_ELEMENTS) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * sizeof(int32_t)));
+        extreme = Max ? _mm256_max_epi32(extreme, v) : _mm256_min_epi32(extreme, v);
+    }
+
+    // Свертка восьми полос в одну
+    __m128i half = _mm256_castsi256_si128(extreme);
+    __m128i high = _mm256_extracti128_si256(extreme, 1);
+    half = Max ? _mm_max_epi32(half, high) : _mm_min_epi32(half, high);
+    high = _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2));
+    half = Max ? _mm_max_epi32(half, high) : _mm_min_epi32(half, high);
+    high = _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1));
+    half = Max ? _mm_max_epi32(half, high) : _mm_min_epi32(half, high);
+
+    int64_t result = _mm_cvtsi128_si32(half);
+    state.value = Max ? std::max(state.value, result) : std::min(state.value, result);
+    return done;
+}
+
+/**
+ * @brief Сумма модулей
+ *
+ * Модуль INT_MIN в int32 остается 0x80000000 и расширяется
+ * как беззнаковое 2^31.
+ */
+__attribute__((target("avx2")))
+static size_t l1Avx2(const void* values, size_t count, ReduceState& state) {
+    const char* data = static_cast<const char*>(values);
+    size_t done = count - count % ReduceKernels::GROUP_ELEMENTS;
+
+    __m256i total = _mm256_setzero_si256();
+    for (size_t i = 0; i < done; i += ReduceKernels::GROUP_ELEMENTS) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * sizeof(int32_t)));
+        __m256i magnitude = _mm256_abs_epi32(v);
+        total = _mm256_add_epi64(total, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(magnitude)));
+        total = _mm256_add_epi64(total, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(magnitude, 1)));
+    }
+
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total),
+                                 _mm256_extracti128_si256(total, 1));
+    state.total += _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+    return done;
+}
+
+/**
+ * @brief Количество ненулевых элементов
+ */
+__attribute__((target("avx2,popcnt")))
+static size_t countNonZeroAvx2(const void* values, size_t count, ReduceState& state) {
+    const char* data = static_cast<const char*>(values);
+    size_t done = count - count % ReduceKernels::GROUP_ELEMENTS;
+    const __m256i zero = _mm256_setzero_si256();
+
+    int64_t zeros = 0;
+    for (size_t i = 0; i < done; i += ReduceKernels::GROUP_ELEMENTS) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * sizeof(int32_t)));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero)));
+        zeros += __builtin_popcount(static_cast<unsigned>(mask));
+    }
+
+    state.value += static_cast<int64_t>(done) - zeros;
+    return done;
+}
+
+/**
+ * @brief Количество единиц маски, по 8 байт за шаг
+ */
+__attribute__((target("popcnt")))
+static size_t countBitsPopcnt(const void* bytes, size_t size, uint64_t& bits) {
+    const char* data = static_cast<const char*>(bytes);
+    size_t done = size - size % sizeof(uint64_t);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < done; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        total += static_cast<uint64_t>(__builtin_popcountll(word));
+    }
+    bits += total;
+    return done;
+}
+
+#endif // REDUCEKERNELS_X86
+
+ReduceKernels::Kernel ReduceKernels::get(ReduceOp op, SimdLevel level) {
+#ifdef REDUCEKERNELS_X86
+    if (level == SimdLevel::AVX2 || level == SimdLevel::AVX512) {
+        switch (op) {
+            case ReduceOp::MIN:      return extremeAvx2<false>;
+            case ReduceOp::MAX:      return extremeAvx2<true>;
+            case ReduceOp::L1:       return l1Avx2;
+            case ReduceOp::COUNT_NZ: return countNonZeroAvx2;
+            default:                 break;
+        }
+    }
+#else
+    (void)op;
+    (void)level;
+#endif
+    return nullptr;
+}
+
+ReduceKernels::BitCounter ReduceKernels::bitCounter(SimdLevel level) {
+#ifdef REDUCEKERNELS_X86
+    // popcnt есть на всех процессорах с AVX2 (ядро countNonZeroAvx2 тоже на это рассчитывает)
+    if (level == SimdLevel::AVX2 || level == SimdLevel::AVX512) {
+        return countBitsPopcnt;
+    }
+#else
+    (void)level;
+#endif
+    return nullptr;
+}
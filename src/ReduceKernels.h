@@ -0,0 +1,69 @@
+/**
+ * @file ReduceKernels.h
+ * @brief SIMD-ядра сверток вектора: минимум, максимум, L1, ненулевые
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef REDUCEKERNELS_H
+#define REDUCEKERNELS_H
+
+#include "VectorProcessor.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Ядра сверток, кроме суммы
+ *
+ * Ядро обрабатывает полные группы по GROUP_ELEMENTS элементов int32
+ * и обновляет накопитель ReduceState; неполный хвост и счетчик элементов
+ * остаются поэлементному циклу VectorProcessor. Сумма и среднее
+ * используют ядра SumKernels, сумма квадратов (L2) считается поэлементно
+ * в 128-битном накопителе: произведения int32 в 64-битных полосах SIMD
+ * переполнились бы уже после нескольких сложений.
+ *
+ * Свертки упираются в пропускную способность памяти, поэтому ядра есть
+ * только для AVX2: на процессорах с AVX-512 используется тот же вариант.
+ */
+namespace ReduceKernels {
+
+/// Количество элементов, обрабатываемых ядром за шаг
+const size_t GROUP_ELEMENTS = 8;
+
+/**
+ * @brief Ядро свертки
+ * @param values Элементы int32 в хостовом порядке байт (выравнивание не требуется)
+ * @param count Количество элементов
+ * @param state Состояние свертки
+ * @return Количество обработанных элементов (кратно GROUP_ELEMENTS)
+ */
+typedef size_t (*Kernel)(const void* values, size_t count, ReduceState& state);
+
+/**
+ * @brief Получить ядро свертки для набора инструкций
+ * @param op Операция
+ * @param level Набор инструкций (кроме AUTO), поддерживаемый процессором
+ * @return Ядро или nullptr, если для операции и набора ядра нет
+ */
+Kernel get(ReduceOp op, SimdLevel level);
+
+/**
+ * @brief Ядро подсчета битов маски
+ * @param bytes Маска
+ * @param size Размер маски в байтах
+ * @param bits Количество единиц (увеличивается)
+ * @return Количество обработанных байт (кратно 8)
+ */
+typedef size_t (*BitCounter)(const void* bytes, size_t size, uint64_t& bits);
+
+/**
+ * @brief Получить ядро подсчета битов (инструкция popcnt)
+ * @param level Набор инструкций (кроме AUTO), поддерживаемый процессором
+ * @return Ядро или nullptr, если для набора ядра нет
+ */
+BitCounter bitCounter(SimdLevel level);
+
+} // namespace ReduceKernels
+
+#endif // REDUCEKERNELS_H
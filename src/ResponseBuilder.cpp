@@ -0,0 +1,130 @@
+#include "ResponseBuilder.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/// Максимальное количество блоков в одном sendmsg
+static const size_t MAX_IOV = 64;
+
+ResponseBuilder::ResponseBuilder()
+    : offset_(0),
+      pending_(0),
+      sendCalls_(0),
+      configuredSocket_(-1),
+      corked_(false) {
+}
+
+void ResponseBuilder::append(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        if (blocks_.empty() || blocks_.back().size() == BLOCK_SIZE) {
+            blocks_.emplace_back();
+            blocks_.back().swap(spare_);
+            blocks_.back().clear();
+            blocks_.back().reserve(BLOCK_SIZE);
+        }
+
+        std::vector<char>& block = blocks_.back();
+        size_t chunk = std::min(size, BLOCK_SIZE - block.size());
+        block.insert(block.end(), bytes, bytes + chunk);
+        bytes += chunk;
+        size -= chunk;
+        pending_ += chunk;
+    }
+}
+
+bool ResponseBuilder::flush(int socket) {
+    if (pending_ == 0) {
+        return true;
+    }
+
+    if (configuredSocket_ != socket) {
+        // Хвост ответа уходит сразу, без ожидания ACK (для не-TCP сокетов - без эффекта)
+        int one = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        configuredSocket_ = socket;
+    }
+
+    while (pending_ > 0) {
+        struct iovec parts[MAX_IOV];
+        size_t count = 0;
+        size_t offered = 0;
+        for (size_t i = 0; i < blocks_.size() && count < MAX_IOV; i++, count++) {
+            size_t skip = (i == 0) ? offset_ : 0;
+            parts[count].iov_base = blocks_[i].data() + skip;
+            parts[count].iov_len = blocks_[i].size() - skip;
+            offered += parts[count].iov_len;
+        }
+
+        if (!corked_ && offered < pending_) {
+            // Ответ не уйдет за один вызов: склеиваем части в полные сегменты
+            setCork(socket, true);
+        }
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        sendCalls_++;
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            break;
+        }
+        consume(static_cast<size_t>(sent));
+
+        if (static_cast<size_t>(sent) < offered) {
+            // Буфер сокета заполнен - продолжим по готовности к записи
+            break;
+        }
+    }
+
+    if (corked_) {
+        // Пробка снимается и при неполной отправке: иначе неполный сегмент
+        // в очереди сокета ждал бы таймера TCP_CORK (200 мс)
+        setCork(socket, false);
+    }
+    return true;
+}
+
+void ResponseBuilder::take(std::string& buffer) {
+    buffer.clear();
+    buffer.reserve(pending_);
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        size_t skip = (i == 0) ? offset_ : 0;
+        buffer.append(blocks_[i].data() + skip, blocks_[i].size() - skip);
+    }
+    consume(pending_);
+}
+
+void ResponseBuilder::consume(size_t size) {
+    pending_ -= size;
+    while (size > 0) {
+        std::vector<char>& front = blocks_.front();
+        size_t left = front.size() - offset_;
+        if (size < left) {
+            offset_ += size;
+            return;
+        }
+
+        size -= left;
+        offset_ = 0;
+        // Блок сохраняется для следующего ответа, чтобы не выделять память снова
+        if (front.capacity() >= BLOCK_SIZE) {
+            spare_.swap(front);
+        }
+        blocks_.pop_front();
+    }
+}
+
+void ResponseBuilder::setCork(int socket, bool enable) {
+    int value = enable ? 1 : 0;
+    setsockopt(socket, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+    corked_ = enable;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file ResponseBuilder.h
+ * @brief Накопитель ответов клиенту с отправкой одним sendmsg
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef RESPONSEBUILDER_H
+#define RESPONSEBUILDER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Накопитель ответов соединения
+ *
+ * Результаты дописываются в блоки фиксированного размера (без перевыделения
+ * и копирования уже накопленного) и отправляются одним sendmsg с массивом
+ * iovec по всем блокам. TCP_NODELAY включается при первой отправке, чтобы
+ * хвост ответа не ждал алгоритма Нейгла; если ответ не уходит за один
+ * вызов, сокет на время серии вызовов закрывается TCP_CORK, чтобы части
+ * ушли полными сегментами; перед возвратом из flush() пробка снимается
+ * всегда, даже если буфер сокета заполнился.
+ */
+class ResponseBuilder {
+public:
+    /**
+     * @brief Конструктор
+     */
+    ResponseBuilder();
+
+    /**
+     * @brief Добавить данные в ответ
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void append(const void* data, size_t size);
+
+    /**
+     * @brief Отправить накопленный ответ
+     *
+     * Отправляет, пока есть данные и сокет их принимает.
+     *
+     * @param socket Неблокирующий сокет
+     * @return false - ошибка сокета (errno), true - отправлено или EAGAIN
+     */
+    bool flush(int socket);
+
+    /**
+     * @brief Забрать весь неотправленный ответ одним буфером
+     *
+     * Используется бэкендом io_uring, который отправляет ответ сам.
+     *
+     * @param buffer Буфер (выходной параметр, прежнее содержимое теряется)
+     */
+    void take(std::string& buffer);
+
+    /**
+     * @brief Количество неотправленных байт
+     * @return Количество байт
+     */
+    size_t pending() const { return pending_; }
+
+    /**
+     * @brief Проверить отсутствие неотправленных данных
+     * @return true - ответ пуст
+     */
+    bool empty() const { return pending_ == 0; }
+
+    /**
+     * @brief Количество системных вызовов отправки за время жизни
+     * @return Количество вызовов sendmsg
+     */
+    uint64_t getSendCalls() const { return sendCalls_; }
+
+    /// Размер блока накопителя
+    static const size_t BLOCK_SIZE = 4096;
+
+private:
+    std::deque<std::vector<char>> blocks_;
+    std::vector<char> spare_;   ///< Освобожденный блок для повторного использования
+    size_t offset_;             ///< Сколько байт первого блока уже отправлено
+    size_t pending_;
+    uint64_t sendCalls_;
+    int configuredSocket_;      ///< Сокет, для которого уже включен TCP_NODELAY
+    bool corked_;
+
+    /**
+     * @brief Освободить полностью отправленные байты
+     * @param size Количество отправленных байт
+     */
+    void consume(size_t size);
+
+    /**
+     * @brief Установить TCP_CORK
+     * @param socket Сокет
+     * @param enable Включить или снять
+     */
+    void setCork(int socket, bool enable);
+};
+
+#endif // RESPONSEBUILDER_H
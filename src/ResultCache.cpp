@@ -0,0 +1,97 @@
+#include "ResultCache.h"
+#include "Xxh64.h"
+#include <algorithm>
+#include <random>
+
+const size_t ResultCache::DEFAULT_SHARDS;
+
+ResultCache::ResultCache(size_t capacity, size_t shards)
+    : shardCapacity_(0), secret_(0), hits_(0), misses_(0), insertions_(0), evictions_(0) {
+    std::random_device random;
+    secret_ = (static_cast<uint64_t>(random()) << 32) | random();
+    if (shards == 0) {
+        shards = 1;
+    }
+    shardCapacity_ = std::max<size_t>(1, capacity / shards);
+    for (size_t i = 0; i < shards; i++) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->keys.reserve(shardCapacity_);
+        shard->results.reserve(shardCapacity_);
+        shard->referenced.reserve(shardCapacity_);
+        shard->index.reserve(shardCapacity_);
+        shard->hand = 0;
+        shards_.push_back(std::move(shard));
+    }
+}
+
+uint64_t ResultCache::scopedKey(const std::string& scope, uint64_t key) const {
+    Xxh64 hasher(secret_);
+    hasher.update(&key, sizeof(key));
+    hasher.update(scope.data(), scope.size());
+    return hasher.digest();
+}
+
+bool ResultCache::lookup(uint64_t key, CachedResult& result) {
+    Shard& s = shard(key);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto found = s.index.find(key);
+        if (found != s.index.end()) {
+            s.referenced[found->second] = 1;
+            result = s.results[found->second];
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void ResultCache::insert(uint64_t key, const CachedResult& result) {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto found = s.index.find(key);
+    if (found != s.index.end()) {
+        s.results[found->second] = result;
+        s.referenced[found->second] = 1;
+        return;
+    }
+
+    uint32_t slot;
+    if (s.keys.size() < shardCapacity_) {
+        slot = static_cast<uint32_t>(s.keys.size());
+        s.keys.push_back(key);
+        s.results.push_back(result);
+        s.referenced.push_back(0);
+    } else {
+        // Стрелка пропускает записи с битом обращения, сбрасывая его
+        while (s.referenced[s.hand]) {
+            s.referenced[s.hand] = 0;
+            s.hand = (s.hand + 1) % shardCapacity_;
+        }
+        slot = static_cast<uint32_t>(s.hand);
+        s.hand = (s.hand + 1) % shardCapacity_;
+        s.index.erase(s.keys[slot]);
+        s.keys[slot] = key;
+        s.results[slot] = result;
+        s.referenced[slot] = 0;
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    s.index[key] = slot;
+    insertions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.insertions = insertions_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.entries = 0;
+    for (const auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        stats.entries += s->keys.size();
+    }
+    return stats;
+}
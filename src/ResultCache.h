@@ -0,0 +1,140 @@
+/**
+ * @file ResultCache.h
+ * @brief Кэш результатов сверток по хешу содержимого вектора
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Ответ на вектор, сохраненный в кэше
+ */
+struct CachedResult {
+    uint8_t size;               ///< Размер ответа в байтах
+    unsigned char bytes[15];    ///< Ответ в том виде, в каком он уходит клиенту
+};
+
+/**
+ * @brief Ограниченный кэш результатов, общий для всех потоков сервера
+ *
+ * Ключ - 64-битный хеш операции, политики, типа и содержимого вектора
+ * (Protocol::FLAG_CACHED), который клиент может посчитать сам. Чтобы
+ * один пользователь не мог подложить неверный результат под ключ
+ * другого, сеанс ищет и добавляет записи по scopedKey(): ключ клиента
+ * перемешивается с логином и случайным секретом процесса. Записи распределены по сегментам со своими
+ * мьютексами, сегмент выбирается старшими битами ключа, поэтому потоки
+ * сеансов редко конкурируют за один мьютекс. Внутри сегмента записи
+ * вытесняются по алгоритму CLOCK: попадание только взводит бит
+ * обращения, а стрелка при вставке пропускает недавно использованные
+ * записи, сбрасывая их бит. В отличие от LRU, попадание не перестраивает
+ * список и обходится одной записью в память.
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Счетчики кэша
+     */
+    struct Stats {
+        uint64_t hits;          ///< Найдено записей
+        uint64_t misses;        ///< Не найдено записей
+        uint64_t insertions;    ///< Добавлено записей
+        uint64_t evictions;     ///< Вытеснено записей
+        size_t entries;         ///< Записей сейчас
+    };
+
+    /**
+     * @brief Конструктор
+     * @param capacity Наибольшее количество записей (не меньше количества сегментов)
+     * @param shards Количество сегментов
+     */
+    explicit ResultCache(size_t capacity, size_t shards = DEFAULT_SHARDS);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * @brief Ключ записи в пространстве одного пользователя
+     *
+     * Зависит от секрета, выбранного при создании кэша, поэтому подобрать
+     * ключ, совпадающий с ключом другого пользователя, нельзя.
+     *
+     * @param scope Логин
+     * @param key Ключ, посчитанный клиентом
+     * @return Ключ для lookup() и insert()
+     */
+    uint64_t scopedKey(const std::string& scope, uint64_t key) const;
+
+    /**
+     * @brief Найти результат
+     * @param key Ключ
+     * @param result Результат (выходной параметр)
+     * @return true - запись найдена
+     */
+    bool lookup(uint64_t key, CachedResult& result);
+
+    /**
+     * @brief Добавить или заменить результат
+     * @param key Ключ
+     * @param result Результат
+     */
+    void insert(uint64_t key, const CachedResult& result);
+
+    /**
+     * @brief Получить счетчики
+     * @return Счетчики на момент вызова
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Наибольшее количество записей
+     * @return Емкость (сумма емкостей сегментов)
+     */
+    size_t capacity() const { return shardCapacity_ * shards_.size(); }
+
+    /// Количество сегментов по умолчанию
+    static const size_t DEFAULT_SHARDS = 16;
+
+private:
+    /**
+     * @brief Сегмент кэша: записи, индекс и стрелка CLOCK
+     */
+    struct Shard {
+        std::mutex mutex;
+        std::vector<uint64_t> keys;
+        std::vector<CachedResult> results;
+        std::vector<uint8_t> referenced;            ///< Бит обращения CLOCK
+        std::unordered_map<uint64_t, uint32_t> index;   ///< Ключ -> номер записи
+        size_t hand;                                ///< Стрелка CLOCK
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shardCapacity_;
+    uint64_t secret_;           ///< Случайное зерно scopedKey()
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> insertions_;
+    std::atomic<uint64_t> evictions_;
+
+    /**
+     * @brief Сегмент ключа
+     * @param key Ключ
+     * @return Сегмент
+     */
+    Shard& shard(uint64_t key) {
+        return *shards_[static_cast<size_t>(key >> 32) % shards_.size()];
+    }
+};
+
+#endif // RESULTCACHE_H
@@ -1,52 +1,14 @@
 #include "Server.h"
+#include "VectorProcessor.h"
 #include <iostream>
 #include <cstring>
 #include <cerrno>
+#include <thread>
 #include <vector>
-#include <arpa/inet.h>
-
-// ========== ФУНКЦИИ ДЛЯ РАБОТЫ С LITTLE-ENDIAN ==========
-
-/**
- * @brief Конвертировать из little-endian в хостовый порядок
- */
-static uint32_t le32_to_host(uint32_t value) {
-    // Для x86/x64 систем (little-endian) ничего не делаем
-    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-        return value;
-    #else
-        // Для big-endian систем конвертируем
-        return ((value & 0xFF) << 24) |
-               ((value & 0xFF00) << 8) |
-               ((value & 0xFF0000) >> 8) |
-               ((value >> 24) & 0xFF);
-    #endif
-}
-
-/**
- * @brief Конвертировать хостовый порядок в little-endian
- */
-static uint32_t host_to_le32(uint32_t value) {
-    // Для x86/x64 систем (little-endian) ничего не делаем
-    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-        return value;
-    #else
-        // Для big-endian систем конвертируем
-        return ((value & 0xFF) << 24) |
-               ((value & 0xFF00) << 8) |
-               ((value & 0xFF0000) >> 8) |
-               ((value >> 24) & 0xFF);
-    #endif
-}
-
-// Версии для int32_t
-static int32_t le32_to_host_int(int32_t value) {
-    return static_cast<int32_t>(le32_to_host(static_cast<uint32_t>(value)));
-}
-
-static int32_t host_to_le32_int(int32_t value) {
-    return static_cast<int32_t>(host_to_le32(static_cast<uint32_t>(value)));
-}
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 
 Server::Server(const Config& config) 
     : config_(config), 
@@ -58,6 +20,7 @@ Server::Server(const Config& config)
     std::cout << "  База клиентов: " << config_.getClientDbPath() << std::endl;
     std::cout << "  Файл журнала:  " << config_.getLogFilePath() << std::endl;
     std::cout << "  Порт:          " << config_.getPort() << std::endl;
+    std::cout << "  Потоков:       " << config_.getThreads() << std::endl;
 }
 
 Server::~Server() {
@@ -80,6 +43,21 @@ bool Server::start() {
     logger_.log(LogLevel::INFO, "База клиентов загружена", 
                "клиентов: " + std::to_string(database_.getClientCount()));
     
+    // Хранилище векторов открывается до приема клиентов: с файлом
+    // векторы прежнего запуска доступны сразу
+    if (config_.getStoreMegabytes() > 0) {
+        vectorStore_.reset(new VectorStore(config_.getStoreMegabytes() << 20));
+        logger_.log(LogLevel::INFO, "Хранилище векторов",
+                   "байт: " + std::to_string(vectorStore_->budget()));
+        if (!config_.getStoreFilePath().empty() &&
+            !vectorStore_->openFile(config_.getStoreFilePath(), logger_)) {
+            logger_.log(LogLevel::ERROR, "Не удалось открыть файл хранилища",
+                       config_.getStoreFilePath());
+            vectorStore_.reset();
+            return false;
+        }
+    }
+    
     // Инициализация сети
     if (!initializeNetwork()) {
         logger_.log(LogLevel::CRITICAL, "Не удалось инициализировать сеть");
@@ -91,46 +69,93 @@ bool Server::start() {
                "порт: " + std::to_string(config_.getPort()));
     
     mainLoop();
+    stop();
+    
+    if (resultCache_) {
+        ResultCache::Stats stats = resultCache_->stats();
+        logger_.log(LogLevel::INFO, "Кэш результатов",
+                   "попаданий: " + std::to_string(stats.hits) +
+                   ", промахов: " + std::to_string(stats.misses) +
+                   ", вытеснений: " + std::to_string(stats.evictions) +
+                   ", записей: " + std::to_string(stats.entries));
+    }
+    
+    if (vectorStore_) {
+        VectorStore::Stats stats = vectorStore_->stats();
+        logger_.log(LogLevel::INFO, "Хранилище векторов",
+                   "векторов: " + std::to_string(stats.vectors) +
+                   ", пользователей: " + std::to_string(stats.users) +
+                   ", байт: " + std::to_string(stats.bytes) +
+                   ", вытеснений: " + std::to_string(stats.evictions) +
+                   ", байт файла: " + std::to_string(stats.fileBytes));
+        vectorStore_->close();
+    }
     
     return true;
 }
 
 void Server::stop() {
-    if (!running_) return;
-    
     running_ = false;
+    if (serverSocket_ < 0 && shardSockets_.empty()) return;
     
     if (serverSocket_ >= 0) {
         close(serverSocket_);
         serverSocket_ = -1;
     }
     
+    for (int socket : shardSockets_) {
+        close(socket);
+    }
+    shardSockets_.clear();
+    
     logger_.log(LogLevel::INFO, "Сервер остановлен");
 }
 
 bool Server::initializeNetwork() {
+    unsigned int shards = config_.getShards();
+    if (shards == 0) {
+        serverSocket_ = createListener(false);
+        return serverSocket_ >= 0;
+    }
+    
+    // Шардирование: у каждого потока свой слушающий сокет на том же порту,
+    // ядро распределяет входящие соединения между ними
+    for (unsigned int i = 0; i < shards; i++) {
+        int socket = createListener(true);
+        if (socket < 0) {
+            for (int opened : shardSockets_) {
+                close(opened);
+            }
+            shardSockets_.clear();
+            return false;
+        }
+        shardSockets_.push_back(socket);
+    }
+    
+    return true;
+}
+
+int Server::createListener(bool reusePort) {
     // Создание сокета
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket_ < 0) {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
         logger_.logSystemError("Ошибка создания сокета");
-        return false;
+        return -1;
     }
     
     // Настройка опций сокета
     int opt = 1;
-    if (setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         logger_.logSystemError("Ошибка настройки сокета");
-        close(serverSocket_);
-        serverSocket_ = -1;
-        return false;
+        close(listenSocket);
+        return -1;
     }
     
-    // Установка таймаута (3 минуты)
-    struct timeval timeout;
-    timeout.tv_sec = 180;
-    timeout.tv_usec = 0;
-    if (setsockopt(serverSocket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
-        logger_.logSystemError("Ошибка установки таймаута");
+    if (reusePort && 
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        logger_.logSystemError("Ошибка установки SO_REUSEPORT");
+        close(listenSocket);
+        return -1;
     }
     
     // Привязка сокета
@@ -140,328 +165,220 @@ bool Server::initializeNetwork() {
     serverAddr.sin_addr.s_addr = INADDR_ANY;
     serverAddr.sin_port = htons(config_.getPort());
     
-    if (bind(serverSocket_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+    if (bind(listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
         logger_.logSystemError("Ошибка привязки сокета");
-        close(serverSocket_);
-        serverSocket_ = -1;
-        return false;
+        close(listenSocket);
+        return -1;
     }
     
     // Начало прослушивания
-    if (listen(serverSocket_, 10) < 0) {
+    if (listen(listenSocket, config_.getBacklog()) < 0) {
         logger_.logSystemError("Ошибка начала прослушивания");
-        close(serverSocket_);
-        serverSocket_ = -1;
-        return false;
+        close(listenSocket);
+        return -1;
     }
     
-    return true;
+    return listenSocket;
 }
 
 void Server::mainLoop() {
     std::cout << "Сервер запущен. Ожидание подключений..." << std::endl;
     
-    while (running_) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(serverSocket_, 
-                                 (struct sockaddr*)&clientAddr, 
-                                 &clientLen);
-        
-        if (clientSocket < 0) {
-            if (errno == EINTR) continue;
-            if (running_) { // Только если сервер еще работает
-                logger_.logSystemError("Ошибка принятия соединения");
-            }
-            continue;
+    if (config_.getIoBackend() == IoBackend::IO_URING) {
+        if (IoLoop::isBackendAvailable(IoBackend::IO_URING)) {
+            logger_.log(LogLevel::INFO, "Бэкенд ввода-вывода", "io_uring");
+        } else {
+            logger_.log(LogLevel::WARNING, "io_uring не поддерживается ядром", 
+                       "используется epoll");
         }
-        
-        // Получение IP клиента
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, sizeof(clientIP));
-        
-        logger_.log(LogLevel::INFO, "Новое подключение", clientIP);
-        
-        // Обработка клиента
-        handleClient(clientSocket);
     }
-}
-
-bool Server::sendString(int socket, const std::string& str) {
-    return sendAll(socket, str.c_str(), str.length() + 1); // +1 для нуль-терминатора
-}
-
-bool Server::recvString(int socket, std::string& str, size_t maxLength) {
-    char buffer[1024];
-    str.clear();
     
-    // Вариант 1: сначала пробуем прочитать всю строку с MSG_PEEK
-    ssize_t peeked = recv(socket, buffer, std::min(sizeof(buffer), maxLength), MSG_PEEK);
-    if (peeked <= 0) {
-        return false;
+    SimdLevel kernel = VectorProcessor::selectKernel(config_.getSimdLevel());
+    if (config_.getSimdLevel() != SimdLevel::AUTO && kernel != config_.getSimdLevel()) {
+        logger_.log(LogLevel::WARNING, 
+                   std::string("Ядро ") + VectorProcessor::kernelName(config_.getSimdLevel()) +
+                   " не поддерживается процессором",
+                   std::string("используется ") + VectorProcessor::kernelName(kernel));
+    } else {
+        logger_.log(LogLevel::INFO, "Ядро суммирования", VectorProcessor::kernelName(kernel));
     }
     
-    // Ищем нуль-терминатор в заглянутых данных
-    for (ssize_t i = 0; i < peeked; i++) {
-        if (buffer[i] == '\0') {
-            // Нашли нуль-терминатор - читаем всю строку включая его
-            ssize_t toRead = i + 1; // включая \0
-            ssize_t received = recv(socket, buffer, toRead, 0);
-            if (received != toRead) {
-                return false;
-            }
-            str.assign(buffer, i); // без нуль-терминатора
-            return true;
-        }
+    if (config_.getComputeThreads() > 0) {
+        computePool_.reset(new WorkStealingPool(config_.getComputeThreads()));
+        logger_.log(LogLevel::INFO, "Пул параллельной обработки",
+                   "потоков: " + std::to_string(computePool_->size()));
     }
     
-    // Если не нашли нуль-терминатор, может клиент не отправляет его
-    // Попробуем прочитать строку до пробела или перевода строки
-    for (ssize_t i = 0; i < peeked; i++) {
-        if (buffer[i] == ' ' || buffer[i] == '\n' || buffer[i] == '\r') {
-            // Читаем до разделителя
-            ssize_t received = recv(socket, buffer, i, 0);
-            if (received != i) {
-                return false;
-            }
-            str.assign(buffer, i);
-            return true;
-        }
+    if (config_.getCacheEntries() > 0) {
+        resultCache_.reset(new ResultCache(config_.getCacheEntries()));
+        logger_.log(LogLevel::INFO, "Кэш результатов",
+                   "записей: " + std::to_string(resultCache_->capacity()));
     }
     
-    // Если не нашли разделитель, читаем все что есть
-    ssize_t received = recv(socket, buffer, peeked, 0);
-    if (received != peeked) {
-        return false;
+    if (!shardSockets_.empty()) {
+        runShards();
+        return;
     }
-    str.assign(buffer, received);
     
-    // Обрезаем пробелы и управляющие символы
-    size_t last = str.find_last_not_of(" \t\n\r");
-    if (last != std::string::npos) {
-        str = str.substr(0, last + 1);
+    unsigned int threads = config_.getThreads();
+    if (threads > 1) {
+        runWorkerPool(threads);
+        return;
     }
     
-    return true;
+    // Один поток: цикл событий сам принимает соединения
+    std::unique_ptr<IoLoop> loop(createLoop());
+    if (!loop->isValid() || !loop->addListener(serverSocket_, sessionOptions(0))) {
+        logger_.log(LogLevel::CRITICAL, "Не удалось запустить цикл обработки событий");
+        return;
+    }
+    
+    loop->run(running_);
 }
 
-bool Server::sendAll(int socket, const void* data, size_t size) {
-    const char* ptr = static_cast<const char*>(data);
-    size_t totalSent = 0;
-    
-    while (totalSent < size) {
-        ssize_t sent = send(socket, ptr + totalSent, size - totalSent, 0);
-        if (sent <= 0) {
-            if (errno == EINTR) continue;
-            return false;
-        }
-        totalSent += sent;
-    }
-    return true;
+IoLoop* Server::createLoop() {
+    return IoLoop::create(config_.getIoBackend(), database_, logger_);
 }
 
-bool Server::recvAll(int socket, void* data, size_t size) {
-    char* ptr = static_cast<char*>(data);
-    size_t totalReceived = 0;
-    
-    while (totalReceived < size) {
-        ssize_t received = recv(socket, ptr + totalReceived, size - totalReceived, 0);
-        if (received <= 0) {
-            return false;
-        }
-        totalReceived += received;
-    }
-    
-    return true;
+SessionOptions Server::sessionOptions(size_t listener) const {
+    SessionOptions options;
+    options.keepAliveTimeoutSec = config_.getKeepAliveTimeout();
+    options.flushMode = config_.getFlushMode(listener);
+    options.flushBytes = config_.getFlushBytes();
+    options.flushDelayMs = config_.getFlushDelayMs();
+    options.pool = computePool_.get();
+    options.cache = resultCache_.get();
+    options.store = vectorStore_.get();
+    return options;
 }
 
-bool Server::authenticateClient(int clientSocket, std::string& clientLogin) {
-    // Шаг 2: Получение логина
-    std::string login;
-    if (!recvString(clientSocket, login, 32)) {
-        logger_.log(LogLevel::ERROR, "Ошибка получения логина");
-        return false;
-    }
-    
-    // Отладочный вывод
-    std::cout << "DEBUG: Получен логин: '" << login << "' (длина: " << login.length() << ")" << std::endl;
-    logger_.log(LogLevel::INFO, "Получен логин", login);
-    
-    // Шаг 3: Проверка идентификации
-    if (!database_.userExists(login)) {
-        // Отправляем "ERR" с нуль-терминатором
-        std::string err_msg = "ERR";
-        if (!sendString(clientSocket, err_msg)) {
-            logger_.log(LogLevel::ERROR, "Ошибка отправки ERR", login);
+void Server::runShards() {
+    std::vector<std::unique_ptr<IoLoop>> loops;
+    
+    for (size_t i = 0; i < shardSockets_.size(); i++) {
+        loops.emplace_back(createLoop());
+        if (!loops.back()->isValid() || 
+            !loops.back()->addListener(shardSockets_[i], sessionOptions(i))) {
+            logger_.log(LogLevel::CRITICAL, "Не удалось создать поток шарда");
+            return;
         }
-        logger_.log(LogLevel::WARNING, "Неизвестный пользователь", login);
-        return false;
     }
     
-    // Шаг 3a: Отправка соли (16 hex символов без нуль-терминатора)
-    std::string salt = Authenticator::generateSalt();
-    logger_.log(LogLevel::INFO, "Сгенерирована соль", salt);
-    
-    // Отправляем соль без нуль-терминатора (как ожидает клиент)
-    if (!sendAll(clientSocket, salt.c_str(), salt.length())) {
-        logger_.log(LogLevel::ERROR, "Ошибка отправки соли", login);
-        return false;
-    }
-    
-    // Шаг 4: Получение хеша пароля
-    std::string passwordHash;
-    if (!recvString(clientSocket, passwordHash, 64)) {
-        logger_.log(LogLevel::ERROR, "Ошибка получения хеша пароля", login);
-        return false;
-    }
-    
-    logger_.log(LogLevel::INFO, "Получен хеш пароля", passwordHash.substr(0, 16) + "...");
-    
-    // Шаг 5: Проверка аутентификации
-    std::string storedPassword = database_.getPassword(login);
-    if (!Authenticator::verifyHash(passwordHash, salt, storedPassword)) {
-        // Отправляем "ERR" с нуль-терминатором
-        std::string err_msg = "ERR";
-        if (!sendString(clientSocket, err_msg)) {
-            logger_.log(LogLevel::ERROR, "Ошибка отправки ERR при аутентификации", login);
+    unsigned int cpuCount = std::thread::hardware_concurrency();
+    std::vector<std::thread> shards;
+    for (size_t i = 0; i < loops.size(); i++) {
+        IoLoop* loop = loops[i].get();
+        shards.emplace_back([this, loop]() {
+            loop->run(running_);
+        });
+        
+        if (config_.getPinCpu() && cpuCount > 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % cpuCount, &cpus);
+            if (pthread_setaffinity_np(shards.back().native_handle(), 
+                                       sizeof(cpus), &cpus) != 0) {
+                logger_.log(LogLevel::WARNING, "Не удалось закрепить шард за ядром", 
+                           "шард: " + std::to_string(i));
+            }
         }
-        logger_.log(LogLevel::WARNING, "Ошибка аутентификации", login);
-        return false;
     }
     
-    // Шаг 5a: Успешная аутентификация
-    // Отправляем "OK" с нуль-терминатором
-    std::string ok_msg = "OK";
-    if (!sendString(clientSocket, ok_msg)) {
-        logger_.log(LogLevel::ERROR, "Ошибка отправки OK", login);
-        return false;
-    }
+    logger_.log(LogLevel::INFO, "Запущены шарды SO_REUSEPORT", 
+               "количество: " + std::to_string(loops.size()) +
+               ", backlog: " + std::to_string(config_.getBacklog()));
     
-    clientLogin = login;
-    logger_.log(LogLevel::INFO, "Клиент аутентифицирован", login);
-    return true;
+    for (auto& shard : shards) {
+        shard.join();
+    }
 }
 
-void Server::processVectorData(int clientSocket) {
-    // Шаг 6: Получение количества векторов (4 байта, uint32_t)
-    uint32_t numVectors;
-    if (!recvAll(clientSocket, &numVectors, sizeof(numVectors))) {
-        logger_.log(LogLevel::ERROR, "Ошибка получения количества векторов");
-        return;
+void Server::runWorkerPool(unsigned int threads) {
+    ConnectionQueue queue(CONNECTION_QUEUE_CAPACITY);
+    std::vector<std::unique_ptr<IoLoop>> loops;
+    
+    for (unsigned int i = 0; i < threads; i++) {
+        loops.emplace_back(createLoop());
+        if (!loops.back()->isValid() || !loops.back()->attachQueue(&queue, sessionOptions(0))) {
+            logger_.log(LogLevel::CRITICAL, "Не удалось создать рабочий поток");
+            return;
+        }
     }
     
-    // КОНВЕРТИРУЕМ ИЗ LITTLE-ENDIAN (клиент отправляет в little-endian!)
-    numVectors = le32_to_host(numVectors);
+    // Рабочие потоки останавливаются вместе с потоком приема
+    std::atomic<bool> workersRunning(true);
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++) {
+        IoLoop* loop = loops[i].get();
+        workers.emplace_back([loop, &workersRunning]() {
+            loop->run(workersRunning);
+        });
+    }
     
-    std::cout << "DEBUG: Получено количество векторов (после конвертации): " << numVectors << std::endl;
+    logger_.log(LogLevel::INFO, "Запущены рабочие потоки", 
+               "количество: " + std::to_string(threads));
     
-    logger_.log(LogLevel::INFO, "Получено количество векторов", 
-               std::to_string(numVectors));
+    acceptLoop(queue, loops);
     
-    if (numVectors == 0 || numVectors > 100) {
-        logger_.log(LogLevel::ERROR, "Некорректное количество векторов", 
-                   std::to_string(numVectors));
-        return;
+    workersRunning = false;
+    for (auto& worker : workers) {
+        worker.join();
     }
-    
-    // Шаги 7-10: Обработка каждого вектора
-    for (uint32_t i = 0; i < numVectors; i++) {
-        // Шаг 7: Получение размера вектора (4 байта, uint32_t)
-        uint32_t vectorSize;
-        if (!recvAll(clientSocket, &vectorSize, sizeof(vectorSize))) {
-            logger_.log(LogLevel::ERROR, "Ошибка получения размера вектора " + std::to_string(i+1));
-            return;
-        }
-        
-        // КОНВЕРТИРУЕМ ИЗ LITTLE-ENDIAN
-        vectorSize = le32_to_host(vectorSize);
-        
-        logger_.log(LogLevel::INFO, "Размер вектора " + std::to_string(i+1), 
-                   std::to_string(vectorSize));
-        
-        if (vectorSize == 0 || vectorSize > 1000) {
-            logger_.log(LogLevel::ERROR, "Некорректный размер вектора", 
-                       std::to_string(vectorSize));
-            return;
-        }
-        
-        // Шаг 8: Получение всех значений вектора одним блоком
-        std::vector<int32_t> vector(vectorSize);
-        if (!recvAll(clientSocket, vector.data(), vectorSize * sizeof(int32_t))) {
-            logger_.log(LogLevel::ERROR, "Ошибка получения данных вектора " + std::to_string(i+1));
-            return;
-        }
-        
-        // КОНВЕРТИРУЕМ КАЖДОЕ ЗНАЧЕНИЕ ИЗ LITTLE-ENDIAN
-        for (auto& value : vector) {
-            value = le32_to_host_int(value);
-        }
-        
-        // Логирование для отладки
-        if (vectorSize > 0) {
-            std::cout << "DEBUG: Вектор " << (i+1) << " значения[0]=" << vector[0];
-            if (vectorSize > 1) std::cout << " [1]=" << vector[1];
-            if (vectorSize > 2) std::cout << " [last]=" << vector.back();
-            std::cout << std::endl;
-        }
-        
-        // Шаг 9: Вычисление и возврат результата по вектору
-        int32_t result = VectorProcessor::calculateSum(vector);
-        std::cout << "DEBUG: Сумма вектора " << (i+1) << " = " << result << std::endl;
-        
-        // КОНВЕРТИРУЕМ В LITTLE-ENDIAN ДЛЯ ОТПРАВКИ
-        int32_t resultLE = host_to_le32_int(result);
-        
-        // Отправка результата (4 байта, int32_t)
-        if (!sendAll(clientSocket, &resultLE, sizeof(resultLE))) {
-            logger_.log(LogLevel::ERROR, "Ошибка отправки результата вектора " + std::to_string(i+1));
-            return;
-        }
-        
-        logger_.log(LogLevel::INFO, "Отправлен результат вектора " + std::to_string(i+1), 
-                   std::to_string(result));
-    }
-    
-    logger_.log(LogLevel::INFO, "Все векторы обработаны", 
-               "количество: " + std::to_string(numVectors));
 }
 
-
-void Server::handleClient(int clientSocket) {
-    // Установка таймаута на чтение (5 секунд)
-    struct timeval timeout;
-    timeout.tv_sec = 5;
-    timeout.tv_usec = 0;
-    
-    if (setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
-        logger_.logSystemError("Ошибка установки таймаута на клиентский сокет");
-    }
-    
-    std::string clientLogin;
-    
-    // Аутентификация клиента
-    if (!authenticateClient(clientSocket, clientLogin)) {
-        closeConnection(clientSocket);
+void Server::acceptLoop(ConnectionQueue& queue, 
+                        std::vector<std::unique_ptr<IoLoop>>& loops) {
+    int flags = fcntl(serverSocket_, F_GETFL, 0);
+    if (flags < 0 || fcntl(serverSocket_, F_SETFL, flags | O_NONBLOCK) < 0) {
+        logger_.logSystemError("Ошибка перевода сокета в неблокирующий режим");
         return;
     }
     
-    // Обработка векторных данных
-    processVectorData(clientSocket);
-    
-    // Закрытие соединения
-    closeConnection(clientSocket);
-    logger_.log(LogLevel::INFO, "Сеанс завершен", clientLogin);
-}
-void Server::closeConnection(int socket) {
-    if (socket >= 0) {
-        // Завершаем передачу данных в обоих направлениях
-        shutdown(socket, SHUT_RDWR);
+    size_t next = 0;
+    while (running_) {
+        struct pollfd listenPoll;
+        listenPoll.fd = serverSocket_;
+        listenPoll.events = POLLIN;
+        listenPoll.revents = 0;
         
-        // Закрываем сокет
-        close(socket);
+        // Таймаут нужен, чтобы периодически проверять флаг остановки
+        if (poll(&listenPoll, 1, 1000) <= 0) {
+            continue;
+        }
         
-        // Отладочный вывод
-        std::cout << "DEBUG: Соединение закрыто (socket: " << socket << ")" << std::endl;
+        while (running_) {
+            struct sockaddr_in clientAddr;
+            socklen_t clientLen = sizeof(clientAddr);
+            
+            int clientSocket = accept4(serverSocket_, 
+                                       (struct sockaddr*)&clientAddr, 
+                                       &clientLen,
+                                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientSocket < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running_) {
+                    logger_.logSystemError("Ошибка принятия соединения");
+                }
+                break;
+            }
+            
+            AcceptedConnection connection;
+            connection.socket = clientSocket;
+            inet_ntop(AF_INET, &clientAddr.sin_addr, 
+                      connection.peer, sizeof(connection.peer));
+            
+            logger_.log(LogLevel::INFO, "Новое подключение", connection.peer);
+            
+            if (!queue.push(connection)) {
+                logger_.log(LogLevel::WARNING, "Очередь соединений переполнена", 
+                           connection.peer);
+                close(clientSocket);
+                continue;
+            }
+            
+            // Соединения раздаются рабочим потокам по кругу
+            loops[next]->wakeup();
+            next = (next + 1) % loops.size();
+        }
     }
 }
@@ -12,16 +12,30 @@
 #include "Config.h"
 #include "Database.h"
 #include "Logger.h"
-#include "Authenticator.h"
-#include "VectorProcessor.h"
+#include "IoLoop.h"
+#include "WorkStealingPool.h"
+#include "ResultCache.h"
+#include "VectorStore.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 /**
  * @brief Главный класс сервера
+ *
+ * Сеансы клиентов обслуживаются циклами ввода-вывода IoLoop
+ * (epoll или io_uring, см. --io-backend).
+ * При --threads N > 1 поток приема раздает соединения N рабочим
+ * потокам через lock-free очередь; каждый рабочий поток сам ведет
+ * свои сеансы от аутентификации до закрытия.
+ * При --shards N открывается N слушающих сокетов SO_REUSEPORT, каждый
+ * со своим потоком и циклом событий: общего сокета у потоков нет.
+ * При --compute-threads N пакеты с флагом параллельной обработки
+ * суммируются в общем пуле из N потоков с перехватом задач.
  */
 class Server {
 private:
@@ -29,7 +43,11 @@ private:
     Database database_;
     Logger logger_;
     int serverSocket_;
-    bool running_;
+    std::vector<int> shardSockets_;
+    std::atomic<bool> running_;
+    std::unique_ptr<WorkStealingPool> computePool_;   ///< Пул для пакетов FLAG_PARALLEL
+    std::unique_ptr<ResultCache> resultCache_;        ///< Кэш для пакетов FLAG_CACHED
+    std::unique_ptr<VectorStore> vectorStore_;        ///< Хранилище для пакетов FLAG_STORE
     
 public:
     /**
@@ -50,7 +68,18 @@ public:
     bool start();
     
     /**
-     * @brief Остановить сервер
+     * @brief Запросить остановку сервера
+     *
+     * Только сбрасывает атомарный флаг работы, поэтому допустим в
+     * обработчике сигнала: циклы замечают его в пределах своего такта,
+     * а сокеты закрывает и журнал пишет start() в основном потоке.
+     */
+    void requestStop() { running_ = false; }
+    
+    /**
+     * @brief Остановить сервер и закрыть слушающие сокеты
+     *
+     * Вызывается в основном потоке после завершения циклов.
      */
     void stop();
     
@@ -68,70 +97,51 @@ private:
     bool initializeNetwork();
     
     /**
-     * @brief Главный цикл сервера
-     */
-    void mainLoop();
-    
-    /**
-     * @brief Обработать клиента
-     * @param clientSocket Сокет клиента
+     * @brief Создать слушающий сокет на порту из конфигурации
+     * @param reusePort Установить SO_REUSEPORT (для шардов)
+     * @return Сокет или -1 при ошибке
      */
-    void handleClient(int clientSocket);
+    int createListener(bool reusePort);
     
     /**
-     * @brief Аутентифицировать клиента
-     * @param clientSocket Сокет клиента
-     * @param clientLogin Логин клиента (выходной параметр)
-     * @return true - аутентификация успешна
+     * @brief Главный цикл сервера
      */
-    bool authenticateClient(int clientSocket, std::string& clientLogin);
+    void mainLoop();
     
     /**
-     * @brief Обработать векторные данные
-     * @param clientSocket Сокет клиента
+     * @brief Создать цикл ввода-вывода выбранного бэкенда
+     * @return Новый цикл
      */
-    void processVectorData(int clientSocket);
+    IoLoop* createLoop();
     
     /**
-     * @brief Отправить строку клиенту
-     * @param socket Сокет
-     * @param str Строка
-     * @return true - успешно
+     * @brief Параметры сеансов для слушающего сокета
+     * @param listener Номер слушающего сокета (шарда)
+     * @return Параметры сеансов
      */
-    bool sendString(int socket, const std::string& str);
+    SessionOptions sessionOptions(size_t listener) const;
     
     /**
-     * @brief Получить строку от клиента
-     * @param socket Сокет
-     * @param str Строка (выходной параметр)
-     * @param maxLength Максимальная длина
-     * @return true - успешно
+     * @brief Запустить потоки шардов, каждый со своим слушающим сокетом
      */
-    bool recvString(int socket, std::string& str, size_t maxLength = 1024);
+    void runShards();
     
     /**
-     * @brief Отправить двоичные данные
-     * @param socket Сокет
-     * @param data Данные
-     * @param size Размер данных
-     * @return true - успешно
+     * @brief Запустить пул рабочих потоков и поток приема
+     * @param threads Количество рабочих потоков
      */
-    bool sendAll(int socket, const void* data, size_t size);
+    void runWorkerPool(unsigned int threads);
     
     /**
-     * @brief Получить двоичные данные
-     * @param socket Сокет
-     * @param data Данные (выходной параметр)
-     * @param size Размер данных
-     * @return true - успешно
+     * @brief Цикл приема соединений с передачей их рабочим потокам
+     * @param queue Очередь принятых соединений
+     * @param loops Циклы событий рабочих потоков
      */
-    bool recvAll(int socket, void* data, size_t size);
+    void acceptLoop(ConnectionQueue& queue, 
+                    std::vector<std::unique_ptr<IoLoop>>& loops);
     
-    /**
-     * @brief Закрыть соединение
-     * @param socket Сокет
-     */
-    void closeConnection(int socket);
+    /// Емкость очереди принятых соединений
+    static const size_t CONNECTION_QUEUE_CAPACITY = 4096;
 };
 
 #endif // SERVER_H
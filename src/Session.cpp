@@ -0,0 +1,1423 @@
+#include "Session.h"
+#include "Authenticator.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ========== ФУНКЦИИ ДЛЯ РАБОТЫ С LITTLE-ENDIAN ==========
+
+/**
+ * @brief Конвертировать хостовый порядок в little-endian
+ */
+static uint32_t host_to_le32(uint32_t value) {
+    // Для x86/x64 систем (little-endian) ничего не делаем
+    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return value;
+    #else
+        // Для big-endian систем конвертируем
+        return ((value & 0xFF) << 24) |
+               ((value & 0xFF00) << 8) |
+               ((value & 0xFF0000) >> 8) |
+               ((value >> 24) & 0xFF);
+    #endif
+}
+
+// Версия для int32_t
+static int32_t host_to_le32_int(int32_t value) {
+    return static_cast<int32_t>(host_to_le32(static_cast<uint32_t>(value)));
+}
+
+/// Политики переполнения по кодам Protocol::OverflowCode
+static const OverflowPolicy OVERFLOW_POLICIES[] = {
+    OverflowPolicy::SATURATE,   // POLICY_SATURATE
+    OverflowPolicy::WRAP,       // POLICY_WRAP
+    OverflowPolicy::WIDEN,      // POLICY_INT64
+    OverflowPolicy::ERROR       // POLICY_ERROR
+};
+
+/// Операции свертки по кодам Protocol::OpCode
+static const ReduceOp OPERATIONS[] = {
+    ReduceOp::SUM,      // OP_SUM
+    ReduceOp::MIN,      // OP_MIN
+    ReduceOp::MAX,      // OP_MAX
+    ReduceOp::MEAN,     // OP_MEAN
+    ReduceOp::L1,       // OP_L1
+    ReduceOp::L2,       // OP_L2
+    ReduceOp::COUNT_NZ  // OP_COUNT_NZ
+};
+
+/// Матричные операции по кодам Protocol::OpCode, начиная с OP_COLUMN_SUM
+static const MatrixOp MATRIX_OPERATIONS[] = {
+    MatrixOp::COLUMN_SUM,   // OP_COLUMN_SUM
+    MatrixOp::GRAM,         // OP_DOT
+    MatrixOp::MATVEC        // OP_MATVEC
+};
+
+/// Операции преобразования по кодам Protocol::OpCode, начиная с OP_PREFIX_SUM
+static const TransformOp TRANSFORM_OPERATIONS[] = {
+    TransformOp::PREFIX_SUM,    // OP_PREFIX_SUM
+    TransformOp::ADD,           // OP_ADD
+    TransformOp::SCALE,         // OP_SCALE
+    TransformOp::CLAMP          // OP_CLAMP
+};
+
+/// Типы элементов по кодам Protocol::ElementCode
+static const ElementType ELEMENT_TYPES[] = {
+    ElementType::INT32,     // TYPE_INT32
+    ElementType::INT8,      // TYPE_INT8
+    ElementType::INT16,     // TYPE_INT16
+    ElementType::INT64,     // TYPE_INT64
+    ElementType::FLOAT32,   // TYPE_FLOAT32
+    ElementType::FLOAT64    // TYPE_FLOAT64
+};
+
+/// Ответы на команды хранилища по результатам VectorStore
+static const Protocol::StoreStatus STORE_STATUSES[] = {
+    Protocol::STORE_OK,         // StoreResult::OK
+    Protocol::STORE_NOT_FOUND,  // StoreResult::NOT_FOUND
+    Protocol::STORE_BAD_INDEX,  // StoreResult::BAD_INDEX
+    Protocol::STORE_NO_SPACE    // StoreResult::NO_SPACE
+};
+
+/**
+ * @brief Расширить буфер под принятые данные, не превышая объявленного размера
+ * @param buffer Буфер
+ * @param size Нужное количество элементов
+ * @param limit Объявленное количество элементов
+ * @param allocations Счетчик выделений памяти
+ * @return Начало буфера
+ */
+template <typename T>
+static char* growBuffer(std::vector<T>& buffer, size_t size, size_t limit, uint64_t& allocations) {
+    if (size > buffer.capacity()) {
+        buffer.reserve(std::min(limit, std::max(size, 2 * buffer.capacity())));
+        allocations++;
+    }
+    if (size > buffer.size()) {
+        buffer.resize(size);
+    }
+    return reinterpret_cast<char*>(buffer.data());
+}
+
+/**
+ * @brief Очистить буфер, освободив память, если ее больше порога
+ * @param buffer Буфер
+ * @param limit Емкость (байт), которую можно сохранить до следующего использования
+ */
+template <typename T>
+static void releaseBuffer(std::vector<T>& buffer, size_t limit) {
+    if (buffer.capacity() * sizeof(T) > limit) {
+        std::vector<T>().swap(buffer);
+    } else {
+        buffer.clear();
+    }
+}
+
+/**
+ * @brief Записать uint64 в little-endian
+ */
+static void host_to_le64(uint64_t value, unsigned char* bytes) {
+    for (size_t b = 0; b < sizeof(value); b++) {
+        bytes[b] = static_cast<unsigned char>(value >> (8 * b));
+    }
+}
+
+/// Разделители строки логина
+static const std::string LOGIN_DELIMITERS("\0 \n\r", 4);
+
+/// Максимальная длина логина
+static const size_t MAX_LOGIN_LENGTH = 32;
+
+/// Длина хеша пароля (SHA-256 в hex)
+static const size_t HASH_LENGTH = 64;
+
+Session::Session(int socket, const std::string& peer,
+                 const Database& database, Logger& logger,
+                 const SessionOptions& options)
+    : socket_(socket),
+      peer_(peer),
+      database_(database),
+      logger_(logger),
+      options_(options),
+      state_(State::LOGIN),
+      authenticated_(false),
+      numVectors_(0),
+      currentVector_(0),
+      vectorSize_(0),
+      keepAlive_(false),
+      streaming_(false),
+      parallel_(false),
+      matrix_(false),
+      matrixOp_(MatrixOp::COLUMN_SUM),
+      sparse_(false),
+      encoding_(Protocol::ENC_DENSE),
+      nonZero_(0),
+      indexBytes_(0),
+      nextIndex_(0),
+      maskBits_(0),
+      packed_(false),
+      generated_(false),
+      cached_(false),
+      cacheSeed_(0),
+      recording_(false),
+      store_(false),
+      storeCommand_(Protocol::STORE_CREATE),
+      storeNameLength_(0),
+      rangeBegin_(0),
+      rangeEnd_(0),
+      storeCount_(0),
+      storeDiscard_(false),
+      transform_(false),
+      transformOp_(TransformOp::PREFIX_SUM),
+      policy_(OverflowPolicy::SATURATE),
+      op_(ReduceOp::SUM),
+      type_(ElementType::INT32),
+      filled_(0),
+      batchCount_(0),
+      bufferAllocations_(0),
+      batchAllocations_(0),
+      batchGenerated_(0),
+      stepBudget_(0),
+      yielded_(false),
+      inputDrained_(false),
+      inputPaused_(false),
+      inputClosed_(false),
+      flushRequested_(false),
+      lastActivity_(time(nullptr)),
+      socketQueued_(0) {
+}
+
+Session::~Session() {
+    if (socket_ >= 0) {
+        // Завершаем передачу данных в обоих направлениях
+        shutdown(socket_, SHUT_RDWR);
+        close(socket_);
+
+        // Отладочный вывод
+        std::cout << "DEBUG: Соединение закрыто (socket: " << socket_ << ")" << std::endl;
+    }
+
+    if (authenticated_) {
+        logger_.log(LogLevel::INFO, "Сеанс завершен", login_);
+    }
+}
+
+bool Session::onReadable() {
+    // Edge-triggered режим: читаем, пока ядро не отдаст меньше, чем просили
+    while (true) {
+        if (isOutputBlocked()) {
+            // Клиент не успевает забирать ответ: не читаем дальше, пока
+            // готовность к записи не позволит его отправить (onWritable)
+            if (!flushOutput()) {
+                return false;
+            }
+            if (isOutputBlocked()) {
+                inputPaused_ = true;
+                return true;
+            }
+            process();
+            continue;
+        }
+        if (yielded_) {
+            // Разбор остановлен бюджетом шага: сокет дочитаем после resume()
+            inputPaused_ = true;
+            break;
+        }
+
+        bool drained = false;
+        ssize_t received = reader_.fill(socket_, drained);
+        if (received == 0) {
+            // Клиент закрыл соединение: разбираем то, что успело прийти;
+            // разбор, остановленный бюджетом шага, завершит resume()
+            inputDrained_ = true;
+            inputClosed_ = true;
+            process();
+            flushOutput();
+            return yielded_;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && !drained) {
+            logger_.logSystemError("Ошибка чтения из сокета клиента");
+            return false;
+        }
+
+        if (received > 0) {
+            lastActivity_ = time(nullptr);
+        }
+        inputDrained_ = drained;
+        process();
+        // Разбор мог остановиться на неотправленном ответе, когда сокет уже
+        // вычитан: нового события чтения не будет, поэтому остаток буфера
+        // разбирается в начале цикла или после отправки (onWritable)
+        if (drained && !isOutputBlocked()) break;
+    }
+
+    return flushOutput();
+}
+
+bool Session::onWritable() {
+    if (!flushOutput()) {
+        return false;
+    }
+    if (inputPaused_ && !isOutputBlocked() && !yielded_) {
+        inputPaused_ = false;
+        return onReadable();
+    }
+    return true;
+}
+
+void Session::resume() {
+    if (!isOutputBlocked() && (yielded_ || reader_.available() > 0)) {
+        process();
+    }
+    if (isOutputBlocked()) {
+        // Сокет дочитаем после отправки ответа (onWritable)
+        inputPaused_ = true;
+    } else if (inputClosed_ && !yielded_) {
+        // Клиент закрыл соединение, а принятое уже разобрано
+        finish();
+    }
+}
+
+void Session::deliver(const char* data, size_t size) {
+    reader_.append(data, size);
+    lastActivity_ = time(nullptr);
+    // Внешний механизм передает каждую порцию, как только она принята
+    inputDrained_ = true;
+    process();
+}
+
+void Session::takeOutput(std::string& buffer) {
+    // Прежний буфер отправлен целиком: клиент забирает ответ
+    if (!output_.empty()) {
+        lastActivity_ = time(nullptr);
+    }
+    output_.take(buffer);
+    flushRequested_ = false;
+}
+
+bool Session::pollFlushDeadline(std::chrono::steady_clock::time_point now) {
+    if (hasDeferredOutput() &&
+        now - pendingSince_ >= std::chrono::milliseconds(options_.flushDelayMs)) {
+        requestFlush();
+    }
+    return hasOutput();
+}
+
+bool Session::isFinished() const {
+    return state_ == State::CLOSING && output_.empty();
+}
+
+bool Session::isTimedOut(time_t now) {
+    int timeout = (state_ == State::NEXT_BATCH) ? options_.keepAliveTimeoutSec
+                                                : IDLE_TIMEOUT_SEC;
+    if (now - lastActivity_ < timeout) {
+        return false;
+    }
+
+    // Ответ, уже переданный ядру (в том числе заявкой io_uring), клиент
+    // с малым окном приема может забирать дольше таймаута: пока очередь
+    // отправки сокета меняется между проверками, клиент считается активным
+    int queued = 0;
+    if (ioctl(socket_, SIOCOUTQ, &queued) == 0 && queued > 0 && queued != socketQueued_) {
+        socketQueued_ = queued;
+        lastActivity_ = now;
+        return false;
+    }
+    return true;
+}
+
+void Session::process() {
+    yielded_ = false;
+    stepBudget_ = STEP_GENERATED_ELEMENTS;
+    bool progress = true;
+    while (progress && state_ != State::CLOSING) {
+        switch (state_) {
+            case State::LOGIN:
+            case State::HASH:
+                progress = authenticateClient();
+                break;
+            default:
+                progress = processVectorData();
+                break;
+        }
+    }
+}
+
+bool Session::authenticateClient() {
+    if (state_ == State::LOGIN) {
+        // Шаг 2: Получение логина
+        std::string login;
+        if (!extractLogin(login)) {
+            return false;
+        }
+
+        // Отладочный вывод
+        std::cout << "DEBUG: Получен логин: '" << login << "' (длина: " << login.length() << ")" << std::endl;
+        logger_.log(LogLevel::INFO, "Получен логин", login);
+
+        // Шаг 3: Проверка идентификации
+        if (!database_.userExists(login)) {
+            // Отправляем "ERR" с нуль-терминатором
+            queueString("ERR");
+            logger_.log(LogLevel::WARNING, "Неизвестный пользователь", login);
+            finish();
+            return false;
+        }
+
+        // Шаг 3a: Отправка соли (16 hex символов без нуль-терминатора)
+        login_ = login;
+        salt_ = Authenticator::generateSalt();
+        logger_.log(LogLevel::INFO, "Сгенерирована соль", salt_);
+        queueBytes(salt_.c_str(), salt_.length());
+        requestFlush();
+
+        state_ = State::HASH;
+        return true;
+    }
+
+    // Шаг 4: Получение хеша пароля (ровно 64 hex символа).
+    // Разделитель логина мог прийти отдельным сегментом - пропускаем его
+    reader_.skip(LOGIN_DELIMITERS);
+    std::string passwordHash(HASH_LENGTH, '\0');
+    if (!reader_.readExact(&passwordHash[0], HASH_LENGTH)) {
+        return false;
+    }
+
+    logger_.log(LogLevel::INFO, "Получен хеш пароля", passwordHash.substr(0, 16) + "...");
+
+    // Шаг 5: Проверка аутентификации
+    std::string storedPassword = database_.getPassword(login_);
+    if (!Authenticator::verifyHash(passwordHash, salt_, storedPassword)) {
+        // Отправляем "ERR" с нуль-терминатором
+        queueString("ERR");
+        logger_.log(LogLevel::WARNING, "Ошибка аутентификации", login_);
+        finish();
+        return false;
+    }
+
+    // Шаг 5a: Успешная аутентификация
+    // Отправляем "OK" с нуль-терминатором
+    queueString("OK");
+    requestFlush();
+    authenticated_ = true;
+    logger_.log(LogLevel::INFO, "Клиент аутентифицирован", login_);
+
+    state_ = State::NUM_VECTORS;
+    return true;
+}
+
+bool Session::processVectorData() {
+    if (state_ == State::NUM_VECTORS || state_ == State::BATCH_HEADER ||
+        state_ == State::NEXT_BATCH) {
+        return processBatchHeader();
+    }
+    if (state_ == State::STORE_COMMAND || state_ == State::STORE_NAME ||
+        state_ == State::STORE_DATA) {
+        return processStoreCommand();
+    }
+
+    uint32_t i = currentVector_;
+
+    if (state_ == State::VECTOR_SIZE) {
+        // Шаг 7: Получение размера вектора (4 байта, uint32_t),
+        // у разреженного вектора - также кодировки и количества значений,
+        // у сгенерированного - описания генератора
+        if (sparse_ && reader_.available() < 3 * sizeof(uint32_t)) {
+            return false;
+        }
+        if (generated_ && reader_.available() < 4 * sizeof(uint32_t) + sizeof(uint64_t)) {
+            return false;
+        }
+        if (!reader_.readU32LE(vectorSize_)) {
+            return false;
+        }
+        if (sparse_) {
+            reader_.readU32LE(encoding_);
+            reader_.readU32LE(nonZero_);
+        }
+
+        if (cached_ && vectorSize_ == Protocol::HASH_REF) {
+            state_ = State::CACHE_KEY;
+            return true;
+        }
+        logger_.log(LogLevel::INFO, "Размер вектора " + std::to_string(i+1),
+                   std::to_string(vectorSize_));
+
+        if (vectorSize_ == 0 ||
+            vectorSize_ > (streaming_ ? Protocol::MAX_STREAMING_SIZE : Protocol::MAX_VECTOR_SIZE)) {
+            logger_.log(LogLevel::ERROR, "Некорректный размер вектора",
+                       std::to_string(vectorSize_));
+            finish();
+            return false;
+        }
+
+        if (matrix_ && i == 0 && matrixOp_ == MatrixOp::GRAM && options_.pool == nullptr &&
+            uint64_t(numVectors_) * (numVectors_ + 1) / 2 * vectorSize_ >
+                Protocol::MAX_INLINE_GRAM_PRODUCTS) {
+            // Без пула произведения считаются в потоке цикла событий,
+            // и долгая операция задержала бы остальные сеансы цикла
+            logger_.log(LogLevel::ERROR, "Слишком объемная операция без пула вычислительных потоков",
+                       std::string(VectorProcessor::matrixOpName(matrixOp_)) + ": " +
+                       std::to_string(numVectors_) + " x " + std::to_string(vectorSize_));
+            finish();
+            return false;
+        }
+        if (matrix_ && i > 0 && vectorSize_ != batch_.vectorSize(0)) {
+            logger_.log(LogLevel::ERROR, "Длина вектора отличается от первого",
+                       std::to_string(vectorSize_));
+            finish();
+            return false;
+        }
+        if (sparse_) {
+            return beginSparseVector();
+        }
+        if (generated_) {
+            return generateVector();
+        }
+        if (transform_ && !storesVector()) {
+            return beginTransform();
+        }
+        if (storesVector()) {
+            if (batch_.totalElements() + vectorSize_ > Protocol::MAX_PARALLEL_ELEMENTS) {
+                logger_.log(LogLevel::ERROR, "Превышен объем параллельного пакета",
+                           std::to_string(batch_.totalElements() + vectorSize_));
+                finish();
+                return false;
+            }
+            // Память под значения выделяется по мере их приема
+            batch_.declareVector(vectorSize_);
+            filled_ = 0;
+        } else {
+            reduction_.begin(vectorSize_, policy_, op_, type_);
+            if (packed_) {
+                decoder_.begin(vectorSize_);
+            }
+            if (cached_) {
+                hasher_.reset(cacheSeed_ | vectorSize_);
+            }
+        }
+        state_ = State::VECTOR_DATA;
+        return true;
+    }
+
+    if (state_ == State::SPARSE_INDEX) {
+        return receiveSparseIndex();
+    }
+    if (state_ == State::CACHE_KEY) {
+        return answerCacheKey();
+    }
+    if (generated_) {
+        return generateStep();
+    }
+    if (storesVector()) {
+        return receiveVector();
+    }
+    if (transform_) {
+        return transformVector();
+    }
+
+    // Шаг 8: Суммирование значений по мере приема, прямо в буфере приема
+    // (порция может обрываться посреди элемента); сжатые значения
+    // распаковываются небольшими блоками сразу в свертку
+    while (!reduction_.isComplete() && reader_.available() > 0) {
+        size_t size = 0;
+        const char* data = reader_.contiguous(size);
+        if (!packed_) {
+            size_t used = reduction_.feed(data, size);
+            if (cached_) {
+                hasher_.update(data, used);
+            }
+            reader_.discard(used);
+            continue;
+        }
+        reader_.discard(decoder_.feed(data, size, reduction_));
+        if (!decoder_.isValid()) {
+            logger_.log(LogLevel::ERROR, "Некорректные сжатые значения вектора",
+                       std::to_string(i + 1));
+            finish();
+            return false;
+        }
+    }
+    if (!reduction_.isComplete()) {
+        return false;
+    }
+
+    // Шаг 9: Сумма готова сразу после последнего байта вектора
+    if (reduction_.usesAccumulator()) {
+        std::cout << "DEBUG: Сумма вектора " << (i+1) << " = "
+                  << reduction_.sum().result64() << std::endl;
+    }
+
+    return completeVector();
+}
+
+bool Session::completeVector() {
+    uint32_t i = currentVector_;
+    if (cached_) {
+        uint8_t status = Protocol::CACHE_COMPUTED;
+        queueBytes(&status, sizeof(status));
+        recorded_.size = 0;
+        recording_ = true;
+    }
+
+    if (!reduction_.usesAccumulator()) {
+        queueReduction();
+    } else {
+        queueSum(i, reduction_.sum());
+    }
+
+    if (cached_) {
+        recording_ = false;
+        if (options_.cache != nullptr) {
+            options_.cache->insert(options_.cache->scopedKey(login_, hasher_.digest()), recorded_);
+        }
+    }
+    return nextVector();
+}
+
+bool Session::answerCacheKey() {
+    uint32_t low, high;
+    if (reader_.available() < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    reader_.readU32LE(low);
+    reader_.readU32LE(high);
+    uint64_t key = (static_cast<uint64_t>(high) << 32) | low;
+
+    CachedResult result;
+    bool hit = options_.cache != nullptr &&
+               options_.cache->lookup(options_.cache->scopedKey(login_, key), result);
+    uint8_t status = hit ? Protocol::CACHE_HIT : Protocol::CACHE_UNKNOWN;
+    queueBytes(&status, sizeof(status));
+    if (hit) {
+        queueBytes(result.bytes, result.size);
+    }
+
+    logger_.log(LogLevel::INFO, "Ссылка на вектор " + std::to_string(currentVector_ + 1),
+               std::string(hit ? "найден в кэше" : "нет в кэше") + " (" + std::to_string(key) + ")");
+    return nextVector();
+}
+
+void Session::queueSum(uint32_t index, const SumAccumulator& sum) {
+    // КОНВЕРТИРУЕМ В LITTLE-ENDIAN ДЛЯ ОТПРАВКИ
+    if (policy_ == OverflowPolicy::WIDEN) {
+        unsigned char resultLE[sizeof(uint64_t)];
+        host_to_le64(static_cast<uint64_t>(sum.result64()), resultLE);
+        queueBytes(resultLE, sizeof(resultLE));
+    } else {
+        if (policy_ == OverflowPolicy::ERROR) {
+            uint8_t status = sum.isSaturated() ? Protocol::STATUS_OVERFLOW
+                                               : Protocol::STATUS_OK;
+            queueBytes(&status, sizeof(status));
+        }
+        int32_t resultLE = host_to_le32_int(sum.result());
+        queueBytes(&resultLE, sizeof(resultLE));
+    }
+
+    logger_.log(LogLevel::INFO, "Отправлен результат вектора " + std::to_string(index+1),
+               std::to_string(sum.result64()) +
+               (sum.isSaturated() ? " (переполнение)" : ""));
+}
+
+bool Session::receiveVector() {
+    // Значения копируются из буфера приема прямо на место в пакете
+    size_t begin = batch_.offset(currentVector_);
+    size_t bytes = static_cast<size_t>(vectorSize_) * sizeof(int32_t);
+    while (filled_ < bytes && reader_.available() > 0) {
+        size_t size = 0;
+        const char* data = reader_.contiguous(size);
+        size = std::min(size, bytes - filled_);
+        size_t used = begin + (filled_ + sizeof(int32_t) - 1) / sizeof(int32_t);
+        size_t elements = begin + (filled_ + size + sizeof(int32_t) - 1) / sizeof(int32_t);
+        size_t capacity = batch_.capacity();
+        char* target = reinterpret_cast<char*>(batch_.reserve(elements, used) + begin);
+        if (batch_.capacity() != capacity) {
+            bufferAllocations_++;
+        }
+        memcpy(target + filled_, data, size);
+        reader_.discard(size);
+        filled_ += size;
+    }
+    if (filled_ < bytes) {
+        return false;
+    }
+
+    #if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+        int32_t* values = batch_.data(currentVector_);
+        for (uint32_t k = 0; k < vectorSize_; k++) {
+            values[k] = host_to_le32_int(values[k]);
+        }
+    #endif
+    return nextVector();
+}
+
+bool Session::beginSparseVector() {
+    if (encoding_ > Protocol::MAX_ENCODING || nonZero_ > vectorSize_ ||
+        (encoding_ == Protocol::ENC_DENSE && nonZero_ != vectorSize_)) {
+        logger_.log(LogLevel::ERROR, "Некорректная кодировка вектора",
+                   std::to_string(encoding_) + ", значений: " + std::to_string(nonZero_));
+        finish();
+        return false;
+    }
+
+    // Сворачиваются только переданные значения, остальные учитываются как нули
+    reduction_.begin(nonZero_, policy_, op_, type_);
+    reduction_.addZeros(vectorSize_ - nonZero_);
+    nextIndex_ = 0;
+    maskBits_ = 0;
+    switch (encoding_) {
+        case Protocol::ENC_COO:    indexBytes_ = uint64_t(nonZero_) * sizeof(uint32_t); break;
+        case Protocol::ENC_BITMAP: indexBytes_ = (uint64_t(vectorSize_) + 7) / 8; break;
+        default:                   indexBytes_ = 0; break;
+    }
+    state_ = (indexBytes_ > 0) ? State::SPARSE_INDEX : State::VECTOR_DATA;
+    return true;
+}
+
+bool Session::generateVector() {
+    uint32_t code, first, second, seedLow, seedHigh;
+    reader_.readU32LE(code);
+    reader_.readU32LE(first);
+    reader_.readU32LE(second);
+    reader_.readU32LE(seedLow);
+    reader_.readU32LE(seedHigh);
+
+    VectorGenerator generator;
+    generator.kind = static_cast<GeneratorKind>(code);
+    generator.first = static_cast<int32_t>(first);
+    generator.second = static_cast<int32_t>(second);
+    generator.seed = (static_cast<uint64_t>(seedHigh) << 32) | seedLow;
+
+    bool valid = false;
+    switch (code) {
+        case Protocol::GEN_CONSTANT: valid = (second == 0 && generator.seed == 0); break;
+        case Protocol::GEN_ARANGE:   valid = (generator.seed == 0); break;
+        case Protocol::GEN_RANDOM:   valid = (generator.first <= generator.second); break;
+    }
+    if (!valid) {
+        logger_.log(LogLevel::ERROR, "Некорректное описание генератора",
+                   std::to_string(code));
+        finish();
+        return false;
+    }
+
+    reduction_.begin(vectorSize_, policy_, op_, type_);
+    if (reduction_.reduceClosedForm(generator)) {
+        return completeVector();
+    }
+    if (vectorSize_ > Protocol::MAX_GENERATED_SIZE ||
+        batchGenerated_ + vectorSize_ > Protocol::MAX_BATCH_GENERATED) {
+        logger_.log(LogLevel::ERROR, "Превышен размер генерируемого вектора",
+                   std::to_string(vectorSize_) + ", в пакете: " +
+                   std::to_string(batchGenerated_ + vectorSize_));
+        finish();
+        return false;
+    }
+    batchGenerated_ += vectorSize_;
+    generator_ = generator;
+    state_ = State::VECTOR_DATA;
+    return true;
+}
+
+bool Session::generateStep() {
+    if (stepBudget_ == 0) {
+        yielded_ = true;
+        return false;
+    }
+    uint64_t count = std::min(stepBudget_, reduction_.remaining());
+    reduction_.generate(generator_, vectorSize_ - reduction_.remaining(), count);
+    stepBudget_ -= count;
+    // Клиент ждет результат, пока сервер строит вектор
+    lastActivity_ = time(nullptr);
+    if (!reduction_.isComplete()) {
+        yielded_ = true;
+        return false;
+    }
+    return completeVector();
+}
+
+bool Session::receiveSparseIndex() {
+    bool valid = true;
+    while (indexBytes_ > 0 && valid) {
+        size_t size = 0;
+        const char* data = reader_.contiguous(size);
+        size = static_cast<size_t>(std::min<uint64_t>(size, indexBytes_));
+
+        if (encoding_ == Protocol::ENC_COO) {
+            size_t count = size / sizeof(uint32_t);
+            if (count > 0) {
+                valid = VectorProcessor::checkIndices(data, count, nextIndex_, vectorSize_);
+                reader_.discard(count * sizeof(uint32_t));
+            } else {
+                // Индекс разорван границей кольцевого буфера
+                unsigned char index[sizeof(uint32_t)];
+                if (!reader_.readExact(index, sizeof(index))) {
+                    return false;
+                }
+                valid = VectorProcessor::checkIndices(index, 1, nextIndex_, vectorSize_);
+                count = 1;
+            }
+            indexBytes_ -= count * sizeof(uint32_t);
+        } else {
+            if (size == 0) {
+                return false;
+            }
+            if (size == indexBytes_ && vectorSize_ % 8 != 0) {
+                // Биты за концом вектора в последнем байте маски должны быть нулевыми
+                unsigned char last = static_cast<unsigned char>(data[size - 1]);
+                valid = (last >> (vectorSize_ % 8)) == 0;
+            }
+            maskBits_ += VectorProcessor::countBits(data, size);
+            reader_.discard(size);
+            indexBytes_ -= size;
+        }
+    }
+
+    if (!valid || (encoding_ == Protocol::ENC_BITMAP && maskBits_ != nonZero_)) {
+        logger_.log(LogLevel::ERROR, "Некорректные индексы разреженного вектора",
+                   std::to_string(currentVector_ + 1));
+        finish();
+        return false;
+    }
+    state_ = State::VECTOR_DATA;
+    return true;
+}
+
+bool Session::processStoreCommand() {
+    if (state_ == State::STORE_COMMAND) {
+        if (reader_.available() < 2 * sizeof(uint32_t)) {
+            return false;
+        }
+        reader_.readU32LE(storeCommand_);
+        reader_.readU32LE(storeNameLength_);
+        if (storeCommand_ > Protocol::MAX_STORE_COMMAND || storeNameLength_ == 0 ||
+            storeNameLength_ > Protocol::MAX_STORE_NAME) {
+            logger_.log(LogLevel::ERROR, "Некорректная команда хранилища",
+                       std::to_string(storeCommand_) + ", длина имени: " +
+                       std::to_string(storeNameLength_));
+            finish();
+            return false;
+        }
+        state_ = State::STORE_NAME;
+        return true;
+    }
+
+    if (state_ == State::STORE_NAME) {
+        // Имя и размер данных (или диапазон) команды принимаются вместе
+        bool payload = storeCommand_ == Protocol::STORE_CREATE ||
+                       storeCommand_ == Protocol::STORE_PATCH;
+        bool range = storeCommand_ == Protocol::STORE_RANGE;
+        size_t header = payload ? sizeof(uint32_t) : range ? 2 * sizeof(uint32_t) : 0;
+        if (reader_.available() < storeNameLength_ + header) {
+            return false;
+        }
+        storeName_.resize(storeNameLength_);
+        reader_.readExact(&storeName_[0], storeNameLength_);
+        if (range) {
+            reader_.readU32LE(rangeBegin_);
+            reader_.readU32LE(rangeEnd_);
+        }
+        if (!payload) {
+            return executeStoreCommand();
+        }
+
+        uint32_t count;
+        reader_.readU32LE(count);
+        uint32_t limit = (storeCommand_ == Protocol::STORE_CREATE) ? Protocol::MAX_STORED_SIZE
+                                                                   : Protocol::MAX_STORE_PATCH;
+        if (count == 0 || count > limit) {
+            logger_.log(LogLevel::ERROR, "Некорректный размер команды хранилища",
+                       storeName_ + ": " + std::to_string(count));
+            finish();
+            return false;
+        }
+        // Память под данные выделяется по мере их приема; данные команды,
+        // которую хранилище заведомо отклонит, пропускаются без копирования
+        storeCount_ = count;
+        storeDiscard_ = options_.store == nullptr ||
+                        (storeCommand_ == Protocol::STORE_CREATE &&
+                         VectorStore::entryBytes(storeName_, count) > options_.store->budget());
+        filled_ = 0;
+        state_ = State::STORE_DATA;
+        return true;
+    }
+
+    // Значения или изменения копируются из буфера приема прямо на место
+    bool create = storeCommand_ == Protocol::STORE_CREATE;
+    size_t width = create ? sizeof(int32_t) : sizeof(StorePatch);
+    size_t bytes = storeCount_ * width;
+    while (filled_ < bytes && reader_.available() > 0) {
+        size_t size = 0;
+        const char* data = reader_.contiguous(size);
+        size = std::min(size, bytes - filled_);
+        if (!storeDiscard_) {
+            size_t elements = (filled_ + size + width - 1) / width;
+            char* target = create
+                ? growBuffer(storeValues_, elements, storeCount_, bufferAllocations_)
+                : growBuffer(storePatches_, elements, storeCount_, bufferAllocations_);
+            memcpy(target + filled_, data, size);
+        }
+        reader_.discard(size);
+        filled_ += size;
+    }
+    if (filled_ < bytes) {
+        return false;
+    }
+
+    #if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+        uint32_t* words = create ? reinterpret_cast<uint32_t*>(storeValues_.data())
+                                 : reinterpret_cast<uint32_t*>(storePatches_.data());
+        for (size_t k = 0; k < (storeDiscard_ ? 0 : bytes / sizeof(uint32_t)); k++) {
+            words[k] = host_to_le32(words[k]);
+        }
+    #endif
+    return executeStoreCommand();
+}
+
+bool Session::executeStoreCommand() {
+    VectorStore* store = options_.store;
+    uint8_t status = Protocol::STORE_DISABLED;
+    StoredAggregates aggregates = StoredAggregates();
+    SumAccumulator sum(policy_);
+    if (store != nullptr && storeDiscard_) {
+        // Вектор больше всего хранилища: данные пропущены при приеме
+        status = Protocol::STORE_NO_SPACE;
+    } else if (store != nullptr) {
+        StoreResult result;
+        switch (storeCommand_) {
+            case Protocol::STORE_CREATE:
+                result = store->create(login_, storeName_, storeValues_);
+                break;
+            case Protocol::STORE_PATCH:
+                result = store->patch(login_, storeName_, storePatches_.data(), storePatches_.size());
+                break;
+            case Protocol::STORE_QUERY:
+                result = store->query(login_, storeName_, aggregates);
+                break;
+            case Protocol::STORE_INDEX:
+                result = store->buildIndex(login_, storeName_);
+                break;
+            case Protocol::STORE_RANGE:
+                result = store->rangeSum(login_, storeName_, rangeBegin_, rangeEnd_, sum);
+                break;
+            default:
+                result = store->remove(login_, storeName_);
+                break;
+        }
+        status = STORE_STATUSES[static_cast<int>(result)];
+    }
+    // Данные скопированы в хранилище; между командами удерживаются только
+    // небольшие буферы, а не до MAX_STORED_SIZE значений
+    releaseBuffer(storeValues_, BATCH_KEEP_ELEMENTS * sizeof(int32_t));
+    releaseBuffer(storePatches_, BATCH_KEEP_ELEMENTS * sizeof(int32_t));
+    storeDiscard_ = false;
+    queueBytes(&status, sizeof(status));
+
+    std::string text = storeName_ + ": статус " + std::to_string(status);
+    if (storeCommand_ == Protocol::STORE_QUERY && status == Protocol::STORE_OK) {
+        // Вектор не длиннее MAX_STORED_SIZE: сумма и сумма модулей помещаются в 64 бита
+        double norm = static_cast<double>(std::sqrt(static_cast<long double>(aggregates.squares)));
+        uint64_t bits;
+        memcpy(&bits, &norm, sizeof(bits));
+        uint32_t sizeLE = host_to_le32(static_cast<uint32_t>(aggregates.size));
+        unsigned char resultLE[4 * sizeof(uint64_t)];
+        host_to_le64(static_cast<uint64_t>(static_cast<int64_t>(aggregates.sum)), resultLE);
+        host_to_le64(static_cast<uint64_t>(aggregates.magnitude), resultLE + 8);
+        host_to_le64(aggregates.nonZero, resultLE + 16);
+        host_to_le64(bits, resultLE + 24);
+        queueBytes(&sizeLE, sizeof(sizeLE));
+        queueBytes(resultLE, sizeof(resultLE));
+        text += ", сумма " + std::to_string(static_cast<int64_t>(aggregates.sum));
+    }
+
+    logger_.log(LogLevel::INFO, "Команда хранилища " + std::to_string(storeCommand_), text);
+    if (storeCommand_ == Protocol::STORE_RANGE && status == Protocol::STORE_OK) {
+        queueSum(currentVector_, sum);
+    }
+    return nextVector();
+}
+
+bool Session::storesVector() const {
+    return parallel_ || matrix_ ||
+           (transform_ && currentVector_ == 0 && transformOp_ != TransformOp::PREFIX_SUM);
+}
+
+bool Session::beginTransform() {
+    const int32_t* operand = batch_.empty() ? nullptr : batch_.data(0);
+    size_t operandSize = batch_.empty() ? 0 : batch_.vectorSize(0);
+    bool valid = true;
+    switch (transformOp_) {
+        case TransformOp::PREFIX_SUM: break;
+        case TransformOp::ADD:        valid = (operandSize == vectorSize_); break;
+        case TransformOp::SCALE:      valid = (operandSize == 1); break;
+        case TransformOp::CLAMP:      valid = (operandSize == 2 && operand[0] <= operand[1]); break;
+    }
+    if (!valid) {
+        logger_.log(LogLevel::ERROR, "Некорректный операнд или размер вектора",
+                   std::string(VectorProcessor::transformOpName(transformOp_)) + ": " +
+                   std::to_string(vectorSize_));
+        finish();
+        return false;
+    }
+
+    transformer_.begin(transformOp_, policy_, operand);
+    filled_ = 0;
+    // Длина результата известна заранее: клиент разбирает ответ, не дожидаясь конца
+    uint32_t count = host_to_le32(vectorSize_);
+    queueBytes(&count, sizeof(count));
+    state_ = State::VECTOR_DATA;
+    return true;
+}
+
+bool Session::transformVector() {
+    const size_t width = transformer_.outputSize();
+    while (filled_ < vectorSize_) {
+        if (isOutputBlocked()) {
+            // Ответ копится быстрее, чем уходит: продолжим после отправки
+            requestFlush();
+            return false;
+        }
+
+        size_t size = 0;
+        const char* data = reader_.contiguous(size);
+        size_t count = std::min<size_t>(std::min<size_t>(size / sizeof(int32_t),
+                                                         vectorSize_ - filled_),
+                                        TRANSFORM_CHUNK_ELEMENTS);
+        if (std::max<size_t>(count, 1) > scratch_.capacity()) {
+            bufferAllocations_++;
+        }
+        scratch_.resize(std::max<size_t>(count, 1));
+        if (count > 0) {
+            memcpy(scratch_.data(), data, count * sizeof(int32_t));
+            reader_.discard(count * sizeof(int32_t));
+        } else if (reader_.readExact(scratch_.data(), sizeof(int32_t))) {
+            // Элемент разорван границей кольцевого буфера
+            count = 1;
+        } else {
+            return false;
+        }
+
+        #if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+            for (size_t k = 0; k < count; k++) {
+                scratch_[k] = host_to_le32_int(scratch_[k]);
+            }
+        #endif
+        if (count * width > transformed_.capacity()) {
+            bufferAllocations_++;
+        }
+        transformed_.resize(count * width);
+        transformer_.apply(scratch_.data(), count, transformed_.data());
+        queueBytes(transformed_.data(), transformed_.size());
+        filled_ += count;
+    }
+
+    logger_.log(LogLevel::INFO, "Отправлен результат вектора " + std::to_string(currentVector_+1),
+               std::string(VectorProcessor::transformOpName(transformOp_)) + ", элементов: " +
+               std::to_string(vectorSize_));
+    return nextVector();
+}
+
+void Session::completeMatrixBatch() {
+    size_t rows = batch_.size();
+    size_t cols = batch_.vectorSize(0);
+    size_t capacity = matrixResult_.capacity();
+    switch (matrixOp_) {
+        case MatrixOp::COLUMN_SUM:
+            VectorProcessor::columnSums(batch_.data(0), rows, cols, matrixResult_, options_.pool);
+            break;
+        case MatrixOp::GRAM:
+            VectorProcessor::gram(batch_.data(0), rows, cols, matrixResult_, options_.pool);
+            break;
+        case MatrixOp::MATVEC:
+            // Первый вектор - множитель, остальные - строки матрицы
+            VectorProcessor::matVec(batch_.data(1), rows - 1, cols, batch_.data(0),
+                                    matrixResult_, options_.pool);
+            break;
+    }
+    if (matrixResult_.capacity() != capacity) {
+        bufferAllocations_++;
+    }
+
+    // Количество, затем значения порциями прямо в очередь отправки
+    uint32_t count = host_to_le32(static_cast<uint32_t>(matrixResult_.size()));
+    queueBytes(&count, sizeof(count));
+    unsigned char chunk[MATRIX_CHUNK_VALUES * sizeof(uint64_t)];
+    for (size_t first = 0; first < matrixResult_.size(); first += MATRIX_CHUNK_VALUES) {
+        size_t values = std::min(MATRIX_CHUNK_VALUES, matrixResult_.size() - first);
+        for (size_t k = 0; k < values; k++) {
+            host_to_le64(static_cast<uint64_t>(matrixResult_[first + k]),
+                         chunk + k * sizeof(uint64_t));
+        }
+        queueBytes(chunk, values * sizeof(uint64_t));
+    }
+
+    logger_.log(LogLevel::INFO, "Отправлен результат пакета",
+               std::string(VectorProcessor::matrixOpName(matrixOp_)) + ", значений: " +
+               std::to_string(matrixResult_.size()));
+}
+
+void Session::completeParallelBatch() {
+    VectorProcessor::processVectors(batch_, policy_, results_, options_.pool);
+    for (size_t i = 0; i < results_.size(); i++) {
+        queueSum(static_cast<uint32_t>(i), results_[i]);
+    }
+}
+
+void Session::queueReduction() {
+    uint32_t i = currentVector_;
+    const ReduceState& state = reduction_.state();
+
+    bool integer = VectorProcessor::isInteger(type_);
+    std::string text;
+    if ((op_ == ReduceOp::MIN || op_ == ReduceOp::MAX) && integer) {
+        if (type_ == ElementType::INT64) {
+            unsigned char resultLE[sizeof(uint64_t)];
+            host_to_le64(static_cast<uint64_t>(state.value), resultLE);
+            queueBytes(resultLE, sizeof(resultLE));
+        } else {
+            int32_t value = host_to_le32_int(static_cast<int32_t>(state.value));
+            queueBytes(&value, sizeof(value));
+        }
+        text = std::to_string(state.value);
+    } else if (op_ == ReduceOp::COUNT_NZ || (op_ == ReduceOp::L1 && integer)) {
+        uint64_t value = (op_ == ReduceOp::L1) ? state.magnitude()
+                                               : static_cast<uint64_t>(state.value);
+        unsigned char resultLE[sizeof(value)];
+        host_to_le64(value, resultLE);
+        queueBytes(resultLE, sizeof(resultLE));
+        text = std::to_string(value);
+    } else {
+        // Вещественный результат: среднее, норма, операции над float32/float64
+        double value;
+        switch (op_) {
+            case ReduceOp::MEAN: value = state.mean(); break;
+            case ReduceOp::L2:   value = state.norm(); break;
+            case ReduceOp::MIN:
+            case ReduceOp::MAX:  value = state.real; break;
+            default:             value = state.sum(); break;
+        }
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        unsigned char resultLE[sizeof(bits)];
+        host_to_le64(bits, resultLE);
+        queueBytes(resultLE, sizeof(resultLE));
+        text = std::to_string(value);
+    }
+
+    logger_.log(LogLevel::INFO, "Отправлен результат вектора " + std::to_string(i+1),
+               std::string(VectorProcessor::opName(op_)) + " = " + text);
+}
+
+bool Session::nextVector() {
+    currentVector_++;
+    if (currentVector_ < numVectors_) {
+        state_ = store_ ? State::STORE_COMMAND : State::VECTOR_SIZE;
+        return true;
+    }
+
+    if (parallel_) {
+        completeParallelBatch();
+    } else if (matrix_) {
+        completeMatrixBatch();
+    }
+    logger_.log(LogLevel::INFO, "Все векторы обработаны",
+               "количество: " + std::to_string(numVectors_) +
+               ", выделений буферов: " + std::to_string(bufferAllocations_ - batchAllocations_));
+    finishBatch();
+    return state_ != State::CLOSING;
+}
+
+bool Session::processBatchHeader() {
+    if (state_ == State::BATCH_HEADER) {
+        // Расширенный заголовок: слово управления и количество векторов
+        if (reader_.available() < 2 * sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t control;
+        uint32_t numVectors;
+        reader_.readU32LE(control);
+        reader_.readU32LE(numVectors);
+
+        uint32_t opcode = (control & Protocol::OPCODE_MASK) >> Protocol::OPCODE_SHIFT;
+        uint32_t policy = (control & Protocol::POLICY_MASK) >> Protocol::POLICY_SHIFT;
+        uint32_t type = (control & Protocol::TYPE_MASK) >> Protocol::TYPE_SHIFT;
+        if ((control & ~Protocol::KNOWN_CONTROL_BITS) || policy > Protocol::MAX_POLICY ||
+            type > Protocol::MAX_TYPE) {
+            logger_.log(LogLevel::ERROR, "Некорректное слово управления пакета",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if (opcode > Protocol::MAX_OPCODE) {
+            logger_.log(LogLevel::ERROR, "Неизвестная операция", std::to_string(opcode));
+            finish();
+            return false;
+        }
+        if (opcode > Protocol::MAX_REDUCE_OPCODE && type != Protocol::TYPE_INT32) {
+            logger_.log(LogLevel::ERROR, "Операция над пакетом допустима только для int32",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        bool integerSum = (opcode == Protocol::OP_SUM &&
+                           VectorProcessor::isInteger(ELEMENT_TYPES[type]));
+        bool transform = opcode > Protocol::MAX_MATRIX_OPCODE;
+        if ((!integerSum && !transform && policy != Protocol::POLICY_SATURATE) ||
+            (transform && policy == Protocol::POLICY_ERROR)) {
+            logger_.log(LogLevel::ERROR, "Политика переполнения задана не для суммы целых",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_SPARSE) &&
+            (opcode > Protocol::MAX_REDUCE_OPCODE || (control & Protocol::FLAG_PARALLEL))) {
+            logger_.log(LogLevel::ERROR, "Разреженные векторы допустимы только для сверток",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_PACKED) &&
+            (opcode > Protocol::MAX_REDUCE_OPCODE || type != Protocol::TYPE_INT32 ||
+             (control & (Protocol::FLAG_PARALLEL | Protocol::FLAG_SPARSE)))) {
+            logger_.log(LogLevel::ERROR, "Сжатые векторы допустимы только для сверток int32",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_GENERATED) &&
+            (opcode > Protocol::MAX_REDUCE_OPCODE || type != Protocol::TYPE_INT32 ||
+             (control & (Protocol::FLAG_PARALLEL | Protocol::FLAG_SPARSE | Protocol::FLAG_PACKED)))) {
+            logger_.log(LogLevel::ERROR, "Генераторы векторов допустимы только для сверток int32",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_CACHED) &&
+            (opcode > Protocol::MAX_REDUCE_OPCODE ||
+             (control & (Protocol::FLAG_PARALLEL | Protocol::FLAG_SPARSE |
+                         Protocol::FLAG_PACKED | Protocol::FLAG_GENERATED)))) {
+            logger_.log(LogLevel::ERROR, "Кэш результатов допустим только для сверток",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_STORE) &&
+            (control & ~(Protocol::FLAG_STORE | Protocol::FLAG_KEEP_ALIVE | Protocol::POLICY_MASK))) {
+            logger_.log(LogLevel::ERROR, "Команды хранилища несовместимы с другими полями слова управления",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+        if ((control & Protocol::FLAG_PARALLEL) &&
+            (opcode != Protocol::OP_SUM || type != Protocol::TYPE_INT32)) {
+            logger_.log(LogLevel::ERROR, "Параллельная обработка допустима только для суммы int32",
+                       std::to_string(control));
+            finish();
+            return false;
+        }
+
+        keepAlive_ = (control & Protocol::FLAG_KEEP_ALIVE) != 0;
+        streaming_ = (control & Protocol::FLAG_STREAMING) != 0;
+        parallel_ = (control & Protocol::FLAG_PARALLEL) != 0;
+        sparse_ = (control & Protocol::FLAG_SPARSE) != 0;
+        packed_ = (control & Protocol::FLAG_PACKED) != 0;
+        generated_ = (control & Protocol::FLAG_GENERATED) != 0;
+        cached_ = (control & Protocol::FLAG_CACHED) != 0;
+        store_ = (control & Protocol::FLAG_STORE) != 0;
+        cacheSeed_ = static_cast<uint64_t>(control & (Protocol::OPCODE_MASK | Protocol::POLICY_MASK |
+                                                      Protocol::TYPE_MASK)) << 32;
+        policy_ = OVERFLOW_POLICIES[policy];
+        matrix_ = opcode > Protocol::MAX_REDUCE_OPCODE && !transform;
+        transform_ = transform;
+        op_ = ReduceOp::SUM;
+        if (matrix_) {
+            matrixOp_ = MATRIX_OPERATIONS[opcode - Protocol::OP_COLUMN_SUM];
+        } else if (transform_) {
+            transformOp_ = TRANSFORM_OPERATIONS[opcode - Protocol::OP_PREFIX_SUM];
+        } else {
+            op_ = OPERATIONS[opcode];
+        }
+        type_ = ELEMENT_TYPES[type];
+        return startBatch(numVectors);
+    }
+
+    // Шаг 6: Получение количества векторов (4 байта, uint32_t)
+    // или признака расширенного заголовка
+    // (клиент отправляет в little-endian!)
+    uint32_t value;
+    if (!reader_.readU32LE(value)) {
+        return false;
+    }
+
+    if (value == Protocol::BATCH_MAGIC) {
+        state_ = State::BATCH_HEADER;
+        return true;
+    }
+
+    if (state_ == State::NEXT_BATCH) {
+        // В режиме keep-alive допустим только новый заголовок или маркер конца
+        if (value == Protocol::END_OF_SESSION) {
+            logger_.log(LogLevel::INFO, "Клиент завершил сеанс",
+                       "пакетов: " + std::to_string(batchCount_));
+        } else {
+            logger_.log(LogLevel::ERROR, "Ожидался заголовок пакета",
+                       std::to_string(value));
+        }
+        finish();
+        return false;
+    }
+
+    // Прежний формат: один пакет, затем закрытие соединения
+    std::cout << "DEBUG: Получено количество векторов (после конвертации): " << value << std::endl;
+    keepAlive_ = false;
+    streaming_ = false;
+    parallel_ = false;
+    sparse_ = false;
+    packed_ = false;
+    generated_ = false;
+    cached_ = false;
+    store_ = false;
+    matrix_ = false;
+    transform_ = false;
+    policy_ = OverflowPolicy::SATURATE;
+    op_ = ReduceOp::SUM;
+    type_ = ElementType::INT32;
+    return startBatch(value);
+}
+
+bool Session::startBatch(uint32_t numVectors) {
+    numVectors_ = numVectors;
+
+    logger_.log(LogLevel::INFO, "Получено количество векторов",
+               std::to_string(numVectors_));
+
+    if (numVectors_ == 0 ||
+        (!streaming_ && numVectors_ > Protocol::MAX_VECTORS)) {
+        logger_.log(LogLevel::ERROR, "Некорректное количество векторов",
+                   std::to_string(numVectors_));
+        finish();
+        return false;
+    }
+
+    if (matrix_ && ((matrixOp_ == MatrixOp::GRAM && numVectors_ > Protocol::MAX_GRAM_VECTORS) ||
+                    (matrixOp_ == MatrixOp::MATVEC && numVectors_ < 2))) {
+        logger_.log(LogLevel::ERROR, "Некорректное количество векторов для операции",
+                   std::string(VectorProcessor::matrixOpName(matrixOp_)) + ": " +
+                   std::to_string(numVectors_));
+        finish();
+        return false;
+    }
+    if (transform_ && transformOp_ != TransformOp::PREFIX_SUM && numVectors_ < 2) {
+        logger_.log(LogLevel::ERROR, "Некорректное количество векторов для операции",
+                   std::string(VectorProcessor::transformOpName(transformOp_)) + ": " +
+                   std::to_string(numVectors_));
+        finish();
+        return false;
+    }
+
+    currentVector_ = 0;
+    batch_.clear();
+    batchAllocations_ = bufferAllocations_;
+    batchGenerated_ = 0;
+    state_ = store_ ? State::STORE_COMMAND : State::VECTOR_SIZE;
+    return true;
+}
+
+void Session::finishBatch() {
+    batchCount_++;
+    // Буфер большого пакета не удерживается до конца сеанса keep-alive
+    batch_.shrink(BATCH_KEEP_ELEMENTS);
+    requestFlush();
+    if (!keepAlive_) {
+        finish();
+        return;
+    }
+
+    // Keep-alive: соединение остается открытым до маркера конца или таймаута
+    state_ = State::NEXT_BATCH;
+}
+
+bool Session::extractLogin(std::string& login) {
+    if (reader_.readUntil(LOGIN_DELIMITERS, MAX_LOGIN_LENGTH, login)) {
+        return true;
+    }
+
+    // Разделителя нет среди первых MAX_LOGIN_LENGTH байт: логин обрезается
+    if (reader_.available() >= MAX_LOGIN_LENGTH) {
+        reader_.readSome(login, MAX_LOGIN_LENGTH);
+        return true;
+    }
+
+    if (!inputDrained_ || reader_.available() == 0) {
+        return false;
+    }
+
+    // Логин без разделителя: обрезаем пробелы и управляющие символы
+    std::string candidate;
+    size_t size = reader_.peek(candidate, MAX_LOGIN_LENGTH);
+    size_t last = candidate.find_last_not_of(" \t\n\r");
+    if (last != std::string::npos) {
+        candidate = candidate.substr(0, last + 1);
+    }
+
+    // Как и прежде, логином считается все принятое, даже если такого
+    // клиента нет: прежний клиент сразу получает ERR, а не таймаут
+    reader_.discard(size);
+    login = candidate;
+    return true;
+}
+
+void Session::queueString(const std::string& str) {
+    queueBytes(str.c_str(), str.length() + 1); // +1 для нуль-терминатора
+}
+
+void Session::queueBytes(const void* data, size_t size) {
+    if (output_.empty()) {
+        pendingSince_ = std::chrono::steady_clock::now();
+    }
+    output_.append(data, size);
+    if (recording_ && recorded_.size + size <= sizeof(recorded_.bytes)) {
+        memcpy(recorded_.bytes + recorded_.size, data, size);
+        recorded_.size = static_cast<uint8_t>(recorded_.size + size);
+    }
+
+    if (options_.flushMode == ResponseFlush::IMMEDIATE ||
+        output_.pending() >= options_.flushBytes) {
+        requestFlush();
+    }
+}
+
+bool Session::flushOutput() {
+    if (!hasOutput()) {
+        return true;
+    }
+
+    size_t pending = output_.pending();
+    if (!output_.flush(socket_)) {
+        logger_.logSystemError("Ошибка отправки данных клиенту");
+        return false;
+    }
+    if (output_.pending() < pending) {
+        // Клиент с малым окном приема может забирать длинный ответ дольше таймаута
+        lastActivity_ = time(nullptr);
+    }
+
+    if (output_.empty()) {
+        flushRequested_ = false;
+    }
+    return true;
+}
+
+void Session::finish() {
+    state_ = State::CLOSING;
+    requestFlush();
+}
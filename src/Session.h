@@ -0,0 +1,510 @@
+/**
+ * @file Session.h
+ * @brief Сеанс клиента (конечный автомат протокола)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "ConnectionReader.h"
+#include "Database.h"
+#include "Logger.h"
+#include "ResponseBuilder.h"
+#include "ResultCache.h"
+#include "VectorBatch.h"
+#include "VectorProcessor.h"
+#include "VectorStore.h"
+#include "Xxh64.h"
+#include <chrono>
+#include <string>
+#include <ctime>
+#include <cstdint>
+#include <vector>
+
+class WorkStealingPool;
+
+/**
+ * @brief Параметры сеансов, общие для всех соединений цикла
+ */
+struct SessionOptions {
+    int keepAliveTimeoutSec;    ///< Ожидание следующего пакета в режиме keep-alive
+    ResponseFlush flushMode;    ///< Когда отправлять накопленные ответы
+    size_t flushBytes;          ///< Порог размера отложенного ответа (BATCH)
+    int flushDelayMs;           ///< Порог задержки отложенного ответа (BATCH)
+    WorkStealingPool* pool;     ///< Пул для пакетов FLAG_PARALLEL или nullptr
+    ResultCache* cache;         ///< Кэш для пакетов FLAG_CACHED или nullptr
+    VectorStore* store;         ///< Хранилище для пакетов FLAG_STORE или nullptr
+
+    SessionOptions()
+        : keepAliveTimeoutSec(30),
+          flushMode(ResponseFlush::IMMEDIATE),
+          flushBytes(65536),
+          flushDelayMs(5),
+          pool(nullptr),
+          cache(nullptr),
+          store(nullptr) {}
+};
+
+/**
+ * @brief Сеанс одного клиента
+ *
+ * Сокет клиента неблокирующий. Сеанс накапливает принятые байты в
+ * кольцевом буфере ConnectionReader и продвигает конечный автомат
+ * протокола (аутентификация, затем обработка векторов) по мере их
+ * поступления; поле, разорванное между сегментами TCP, дожидается остатка.
+ * Ответы копятся в ResponseBuilder и отправляются одним вызовом: в режиме
+ * IMMEDIATE после разбора каждой порции, в режиме BATCH - в конце пакета
+ * или при достижении порога размера/задержки.
+ */
+class Session {
+public:
+    /**
+     * @brief Состояния протокола
+     */
+    enum class State {
+        LOGIN,          ///< Ожидание логина
+        HASH,           ///< Ожидание хеша пароля
+        NUM_VECTORS,    ///< Ожидание количества векторов или расширенного заголовка
+        BATCH_HEADER,   ///< Ожидание слова управления и количества векторов
+        VECTOR_SIZE,    ///< Ожидание размера очередного вектора
+        SPARSE_INDEX,   ///< Ожидание индексов или битовой маски разреженного вектора
+        CACHE_KEY,      ///< Ожидание ключа вектора в кэше результатов
+        VECTOR_DATA,    ///< Ожидание значений вектора
+        STORE_COMMAND,  ///< Ожидание кода команды хранилища и длины имени
+        STORE_NAME,     ///< Ожидание имени вектора и размера данных (диапазона) команды
+        STORE_DATA,     ///< Ожидание значений или изменений вектора в хранилище
+        NEXT_BATCH,     ///< Keep-alive: ожидание следующего заголовка или маркера конца
+        CLOSING         ///< Отправка остатка ответа и закрытие
+    };
+
+    /**
+     * @brief Конструктор
+     * @param socket Неблокирующий сокет клиента
+     * @param peer IP адрес клиента
+     * @param database База клиентов
+     * @param logger Журнал
+     * @param options Параметры сеанса
+     */
+    Session(int socket, const std::string& peer,
+            const Database& database, Logger& logger,
+            const SessionOptions& options = SessionOptions());
+
+    /**
+     * @brief Деструктор (закрывает сокет)
+     */
+    ~Session();
+
+    /**
+     * @brief Обработать готовность сокета к чтению
+     * @return false - сеанс нужно закрыть
+     */
+    bool onReadable();
+
+    /**
+     * @brief Обработать готовность сокета к записи
+     * @return false - сеанс нужно закрыть
+     */
+    bool onWritable();
+
+    /**
+     * @brief Продолжить разбор, остановленный из-за неотправленного ответа
+     *        или бюджетом шага
+     *
+     * Используется бэкендом io_uring после завершения отправки и обоими
+     * бэкендами для сеансов с hasPendingWork().
+     */
+    void resume();
+
+    /**
+     * @brief Проверить, ждет ли разбор продолжения без новых данных
+     *
+     * За один вызов разбора строится не больше STEP_GENERATED_ELEMENTS
+     * элементов сгенерированных векторов, чтобы сеанс не задерживал
+     * остальные сеансы цикла. Остаток строит resume(); до тех пор новые
+     * данные клиента не читаются.
+     *
+     * @return true - цикл должен вызвать resume(), не дожидаясь событий сокета
+     */
+    bool hasPendingWork() const { return yielded_ && !isOutputBlocked(); }
+
+    /**
+     * @brief Передать сеансу байты, принятые внешним механизмом ввода-вывода
+     *
+     * Используется бэкендом io_uring, который сам читает сокет.
+     *
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void deliver(const char* data, size_t size);
+
+    /**
+     * @brief Забрать накопленный ответ для отправки внешним механизмом
+     *
+     * Буфер переходит к вызывающему и остается неизменным до конца
+     * отправки, даже если сеанс тем временем формирует новый ответ.
+     *
+     * @param buffer Буфер (выходной параметр, прежнее содержимое теряется)
+     */
+    void takeOutput(std::string& buffer);
+
+    /**
+     * @brief Проверить наличие ответа, готового к отправке
+     * @return true - есть данные, которые пора отправить
+     */
+    bool hasOutput() const { return flushRequested_ && !output_.empty(); }
+
+    /**
+     * @brief Проверить наличие отложенного ответа (режим BATCH)
+     * @return true - ответ накоплен, но срок его отправки еще не наступил
+     */
+    bool hasDeferredOutput() const { return !flushRequested_ && !output_.empty(); }
+
+    /**
+     * @brief Проверить порог задержки отложенного ответа
+     * @param now Текущее время
+     * @return true - есть ответ, готовый к отправке (hasOutput)
+     */
+    bool pollFlushDeadline(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Отправить готовый ответ в сокет (бэкенд epoll)
+     * @return false - ошибка сокета
+     */
+    bool flushOutput();
+
+    /**
+     * @brief Проверить завершение сеанса
+     * @return true - протокол завершен и ответ полностью отправлен
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Проверить завершение протокола (ответ мог быть еще не отправлен)
+     * @return true - новых данных от клиента сеанс не ждет
+     */
+    bool isClosing() const { return state_ == State::CLOSING; }
+
+    /**
+     * @brief Проверить переполнение неотправленного ответа
+     *
+     * Пока ответ не отправлен, разбор стоит, и принимать новые данные
+     * клиента не нужно: бэкенд перестает читать сокет до resume().
+     *
+     * @return true - разбор нужно приостановить до отправки
+     */
+    bool isOutputBlocked() const { return output_.pending() >= OUTPUT_HIGH_WATER; }
+
+    /**
+     * @brief Проверить истечение таймаута бездействия
+     *
+     * Между пакетами сеанса keep-alive действует keepAliveTimeoutSec,
+     * внутри пакета и при аутентификации - IDLE_TIMEOUT_SEC. Активностью
+     * считается и прием данных, и продвижение отправки ответа, включая
+     * уход данных из очереди отправки сокета.
+     *
+     * @param now Текущее время
+     * @return true - клиент молчит дольше допустимого
+     */
+    bool isTimedOut(time_t now);
+
+    /**
+     * @brief Получить сокет клиента
+     * @return Сокет
+     */
+    int getSocket() const { return socket_; }
+
+    /**
+     * @brief Получить состояние протокола
+     * @return Состояние
+     */
+    State getState() const { return state_; }
+
+    /**
+     * @brief Количество выделений памяти под буферы пакетов
+     *
+     * Учитываются значения пакета, буферы команд хранилища, преобразований
+     * и матричного результата. Буферы сохраняют емкость между пакетами,
+     * поэтому в установившемся режиме счетчик не растет.
+     *
+     * @return Количество выделений за время сеанса
+     */
+    uint64_t getBufferAllocations() const { return bufferAllocations_; }
+
+    /// Таймаут бездействия клиента в секундах
+    static const int IDLE_TIMEOUT_SEC = 5;
+
+    /// Объем неотправленного ответа, при котором разбор входных данных приостанавливается
+    static const size_t OUTPUT_HIGH_WATER = 1 << 20;
+
+    /// Емкость буферов пакета и команд хранилища, сохраняемая до следующего пакета (элементов int32)
+    static const size_t BATCH_KEEP_ELEMENTS = 1 << 16;
+
+    /// Количество значений матричного ответа, переводимых в little-endian за раз
+    static const size_t MATRIX_CHUNK_VALUES = 512;
+
+    /// Количество элементов сгенерированных векторов, строящихся за один вызов разбора
+    static const uint64_t STEP_GENERATED_ELEMENTS = 1 << 20;
+
+    /// Количество элементов, преобразуемых за один шаг разбора
+    static const size_t TRANSFORM_CHUNK_ELEMENTS = 16384;
+
+private:
+    int socket_;
+    std::string peer_;
+    const Database& database_;
+    Logger& logger_;
+    SessionOptions options_;
+
+    State state_;
+    std::string login_;
+    std::string salt_;
+    bool authenticated_;
+    uint32_t numVectors_;
+    uint32_t currentVector_;
+    uint32_t vectorSize_;
+    bool keepAlive_;
+    bool streaming_;                ///< Пакет с флагом FLAG_STREAMING
+    bool parallel_;                 ///< Пакет с флагом FLAG_PARALLEL
+    bool matrix_;                   ///< Пакет матричной операции
+    MatrixOp matrixOp_;             ///< Матричная операция пакета
+    bool sparse_;                   ///< Пакет с флагом FLAG_SPARSE
+    uint32_t encoding_;             ///< Кодировка текущего вектора (Protocol::VectorEncoding)
+    uint32_t nonZero_;              ///< Явно переданных значений текущего вектора
+    uint64_t indexBytes_;           ///< Осталось принять байт индексов или маски
+    uint64_t nextIndex_;            ///< Наименьший допустимый следующий индекс (ENC_COO)
+    uint64_t maskBits_;             ///< Единиц в принятой части маски (ENC_BITMAP)
+    bool packed_;                   ///< Пакет с флагом FLAG_PACKED
+    PackedDecoder decoder_;         ///< Распаковка текущего вектора FLAG_PACKED
+    bool generated_;                ///< Пакет с флагом FLAG_GENERATED
+    bool cached_;                   ///< Пакет с флагом FLAG_CACHED
+    uint64_t cacheSeed_;            ///< Зерно ключа без размера вектора
+    VectorGenerator generator_;     ///< Генератор текущего вектора FLAG_GENERATED
+    Xxh64 hasher_;                  ///< Ключ текущего вектора по мере приема
+    bool recording_;                ///< queueBytes копирует ответ в recorded_
+    CachedResult recorded_;         ///< Ответ на вектор для кэша
+    bool store_;                    ///< Пакет с флагом FLAG_STORE
+    uint32_t storeCommand_;         ///< Текущая команда (Protocol::StoreCommand)
+    uint32_t storeNameLength_;      ///< Длина имени текущей команды
+    std::string storeName_;         ///< Имя вектора текущей команды
+    uint32_t rangeBegin_;           ///< Начало диапазона STORE_RANGE
+    uint32_t rangeEnd_;             ///< Конец диапазона STORE_RANGE (не включается)
+    uint32_t storeCount_;           ///< Объявлено значений или изменений в команде
+    bool storeDiscard_;             ///< Данные команды пропускаются (хранилище ее отклонит)
+    std::vector<int32_t> storeValues_;      ///< Значения STORE_CREATE
+    std::vector<StorePatch> storePatches_;  ///< Изменения STORE_PATCH
+    bool transform_;                ///< Пакет операции преобразования
+    TransformOp transformOp_;       ///< Операция преобразования пакета
+    VectorTransform transformer_;   ///< Преобразование текущего вектора по мере приема
+    OverflowPolicy policy_;         ///< Политика переполнения пакета
+    ReduceOp op_;                   ///< Операция свертки пакета
+    ElementType type_;              ///< Тип элементов пакета
+    VectorReduction reduction_;     ///< Свертка текущего вектора по мере приема
+    VectorBatch batch_;             ///< Значения пакета FLAG_PARALLEL
+    size_t filled_;                 ///< Принято байт текущего вектора в batch_ (элементов - при преобразовании)
+    std::vector<SumAccumulator> results_;   ///< Суммы пакета FLAG_PARALLEL
+    std::vector<int64_t> matrixResult_;     ///< Результат матричной операции
+    std::vector<int32_t> scratch_;          ///< Порция элементов для преобразования
+    std::vector<unsigned char> transformed_;    ///< Результат порции преобразования
+    uint64_t batchCount_;
+    uint64_t bufferAllocations_;    ///< Выделения памяти под буферы пакетов за сеанс
+    uint64_t batchAllocations_;     ///< Счетчик выделений в начале пакета
+    uint64_t batchGenerated_;       ///< Построено поэлементно в текущем пакете
+    uint64_t stepBudget_;           ///< Осталось построить элементов в текущем вызове разбора
+    bool yielded_;                  ///< Разбор остановлен бюджетом шага
+
+    ConnectionReader reader_;
+    bool inputDrained_;
+    bool inputPaused_;              ///< Чтение сокета остановлено до отправки ответа
+    bool inputClosed_;              ///< Клиент закрыл соединение (бэкенд epoll)
+    ResponseBuilder output_;
+    bool flushRequested_;
+    std::chrono::steady_clock::time_point pendingSince_;
+    time_t lastActivity_;
+    int socketQueued_;              ///< Очередь отправки сокета при прошлой проверке таймаута
+
+    /**
+     * @brief Продвинуть конечный автомат по накопленным данным
+     */
+    void process();
+
+    /**
+     * @brief Шаг аутентификации (состояния LOGIN и HASH)
+     * @return true - шаг выполнен, можно продолжать разбор
+     */
+    bool authenticateClient();
+
+    /**
+     * @brief Шаг обработки векторов (от NUM_VECTORS до NEXT_BATCH)
+     * @return true - шаг выполнен, можно продолжать разбор
+     */
+    bool processVectorData();
+
+    /**
+     * @brief Отправить результат вектора и перейти к следующему
+     *
+     * Сумма целых отправляется в формате политики переполнения,
+     * прочие свертки - через queueReduction(). В пакете FLAG_CACHED
+     * ответ предваряется байтом CACHE_COMPUTED и сохраняется в кэше.
+     *
+     * @return true - можно продолжать разбор
+     */
+    bool completeVector();
+
+    /**
+     * @brief Поставить результат свертки, кроме суммы целых, в очередь отправки
+     */
+    void queueReduction();
+
+    /**
+     * @brief Ответить на ссылку на вектор по ключу (FLAG_CACHED)
+     * @return true - можно продолжать разбор
+     */
+    bool answerCacheKey();
+
+    /**
+     * @brief Поставить сумму целых в очередь отправки в формате политики
+     * @param index Номер вектора в пакете
+     * @param sum Накопитель с суммой
+     */
+    void queueSum(uint32_t index, const SumAccumulator& sum);
+
+    /**
+     * @brief Принять значения вектора пакета FLAG_PARALLEL или матричной операции в batch_
+     * @return true - вектор принят, можно продолжать разбор
+     */
+    bool receiveVector();
+
+    /**
+     * @brief Начать разреженный вектор: проверить кодировку и количество значений
+     * @return false - некорректный заголовок вектора, сеанс завершается
+     */
+    bool beginSparseVector();
+
+    /**
+     * @brief Принять описание генератора (FLAG_GENERATED)
+     *
+     * Вектор с замкнутой формой сворачивается сразу, остальные строит
+     * generateStep().
+     *
+     * @return true - можно продолжать разбор
+     */
+    bool generateVector();
+
+    /**
+     * @brief Построить и свернуть часть вектора в пределах бюджета шага
+     * @return true - результат вектора готов, можно продолжать разбор
+     */
+    bool generateStep();
+
+    /**
+     * @brief Принять и проверить индексы или битовую маску разреженного вектора
+     * @return true - индексы приняты, можно продолжать разбор
+     */
+    bool receiveSparseIndex();
+
+    /**
+     * @brief Шаг команды хранилища (от STORE_COMMAND до STORE_DATA)
+     * @return true - шаг выполнен, можно продолжать разбор
+     */
+    bool processStoreCommand();
+
+    /**
+     * @brief Выполнить принятую команду хранилища и отправить ответ
+     * @return true - можно продолжать разбор
+     */
+    bool executeStoreCommand();
+
+    /**
+     * @brief Проверить, принимается ли текущий вектор целиком в batch_
+     * @return true - пакет FLAG_PARALLEL, матричная операция или операнд преобразования
+     */
+    bool storesVector() const;
+
+    /**
+     * @brief Начать преобразование вектора: проверить операнд и отправить длину
+     * @return false - некорректный вектор или операнд, сеанс завершается
+     */
+    bool beginTransform();
+
+    /**
+     * @brief Преобразовать значения вектора по мере приема и отправить результат
+     * @return true - вектор обработан, можно продолжать разбор
+     */
+    bool transformVector();
+
+    /**
+     * @brief Просуммировать принятый пакет FLAG_PARALLEL и отправить суммы
+     */
+    void completeParallelBatch();
+
+    /**
+     * @brief Выполнить матричную операцию над принятым пакетом и отправить результат
+     */
+    void completeMatrixBatch();
+
+    /**
+     * @brief Перейти к следующему вектору или завершить пакет
+     * @return true - можно продолжать разбор
+     */
+    bool nextVector();
+
+    /**
+     * @brief Разобрать заголовок пакета (NUM_VECTORS, BATCH_HEADER, NEXT_BATCH)
+     * @return true - шаг выполнен, можно продолжать разбор
+     */
+    bool processBatchHeader();
+
+    /**
+     * @brief Начать прием пакета векторов
+     * @param numVectors Количество векторов
+     * @return false - некорректное количество, сеанс завершается
+     */
+    bool startBatch(uint32_t numVectors);
+
+    /**
+     * @brief Завершить пакет: ждать следующий (keep-alive) или закрыть сеанс
+     */
+    void finishBatch();
+
+    /**
+     * @brief Извлечь логин из входного буфера
+     *
+     * Логин завершается нуль-терминатором или пробельным символом.
+     * Прежние клиенты присылают логин без разделителя: тогда, как и в
+     * прежней версии сервера, логином считаются все принятые байты, как
+     * только сокет вычитан до конца, есть такой клиент в базе или нет.
+     * Пока сокет не вычитан, ждем разделитель или продолжение логина.
+     *
+     * @param login Логин (выходной параметр)
+     * @return true - логин извлечен
+     */
+    bool extractLogin(std::string& login);
+
+    /**
+     * @brief Поставить строку с нуль-терминатором в очередь отправки
+     * @param str Строка
+     */
+    void queueString(const std::string& str);
+
+    /**
+     * @brief Поставить двоичные данные в очередь отправки
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void queueBytes(const void* data, size_t size);
+
+    /**
+     * @brief Разрешить отправку накопленного ответа
+     */
+    void requestFlush() { flushRequested_ = true; }
+
+    /**
+     * @brief Завершить протокол (после отправки ответа сеанс закроется)
+     */
+    void finish();
+};
+
+#endif // SESSION_H
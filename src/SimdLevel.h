@@ -0,0 +1,23 @@
+/**
+ * @file SimdLevel.h
+ * @brief Набор инструкций вычислительных ядер
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef SIMDLEVEL_H
+#define SIMDLEVEL_H
+
+/**
+ * @brief Набор инструкций ядра суммирования векторов
+ */
+enum class SimdLevel {
+    AUTO,       ///< Лучший из поддерживаемых процессором (по умолчанию)
+    SCALAR,     ///< Эталонный поэлементный цикл
+    SSE41,      ///< SSE4.1
+    AVX2,       ///< AVX2
+    AVX512      ///< AVX-512F
+};
+
+#endif // SIMDLEVEL_H
@@ -0,0 +1,341 @@
+#include "StoreFile.h"
+#include "Xxh64.h"
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Сигнатура файла ("VSTORE" и порядок байт процессора)
+static const uint64_t FILE_MAGIC = 0x0000455254535356ULL;
+
+/// Сигнатура заголовка блока
+static const uint32_t BLOCK_MAGIC = 0x4B4C4256;
+
+/// Состояния блока
+static const uint32_t BLOCK_FREE = 0;
+static const uint32_t BLOCK_USED = 1;
+
+const uint32_t StoreFile::FILE_VERSION;
+const size_t StoreFile::BLOCK_BYTES;
+const size_t StoreFile::HEADER_BYTES;
+
+/**
+ * @brief Округлить вверх до размера страницы
+ */
+static uint64_t pageAlign(uint64_t bytes) {
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+}
+
+StoreFile::StoreFile(Logger& logger)
+    : logger_(logger),
+      fd_(-1),
+      base_(nullptr),
+      reserved_(0),
+      mapped_(0),
+      wasClean_(true),
+      version_(FILE_VERSION) {
+}
+
+StoreFile::~StoreFile() {
+    close();
+}
+
+bool StoreFile::open(const std::string& path, size_t growth) {
+    path_ = path;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        logger_.logSystemError("Не удалось открыть файл хранилища " + path);
+        return false;
+    }
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        logger_.logSystemError("Файл хранилища используется другим процессом " + path);
+        unmap();
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+        logger_.logSystemError("Ошибка fstat файла хранилища");
+        unmap();
+        return false;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+
+    // Адреса резервируются сразу: отображение не переезжает при росте файла
+    reserved_ = pageAlign(fileSize + growth + HEADER_BYTES);
+    void* base = mmap(nullptr, reserved_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        logger_.logSystemError("Не удалось зарезервировать адреса для файла хранилища");
+        base_ = nullptr;
+        unmap();
+        return false;
+    }
+    base_ = static_cast<char*>(base);
+
+    if (fileSize == 0) {
+        if (!resize(HEADER_BYTES)) {
+            unmap();
+            return false;
+        }
+        FileHeader* h = header();
+        h->magic = FILE_MAGIC;
+        h->version = FILE_VERSION;
+        h->headerBytes = sizeof(FileHeader);
+        h->blockBytes = BLOCK_BYTES;
+        h->end = HEADER_BYTES;
+        wasClean_ = true;
+        version_ = FILE_VERSION;
+    } else {
+        if (fileSize < HEADER_BYTES || !resize(fileSize) || !checkHeader(fileSize)) {
+            unmap();
+            return false;
+        }
+        scanBlocks();
+        if (fileSize > header()->end && ftruncate(fd_, static_cast<off_t>(header()->end)) != 0) {
+            logger_.logSystemError("Ошибка обрезки файла хранилища");
+        }
+    }
+
+    // До корректного закрытия файл считается незавершенным
+    header()->clean = 0;
+    sealHeader();
+    msync(base_, HEADER_BYTES, MS_SYNC);
+
+    logger_.log(LogLevel::INFO, "Файл хранилища открыт",
+               path + ": версия " + std::to_string(version_) +
+               ", байт: " + std::to_string(header()->end) +
+               ", блоков: " + std::to_string(loaded_.size()) +
+               (wasClean_ ? "" : ", закрыт некорректно"));
+    return true;
+}
+
+bool StoreFile::checkHeader(uint64_t fileSize) {
+    const FileHeader* h = header();
+    std::string problem;
+    if (h->magic != FILE_MAGIC) {
+        problem = "неизвестная сигнатура";
+    } else if (h->version == 0 || h->version > FILE_VERSION) {
+        problem = "версия " + std::to_string(h->version) + " не поддерживается";
+    } else if (h->headerBytes < sizeof(FileHeader) || h->headerBytes > HEADER_BYTES) {
+        problem = "некорректный размер заголовка";
+    } else {
+        uint64_t checksum;
+        memcpy(&checksum, base_ + h->headerBytes - sizeof(checksum), sizeof(checksum));
+        if (checksum != Xxh64::hash(base_, h->headerBytes - sizeof(checksum))) {
+            problem = "неверная контрольная сумма заголовка";
+        } else if (h->blockBytes != BLOCK_BYTES || h->end < HEADER_BYTES || h->end > fileSize ||
+                   (h->end - HEADER_BYTES) % BLOCK_BYTES != 0) {
+            problem = "некорректная разметка блоков";
+        }
+    }
+    if (!problem.empty()) {
+        logger_.log(LogLevel::ERROR, "Файл хранилища не открыт: " + problem, path_);
+        return false;
+    }
+
+    wasClean_ = h->clean == 1;
+    version_ = h->version;
+    return true;
+}
+
+void StoreFile::scanBlocks() {
+    uint64_t offset = HEADER_BYTES;
+    uint64_t end = header()->end;
+    while (offset < end) {
+        const BlockHeader* b = block(offset);
+        if (b->magic != BLOCK_MAGIC || (b->state != BLOCK_FREE && b->state != BLOCK_USED) ||
+            b->blocks == 0 || b->blocks > (end - offset) / BLOCK_BYTES) {
+            logger_.log(LogLevel::WARNING, "Цепочка блоков файла хранилища оборвана",
+                       "смещение " + std::to_string(offset) + ", отброшено байт: " +
+                       std::to_string(end - offset));
+            header()->end = offset;
+            break;
+        }
+
+        uint64_t blocks = b->blocks;
+        if (b->state == BLOCK_USED) {
+            loaded_.push_back(block(offset) + 1);
+        } else {
+            // Соседние свободные блоки объединяются
+            auto last = freeByOffset_.empty() ? freeByOffset_.end() : std::prev(freeByOffset_.end());
+            if (last != freeByOffset_.end() && last->first + last->second * BLOCK_BYTES == offset) {
+                uint64_t start = last->first;
+                uint64_t merged = last->second + blocks;
+                removeFree(start);
+                addFree(start, merged);
+            } else {
+                addFree(offset, blocks);
+            }
+        }
+        offset += blocks * BLOCK_BYTES;
+    }
+    trimTail();
+}
+
+bool StoreFile::resize(uint64_t end) {
+    if (end > reserved_) {
+        logger_.log(LogLevel::WARNING, "Исчерпан резерв адресов файла хранилища",
+                   std::to_string(end) + " байт");
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd_, &info) == 0 && static_cast<uint64_t>(info.st_size) != end &&
+        ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+        logger_.logSystemError("Ошибка изменения размера файла хранилища");
+        return false;
+    }
+
+    uint64_t mapped = pageAlign(end);
+    if (mapped > mapped_) {
+        void* part = mmap(base_ + mapped_, mapped - mapped_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED, fd_, static_cast<off_t>(mapped_));
+        if (part == MAP_FAILED) {
+            logger_.logSystemError("Ошибка отображения файла хранилища");
+            return false;
+        }
+        mapped_ = mapped;
+    }
+    return true;
+}
+
+void* StoreFile::allocate(size_t bytes) {
+    uint64_t blocks = (bytes + sizeof(BlockHeader) + BLOCK_BYTES - 1) / BLOCK_BYTES;
+    uint64_t offset;
+
+    auto fit = freeBySize_.lower_bound(blocks);
+    if (fit != freeBySize_.end()) {
+        uint64_t length = fit->first;
+        offset = fit->second;
+        removeFree(offset);
+        if (length > blocks) {
+            addFree(offset + blocks * BLOCK_BYTES, length - blocks);
+        }
+    } else {
+        offset = header()->end;
+        if (!resize(offset + blocks * BLOCK_BYTES)) {
+            return nullptr;
+        }
+        header()->end = offset + blocks * BLOCK_BYTES;
+        sealHeader();
+    }
+
+    BlockHeader* b = block(offset);
+    b->magic = BLOCK_MAGIC;
+    b->state = BLOCK_USED;
+    b->blocks = blocks;
+    return b + 1;
+}
+
+void StoreFile::release(void* data) {
+    BlockHeader* b = static_cast<BlockHeader*>(data) - 1;
+    uint64_t offset = static_cast<uint64_t>(reinterpret_cast<char*>(b) - base_);
+    uint64_t blocks = b->blocks;
+
+    auto next = freeByOffset_.find(offset + blocks * BLOCK_BYTES);
+    if (next != freeByOffset_.end()) {
+        blocks += next->second;
+        removeFree(next->first);
+    }
+    auto previous = freeByOffset_.lower_bound(offset);
+    if (previous != freeByOffset_.begin()) {
+        --previous;
+        if (previous->first + previous->second * BLOCK_BYTES == offset) {
+            offset = previous->first;
+            blocks += previous->second;
+            removeFree(offset);
+        }
+    }
+    addFree(offset, blocks);
+    trimTail();
+}
+
+void StoreFile::trimTail() {
+    if (freeByOffset_.empty()) {
+        return;
+    }
+    auto last = std::prev(freeByOffset_.end());
+    if (last->first + last->second * BLOCK_BYTES != header()->end) {
+        return;
+    }
+    uint64_t end = last->first;
+    removeFree(end);
+    header()->end = end;
+    sealHeader();
+    if (ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+        logger_.logSystemError("Ошибка обрезки файла хранилища");
+    }
+}
+
+size_t StoreFile::capacity(const void* data) const {
+    const BlockHeader* b = static_cast<const BlockHeader*>(data) - 1;
+    return static_cast<size_t>(b->blocks * BLOCK_BYTES - sizeof(BlockHeader));
+}
+
+uint64_t StoreFile::size() const {
+    return isOpen() ? header()->end : 0;
+}
+
+void StoreFile::addFree(uint64_t offset, uint64_t blocks) {
+    BlockHeader* b = block(offset);
+    b->magic = BLOCK_MAGIC;
+    b->state = BLOCK_FREE;
+    b->blocks = blocks;
+    freeByOffset_[offset] = blocks;
+    freeBySize_.insert(std::make_pair(blocks, offset));
+}
+
+void StoreFile::removeFree(uint64_t offset) {
+    auto found = freeByOffset_.find(offset);
+    auto range = freeBySize_.equal_range(found->second);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == offset) {
+            freeBySize_.erase(it);
+            break;
+        }
+    }
+    freeByOffset_.erase(found);
+}
+
+void StoreFile::sealHeader() {
+    FileHeader* h = header();
+    uint64_t checksum = Xxh64::hash(h, h->headerBytes - sizeof(checksum));
+    memcpy(base_ + h->headerBytes - sizeof(checksum), &checksum, sizeof(checksum));
+}
+
+void StoreFile::close() {
+    if (!isOpen() || base_ == nullptr || mapped_ == 0) {
+        unmap();
+        return;
+    }
+    uint64_t end = header()->end;
+    if (msync(base_, end, MS_SYNC) != 0) {
+        logger_.logSystemError("Ошибка записи файла хранилища");
+    }
+    header()->clean = 1;
+    sealHeader();
+    msync(base_, HEADER_BYTES, MS_SYNC);
+    logger_.log(LogLevel::INFO, "Файл хранилища закрыт",
+               path_ + ": байт: " + std::to_string(end));
+    unmap();
+}
+
+void StoreFile::unmap() {
+    if (base_ != nullptr) {
+        munmap(base_, reserved_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    reserved_ = 0;
+    mapped_ = 0;
+    loaded_.clear();
+    freeByOffset_.clear();
+    freeBySize_.clear();
+}
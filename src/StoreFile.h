@@ -0,0 +1,212 @@
+/**
+ * @file StoreFile.h
+ * @brief Отображаемый в память файл хранилища векторов
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef STOREFILE_H
+#define STOREFILE_H
+
+#include "Logger.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Файл блоков переменной длины, отображенный в память (MAP_SHARED)
+ *
+ * Формат файла:
+ * @code
+ *   FileHeader (HEADER_BYTES байт)
+ *   блок, блок, ... до FileHeader::end
+ *   блок: BlockHeader (16 байт), данные; длина кратна BLOCK_BYTES
+ * @endcode
+ * Все поля в порядке байт процессора; файл с другим порядком байт
+ * не проходит проверку сигнатуры.
+ *
+ * Данные блока изменяются прямо в отображении, без системных вызовов:
+ * в файл их переносит ядро (msync - при закрытии). Освобожденные блоки
+ * объединяются с соседними свободными и переиспользуются (наименьший
+ * подходящий), свободный хвост отрезается от файла; новые блоки
+ * дописываются в конец. Адресное пространство резервируется при
+ * открытии, поэтому рост файла не перемещает отображение и указатели
+ * на данные блоков остаются действительными.
+ *
+ * Заголовок файла защищен XXH64 и содержит версию формата. Программа
+ * читает файлы своей и прежних версий: поля, добавленные в новых
+ * версиях, дописываются в конец заголовка, а headerBytes сообщает,
+ * сколько их записал создатель файла. Файл более новой версии не
+ * открывается, чтобы не повредить его.
+ *
+ * Флаг clean сбрасывается при открытии и устанавливается при закрытии.
+ * Если он сброшен при следующем открытии (процесс завершился аварийно),
+ * владелец данных должен перепроверить их (wasClean).
+ *
+ * Файл блокируется (flock), чтобы два процесса не открыли его сразу.
+ */
+class StoreFile {
+public:
+    /**
+     * @brief Конструктор
+     * @param logger Журнал для ошибок файла
+     */
+    explicit StoreFile(Logger& logger);
+
+    /**
+     * @brief Деструктор (закрывает файл)
+     */
+    ~StoreFile();
+
+    StoreFile(const StoreFile&) = delete;
+    StoreFile& operator=(const StoreFile&) = delete;
+
+    /**
+     * @brief Открыть или создать файл
+     *
+     * Читаются только заголовки блоков; данные не затрагиваются.
+     * Цепочка блоков, оборванная некорректным заголовком, обрезается.
+     *
+     * @param path Путь к файлу
+     * @param growth На сколько байт файл может вырасти за время работы
+     * @return false - файл не открыт (причина записана в журнал)
+     */
+    bool open(const std::string& path, size_t growth);
+
+    /**
+     * @brief Записать изменения на диск, отметить файл закрытым корректно и закрыть
+     */
+    void close();
+
+    /**
+     * @brief Проверить, открыт ли файл
+     * @return true - файл открыт
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Был ли файл закрыт корректно перед открытием
+     * @return false - данные блоков могли остаться недописанными
+     */
+    bool wasClean() const { return wasClean_; }
+
+    /**
+     * @brief Версия формата открытого файла
+     * @return Версия из заголовка (для нового файла - FILE_VERSION)
+     */
+    uint32_t version() const { return version_; }
+
+    /**
+     * @brief Данные занятых блоков, найденных при открытии
+     * @return Указатели на данные в порядке расположения в файле
+     */
+    const std::vector<void*>& loaded() const { return loaded_; }
+
+    /**
+     * @brief Выделить блок
+     * @param bytes Размер данных
+     * @return Данные блока (выравнивание 16) или nullptr - резерв адресов исчерпан
+     *         либо ошибка расширения файла
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Освободить блок
+     * @param data Данные блока, полученные от allocate() или loaded()
+     */
+    void release(void* data);
+
+    /**
+     * @brief Вместимость блока
+     * @param data Данные блока
+     * @return Байт данных, доступных в блоке
+     */
+    size_t capacity(const void* data) const;
+
+    /**
+     * @brief Размер файла
+     * @return Байт до конца последнего блока
+     */
+    uint64_t size() const;
+
+    /// Версия формата, которую пишет программа
+    static const uint32_t FILE_VERSION = 1;
+
+    /// Гранулярность блоков (байт)
+    static const size_t BLOCK_BYTES = 64;
+
+    /// Место под заголовок файла (байт)
+    static const size_t HEADER_BYTES = 64;
+
+private:
+    /**
+     * @brief Заголовок файла (версия 1)
+     */
+    struct FileHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t headerBytes;   ///< Размер заголовка по версии создателя файла
+        uint32_t blockBytes;    ///< BLOCK_BYTES
+        uint32_t clean;         ///< 1 - файл закрыт корректно
+        uint64_t end;           ///< Конец цепочки блоков
+        uint64_t checksum;      ///< XXH64 полей перед ним
+    };
+
+    /**
+     * @brief Заголовок блока
+     */
+    struct BlockHeader {
+        uint32_t magic;
+        uint32_t state;         ///< BLOCK_FREE или BLOCK_USED
+        uint64_t blocks;        ///< Длина в единицах BLOCK_BYTES
+    };
+
+    Logger& logger_;
+    std::string path_;
+    int fd_;
+    char* base_;                ///< Начало зарезервированного адресного пространства
+    size_t reserved_;           ///< Размер резерва
+    size_t mapped_;             ///< Отображенная часть резерва
+    bool wasClean_;
+    uint32_t version_;
+    std::vector<void*> loaded_;
+    std::map<uint64_t, uint64_t> freeByOffset_;         ///< Свободные блоки: смещение -> длина
+    std::multimap<uint64_t, uint64_t> freeBySize_;      ///< Свободные блоки: длина -> смещение
+
+    FileHeader* header() const { return reinterpret_cast<FileHeader*>(base_); }
+    BlockHeader* block(uint64_t offset) const { return reinterpret_cast<BlockHeader*>(base_ + offset); }
+
+    /**
+     * @brief Проверить заголовок существующего файла
+     */
+    bool checkHeader(uint64_t fileSize);
+
+    /**
+     * @brief Пройти цепочку блоков: занятые - в loaded_, свободные - в списки
+     */
+    void scanBlocks();
+
+    /**
+     * @brief Изменить длину файла и отобразить новую часть
+     */
+    bool resize(uint64_t end);
+
+    /**
+     * @brief Пересчитать контрольную сумму заголовка
+     */
+    void sealHeader();
+
+    /**
+     * @brief Отрезать от файла свободный блок в конце цепочки
+     */
+    void trimTail();
+
+    void addFree(uint64_t offset, uint64_t blocks);
+    void removeFree(uint64_t offset);
+    void unmap();
+};
+
+#endif // STOREFILE_H
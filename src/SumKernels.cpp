@@ -0,0 +1,287 @@
+#include "SumKernels.h"
+#include <climits>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SUMKERNELS_X86 1
+#endif
+
+/**
+ * @brief Проверить, что частичные суммы блока не выходят за пределы int32
+ * @param sum Сумма перед блоком
+ * @param positive Сумма положительных элементов блока
+ * @param negative Сумма отрицательных элементов блока
+ */
+static inline bool blockFits(int64_t sum, int64_t positive, int64_t negative) {
+    return sum + positive <= INT_MAX && sum + negative >= INT_MIN;
+}
+
+#ifdef SUMKERNELS_X86
+
+// Ядра - шаблоны по режиму: Checked - с проверкой насыщения по блокам
+// (SATURATE, ERROR), без нее - точная сумма всех полных блоков (WRAP, WIDEN)
+
+// Элементы int8 и int16 расширяются до int32 при загрузке, дальше
+// блок обрабатывается так же, как int32. Перегрузки выбираются по типу
+// второго аргумента
+
+__attribute__((target("sse4.1")))
+static inline __m128i loadLanes128(const char* data, int32_t) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i loadLanes128(const char* data, int16_t) {
+    return _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i loadLanes128(const char* data, int8_t) {
+    int32_t packed;
+    memcpy(&packed, data, sizeof(packed));
+    return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(packed));
+}
+
+__attribute__((target("sse4.1")))
+static inline int64_t horizontalSum(__m128i value) {
+    return _mm_cvtsi128_si64(value) + _mm_extract_epi64(value, 1);
+}
+
+template <typename T, bool Checked>
+__attribute__((target("sse4.1")))
+static size_t sumSse41(const void* values, size_t count, int64_t& sum) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    size_t done = 0;
+
+    while (count - done >= SumKernels::BLOCK_ELEMENTS) {
+        const char* block = static_cast<const char*>(values) + done * sizeof(T);
+        __m128i positive = zero;
+        __m128i negative = zero;
+        for (size_t i = 0; i < SumKernels::BLOCK_ELEMENTS; i += 4) {
+            __m128i v = loadLanes128(block + i * sizeof(T), T());
+            if (Checked) {
+                __m128i up = _mm_max_epi32(v, zero);
+                __m128i down = _mm_min_epi32(v, zero);
+                positive = _mm_add_epi64(positive, _mm_cvtepi32_epi64(up));
+                positive = _mm_add_epi64(positive, _mm_cvtepi32_epi64(_mm_srli_si128(up, 8)));
+                negative = _mm_add_epi64(negative, _mm_cvtepi32_epi64(down));
+                negative = _mm_add_epi64(negative, _mm_cvtepi32_epi64(_mm_srli_si128(down, 8)));
+            } else {
+                total = _mm_add_epi64(total, _mm_cvtepi32_epi64(v));
+                total = _mm_add_epi64(total, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+            }
+        }
+
+        if (Checked) {
+            int64_t up = horizontalSum(positive);
+            int64_t down = horizontalSum(negative);
+            if (!blockFits(sum, up, down)) {
+                break;
+            }
+            sum += up + down;
+        }
+        done += SumKernels::BLOCK_ELEMENTS;
+    }
+
+    if (!Checked) {
+        sum += horizontalSum(total);
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadLanes256(const char* data, int32_t) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadLanes256(const char* data, int16_t) {
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadLanes256(const char* data, int8_t) {
+    return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+}
+
+__attribute__((target("avx2")))
+static inline int64_t horizontalSum(__m256i value) {
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(value),
+                                 _mm256_extracti128_si256(value, 1));
+    return _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+}
+
+template <typename T, bool Checked>
+__attribute__((target("avx2")))
+static size_t sumAvx2(const void* values, size_t count, int64_t& sum) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    size_t done = 0;
+
+    while (count - done >= SumKernels::BLOCK_ELEMENTS) {
+        const char* block = static_cast<const char*>(values) + done * sizeof(T);
+        __m256i positive = zero;
+        __m256i negative = zero;
+        for (size_t i = 0; i < SumKernels::BLOCK_ELEMENTS; i += 8) {
+            __m256i v = loadLanes256(block + i * sizeof(T), T());
+            if (Checked) {
+                __m256i up = _mm256_max_epi32(v, zero);
+                __m256i down = _mm256_min_epi32(v, zero);
+                positive = _mm256_add_epi64(positive, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(up)));
+                positive = _mm256_add_epi64(positive, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(up, 1)));
+                negative = _mm256_add_epi64(negative, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(down)));
+                negative = _mm256_add_epi64(negative, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(down, 1)));
+            } else {
+                total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+                total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+            }
+        }
+
+        if (Checked) {
+            int64_t up = horizontalSum(positive);
+            int64_t down = horizontalSum(negative);
+            if (!blockFits(sum, up, down)) {
+                break;
+            }
+            sum += up + down;
+        }
+        done += SumKernels::BLOCK_ELEMENTS;
+    }
+
+    if (!Checked) {
+        sum += horizontalSum(total);
+    }
+    return done;
+}
+
+// Интринсики AVX-512 в GCC 12 используют заведомо неинициализированные
+// регистры-заглушки (_mm512_undefined_*), на что ложно срабатывает -Wextra
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+__attribute__((target("avx512f")))
+static inline __m512i loadLanes512(const char* data, int32_t) {
+    return _mm512_loadu_si512(data);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i loadLanes512(const char* data, int16_t) {
+    return _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i loadLanes512(const char* data, int8_t) {
+    return _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+}
+
+template <typename T, bool Checked>
+__attribute__((target("avx512f")))
+static size_t sumAvx512(const void* values, size_t count, int64_t& sum) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i total = zero;
+    size_t done = 0;
+
+    while (count - done >= SumKernels::BLOCK_ELEMENTS) {
+        const char* block = static_cast<const char*>(values) + done * sizeof(T);
+        __m512i positive = zero;
+        __m512i negative = zero;
+        for (size_t i = 0; i < SumKernels::BLOCK_ELEMENTS; i += 16) {
+            __m512i v = loadLanes512(block + i * sizeof(T), T());
+            if (Checked) {
+                __m512i up = _mm512_max_epi32(v, zero);
+                __m512i down = _mm512_min_epi32(v, zero);
+                positive = _mm512_add_epi64(positive, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(up)));
+                positive = _mm512_add_epi64(positive, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(up, 1)));
+                negative = _mm512_add_epi64(negative, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(down)));
+                negative = _mm512_add_epi64(negative, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(down, 1)));
+            } else {
+                total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+                total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+            }
+        }
+
+        if (Checked) {
+            int64_t up = _mm512_reduce_add_epi64(positive);
+            int64_t down = _mm512_reduce_add_epi64(negative);
+            if (!blockFits(sum, up, down)) {
+                break;
+            }
+            sum += up + down;
+        }
+        done += SumKernels::BLOCK_ELEMENTS;
+    }
+
+    if (!Checked) {
+        sum += _mm512_reduce_add_epi64(total);
+    }
+    return done;
+}
+
+#pragma GCC diagnostic pop
+
+#endif // SUMKERNELS_X86
+
+bool SumKernels::isSupported(SimdLevel level) {
+#ifdef SUMKERNELS_X86
+    // Выбор ядра возможен из статических конструкторов, до инициализации libgcc
+    __builtin_cpu_init();
+#endif
+    switch (level) {
+        case SimdLevel::AUTO:
+        case SimdLevel::SCALAR:
+            return true;
+#ifdef SUMKERNELS_X86
+        case SimdLevel::SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case SimdLevel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel SumKernels::detect() {
+    const SimdLevel candidates[] = {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE41};
+    for (SimdLevel level : candidates) {
+        if (isSupported(level)) {
+            return level;
+        }
+    }
+    return SimdLevel::SCALAR;
+}
+
+/**
+ * @brief Ядро для типа элемента
+ * @tparam T Тип элемента (int8_t, int16_t, int32_t)
+ */
+template <typename T>
+static SumKernels::BlockKernel kernelFor(SimdLevel level, bool checked) {
+    switch (level) {
+#ifdef SUMKERNELS_X86
+        case SimdLevel::SSE41:
+            return checked ? sumSse41<T, true> : sumSse41<T, false>;
+        case SimdLevel::AVX2:
+            return checked ? sumAvx2<T, true> : sumAvx2<T, false>;
+        case SimdLevel::AVX512:
+            return checked ? sumAvx512<T, true> : sumAvx512<T, false>;
+#endif
+        default:
+            (void)checked;
+            return nullptr;
+    }
+}
+
+SumKernels::BlockKernel SumKernels::get(SimdLevel level, bool checked, size_t elementSize) {
+    switch (elementSize) {
+        case sizeof(int8_t):  return kernelFor<int8_t>(level, checked);
+        case sizeof(int16_t): return kernelFor<int16_t>(level, checked);
+        case sizeof(int32_t): return kernelFor<int32_t>(level, checked);
+        default:              return nullptr;
+    }
+}
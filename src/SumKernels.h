@@ -0,0 +1,80 @@
+/**
+ * @file SumKernels.h
+ * @brief SIMD-ядра суммирования векторов с насыщением
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef SUMKERNELS_H
+#define SUMKERNELS_H
+
+#include "SimdLevel.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Блочные ядра суммирования
+ *
+ * Ядро обрабатывает вектор блоками по BLOCK_ELEMENTS элементов. Для блока
+ * одновременно считаются сумма положительных и сумма отрицательных
+ * элементов: любая частичная сумма внутри блока лежит между
+ * sum + negative и sum + positive. Если обе границы в пределах int32,
+ * насыщения внутри блока гарантированно нет и к сумме прибавляется
+ * positive + negative. Иначе ядро останавливается, и этот блок
+ * проходит эталонный поэлементный цикл, поэтому результат побитово
+ * совпадает с VectorProcessor::calculateSum.
+ *
+ * Для политик без насыщения (WRAP, WIDEN) используется вариант ядра
+ * без проверки: точная сумма в int64 всех полных блоков.
+ *
+ * Ядра есть для элементов int8, int16 и int32: узкие элементы расширяются
+ * до int32 при загрузке, поэтому блок читает из памяти в 4 или 2 раза
+ * меньше байт.
+ *
+ * Ядра собираются с атрибутом target и вызываются только после проверки
+ * поддержки процессором (isSupported).
+ */
+namespace SumKernels {
+
+/// Количество элементов в блоке ядра
+const size_t BLOCK_ELEMENTS = 64;
+
+/**
+ * @brief Блочное ядро
+ * @param values Элементы знакового целого типа в хостовом порядке байт
+ *               (выравнивание не требуется)
+ * @param count Количество элементов
+ * @param sum Частичная сумма (в варианте с проверкой - в пределах int32),
+ *            увеличивается на сумму обработанных блоков
+ * @return Количество обработанных элементов (кратно BLOCK_ELEMENTS):
+ *         обработка останавливается на неполном хвосте, а в варианте
+ *         с проверкой - и на блоке, где возможно насыщение
+ */
+typedef size_t (*BlockKernel)(const void* values, size_t count, int64_t& sum);
+
+/**
+ * @brief Проверить поддержку набора инструкций процессором (cpuid)
+ * @param level Набор инструкций
+ * @return true - ядро можно использовать
+ */
+bool isSupported(SimdLevel level);
+
+/**
+ * @brief Лучший набор инструкций, поддерживаемый процессором
+ * @return Набор инструкций (SCALAR, если SIMD недоступен)
+ */
+SimdLevel detect();
+
+/**
+ * @brief Получить ядро для набора инструкций
+ * @param level Набор инструкций (кроме AUTO)
+ * @param checked Вариант с проверкой насыщения
+ * @param elementSize Размер элемента в байтах: 1 (int8), 2 (int16), 4 (int32)
+ * @return Ядро или nullptr для SCALAR и прочих размеров
+ */
+BlockKernel get(SimdLevel level, bool checked, size_t elementSize = sizeof(int32_t));
+
+} // namespace SumKernels
+
+#endif // SUMKERNELS_H
@@ -0,0 +1,796 @@
+#include "UringLoop.h"
+
+#ifdef VEALC_HAVE_IO_URING
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// ========== СИСТЕМНЫЕ ВЫЗОВЫ IO_URING ==========
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete,
+                                    flags, nullptr, 0));
+}
+
+static int ioUringRegister(int ringFd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+}
+
+// ========== КОДИРОВАНИЕ user_data ==========
+
+/**
+ * @brief Тип заявки (старшие 8 бит user_data, младшие 56 - номер соединения)
+ */
+enum UringOp : uint64_t {
+    OP_ACCEPT = 1,
+    OP_RECV,
+    OP_SEND,
+    OP_SHUTDOWN,
+    OP_WAKE,
+    OP_TICK,
+    OP_FLUSH,
+    OP_CANCEL
+};
+
+static uint64_t makeUserData(UringOp op, uint64_t id) {
+    return (static_cast<uint64_t>(op) << 56) | (id & ((1ULL << 56) - 1));
+}
+
+static UringOp userDataOp(uint64_t userData) {
+    return static_cast<UringOp>(userData >> 56);
+}
+
+static uint64_t userDataId(uint64_t userData) {
+    return userData & ((1ULL << 56) - 1);
+}
+
+bool UringLoop::isSupported() {
+    // Multishot recv с предоставленными буферами появился в Linux 6.0
+    struct utsname name;
+    if (uname(&name) != 0) {
+        return false;
+    }
+    int major = 0, minor = 0;
+    if (sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6) {
+        return false;
+    }
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ringFd = ioUringSetup(8, &params);
+    if (ringFd < 0) {
+        // ENOSYS - нет поддержки, EPERM - io_uring запрещен sysctl
+        return false;
+    }
+
+    const unsigned opCount = 256;
+    std::vector<char> probeMemory(sizeof(struct io_uring_probe) +
+                                  opCount * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(probeMemory.data());
+    bool supported = ioUringRegister(ringFd, IORING_REGISTER_PROBE, probe, opCount) == 0;
+
+    const unsigned required[] = {
+        IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+        IORING_OP_SHUTDOWN, IORING_OP_READ, IORING_OP_TIMEOUT,
+        IORING_OP_ASYNC_CANCEL
+    };
+    for (unsigned op : required) {
+        if (!supported) break;
+        supported = op <= probe->last_op &&
+                    (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    close(ringFd);
+    return supported;
+}
+
+UringLoop::UringLoop(const Database& database, Logger& logger)
+    : database_(database),
+      logger_(logger),
+      ringFd_(-1),
+      sqRing_(MAP_FAILED),
+      sqRingSize_(0),
+      cqRing_(MAP_FAILED),
+      cqRingSize_(0),
+      sqes_(nullptr),
+      sqesSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqArray_(nullptr),
+      sqMask_(0),
+      sqEntries_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqMask_(0),
+      cqes_(nullptr),
+      pending_(0),
+      bufRing_(nullptr),
+      bufRingSize_(0),
+      bufPool_(nullptr),
+      bufTail_(0),
+      listenSocket_(-1),
+      wakeFd_(-1),
+      wakeValue_(0),
+      queue_(nullptr),
+      flushTickArmed_(false),
+      pendingWork_(false),
+      nextId_(1) {
+    tick_.tv_sec = 1;
+    tick_.tv_nsec = 0;
+    flushTick_.tv_sec = 0;
+    flushTick_.tv_nsec = 0;
+
+    if (!setupRing() || !setupBuffers()) {
+        logger_.log(LogLevel::ERROR, "Не удалось инициализировать io_uring");
+    }
+}
+
+UringLoop::~UringLoop() {
+    // Сначала обрываем соединения, чтобы незавершенные send не ждали клиента
+    for (auto& entry : connections_) {
+        shutdown(entry.second.session->getSocket(), SHUT_RDWR);
+    }
+
+    // Закрытие кольца отменяет все заявки ядра
+    if (ringFd_ >= 0) {
+        close(ringFd_);
+    }
+    connections_.clear();
+
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+        munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_ != MAP_FAILED) {
+        munmap(sqRing_, sqRingSize_);
+    }
+    if (bufRing_ != nullptr) {
+        munmap(bufRing_, bufRingSize_);
+    }
+    delete[] bufPool_;
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+    }
+}
+
+bool UringLoop::setupRing() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ringFd_ = ioUringSetup(RING_ENTRIES, &params);
+    if (ringFd_ < 0) {
+        logger_.logSystemError("Ошибка io_uring_setup");
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        logger_.logSystemError("Ошибка отображения очереди заявок io_uring");
+        return false;
+    }
+
+    if (singleMmap) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            logger_.logSystemError("Ошибка отображения очереди завершений io_uring");
+            return false;
+        }
+    }
+
+    sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        logger_.logSystemError("Ошибка отображения массива заявок io_uring");
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqEntries_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+
+    char* cq = static_cast<char*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+bool UringLoop::setupBuffers() {
+    if (ringFd_ < 0) {
+        return false;
+    }
+
+    // Кольцо дескрипторов буферов должно быть выровнено по странице
+    bufRingSize_ = BUFFER_COUNT * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, bufRingSize_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        logger_.logSystemError("Ошибка выделения кольца буферов io_uring");
+        return false;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = BUFFER_COUNT;
+    reg.bgid = BUFFER_GROUP;
+    if (ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        logger_.logSystemError("Ошибка регистрации кольца буферов io_uring");
+        munmap(ring, bufRingSize_);
+        return false;
+    }
+
+    bufRing_ = static_cast<struct io_uring_buf_ring*>(ring);
+    bufPool_ = new char[static_cast<size_t>(BUFFER_COUNT) * BUFFER_SIZE];
+    for (unsigned i = 0; i < BUFFER_COUNT; i++) {
+        recycleBuffer(static_cast<unsigned short>(i));
+    }
+
+    return true;
+}
+
+struct io_uring_sqe* UringLoop::getSqe() {
+    unsigned tail = *sqTail_;
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (tail - head >= sqEntries_) {
+        // Очередь заполнена: отправляем накопленное ядру
+        int submitted = ioUringEnter(ringFd_, pending_, 0, 0);
+        if (submitted > 0) {
+            pending_ -= static_cast<unsigned>(submitted);
+        }
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if (tail - head >= sqEntries_) {
+            return nullptr;
+        }
+    }
+
+    unsigned index = tail & sqMask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    pending_++;
+    return sqe;
+}
+
+void UringLoop::recycleBuffer(unsigned short bufferId) {
+    // Элементы адресуются от начала кольца: в C++ пустая структура внутри
+    // __DECLARE_FLEX_ARRAY занимает байт и сдвигает поле bufs на 8 байт
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(bufRing_) +
+                               (bufTail_ & (BUFFER_COUNT - 1));
+    buf->addr = reinterpret_cast<uint64_t>(bufPool_ + static_cast<size_t>(bufferId) * BUFFER_SIZE);
+    buf->len = BUFFER_SIZE;
+    buf->bid = bufferId;
+    bufTail_++;
+    __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+}
+
+bool UringLoop::addListener(int socket, const SessionOptions& options) {
+    listenSocket_ = socket;
+    listenerOptions_ = options;
+    noteFlushMode(options);
+    return true;
+}
+
+bool UringLoop::attachQueue(ConnectionQueue* queue, const SessionOptions& options) {
+    wakeFd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        logger_.logSystemError("Ошибка создания eventfd");
+        return false;
+    }
+    queue_ = queue;
+    queueOptions_ = options;
+    noteFlushMode(options);
+    return true;
+}
+
+void UringLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void UringLoop::armAccept() {
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenSocket_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = makeUserData(OP_ACCEPT, 0);
+}
+
+void UringLoop::armRecv(uint64_t id, Connection& connection) {
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = connection.session->getSocket();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = makeUserData(OP_RECV, id);
+    connection.recvArmed = true;
+}
+
+void UringLoop::updateRecv(uint64_t id, Connection& connection) {
+    if (connection.session->isOutputBlocked() || connection.session->hasPendingWork()) {
+        if (connection.recvArmed && !connection.recvPaused) {
+            // Завершения, уже поставленные ядром, еще придут; заявка
+            // завершится с ECANCELED
+            struct io_uring_sqe* sqe = getSqe();
+            if (sqe == nullptr) return;
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = makeUserData(OP_RECV, id);
+            sqe->user_data = makeUserData(OP_CANCEL, id);
+        }
+        connection.recvPaused = true;
+        return;
+    }
+
+    connection.recvPaused = false;
+    if (!connection.recvArmed && !connection.closeAfterSend &&
+        !connection.session->isClosing()) {
+        armRecv(id, connection);
+    }
+}
+
+void UringLoop::armWakeRead() {
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeFd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeValue_);
+    sqe->len = sizeof(wakeValue_);
+    sqe->user_data = makeUserData(OP_WAKE, 0);
+}
+
+void UringLoop::armTick() {
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick_);
+    sqe->len = 1;
+    sqe->user_data = makeUserData(OP_TICK, 0);
+}
+
+void UringLoop::noteFlushMode(const SessionOptions& options) {
+    if (options.flushMode != ResponseFlush::BATCH) {
+        return;
+    }
+    long pollNs = std::max(1, options.flushDelayMs) * 1000000L;
+    long currentNs = flushTick_.tv_sec * 1000000000L + flushTick_.tv_nsec;
+    if (currentNs == 0 || pollNs < currentNs) {
+        flushTick_.tv_sec = pollNs / 1000000000L;
+        flushTick_.tv_nsec = pollNs % 1000000000L;
+    }
+}
+
+void UringLoop::armFlushTick() {
+    if (flushTickArmed_) return;
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&flushTick_);
+    sqe->len = 1;
+    sqe->user_data = makeUserData(OP_FLUSH, 0);
+    flushTickArmed_ = true;
+}
+
+void UringLoop::flushDeferredOutput() {
+    auto now = std::chrono::steady_clock::now();
+    bool deferred = false;
+    for (auto& entry : connections_) {
+        Connection& connection = entry.second;
+        if (connection.sendInFlight || connection.aborted) {
+            // Отложенный ответ уйдет после завершения текущей отправки
+            deferred = deferred || connection.session->hasDeferredOutput();
+            continue;
+        }
+        if (connection.session->pollFlushDeadline(now)) {
+            submitSend(entry.first, connection, connection.session->isClosing());
+        } else if (connection.session->hasDeferredOutput()) {
+            deferred = true;
+        }
+    }
+    if (deferred) {
+        armFlushTick();
+    }
+}
+
+void UringLoop::submitSend(uint64_t id, Connection& connection, bool last) {
+    if (connection.sent >= connection.sending.size()) {
+        connection.session->takeOutput(connection.sending);
+        connection.sent = 0;
+    }
+    if (connection.sending.empty()) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = getSqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = connection.session->getSocket();
+    sqe->addr = reinterpret_cast<uint64_t>(connection.sending.data() + connection.sent);
+    sqe->len = static_cast<unsigned>(connection.sending.size() - connection.sent);
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = makeUserData(OP_SEND, id);
+    connection.sendInFlight = true;
+
+    if (last) {
+        // Последний ответ: FIN уходит сразу за данными без возврата в цикл
+        sqe->flags |= IOSQE_IO_LINK;
+        struct io_uring_sqe* shut = getSqe();
+        if (shut == nullptr) {
+            sqe->flags &= ~IOSQE_IO_LINK;
+            return;
+        }
+        shut->opcode = IORING_OP_SHUTDOWN;
+        shut->fd = connection.session->getSocket();
+        shut->len = SHUT_WR;
+        shut->user_data = makeUserData(OP_SHUTDOWN, id);
+        connection.shutdownsPending++;
+    }
+}
+
+void UringLoop::run(const std::atomic<bool>& running) {
+    if (listenSocket_ >= 0) {
+        armAccept();
+    }
+    if (wakeFd_ >= 0) {
+        armWakeRead();
+    }
+    armTick();
+
+    while (running) {
+        // Один системный вызов: отправить все заявки и дождаться завершений;
+        // пока есть незавершенный разбор, только забираем готовые завершения
+        int submitted = ioUringEnter(ringFd_, pending_, pendingWork_ ? 0 : 1,
+                                     IORING_ENTER_GETEVENTS);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                // EBUSY: очередь завершений переполнена - разбираем ее ниже
+            } else {
+                logger_.logSystemError("Ошибка io_uring_enter");
+                break;
+            }
+        } else {
+            pending_ -= static_cast<unsigned>(submitted);
+        }
+
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe cqe = cqes_[head & cqMask_];
+            head++;
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            handleCompletion(cqe);
+            tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        }
+
+        if (pendingWork_) {
+            resumeSessions();
+        }
+    }
+}
+
+void UringLoop::resumeSessions() {
+    // Каждый сеанс с незавершенным разбором делает по одному шагу
+    // между проверками завершений, поэтому остальные сеансы не ждут
+    pendingWork_ = false;
+    std::vector<uint64_t> ids;
+    for (const auto& entry : connections_) {
+        if (!entry.second.aborted && entry.second.session->hasPendingWork()) {
+            ids.push_back(entry.first);
+        }
+    }
+
+    for (uint64_t id : ids) {
+        Connection& connection = connections_[id];
+        connection.session->resume();
+        updateRecv(id, connection);
+        afterInput(id, connection);
+    }
+}
+
+void UringLoop::handleCompletion(const struct io_uring_cqe& cqe) {
+    uint64_t id = userDataId(cqe.user_data);
+
+    switch (userDataOp(cqe.user_data)) {
+        case OP_ACCEPT:
+            onAccept(cqe.res, (cqe.flags & IORING_CQE_F_MORE) != 0);
+            break;
+        case OP_RECV:
+            onRecv(id, cqe.res, cqe.flags);
+            break;
+        case OP_SEND:
+            onSend(id, cqe.res);
+            break;
+        case OP_SHUTDOWN: {
+            auto it = connections_.find(id);
+            if (it != connections_.end()) {
+                it->second.shutdownsPending--;
+                if (it->second.aborted ||
+                    (it->second.closeAfterSend && isDrained(it->second))) {
+                    closeConnection(id);
+                }
+            }
+            break;
+        }
+        case OP_WAKE:
+            onWake(cqe.res);
+            break;
+        case OP_TICK:
+            closeIdleSessions();
+            armTick();
+            break;
+        case OP_FLUSH:
+            flushTickArmed_ = false;
+            flushDeferredOutput();
+            break;
+        case OP_CANCEL:
+            // Результат приходит завершением самой заявки recv
+            break;
+    }
+}
+
+void UringLoop::onAccept(int result, bool more) {
+    if (result >= 0) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        char clientIP[INET_ADDRSTRLEN] = "?";
+        if (getpeername(result, (struct sockaddr*)&clientAddr, &clientLen) == 0) {
+            inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, sizeof(clientIP));
+        }
+
+        logger_.log(LogLevel::INFO, "Новое подключение", clientIP);
+        addSession(result, clientIP, listenerOptions_);
+    } else if (result != -ECANCELED) {
+        errno = -result;
+        logger_.logSystemError("Ошибка принятия соединения");
+    }
+
+    // Multishot accept снимается ядром при ошибке - взводим заново
+    if (!more) {
+        armAccept();
+    }
+}
+
+void UringLoop::onWake(int result) {
+    if (result == sizeof(wakeValue_)) {
+        // Забираем не больше соединений, чем было сигналов для этого цикла
+        uint64_t pending = wakeValue_;
+        AcceptedConnection connection;
+        while (pending > 0 && queue_->pop(connection)) {
+            addSession(connection.socket, connection.peer, queueOptions_);
+            pending--;
+        }
+    }
+    armWakeRead();
+}
+
+void UringLoop::addSession(int socket, const std::string& peer,
+                          const SessionOptions& options) {
+    uint64_t id = nextId_++;
+    Connection& connection = connections_[id];
+    connection.session.reset(new Session(socket, peer, database_, logger_, options));
+    connection.sent = 0;
+    connection.sendInFlight = false;
+    connection.closeAfterSend = false;
+    connection.shutdownsPending = 0;
+    connection.aborted = false;
+    connection.recvArmed = false;
+    connection.recvPaused = false;
+    armRecv(id, connection);
+}
+
+void UringLoop::onRecv(uint64_t id, int result, unsigned flags) {
+    bool hasBuffer = (flags & IORING_CQE_F_BUFFER) != 0;
+    unsigned short bufferId = static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        // Завершение для уже закрытого соединения
+        if (hasBuffer) recycleBuffer(bufferId);
+        return;
+    }
+    Connection& connection = it->second;
+
+    if (result > 0 && hasBuffer) {
+        // Данные копируются в сеанс, буфер сразу возвращается ядру
+        connection.session->deliver(bufPool_ + static_cast<size_t>(bufferId) * BUFFER_SIZE,
+                                    static_cast<size_t>(result));
+        recycleBuffer(bufferId);
+
+        if (!(flags & IORING_CQE_F_MORE)) {
+            connection.recvArmed = false;
+        }
+        updateRecv(id, connection);
+        afterInput(id, connection);
+        return;
+    }
+
+    if (hasBuffer) recycleBuffer(bufferId);
+
+    if (result == -ENOBUFS || (result == -ECANCELED && !connection.aborted)) {
+        // Буферы временно закончились (они уже возвращены) или прием
+        // отменен до отправки ответа: взводим снова, если ответ ушел
+        connection.recvArmed = false;
+        updateRecv(id, connection);
+        return;
+    }
+
+    // Клиент закрыл соединение (0) или ошибка приема
+    if (result < 0 && result != -ECANCELED && result != -ECONNRESET) {
+        errno = -result;
+        logger_.logSystemError("Ошибка чтения из сокета клиента");
+    }
+    connection.closeAfterSend = true;
+    if (connection.sendInFlight) {
+        return;
+    }
+    if (connection.session->hasOutput()) {
+        submitSend(id, connection, false);
+    } else if (isDrained(connection)) {
+        closeConnection(id);
+    }
+    // Иначе соединение закроется после разбора принятого (resumeSessions)
+}
+
+void UringLoop::afterInput(uint64_t id, Connection& connection) {
+    bool last = connection.session->isClosing();
+    if (last) {
+        connection.closeAfterSend = true;
+    }
+    if (connection.session->hasDeferredOutput()) {
+        armFlushTick();
+    }
+    if (connection.session->hasPendingWork()) {
+        pendingWork_ = true;
+    }
+
+    if (connection.sendInFlight) {
+        // Новый ответ уйдет после завершения текущей отправки
+        return;
+    }
+
+    if (connection.session->hasOutput()) {
+        submitSend(id, connection, last);
+    } else if (last || (connection.closeAfterSend && isDrained(connection))) {
+        // Клиент закрыл соединение, а разбор принятого уже завершен
+        closeConnection(id);
+    }
+}
+
+void UringLoop::onSend(uint64_t id, int result) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        return;
+    }
+    Connection& connection = it->second;
+    connection.sendInFlight = false;
+
+    if (connection.aborted) {
+        closeConnection(id);
+        return;
+    }
+
+    if (result < 0) {
+        if (result != -ECONNRESET && result != -EPIPE) {
+            errno = -result;
+            logger_.logSystemError("Ошибка отправки данных клиенту");
+        }
+        closeConnection(id);
+        return;
+    }
+
+    connection.sent += static_cast<size_t>(result);
+    if (connection.sent >= connection.sending.size()) {
+        // Буфер ушел целиком: продолжаем разбор, остановленный до отправки ответа
+        connection.session->resume();
+        if (connection.session->hasPendingWork()) {
+            pendingWork_ = true;
+        }
+    }
+
+    if (connection.sent < connection.sending.size() || connection.session->hasOutput()) {
+        // Остаток текущего буфера или ответ, накопленный за время отправки.
+        // Связанный shutdown (если был) отменен ядром из-за неполной отправки
+        submitSend(id, connection, connection.session->isClosing());
+        updateRecv(id, connection);
+        return;
+    }
+    updateRecv(id, connection);
+
+    if (connection.session->hasDeferredOutput()) {
+        armFlushTick();
+    }
+    if (connection.closeAfterSend && isDrained(connection)) {
+        closeConnection(id);
+    }
+    // Иначе соединение закроет завершение связанного shutdown
+}
+
+bool UringLoop::isDrained(const Connection& connection) const {
+    return !connection.sendInFlight &&
+           connection.shutdownsPending == 0 &&
+           connection.sent >= connection.sending.size() &&
+           !connection.session->hasOutput() &&
+           !connection.session->hasPendingWork();
+}
+
+void UringLoop::closeConnection(uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        return;
+    }
+
+    if (it->second.sendInFlight || it->second.shutdownsPending > 0) {
+        // Ядро еще использует буфер отправки или номер сокета -
+        // закроем после завершения заявок
+        it->second.aborted = true;
+        shutdown(it->second.session->getSocket(), SHUT_RDWR);
+        return;
+    }
+
+    // Деструктор сеанса делает shutdown и close; multishot recv
+    // завершится сам, его буфер будет возвращен в onRecv
+    connections_.erase(it);
+}
+
+void UringLoop::closeIdleSessions() {
+    time_t now = time(nullptr);
+    std::vector<uint64_t> idle;
+    for (const auto& entry : connections_) {
+        if (entry.second.session->isTimedOut(now)) {
+            idle.push_back(entry.first);
+        }
+    }
+
+    for (uint64_t id : idle) {
+        logger_.log(LogLevel::WARNING, "Таймаут клиента",
+                   "socket: " + std::to_string(connections_[id].session->getSocket()));
+        closeConnection(id);
+    }
+}
+
+#endif // VEALC_HAVE_IO_URING
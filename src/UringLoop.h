@@ -0,0 +1,270 @@
+/**
+ * @file UringLoop.h
+ * @brief Цикл ввода-вывода на основе io_uring
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef URINGLOOP_H
+#define URINGLOOP_H
+
+#include "IoLoop.h"
+#include "Session.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT)
+#define VEALC_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#ifdef VEALC_HAVE_IO_URING
+
+/**
+ * @brief Цикл ввода-вывода на io_uring
+ *
+ * Вместо пары epoll_wait + recv/send на каждое событие используются:
+ * - multishot accept: одна заявка принимает все соединения;
+ * - multishot recv с кольцом предоставленных буферов: одна заявка
+ *   на соединение, ядро само выбирает буфер под каждый сегмент;
+ *   пока сеанс ждет отправки ответа (Session::isOutputBlocked), заявка
+ *   отменяется и взводится снова после отправки, поэтому данные
+ *   клиента копятся в буфере сокета, а не в памяти сервера;
+ * - send, связанный (IOSQE_IO_LINK) с shutdown для последнего ответа.
+ *
+ * Все заявки за проход цикла отправляются одним io_uring_enter.
+ * Работает с ядром напрямую через системные вызовы (без liburing).
+ */
+class UringLoop : public IoLoop {
+public:
+    /**
+     * @brief Конструктор
+     * @param database База клиентов
+     * @param logger Журнал
+     */
+    UringLoop(const Database& database, Logger& logger);
+
+    /**
+     * @brief Деструктор (закрывает сеансы и кольцо)
+     */
+    ~UringLoop() override;
+
+    /**
+     * @brief Проверить поддержку нужных возможностей io_uring ядром
+     * @return true - io_uring можно использовать
+     */
+    static bool isSupported();
+
+    bool isValid() const override { return ringFd_ >= 0 && bufRing_ != nullptr; }
+    bool addListener(int socket, const SessionOptions& options) override;
+    bool attachQueue(ConnectionQueue* queue, const SessionOptions& options) override;
+    void wakeup() override;
+    void run(const std::atomic<bool>& running) override;
+    size_t getSessionCount() const override { return connections_.size(); }
+
+private:
+    /**
+     * @brief Состояние соединения
+     */
+    struct Connection {
+        std::unique_ptr<Session> session;
+        std::string sending;        ///< Буфер, который сейчас отправляет ядро
+        size_t sent;                ///< Сколько байт из sending уже отправлено
+        bool sendInFlight;          ///< Заявка send еще не завершена
+        bool closeAfterSend;        ///< Закрыть после завершения отправки
+        unsigned shutdownsPending;  ///< Связанные shutdown, еще не завершенные
+        bool aborted;               ///< Закрыто принудительно, ждем завершения заявок
+        bool recvArmed;             ///< Заявка multishot recv активна
+        bool recvPaused;            ///< Прием остановлен до отправки ответа
+    };
+
+    const Database& database_;
+    Logger& logger_;
+    SessionOptions listenerOptions_;
+    SessionOptions queueOptions_;
+
+    int ringFd_;
+    void* sqRing_;
+    size_t sqRingSize_;
+    void* cqRing_;
+    size_t cqRingSize_;
+    struct io_uring_sqe* sqes_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqArray_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    struct io_uring_cqe* cqes_;
+    unsigned pending_;
+
+    struct io_uring_buf_ring* bufRing_;
+    size_t bufRingSize_;
+    char* bufPool_;
+    unsigned short bufTail_;
+
+    int listenSocket_;
+    int wakeFd_;
+    uint64_t wakeValue_;
+    ConnectionQueue* queue_;
+    struct __kernel_timespec tick_;
+    struct __kernel_timespec flushTick_;    ///< Период проверки отложенных ответов
+    bool flushTickArmed_;
+    bool pendingWork_;          ///< Есть сеансы с разбором, остановленным бюджетом шага
+
+    uint64_t nextId_;
+    std::unordered_map<uint64_t, Connection> connections_;
+
+    /// Количество записей в очереди заявок
+    static const unsigned RING_ENTRIES = 1024;
+    /// Количество предоставленных буферов приема (степень двойки)
+    static const unsigned BUFFER_COUNT = 512;
+    /// Размер одного буфера приема
+    static const unsigned BUFFER_SIZE = 8192;
+    /// Группа предоставленных буферов
+    static const unsigned short BUFFER_GROUP = 0;
+
+    /**
+     * @brief Создать кольцо и отобразить его очереди в память
+     * @return true - успешно
+     */
+    bool setupRing();
+
+    /**
+     * @brief Зарегистрировать кольцо предоставленных буферов приема
+     * @return true - успешно
+     */
+    bool setupBuffers();
+
+    /**
+     * @brief Получить свободную заявку (при переполнении очередь сбрасывается ядру)
+     * @return Заявка или nullptr
+     */
+    struct io_uring_sqe* getSqe();
+
+    /**
+     * @brief Вернуть буфер приема ядру
+     * @param bufferId Номер буфера
+     */
+    void recycleBuffer(unsigned short bufferId);
+
+    /**
+     * @brief Взвести multishot accept на слушающем сокете
+     */
+    void armAccept();
+
+    /**
+     * @brief Взвести multishot recv для соединения
+     * @param id Номер соединения
+     * @param connection Соединение
+     */
+    void armRecv(uint64_t id, Connection& connection);
+
+    /**
+     * @brief Остановить или возобновить прием по состоянию ответа сеанса
+     *
+     * Пока неотправленный ответ выше порога, заявка recv отменяется;
+     * когда ответ уходит, прием взводится снова.
+     *
+     * @param id Номер соединения
+     * @param connection Соединение
+     */
+    void updateRecv(uint64_t id, Connection& connection);
+
+    /**
+     * @brief Взвести чтение eventfd очереди соединений
+     */
+    void armWakeRead();
+
+    /**
+     * @brief Взвести таймер проверки таймаутов
+     */
+    void armTick();
+
+    /**
+     * @brief Учесть режим отправки ответов нового источника сеансов
+     * @param options Параметры сеансов
+     */
+    void noteFlushMode(const SessionOptions& options);
+
+    /**
+     * @brief Взвести таймер отложенных ответов (если еще не взведен)
+     */
+    void armFlushTick();
+
+    /**
+     * @brief Отправить отложенные ответы, срок которых наступил
+     */
+    void flushDeferredOutput();
+
+    /**
+     * @brief Продолжить разбор сеансов, остановленный бюджетом шага
+     */
+    void resumeSessions();
+
+    /**
+     * @brief Отправить накопленный ответ соединения
+     * @param id Номер соединения
+     * @param connection Соединение
+     * @param last Последний ответ: за ним связанно выполняется shutdown
+     */
+    void submitSend(uint64_t id, Connection& connection, bool last);
+
+    /**
+     * @brief Обработать одно завершение
+     * @param cqe Запись очереди завершений
+     */
+    void handleCompletion(const struct io_uring_cqe& cqe);
+
+    void onAccept(int result, bool more);
+    void onRecv(uint64_t id, int result, unsigned flags);
+    void onSend(uint64_t id, int result);
+    void onWake(int result);
+
+    /**
+     * @brief Создать сеанс для нового соединения
+     * @param socket Неблокирующий сокет клиента
+     * @param peer IP адрес клиента
+     * @param options Параметры сеанса
+     */
+    void addSession(int socket, const std::string& peer, const SessionOptions& options);
+
+    /**
+     * @brief Отправить ответ или закрыть соединение после приема данных
+     * @param id Номер соединения
+     * @param connection Соединение
+     */
+    void afterInput(uint64_t id, Connection& connection);
+
+    /**
+     * @brief Проверить, что у соединения нет неотправленных данных и заявок
+     * @param connection Соединение
+     * @return true - соединение можно закрыть
+     */
+    bool isDrained(const Connection& connection) const;
+
+    /**
+     * @brief Закрыть соединение (или отложить до завершения его заявок)
+     * @param id Номер соединения
+     */
+    void closeConnection(uint64_t id);
+
+    /**
+     * @brief Закрыть сеансы, превысившие таймаут бездействия
+     */
+    void closeIdleSessions();
+};
+
+#endif // VEALC_HAVE_IO_URING
+
+#endif // URINGLOOP_H
@@ -0,0 +1,35 @@
+#include "VectorBatch.h"
+#include <algorithm>
+
+void VectorBatch::clear() {
+    offsets_.resize(1);
+}
+
+int32_t* VectorBatch::addVector(size_t size) {
+    size_t begin = totalElements();
+    declareVector(size);
+    return reserve(begin + size, begin) + begin;
+}
+
+int32_t* VectorBatch::reserve(size_t elements, size_t used) {
+    if (elements > capacity_) {
+        size_t capacity = std::max(elements, capacity_ * 2);
+        std::unique_ptr<int32_t[]> values(new int32_t[capacity]);
+        std::copy(values_.get(), values_.get() + used, values.get());
+        values_.swap(values);
+        capacity_ = capacity;
+    }
+    return values_.get();
+}
+
+void VectorBatch::shrink(size_t limit) {
+    if (capacity_ > limit) {
+        values_.reset();
+        capacity_ = 0;
+    }
+}
+
+void VectorBatch::addVector(const std::vector<int32_t>& values) {
+    int32_t* data = addVector(values.size());
+    std::copy(values.begin(), values.end(), data);
+}
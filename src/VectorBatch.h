@@ -0,0 +1,146 @@
+/**
+ * @file VectorBatch.h
+ * @brief Пакет векторов в плоском представлении (CSR)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef VECTORBATCH_H
+#define VECTORBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Пакет векторов int32 в двух непрерывных массивах
+ *
+ * Значения всех векторов лежат подряд в одном буфере, границы векторов
+ * заданы массивом смещений (offsets[i] - начало i-го вектора,
+ * offsets[size()] - общее количество значений). Пакет не выделяет
+ * память на каждый вектор, а clear() сохраняет емкость буферов,
+ * поэтому повторное заполнение обходится без выделений.
+ *
+ * Вектор, значения которого приходят из сети, объявляется без памяти
+ * (declareVector) и получает ее по мере приема (reserve): объявленный
+ * клиентом размер сам по себе памяти не занимает.
+ */
+class VectorBatch {
+public:
+    /**
+     * @brief Конструктор (пустой пакет)
+     */
+    VectorBatch() : capacity_(0), offsets_(1, 0) {}
+
+    /**
+     * @brief Удалить все векторы, сохранив емкость буферов
+     */
+    void clear();
+
+    /**
+     * @brief Добавить вектор
+     *
+     * Значения вектора не инициализируются: их заполняет вызывающий.
+     * При нехватке места буфер увеличивается вдвое.
+     *
+     * @param size Количество элементов
+     * @return Указатель на первый элемент; действителен до следующего расширения буфера
+     */
+    int32_t* addVector(size_t size);
+
+    /**
+     * @brief Объявить вектор, не выделяя памяти под его значения
+     *
+     * Значения записываются только в пределах, обеспеченных reserve().
+     *
+     * @param size Количество элементов
+     */
+    void declareVector(size_t size) { offsets_.push_back(totalElements() + size); }
+
+    /**
+     * @brief Обеспечить место под первые значения пакета
+     *
+     * Буфер растет вдвое, поэтому занимает не больше удвоенного объема
+     * принятых значений; при расширении копируются только заполненные.
+     *
+     * @param elements Нужное количество значений от начала пакета
+     * @param used Заполнено значений от начала пакета
+     * @return Начало буфера; действительно до следующего расширения
+     */
+    int32_t* reserve(size_t elements, size_t used);
+
+    /**
+     * @brief Освободить буфер значений, если он больше порога
+     * @param limit Емкость (элементов), которую можно сохранить
+     */
+    void shrink(size_t limit);
+
+    /**
+     * @brief Добавить вектор с копированием значений
+     * @param values Значения
+     */
+    void addVector(const std::vector<int32_t>& values);
+
+    /**
+     * @brief Количество векторов
+     * @return Количество векторов
+     */
+    size_t size() const { return offsets_.size() - 1; }
+
+    /**
+     * @brief Проверить отсутствие векторов
+     * @return true - пакет пуст
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Количество элементов вектора
+     * @param index Номер вектора
+     * @return Количество элементов
+     */
+    size_t vectorSize(size_t index) const {
+        return static_cast<size_t>(offsets_[index + 1] - offsets_[index]);
+    }
+
+    /**
+     * @brief Смещение вектора от начала пакета
+     * @param index Номер вектора
+     * @return Номер первого элемента вектора среди всех значений пакета
+     */
+    size_t offset(size_t index) const { return static_cast<size_t>(offsets_[index]); }
+
+    /**
+     * @brief Элементы вектора
+     * @param index Номер вектора
+     * @return Указатель на первый элемент
+     */
+    const int32_t* data(size_t index) const { return values_.get() + offsets_[index]; }
+
+    /**
+     * @brief Элементы вектора для заполнения
+     * @param index Номер вектора
+     * @return Указатель на первый элемент
+     */
+    int32_t* data(size_t index) { return values_.get() + offsets_[index]; }
+
+    /**
+     * @brief Общее количество элементов всех векторов
+     * @return Количество элементов
+     */
+    size_t totalElements() const { return static_cast<size_t>(offsets_.back()); }
+
+    /**
+     * @brief Емкость буфера значений
+     * @return Количество элементов, помещающихся без выделения памяти
+     */
+    size_t capacity() const { return capacity_; }
+
+private:
+    std::unique_ptr<int32_t[]> values_;     ///< Без инициализации (в отличие от std::vector)
+    size_t capacity_;
+    std::vector<uint64_t> offsets_;
+};
+
+#endif // VECTORBATCH_H
@@ -1,31 +1,919 @@
 #include "VectorProcessor.h"
+#include "SumKernels.h"
+#include "ReduceKernels.h"
+#include "MatrixKernels.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <type_traits>
 
-int32_t VectorProcessor::calculateSum(const std::vector<int32_t>& vector) {
-    int64_t sum = 0;
-    
-    for (int32_t value : vector) {
-        // Проверка на переполнение при сложении
-        if (willOverflowAdd(static_cast<int32_t>(sum), value)) {
-            if (value > 0) {
-                return MAX_INT32;  // Переполнение вверх
+/// Количество операций свертки
+static const size_t REDUCE_OPS = static_cast<size_t>(ReduceOp::COUNT_NZ) + 1;
+
+/// Количество типов элементов с ядрами суммирования (int8, int16, int32)
+static const size_t SUM_KERNEL_TYPES = 3;
+
+/**
+ * @brief Ядра набора инструкций
+ */
+struct KernelTable {
+    SumKernels::BlockKernel checked[SUM_KERNEL_TYPES];  ///< С проверкой насыщения, по типам
+    SumKernels::BlockKernel exact[SUM_KERNEL_TYPES];    ///< Точная сумма, по типам
+    ReduceKernels::Kernel reduce[REDUCE_OPS];           ///< Свертки int32, по операциям
+    MatrixKernels::DotKernel dot;                       ///< Скалярные произведения
+    MatrixKernels::AddRowKernel addRow;                 ///< Суммы по столбцам
+    ReduceKernels::BitCounter countBits;                ///< Биты маски разреженного вектора
+    PackedKernels::DecodeKernel decode;                 ///< Распаковка сжатого вектора
+
+    explicit KernelTable(SimdLevel level) {
+        for (size_t i = 0; i < SUM_KERNEL_TYPES; i++) {
+            checked[i] = SumKernels::get(level, true, size_t(1) << i);
+            exact[i] = SumKernels::get(level, false, size_t(1) << i);
+        }
+        for (size_t op = 0; op < REDUCE_OPS; op++) {
+            reduce[op] = ReduceKernels::get(static_cast<ReduceOp>(op), level);
+        }
+        dot = MatrixKernels::dot(level);
+        addRow = MatrixKernels::addRow(level);
+        countBits = ReduceKernels::bitCounter(level);
+        decode = PackedKernels::decoder(level);
+    }
+};
+
+// Определения констант: std::min принимает их по ссылке
+const size_t VectorProcessor::PARALLEL_CHUNK_ELEMENTS;
+const size_t VectorProcessor::PARALLEL_GRAIN_ELEMENTS;
+const size_t VectorProcessor::MATRIX_BLOCK_COLUMNS;
+const size_t VectorProcessor::MATRIX_BLOCK_ROWS;
+const size_t PackedDecoder::BLOCK_ELEMENTS;
+
+/// Текущий набор инструкций и его ядра (выбираются при запуске)
+static SimdLevel activeLevel = SumKernels::detect();
+static KernelTable kernels(activeLevel);
+
+/// Сетевой порядок (little-endian) отличается от хостового
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static const bool HOST_BIG_ENDIAN = false;
+#else
+static const bool HOST_BIG_ENDIAN = true;
+#endif
+
+/**
+ * @brief Загрузить элемент по невыровненному адресу
+ * @tparam T Тип элемента
+ * @tparam Swap Переставить байты
+ */
+template <typename T, bool Swap>
+static inline T loadValue(const unsigned char* bytes) {
+    unsigned char raw[sizeof(T)];
+    memcpy(raw, bytes, sizeof(T));
+    if (Swap) {
+        std::reverse(raw, raw + sizeof(T));
+    }
+    T value;
+    memcpy(&value, raw, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Ядро суммирования для типа элемента
+ * @tparam T Тип элемента
+ * @param checked Вариант с проверкой насыщения
+ * @return Ядро или nullptr (SCALAR, int64, вещественные типы)
+ */
+template <typename T>
+static inline SumKernels::BlockKernel sumKernel(bool checked) {
+    if (!std::is_integral<T>::value || sizeof(T) > sizeof(int32_t)) {
+        return nullptr;
+    }
+    size_t slot = (sizeof(T) == 1) ? 0 : (sizeof(T) == 2) ? 1 : 2;
+    return checked ? kernels.checked[slot] : kernels.exact[slot];
+}
+
+/**
+ * @brief Добавить целый элемент в свертку
+ * @tparam Op Операция (ветвление сворачивается при компиляции)
+ * @tparam T Тип элемента
+ */
+template <ReduceOp Op, typename T>
+static inline void reduceStep(ReduceState& state, T element, std::false_type) {
+    int64_t value = element;
+    switch (Op) {
+        case ReduceOp::SUM:
+        case ReduceOp::MEAN:
+            state.total += value;
+            break;
+        case ReduceOp::MIN:
+            state.value = std::min(state.value, value);
+            break;
+        case ReduceOp::MAX:
+            state.value = std::max(state.value, value);
+            break;
+        case ReduceOp::L1:
+            // Модуль INT64_MIN не помещается в int64
+            state.total += (value < 0) ? -static_cast<__int128>(value) : value;
+            break;
+        case ReduceOp::L2:
+            if (sizeof(T) < sizeof(int64_t)) {
+                state.squares += static_cast<uint64_t>(value * value);
             } else {
-                return MIN_INT32;  // Переполнение вниз
+                // Квадраты int64 переполнили бы и 128 бит
+                double real = static_cast<double>(value);
+                state.addReal(real * real);
+            }
+            break;
+        case ReduceOp::COUNT_NZ:
+            state.value += (value != 0);
+            break;
+    }
+}
+
+/**
+ * @brief Добавить вещественный элемент в свертку
+ *
+ * NaN делает минимум и максимум NaN; нулем считаются +0 и -0.
+ *
+ * @tparam Op Операция
+ * @tparam T Тип элемента
+ */
+template <ReduceOp Op, typename T>
+static inline void reduceStep(ReduceState& state, T element, std::true_type) {
+    double value = element;
+    switch (Op) {
+        case ReduceOp::SUM:
+        case ReduceOp::MEAN:
+            state.addReal(value);
+            break;
+        case ReduceOp::MIN:
+            if (value != value || value < state.real) {
+                state.real = value;
             }
+            break;
+        case ReduceOp::MAX:
+            if (value != value || value > state.real) {
+                state.real = value;
+            }
+            break;
+        case ReduceOp::L1:
+            state.addReal(std::fabs(value));
+            break;
+        case ReduceOp::L2:
+            state.addReal(value * value);
+            break;
+        case ReduceOp::COUNT_NZ:
+            state.value += (value != 0.0);
+            break;
+    }
+}
+
+/**
+ * @brief Обработать начало фрагмента SIMD-ядром
+ *
+ * Сумма и среднее элементов int8-int32 используют ядра SumKernels,
+ * прочие операции - ядра ReduceKernels для int32.
+ *
+ * @tparam Op Операция
+ * @tparam T Тип элемента
+ * @return Количество обработанных элементов
+ */
+template <ReduceOp Op, typename T>
+static inline size_t reduceKernel(ReduceState& state, const unsigned char* bytes, size_t count) {
+    if (Op == ReduceOp::SUM || Op == ReduceOp::MEAN) {
+        SumKernels::BlockKernel kernel = sumKernel<T>(false);
+        if (kernel == nullptr) {
+            return 0;
+        }
+        // Сумма int32 по одному фрагменту помещается в int64
+        int64_t partial = 0;
+        size_t done = kernel(bytes, count, partial);
+        state.total += partial;
+        return done;
+    }
+
+    ReduceKernels::Kernel kernel = kernels.reduce[static_cast<size_t>(Op)];
+    if (!std::is_same<T, int32_t>::value || kernel == nullptr) {
+        return 0;
+    }
+    return kernel(bytes, count, state);
+}
+
+/**
+ * @brief Свертка фрагмента
+ *
+ * Элементы в хостовом порядке сначала проходят SIMD-ядро
+ * операции, остаток и прочие случаи - поэлементный цикл.
+ *
+ * @tparam Op Операция
+ * @tparam T Тип элемента
+ * @tparam Swap Переставлять байты каждого элемента
+ */
+template <ReduceOp Op, typename T, bool Swap>
+static void reduceValues(ReduceState& state, const unsigned char* bytes, size_t count) {
+    size_t done = Swap ? 0 : reduceKernel<Op, T>(state, bytes, count);
+    for (size_t i = done; i < count; i++) {
+        reduceStep<Op, T>(state, loadValue<T, Swap>(bytes + i * sizeof(T)),
+                          std::is_floating_point<T>());
+    }
+    state.count += count;
+}
+
+/**
+ * @brief Реестр специализаций свертки для типа элемента
+ * @tparam T Тип элемента
+ * @tparam Swap Переставлять байты каждого элемента
+ */
+template <typename T, bool Swap>
+static VectorReduction::Function lookupReduction(ReduceOp op) {
+    switch (op) {
+        case ReduceOp::SUM:      return reduceValues<ReduceOp::SUM, T, Swap>;
+        case ReduceOp::MIN:      return reduceValues<ReduceOp::MIN, T, Swap>;
+        case ReduceOp::MAX:      return reduceValues<ReduceOp::MAX, T, Swap>;
+        case ReduceOp::MEAN:     return reduceValues<ReduceOp::MEAN, T, Swap>;
+        case ReduceOp::L1:       return reduceValues<ReduceOp::L1, T, Swap>;
+        case ReduceOp::L2:       return reduceValues<ReduceOp::L2, T, Swap>;
+        case ReduceOp::COUNT_NZ: return reduceValues<ReduceOp::COUNT_NZ, T, Swap>;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Реестр специализаций свертки
+ * @tparam Swap Переставлять байты каждого элемента
+ */
+template <bool Swap>
+static VectorReduction::Function lookupReduction(ReduceOp op, ElementType type) {
+    switch (type) {
+        case ElementType::INT8:    return lookupReduction<int8_t, Swap>(op);
+        case ElementType::INT16:   return lookupReduction<int16_t, Swap>(op);
+        case ElementType::INT32:   return lookupReduction<int32_t, Swap>(op);
+        case ElementType::INT64:   return lookupReduction<int64_t, Swap>(op);
+        case ElementType::FLOAT32: return lookupReduction<float, Swap>(op);
+        case ElementType::FLOAT64: return lookupReduction<double, Swap>(op);
+    }
+    return nullptr;
+}
+
+template <OverflowPolicy Policy, typename T, bool Swap>
+void SumAccumulator::accumulate(const unsigned char* bytes, size_t count) {
+    const bool checked = (Policy == OverflowPolicy::SATURATE ||
+                          Policy == OverflowPolicy::ERROR);
+    if (checked && saturated_) {
+        return;
+    }
+
+    // Ядра читают элементы в хостовом порядке байт
+    SumKernels::BlockKernel kernel = Swap ? nullptr : sumKernel<T>(checked);
+
+    int64_t sum = sum_;
+    if (!checked) {
+        // Точная сумма: |sum| < 2^63 для любых 2^32 элементов до int32;
+        // сумма int64 берется по модулю 2^64
+        if (kernel != nullptr) {
+            size_t done = kernel(bytes, count, sum);
+            bytes += done * sizeof(T);
+            count -= done;
         }
-        
-        sum += value;
-        
-        // Дополнительная проверка границ
-        if (sum > MAX_INT32) {
-            return MAX_INT32;
+        uint64_t wrapped = static_cast<uint64_t>(sum);
+        for (size_t i = 0; i < count; i++) {
+            wrapped += static_cast<uint64_t>(static_cast<int64_t>(
+                loadValue<T, Swap>(bytes + i * sizeof(T))));
         }
-        if (sum < MIN_INT32) {
-            return MIN_INT32;
+        sum_ = static_cast<int64_t>(wrapped);
+        return;
+    }
+
+    while (count > 0) {
+        if (kernel != nullptr) {
+            size_t done = kernel(bytes, count, sum);
+            bytes += done * sizeof(T);
+            count -= done;
         }
+
+        // Блок, где возможно насыщение, или неполный хвост - поэлементно
+        size_t n = std::min(count, SumKernels::BLOCK_ELEMENTS);
+        for (size_t i = 0; i < n; i++) {
+            int64_t value = loadValue<T, Swap>(bytes + i * sizeof(T));
+            if (sizeof(T) < sizeof(int64_t)) {
+                sum += value;
+            } else if (__builtin_add_overflow(sum, value, &sum)) {
+                // Сумма с элементом int64 вышла и за пределы int64
+                sum = (value > 0) ? INT64_MAX : INT64_MIN;
+            }
+
+            // Проверка границ: частичная сумма вышла за пределы int32
+            if (sum > INT_MAX) {
+                sum_ = INT_MAX;  // Переполнение вверх
+                saturated_ = true;
+                return;
+            }
+            if (sum < INT_MIN) {
+                sum_ = INT_MIN;  // Переполнение вниз
+                saturated_ = true;
+                return;
+            }
+        }
+        bytes += n * sizeof(T);
+        count -= n;
     }
-    
-    return static_cast<int32_t>(sum);
+    sum_ = sum;
+}
+
+template <typename T, bool Swap>
+void SumAccumulator::dispatch(const unsigned char* bytes, size_t count) {
+    switch (policy_) {
+        case OverflowPolicy::SATURATE:
+            accumulate<OverflowPolicy::SATURATE, T, Swap>(bytes, count);
+            break;
+        case OverflowPolicy::WRAP:
+            accumulate<OverflowPolicy::WRAP, T, Swap>(bytes, count);
+            break;
+        case OverflowPolicy::WIDEN:
+            accumulate<OverflowPolicy::WIDEN, T, Swap>(bytes, count);
+            break;
+        case OverflowPolicy::ERROR:
+            accumulate<OverflowPolicy::ERROR, T, Swap>(bytes, count);
+            break;
+    }
+}
+
+void SumAccumulator::add(const int32_t* values, size_t count) {
+    dispatch<int32_t, false>(reinterpret_cast<const unsigned char*>(values), count);
+}
+
+void SumAccumulator::addLE(const void* bytes, size_t count) {
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    switch (type_) {
+        case ElementType::INT8:
+            dispatch<int8_t, false>(data, count);
+            break;
+        case ElementType::INT16:
+            dispatch<int16_t, HOST_BIG_ENDIAN>(data, count);
+            break;
+        case ElementType::INT32:
+            dispatch<int32_t, HOST_BIG_ENDIAN>(data, count);
+            break;
+        case ElementType::INT64:
+            dispatch<int64_t, HOST_BIG_ENDIAN>(data, count);
+            break;
+        default:
+            // Вещественные суммы считает VectorProcessor::reduction
+            break;
+    }
+}
+
+bool SumAccumulator::addBounded(int64_t total, int64_t positive, int64_t negative) {
+    if (policy_ == OverflowPolicy::WRAP || policy_ == OverflowPolicy::WIDEN) {
+        sum_ = static_cast<int64_t>(static_cast<uint64_t>(sum_) + static_cast<uint64_t>(total));
+        return true;
+    }
+    if (saturated_) {
+        return true;
+    }
+    if (sum_ + positive > INT_MAX || sum_ + negative < INT_MIN) {
+        return false;
+    }
+    sum_ += total;
+    return true;
+}
+
+VectorReduction::VectorReduction()
+    : op_(ReduceOp::SUM),
+      type_(ElementType::INT32),
+      elementSize_(sizeof(int32_t)),
+      function_(nullptr),
+      remaining_(0),
+      carryLength_(0) {
+    state_.reset(op_);
+}
+
+void VectorReduction::begin(uint64_t count, OverflowPolicy policy, ReduceOp op,
+                            ElementType type) {
+    op_ = op;
+    type_ = type;
+    elementSize_ = VectorProcessor::elementSize(type);
+    accumulator_.reset(policy, type);
+    state_.reset(op);
+    bool integerSum = (op == ReduceOp::SUM && VectorProcessor::isInteger(type));
+    function_ = integerSum ? nullptr : VectorProcessor::reduction(op, type, true);
+    remaining_ = count;
+    carryLength_ = 0;
+}
+
+void VectorReduction::add(const unsigned char* bytes, size_t count) {
+    if (function_ != nullptr) {
+        function_(state_, bytes, count);
+    } else {
+        accumulator_.addLE(bytes, count);
+    }
+}
+
+void VectorReduction::addZeros(uint64_t zeros) {
+    if (function_ != nullptr) {
+        state_.addZeros(op_, VectorProcessor::isInteger(type_), zeros);
+    }
+}
+
+/**
+ * @brief Сумма отрезка арифметической прогрессии start + k * step, k из [from, to)
+ */
+static __int128 seriesSum(__int128 start, __int128 step, uint64_t from, uint64_t to) {
+    __int128 count = static_cast<__int128>(to) - from;
+    // (from + to - 1) и (to - from) разной четности: произведение делится на 2
+    __int128 indices = (static_cast<__int128>(from) + to - 1) * count / 2;
+    return start * count + step * indices;
+}
+
+bool VectorReduction::reduceClosedForm(const VectorGenerator& generator) {
+    uint64_t n = remaining_;
+    if (generator.kind == GeneratorKind::RANDOM || type_ != ElementType::INT32 || n == 0) {
+        return false;
+    }
+    __int128 a = generator.first;
+    __int128 d = (generator.kind == GeneratorKind::ARANGE) ? generator.second : 0;
+    __int128 last = a + d * static_cast<__int128>(n - 1);
+    if (last > INT_MAX || last < INT_MIN) {
+        return false;   // Элементы переполняются по модулю 2^32
+    }
+
+    // Отрицательные элементы - отрезок [negativeBegin, negativeEnd)
+    uint64_t negativeBegin = 0;
+    uint64_t negativeEnd = 0;
+    if (d > 0 && a < 0) {
+        negativeEnd = static_cast<uint64_t>(std::min<__int128>((-a + d - 1) / d, n));
+    } else if (d < 0) {
+        negativeBegin = (a < 0) ? 0 : static_cast<uint64_t>(std::min<__int128>(a / -d + 1, n));
+        negativeEnd = n;
+    } else if (d == 0 && a < 0) {
+        negativeEnd = n;
+    }
+    __int128 total = seriesSum(a, d, 0, n);
+    __int128 negative = seriesSum(a, d, negativeBegin, negativeEnd);
+
+    if (function_ == nullptr) {
+        // Границы частичных сумм: за пределами int64 насыщение заведомо возможно
+        const __int128 limit = INT64_MAX / 2;
+        int64_t positiveBound = static_cast<int64_t>(std::min(total - negative, limit));
+        int64_t negativeBound = static_cast<int64_t>(std::max(negative, -limit));
+        if (!accumulator_.addBounded(static_cast<int64_t>(static_cast<uint64_t>(total)),
+                                     positiveBound, negativeBound)) {
+            return false;
+        }
+    } else {
+        switch (op_) {
+            case ReduceOp::SUM:
+            case ReduceOp::MEAN:
+                state_.total += total;
+                break;
+            case ReduceOp::MIN:
+                state_.value = static_cast<int64_t>(std::min(a, last));
+                break;
+            case ReduceOp::MAX:
+                state_.value = static_cast<int64_t>(std::max(a, last));
+                break;
+            case ReduceOp::L1:
+                state_.total += total - 2 * negative;
+                break;
+            case ReduceOp::L2: {
+                // n*a^2 + 2ad*Σk + d^2*Σk^2; все слагаемые меньше 2^100
+                __int128 count = n;
+                __int128 indices = count * (count - 1) / 2;
+                __int128 squares = (count - 1) * count * (2 * count - 1) / 6;
+                state_.squares += static_cast<unsigned __int128>(
+                    count * a * a + 2 * a * d * indices + d * d * squares);
+                break;
+            }
+            case ReduceOp::COUNT_NZ: {
+                uint64_t zeros = 0;
+                if (d == 0) {
+                    zeros = (a == 0) ? n : 0;
+                } else if ((-a) % d == 0 && (-a) / d >= 0 && (-a) / d < static_cast<__int128>(n)) {
+                    zeros = 1;
+                }
+                state_.value += static_cast<int64_t>(n - zeros);
+                break;
+            }
+        }
+        state_.count += n;
+    }
+    remaining_ = 0;
+    return true;
+}
+
+void VectorReduction::generate(const VectorGenerator& generator, uint64_t offset, uint64_t count) {
+    const size_t blockElements = 256;
+    int32_t block[blockElements];
+    Function hostOrder = (function_ != nullptr) ? VectorProcessor::reduction(op_, type_, false)
+                                                : nullptr;
+
+    for (uint64_t end = offset + std::min(count, remaining_); offset < end; ) {
+        size_t size = static_cast<size_t>(std::min<uint64_t>(end - offset, blockElements));
+        VectorProcessor::generate(generator, offset, size, block);
+        if (hostOrder != nullptr) {
+            hostOrder(state_, reinterpret_cast<const unsigned char*>(block), size);
+        } else {
+            accumulator_.add(block, size);
+        }
+        offset += size;
+        remaining_ -= size;
+    }
+}
+
+size_t VectorReduction::feed(const void* bytes, size_t size) {
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    size_t consumed = 0;
+
+    if (carryLength_ > 0 && remaining_ > 0) {
+        // Дополняем элемент, начатый в прошлой порции
+        size_t take = std::min(size, elementSize_ - carryLength_);
+        memcpy(carry_ + carryLength_, data, take);
+        carryLength_ += take;
+        consumed += take;
+        if (carryLength_ < elementSize_) {
+            return consumed;
+        }
+        add(carry_, 1);
+        carryLength_ = 0;
+        remaining_--;
+    }
+
+    size_t whole = static_cast<size_t>(
+        std::min<uint64_t>((size - consumed) / elementSize_, remaining_));
+    add(data + consumed, whole);
+    consumed += whole * elementSize_;
+    remaining_ -= whole;
+
+    if (remaining_ > 0 && consumed < size) {
+        // Хвост порции - начало следующего элемента
+        carryLength_ = size - consumed;
+        memcpy(carry_, data + consumed, carryLength_);
+        consumed = size;
+    }
+    return consumed;
+}
+
+PackedDecoder::PackedDecoder()
+    : remaining_(0),
+      previous_(0),
+      valid_(true),
+      carryLength_(0),
+      blockLength_(0) {
+}
+
+void PackedDecoder::begin(uint64_t count) {
+    remaining_ = count;
+    previous_ = 0;
+    valid_ = true;
+    carryLength_ = 0;
+    blockLength_ = 0;
+}
+
+void PackedDecoder::decodeGroup(const unsigned char* group, size_t elements) {
+    unsigned char key = group[0];
+    // Длины несуществующих элементов последней группы должны быть нулевыми
+    if (elements < PackedKernels::GROUP_ELEMENTS && (key >> (2 * elements)) != 0) {
+        valid_ = false;
+        return;
+    }
+
+    const unsigned char* data = group + 1;
+    for (size_t k = 0; k < elements; k++) {
+        size_t length = ((key >> (2 * k)) & 3u) + 1;
+        uint32_t zigzag = 0;
+        for (size_t b = 0; b < length; b++) {
+            zigzag |= static_cast<uint32_t>(data[b]) << (8 * b);
+        }
+        data += length;
+        previous_ += (zigzag >> 1) ^ (0u - (zigzag & 1u));
+        block_[blockLength_++] = static_cast<int32_t>(previous_);
+    }
+    remaining_ -= elements;
+}
+
+void PackedDecoder::flush(VectorReduction& reduction) {
+    if (HOST_BIG_ENDIAN) {
+        for (size_t i = 0; i < blockLength_; i++) {
+            block_[i] = static_cast<int32_t>(__builtin_bswap32(static_cast<uint32_t>(block_[i])));
+        }
+    }
+    reduction.feed(block_, blockLength_ * sizeof(int32_t));
+    blockLength_ = 0;
+}
+
+size_t PackedDecoder::feed(const void* bytes, size_t size, VectorReduction& reduction) {
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    const size_t group = PackedKernels::GROUP_ELEMENTS;
+    size_t consumed = 0;
+
+    while (remaining_ > 0 && valid_) {
+        if (blockLength_ + group > BLOCK_ELEMENTS) {
+            flush(reduction);
+        }
+        size_t elements = static_cast<size_t>(std::min<uint64_t>(remaining_, group));
+
+        // Дополнение группы, начатой в предыдущей порции
+        if (carryLength_ > 0) {
+            size_t length = PackedKernels::groupBytes(carry_[0], elements);
+            size_t take = std::min(length - carryLength_, size - consumed);
+            memcpy(carry_ + carryLength_, data + consumed, take);
+            carryLength_ += take;
+            consumed += take;
+            if (carryLength_ < length) {
+                break;
+            }
+            decodeGroup(carry_, elements);
+            carryLength_ = 0;
+            continue;
+        }
+        if (consumed == size) {
+            break;
+        }
+
+        // Полные группы - ядром прямо в буфере приема
+        if (kernels.decode != nullptr && remaining_ >= group) {
+            size_t groups = static_cast<size_t>(std::min<uint64_t>(
+                remaining_ / group, (BLOCK_ELEMENTS - blockLength_) / group));
+            size_t used = 0;
+            size_t done = kernels.decode(data + consumed, size - consumed, groups,
+                                         previous_, block_ + blockLength_, used);
+            if (done > 0) {
+                blockLength_ += done * group;
+                remaining_ -= done * group;
+                consumed += used;
+                continue;
+            }
+        }
+
+        size_t length = PackedKernels::groupBytes(data[consumed], elements);
+        if (size - consumed < length) {
+            carryLength_ = size - consumed;
+            memcpy(carry_, data + consumed, carryLength_);
+            consumed = size;
+            break;
+        }
+        decodeGroup(data + consumed, elements);
+        consumed += length;
+    }
+
+    if (valid_) {
+        flush(reduction);
+    }
+    return consumed;
+}
+
+VectorTransform::VectorTransform()
+    : op_(TransformOp::PREFIX_SUM),
+      policy_(OverflowPolicy::SATURATE),
+      operand_(nullptr),
+      position_(0),
+      prefix_(0),
+      saturated_(false) {
+}
+
+void VectorTransform::begin(TransformOp op, OverflowPolicy policy, const int32_t* operand) {
+    op_ = op;
+    policy_ = policy;
+    operand_ = operand;
+    position_ = 0;
+    prefix_ = 0;
+    saturated_ = false;
+}
+
+void VectorTransform::store(int64_t value, unsigned char* output) const {
+    if (policy_ == OverflowPolicy::WIDEN) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (size_t b = 0; b < sizeof(bits); b++) {
+            output[b] = static_cast<unsigned char>(bits >> (8 * b));
+        }
+        return;
+    }
+    if (policy_ != OverflowPolicy::WRAP) {
+        value = std::min<int64_t>(std::max<int64_t>(value, INT_MIN), INT_MAX);
+    }
+    uint32_t bits = static_cast<uint32_t>(value);
+    for (size_t b = 0; b < sizeof(bits); b++) {
+        output[b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+}
+
+void VectorTransform::apply(const int32_t* values, size_t count, unsigned char* output) {
+    const size_t width = outputSize();
+    switch (op_) {
+        case TransformOp::PREFIX_SUM:
+            for (size_t i = 0; i < count; i++, output += width) {
+                if (policy_ == OverflowPolicy::SATURATE) {
+                    // Как SumAccumulator: первая частичная сумма за пределами
+                    // int32 фиксирует насыщение до конца вектора
+                    if (!saturated_) {
+                        prefix_ += values[i];
+                        if (prefix_ > INT_MAX || prefix_ < INT_MIN) {
+                            prefix_ = (prefix_ > INT_MAX) ? INT_MAX : INT_MIN;
+                            saturated_ = true;
+                        }
+                    }
+                } else {
+                    prefix_ += values[i];
+                }
+                store(prefix_, output);
+            }
+            break;
+        case TransformOp::ADD:
+            for (size_t i = 0; i < count; i++, output += width) {
+                store(static_cast<int64_t>(operand_[position_ + i]) + values[i], output);
+            }
+            break;
+        case TransformOp::SCALE:
+            for (size_t i = 0; i < count; i++, output += width) {
+                store(static_cast<int64_t>(operand_[0]) * values[i], output);
+            }
+            break;
+        case TransformOp::CLAMP:
+            for (size_t i = 0; i < count; i++, output += width) {
+                store(std::min(std::max(values[i], operand_[0]), operand_[1]), output);
+            }
+            break;
+    }
+    position_ += count;
+}
+
+int32_t VectorProcessor::calculateSum(const std::vector<int32_t>& vector) {
+    return calculateSum(vector.data(), vector.size());
+}
+
+int32_t VectorProcessor::calculateSum(const int32_t* values, size_t count) {
+    SumAccumulator accumulator;
+    accumulator.add(values, count);
+    return accumulator.result();
+}
+
+int32_t VectorProcessor::sumLE(const void* bytes, size_t count) {
+    SumAccumulator accumulator;
+    accumulator.addLE(bytes, count);
+    return accumulator.result();
+}
+
+ReduceState VectorProcessor::reduce(ReduceOp op, ElementType type,
+                                    const void* values, size_t count) {
+    ReduceState state;
+    state.reset(op);
+    reduction(op, type, false)(state, static_cast<const unsigned char*>(values), count);
+    return state;
+}
+
+VectorReduction::Function VectorProcessor::reduction(ReduceOp op, ElementType type,
+                                                     bool littleEndian) {
+    return littleEndian ? lookupReduction<HOST_BIG_ENDIAN>(op, type)
+                        : lookupReduction<false>(op, type);
+}
+
+size_t VectorProcessor::elementSize(ElementType type) {
+    switch (type) {
+        case ElementType::INT8:    return sizeof(int8_t);
+        case ElementType::INT16:   return sizeof(int16_t);
+        case ElementType::INT32:   return sizeof(int32_t);
+        case ElementType::INT64:   return sizeof(int64_t);
+        case ElementType::FLOAT32: return sizeof(float);
+        case ElementType::FLOAT64: return sizeof(double);
+    }
+    return sizeof(int32_t);
+}
+
+bool VectorProcessor::isInteger(ElementType type) {
+    return type != ElementType::FLOAT32 && type != ElementType::FLOAT64;
+}
+
+const char* VectorProcessor::typeName(ElementType type) {
+    switch (type) {
+        case ElementType::INT8:    return "int8";
+        case ElementType::INT16:   return "int16";
+        case ElementType::INT32:   return "int32";
+        case ElementType::INT64:   return "int64";
+        case ElementType::FLOAT32: return "float32";
+        case ElementType::FLOAT64: return "float64";
+    }
+    return "unknown";
+}
+
+ReduceState VectorProcessor::reduceSparse(ReduceOp op, ElementType type, uint64_t size,
+                                          const void* values, size_t count) {
+    ReduceState state = reduce(op, type, values, count);
+    state.addZeros(op, isInteger(type), size - count);
+    return state;
+}
+
+void VectorProcessor::generate(const VectorGenerator& generator, uint64_t offset, size_t count,
+                               int32_t* values) {
+    switch (generator.kind) {
+        case GeneratorKind::CONSTANT:
+            std::fill(values, values + count, generator.first);
+            break;
+        case GeneratorKind::ARANGE: {
+            uint32_t step = static_cast<uint32_t>(generator.second);
+            uint32_t value = static_cast<uint32_t>(generator.first) +
+                             static_cast<uint32_t>(offset) * step;
+            for (size_t i = 0; i < count; i++, value += step) {
+                values[i] = static_cast<int32_t>(value);
+            }
+            break;
+        }
+        case GeneratorKind::RANDOM: {
+            uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(generator.second) -
+                                                   generator.first) + 1;
+            for (size_t i = 0; i < count; i++) {
+                // splitmix64 от номера элемента
+                uint64_t z = generator.seed + (offset + i + 1) * 0x9E3779B97F4A7C15ull;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                z ^= z >> 31;
+                values[i] = static_cast<int32_t>(static_cast<int64_t>(generator.first) +
+                                                 static_cast<int64_t>(((z >> 32) * range) >> 32));
+            }
+            break;
+        }
+    }
+}
+
+void VectorProcessor::encodePacked(const int32_t* values, size_t count,
+                                   std::vector<unsigned char>& output) {
+    const size_t group = PackedKernels::GROUP_ELEMENTS;
+    uint32_t previous = 0;
+    for (size_t start = 0; start < count; start += group) {
+        size_t elements = std::min(group, count - start);
+        size_t keyPosition = output.size();
+        unsigned char key = 0;
+        output.push_back(0);
+
+        for (size_t k = 0; k < elements; k++) {
+            uint32_t value = static_cast<uint32_t>(values[start + k]);
+            uint32_t delta = value - previous;
+            uint32_t zigzag = (delta << 1) ^ (0u - (delta >> 31));
+            previous = value;
+
+            size_t length = 1;
+            while (length < sizeof(uint32_t) && (zigzag >> (8 * length)) != 0) {
+                length++;
+            }
+            key = static_cast<unsigned char>(key | ((length - 1) << (2 * k)));
+            for (size_t b = 0; b < length; b++) {
+                output.push_back(static_cast<unsigned char>(zigzag >> (8 * b)));
+            }
+        }
+        output[keyPosition] = key;
+    }
+}
+
+bool VectorProcessor::checkIndices(const void* bytes, size_t count, uint64_t& next, uint64_t size) {
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t index = loadValue<uint32_t, HOST_BIG_ENDIAN>(data + i * sizeof(uint32_t));
+        if (index < next || index >= size) {
+            return false;
+        }
+        next = index + 1;
+    }
+    return true;
+}
+
+uint64_t VectorProcessor::countBits(const void* bytes, size_t size) {
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    uint64_t bits = 0;
+    size_t done = kernels.countBits ? kernels.countBits(data, size, bits) : 0;
+    for (size_t i = done; i < size; i++) {
+        bits += static_cast<uint64_t>(__builtin_popcount(data[i]));
+    }
+    return bits;
+}
+
+const char* VectorProcessor::matrixOpName(MatrixOp op) {
+    switch (op) {
+        case MatrixOp::COLUMN_SUM: return "column_sum";
+        case MatrixOp::GRAM:       return "dot";
+        case MatrixOp::MATVEC:     return "matvec";
+    }
+    return "unknown";
+}
+
+const char* VectorProcessor::transformOpName(TransformOp op) {
+    switch (op) {
+        case TransformOp::PREFIX_SUM: return "prefix_sum";
+        case TransformOp::ADD:        return "add";
+        case TransformOp::SCALE:      return "scale";
+        case TransformOp::CLAMP:      return "clamp";
+    }
+    return "unknown";
+}
+
+const char* VectorProcessor::opName(ReduceOp op) {
+    switch (op) {
+        case ReduceOp::SUM:      return "sum";
+        case ReduceOp::MIN:      return "min";
+        case ReduceOp::MAX:      return "max";
+        case ReduceOp::MEAN:     return "mean";
+        case ReduceOp::L1:       return "l1";
+        case ReduceOp::L2:       return "l2";
+        case ReduceOp::COUNT_NZ: return "count_nz";
+    }
+    return "unknown";
 }
 
 std::vector<int32_t> VectorProcessor::processVectors(
@@ -41,10 +929,203 @@ std::vector<int32_t> VectorProcessor::processVectors(
     return results;
 }
 
-bool VectorProcessor::willOverflowAdd(int32_t a, int32_t b) {
-    if (b > 0) {
-        return a > MAX_INT32 - b;  // a + b > MAX_INT32
-    } else {
-        return a < MIN_INT32 - b;  // a + b < MIN_INT32
+void VectorProcessor::processVectors(const VectorBatch& batch, OverflowPolicy policy,
+                                     std::vector<SumAccumulator>& results,
+                                     WorkStealingPool* pool) {
+    results.assign(batch.size(), SumAccumulator(policy));
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i] = sumParallel(batch.data(i), batch.vectorSize(i), policy, pool);
+        }
+    };
+
+    if (pool == nullptr || batch.size() < 2) {
+        body(0, batch.size());
+        return;
+    }
+    // Векторов в задаче - столько, чтобы вышло около PARALLEL_GRAIN_ELEMENTS элементов
+    size_t grain = std::max<size_t>(1, PARALLEL_GRAIN_ELEMENTS * batch.size() /
+                                       std::max<size_t>(1, batch.totalElements()));
+    pool->parallelFor(0, batch.size(), grain, body);
+}
+
+SumAccumulator VectorProcessor::sumParallel(const int32_t* values, size_t count,
+                                            OverflowPolicy policy, WorkStealingPool* pool) {
+    SumAccumulator accumulator(policy);
+    if (pool == nullptr || count < 2 * PARALLEL_CHUNK_ELEMENTS) {
+        accumulator.add(values, count);
+        return accumulator;
+    }
+
+    struct ChunkSum {
+        int64_t total;
+        int64_t positive;
+        int64_t negative;
+    };
+    bool checked = (policy == OverflowPolicy::SATURATE || policy == OverflowPolicy::ERROR);
+    size_t chunks = (count + PARALLEL_CHUNK_ELEMENTS - 1) / PARALLEL_CHUNK_ELEMENTS;
+    std::vector<ChunkSum> sums(chunks);
+
+    pool->parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            const int32_t* chunk = values + c * PARALLEL_CHUNK_ELEMENTS;
+            size_t size = std::min(PARALLEL_CHUNK_ELEMENTS, count - c * PARALLEL_CHUNK_ELEMENTS);
+            int64_t total = static_cast<int64_t>(reduce(ReduceOp::SUM, chunk, size).total);
+            // positive = (total + L1) / 2, negative = (total - L1) / 2
+            int64_t l1 = checked ? static_cast<int64_t>(reduce(ReduceOp::L1, chunk, size).total) : 0;
+            sums[c] = ChunkSum{total, (total + l1) / 2, (total - l1) / 2};
+        }
+    });
+
+    for (size_t c = 0; c < chunks; c++) {
+        if (!accumulator.addBounded(sums[c].total, sums[c].positive, sums[c].negative)) {
+            size_t size = std::min(PARALLEL_CHUNK_ELEMENTS, count - c * PARALLEL_CHUNK_ELEMENTS);
+            accumulator.add(values + c * PARALLEL_CHUNK_ELEMENTS, size);
+        }
+    }
+    return accumulator;
+}
+
+/**
+ * @brief Скалярные произведения x с DOT_ROWS строками (по модулю 2^64)
+ * @param dots Накопители, увеличиваются на произведения
+ */
+static void dotRows(const int32_t* x, const int32_t* const* rows, size_t count, int64_t* dots) {
+    size_t done = kernels.dot ? kernels.dot(x, rows, count, dots) : 0;
+    for (size_t r = 0; r < MatrixKernels::DOT_ROWS; r++) {
+        uint64_t dot = static_cast<uint64_t>(dots[r]);
+        for (size_t k = done; k < count; k++) {
+            dot += static_cast<uint64_t>(static_cast<int64_t>(x[k]) * rows[r][k]);
+        }
+        dots[r] = static_cast<int64_t>(dot);
+    }
+}
+
+/**
+ * @brief Выполнить тело по диапазону: в пуле, если он есть и работы достаточно
+ * @param work Примерное количество операций над элементами
+ */
+static void runRange(WorkStealingPool* pool, size_t work, size_t count,
+                     const WorkStealingPool::Body& body) {
+    if (pool == nullptr || count < 2 || work < 2 * VectorProcessor::PARALLEL_GRAIN_ELEMENTS) {
+        body(0, count);
+        return;
+    }
+    pool->parallelFor(0, count, 1, body);
+}
+
+void VectorProcessor::columnSums(const int32_t* matrix, size_t rows, size_t cols,
+                                 std::vector<int64_t>& sums, WorkStealingPool* pool) {
+    sums.assign(cols, 0);
+    size_t blocks = (cols + MATRIX_BLOCK_COLUMNS - 1) / MATRIX_BLOCK_COLUMNS;
+
+    runRange(pool, rows * cols, blocks, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            size_t first = b * MATRIX_BLOCK_COLUMNS;
+            size_t width = std::min(MATRIX_BLOCK_COLUMNS, cols - first);
+            int64_t* block = sums.data() + first;
+            for (size_t r = 0; r < rows; r++) {
+                const int32_t* row = matrix + r * cols + first;
+                size_t done = kernels.addRow ? kernels.addRow(row, width, block) : 0;
+                for (size_t k = done; k < width; k++) {
+                    block[k] += row[k];
+                }
+            }
+        }
+    });
+}
+
+void VectorProcessor::gram(const int32_t* matrix, size_t rows, size_t cols,
+                           std::vector<int64_t>& dots, WorkStealingPool* pool) {
+    const size_t group = MatrixKernels::DOT_ROWS;
+    dots.assign(rows * (rows + 1) / 2, 0);
+    size_t tiles = (rows + MATRIX_BLOCK_ROWS - 1) / MATRIX_BLOCK_ROWS;
+    // Позиция элемента (i, j) верхнего треугольника в dots
+    auto index = [rows](size_t i, size_t j) { return i * rows - i * (i - 1) / 2 + (j - i); };
+
+    runRange(pool, rows * rows / 2 * cols, tiles, [&](size_t begin, size_t end) {
+        for (size_t ti = begin; ti < end; ti++) {
+            size_t iFirst = ti * MATRIX_BLOCK_ROWS;
+            size_t iLast = std::min(rows, iFirst + MATRIX_BLOCK_ROWS);
+            for (size_t tj = ti; tj < tiles; tj++) {
+                size_t jFirst = tj * MATRIX_BLOCK_ROWS;
+                size_t jLast = std::min(rows, jFirst + MATRIX_BLOCK_ROWS);
+                for (size_t first = 0; first < cols; first += MATRIX_BLOCK_COLUMNS) {
+                    size_t width = std::min(MATRIX_BLOCK_COLUMNS, cols - first);
+                    for (size_t i = iFirst; i < iLast; i++) {
+                        const int32_t* x = matrix + i * cols + first;
+                        for (size_t j = std::max(i, jFirst); j < jLast; j += group) {
+                            // Недостающие строки группы повторяют первую, их результат не нужен
+                            const int32_t* groupRows[group];
+                            int64_t partial[group] = {0};
+                            for (size_t r = 0; r < group; r++) {
+                                size_t row = (j + r < jLast) ? j + r : j;
+                                groupRows[r] = matrix + row * cols + first;
+                            }
+                            dotRows(x, groupRows, width, partial);
+                            for (size_t r = 0; r < group && j + r < jLast; r++) {
+                                int64_t& dot = dots[index(i, j + r)];
+                                dot = static_cast<int64_t>(static_cast<uint64_t>(dot) +
+                                                           static_cast<uint64_t>(partial[r]));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+void VectorProcessor::matVec(const int32_t* matrix, size_t rows, size_t cols, const int32_t* x,
+                             std::vector<int64_t>& result, WorkStealingPool* pool) {
+    const size_t group = MatrixKernels::DOT_ROWS;
+    result.assign(rows, 0);
+    size_t tiles = (rows + MATRIX_BLOCK_ROWS - 1) / MATRIX_BLOCK_ROWS;
+
+    runRange(pool, rows * cols, tiles, [&](size_t begin, size_t end) {
+        size_t rowFirst = begin * MATRIX_BLOCK_ROWS;
+        size_t rowLast = std::min(rows, end * MATRIX_BLOCK_ROWS);
+        for (size_t first = 0; first < cols; first += MATRIX_BLOCK_COLUMNS) {
+            size_t width = std::min(MATRIX_BLOCK_COLUMNS, cols - first);
+            for (size_t i = rowFirst; i < rowLast; i += group) {
+                const int32_t* groupRows[group];
+                for (size_t r = 0; r < group; r++) {
+                    size_t row = (i + r < rowLast) ? i + r : i;
+                    groupRows[r] = matrix + row * cols + first;
+                }
+                int64_t partial[group] = {0};
+                dotRows(x + first, groupRows, width, partial);
+                for (size_t r = 0; r < group && i + r < rowLast; r++) {
+                    result[i + r] = static_cast<int64_t>(static_cast<uint64_t>(result[i + r]) +
+                                                         static_cast<uint64_t>(partial[r]));
+                }
+            }
+        }
+    });
+}
+
+SimdLevel VectorProcessor::selectKernel(SimdLevel requested) {
+    SimdLevel level = requested;
+    if (level == SimdLevel::AUTO || !SumKernels::isSupported(level)) {
+        level = SumKernels::detect();
+    }
+
+    activeLevel = level;
+    kernels = KernelTable(level);
+    return level;
+}
+
+SimdLevel VectorProcessor::getKernel() {
+    return activeLevel;
+}
+
+const char* VectorProcessor::kernelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AUTO:   return "auto";
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE41:  return "sse4.1";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
     }
+    return "unknown";
 }
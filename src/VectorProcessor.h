@@ -9,22 +9,718 @@
 #ifndef VECTORPROCESSOR_H
 #define VECTORPROCESSOR_H
 
+#include "SimdLevel.h"
+#include "PackedKernels.h"
+#include "VectorBatch.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <climits>
+#include <cmath>
+
+/**
+ * @brief Поведение суммы при выходе за пределы int32
+ */
+enum class OverflowPolicy {
+    SATURATE,   ///< Насыщение до INT_MAX/INT_MIN на первой такой частичной сумме
+    WRAP,       ///< Дополнительный код: сумма по модулю 2^32
+    WIDEN,      ///< Точная сумма в int64
+    ERROR       ///< Как SATURATE, но с признаком переполнения для клиента
+};
+
+/**
+ * @brief Операция свертки вектора
+ */
+enum class ReduceOp {
+    SUM,        ///< Сумма (с политикой переполнения, см. SumAccumulator)
+    MIN,        ///< Минимум
+    MAX,        ///< Максимум
+    MEAN,       ///< Среднее арифметическое
+    L1,         ///< Сумма модулей
+    L2,         ///< Евклидова норма
+    COUNT_NZ    ///< Количество ненулевых элементов
+};
+
+/**
+ * @brief Тип элементов вектора
+ */
+enum class ElementType {
+    INT8,
+    INT16,
+    INT32,
+    INT64,
+    FLOAT32,
+    FLOAT64
+};
+
+/**
+ * @brief Операция над пакетом векторов одинаковой длины как над матрицей
+ */
+enum class MatrixOp {
+    COLUMN_SUM, ///< Суммы по столбцам
+    GRAM,       ///< Попарные скалярные произведения строк
+    MATVEC      ///< Произведение матрицы на вектор
+};
+
+/**
+ * @brief Поэлементное преобразование вектора (результат - вектор)
+ */
+enum class TransformOp {
+    PREFIX_SUM, ///< Префиксные суммы
+    ADD,        ///< Поэлементная сумма с вектором-операндом
+    SCALE,      ///< Умножение на число
+    CLAMP       ///< Ограничение диапазоном [low, high]
+};
+
+/**
+ * @brief Вид генератора вектора
+ */
+enum class GeneratorKind {
+    CONSTANT,   ///< Все элементы равны first
+    ARANGE,     ///< Элемент k равен first + k * second (по модулю 2^32)
+    RANDOM      ///< Псевдослучайные элементы из [first, second], зерно seed
+};
+
+/**
+ * @brief Описание вектора, который сервер строит сам
+ *
+ * Элемент k случайного ряда: z = splitmix64(seed + (k + 1) * 0x9E3779B97F4A7C15),
+ * значение first + ((z >> 32) * (second - first + 1) >> 32). Элемент
+ * вычисляется по номеру независимо от остальных, поэтому любой фрагмент
+ * вектора можно построить отдельно.
+ */
+struct VectorGenerator {
+    GeneratorKind kind;
+    int32_t first;      ///< CONSTANT - значение, ARANGE - начало, RANDOM - нижняя граница
+    int32_t second;     ///< ARANGE - шаг, RANDOM - верхняя граница
+    uint64_t seed;      ///< RANDOM - зерно
+};
+
+/**
+ * @brief Промежуточное состояние свертки
+ *
+ * Целые накопители точные: сумма и сумма модулей 2^32 элементов int64
+ * помещаются в 128 бит, как и сумма квадратов элементов до int32.
+ * Вещественные элементы (и квадраты int64) суммируются в double
+ * с компенсацией ошибки округления (алгоритм Кэхэна-Ноймайера).
+ * Округление целых накопителей происходит только при получении
+ * среднего и нормы.
+ */
+struct ReduceState {
+    int64_t value;              ///< MIN/MAX целых - экстремум; COUNT_NZ - количество ненулевых
+    __int128 total;             ///< SUM/MEAN целых - сумма; L1 целых - сумма модулей
+    unsigned __int128 squares;  ///< L2 целых до int32 - сумма квадратов
+    double real;                ///< Вещественная сумма (SUM, MEAN, L1, L2) или экстремум
+    double compensation;        ///< Накопленная ошибка округления real
+    uint64_t count;             ///< Количество свернутых элементов
+
+    /**
+     * @brief Начать новую свертку
+     * @param op Операция
+     */
+    void reset(ReduceOp op) {
+        value = (op == ReduceOp::MIN) ? INT64_MAX :
+                (op == ReduceOp::MAX) ? INT64_MIN : 0;
+        total = 0;
+        squares = 0;
+        real = (op == ReduceOp::MIN) ? HUGE_VAL :
+               (op == ReduceOp::MAX) ? -HUGE_VAL : 0.0;
+        compensation = 0.0;
+        count = 0;
+    }
+
+    /**
+     * @brief Добавить слагаемое к вещественной сумме с компенсацией
+     * @param term Слагаемое
+     */
+    void addReal(double term) {
+        double next = real + term;
+        if (std::fabs(real) >= std::fabs(term)) {
+            compensation += (real - next) + term;
+        } else {
+            compensation += (term - next) + real;
+        }
+        real = next;
+    }
+
+    /**
+     * @brief Вещественная сумма с учетом компенсации
+     * @return Сумма (SUM, L1 вещественных элементов)
+     */
+    double sum() const { return real + compensation; }
+
+    /**
+     * @brief Среднее арифметическое (MEAN)
+     * @return Сумма, деленная на количество элементов (0 для пустой свертки)
+     */
+    double mean() const {
+        if (count == 0) {
+            return 0.0;
+        }
+        long double exact = static_cast<long double>(total) + real + compensation;
+        return static_cast<double>(exact / count);
+    }
+
+    /**
+     * @brief Евклидова норма (L2)
+     * @return Квадратный корень суммы квадратов
+     */
+    double norm() const {
+        long double exact = static_cast<long double>(squares) + real + compensation;
+        return static_cast<double>(std::sqrt(exact));
+    }
+
+    /**
+     * @brief Учесть нулевые элементы, не переданные явно (разреженный вектор)
+     *
+     * Нули не меняют сумм, поэтому учитываются только в количестве
+     * элементов (среднее) и в экстремуме.
+     *
+     * @param op Операция
+     * @param integer Элементы целого типа (экстремум в value, иначе в real)
+     * @param zeros Количество нулей
+     */
+    void addZeros(ReduceOp op, bool integer, uint64_t zeros) {
+        if (zeros == 0) {
+            return;
+        }
+        count += zeros;
+        if (op == ReduceOp::MIN && integer) {
+            value = std::min<int64_t>(value, 0);
+        } else if (op == ReduceOp::MIN) {
+            real = std::min(real, 0.0);
+        } else if (op == ReduceOp::MAX && integer) {
+            value = std::max<int64_t>(value, 0);
+        } else if (op == ReduceOp::MAX) {
+            real = std::max(real, 0.0);
+        }
+    }
+
+    /**
+     * @brief Сумма модулей целых элементов (L1)
+     * @return Сумма, при выходе за пределы uint64 - UINT64_MAX
+     */
+    uint64_t magnitude() const {
+        return total > static_cast<__int128>(UINT64_MAX) ? UINT64_MAX
+                                                         : static_cast<uint64_t>(total);
+    }
+};
+
+/**
+ * @brief Накопитель суммы вектора, поступающего фрагментами
+ *
+ * Результат совпадает с calculateSum для вектора целиком при любом
+ * разбиении на фрагменты: как только частичная сумма выходит за пределы
+ * int32, она насыщается до INT_MAX/INT_MIN, и дальнейшие элементы
+ * на результат не влияют.
+ *
+ * Фрагменты суммируются SIMD-ядром, выбранным VectorProcessor::selectKernel;
+ * блок, внутри которого возможно насыщение, проходит поэлементный цикл.
+ * Для каждой политики переполнения и типа элемента собирается своя
+ * специализация прохода: WRAP и WIDEN считают сумму в int64 без проверок
+ * (точную для элементов до int32, по модулю 2^64 для int64).
+ *
+ * Элементы - знаковые целые (ElementType от INT8 до INT64): вещественные
+ * суммы считаются свертками VectorProcessor.
+ */
+class SumAccumulator {
+public:
+    /**
+     * @brief Конструктор (пустая сумма)
+     * @param policy Политика переполнения
+     */
+    explicit SumAccumulator(OverflowPolicy policy = OverflowPolicy::SATURATE)
+        : policy_(policy), type_(ElementType::INT32), sum_(0), saturated_(false) {}
+
+    /**
+     * @brief Добавить фрагмент вектора
+     * @param values Указатель на первый элемент фрагмента
+     * @param count Количество элементов
+     */
+    void add(const int32_t* values, size_t count);
+
+    /**
+     * @brief Добавить фрагмент в сетевом представлении (little-endian)
+     *
+     * Преобразование порядка байт совмещено с суммированием в одном проходе;
+     * на little-endian платформе байты суммируются SIMD-ядром как есть.
+     *
+     * @param bytes Байты фрагмента (выравнивание не требуется)
+     * @param count Количество элементов типа getType()
+     */
+    void addLE(const void* bytes, size_t count);
+
+    /**
+     * @brief Добавить сумму фрагмента, посчитанную отдельно
+     *
+     * Для политик с насыщением сумма принимается, только если ни одна
+     * частичная сумма фрагмента не может выйти за пределы int32: все они
+     * лежат между sum + negative и sum + positive. Иначе фрагмент нужно
+     * добавить поэлементно (add), чтобы насыщение случилось на том же
+     * элементе, что и при последовательном проходе.
+     *
+     * @param total Точная сумма фрагмента
+     * @param positive Сумма положительных элементов фрагмента
+     * @param negative Сумма отрицательных элементов фрагмента
+     * @return false - фрагмент не добавлен
+     */
+    bool addBounded(int64_t total, int64_t positive, int64_t negative);
+
+    /**
+     * @brief Получить сумму добавленных элементов в int32
+     * @return SATURATE, ERROR - сумма с насыщением;
+     *         WRAP, WIDEN - младшие 32 бита точной суммы
+     */
+    int32_t result() const {
+        return static_cast<int32_t>(static_cast<uint32_t>(sum_));
+    }
+
+    /**
+     * @brief Получить сумму добавленных элементов в int64
+     * @return WRAP, WIDEN - точная сумма; SATURATE, ERROR - сумма с насыщением
+     */
+    int64_t result64() const { return sum_; }
+
+    /**
+     * @brief Проверить насыщение суммы (SATURATE, ERROR)
+     * @return true - частичная сумма вышла за пределы int32
+     */
+    bool isSaturated() const { return saturated_; }
+
+    /**
+     * @brief Получить политику переполнения
+     * @return Политика
+     */
+    OverflowPolicy getPolicy() const { return policy_; }
+
+    /**
+     * @brief Начать новую сумму
+     */
+    void reset() {
+        sum_ = 0;
+        saturated_ = false;
+    }
+
+    /**
+     * @brief Получить тип элементов addLE
+     * @return Тип элемента
+     */
+    ElementType getType() const { return type_; }
+
+    /**
+     * @brief Начать новую сумму с другой политикой и типом элементов
+     * @param policy Политика переполнения
+     * @param type Тип элементов addLE (целый)
+     */
+    void reset(OverflowPolicy policy, ElementType type = ElementType::INT32) {
+        policy_ = policy;
+        type_ = type;
+        reset();
+    }
+
+private:
+    OverflowPolicy policy_;
+    ElementType type_;
+    int64_t sum_;       ///< Частичная сумма (для SATURATE и ERROR - в пределах int32)
+    bool saturated_;
+
+    /**
+     * @brief Выбрать специализацию прохода по политике
+     * @tparam T Тип элемента
+     * @tparam Swap Переставлять байты каждого элемента
+     */
+    template <typename T, bool Swap>
+    void dispatch(const unsigned char* bytes, size_t count);
+
+    /**
+     * @brief Проход суммирования
+     * @tparam Policy Политика переполнения
+     * @tparam T Тип элемента
+     * @tparam Swap Переставлять байты каждого элемента
+     * @param bytes Байты элементов
+     * @param count Количество элементов
+     */
+    template <OverflowPolicy Policy, typename T, bool Swap>
+    void accumulate(const unsigned char* bytes, size_t count);
+};
+
+/**
+ * @brief Состояние свертки вектора по мере приема байт
+ *
+ * Принимает байты вектора порциями произвольного размера, в том числе
+ * с элементом, разрезанным между порциями: недостающие байты элемента
+ * запоминаются до следующей порции. Результат готов сразу после
+ * последнего байта вектора.
+ *
+ * Сумма считается SumAccumulator с политикой переполнения, остальные
+ * операции - специализацией из реестра VectorProcessor.
+ */
+class VectorReduction {
+public:
+    /**
+     * @brief Конструктор (пустой вектор)
+     */
+    VectorReduction();
+
+    /**
+     * @brief Начать новый вектор
+     * @param count Количество элементов
+     * @param policy Политика переполнения (только для суммы целых элементов)
+     * @param op Операция свертки
+     * @param type Тип элементов
+     */
+    void begin(uint64_t count, OverflowPolicy policy = OverflowPolicy::SATURATE,
+               ReduceOp op = ReduceOp::SUM, ElementType type = ElementType::INT32);
+
+    /**
+     * @brief Передать очередную порцию принятых байт (little-endian)
+     * @param bytes Байты
+     * @param size Размер порции
+     * @return Количество использованных байт: меньше size, если порция
+     *         содержит байты после конца вектора
+     */
+    size_t feed(const void* bytes, size_t size);
+
+    /**
+     * @brief Учесть нули разреженного вектора, не переданные явно
+     *
+     * Сумма целых от нулей не меняется (в том числе насыщение: частичные
+     * суммы те же), поэтому порядок вызова относительно feed() не важен.
+     *
+     * @param zeros Количество нулей
+     */
+    void addZeros(uint64_t zeros);
+
+    /**
+     * @brief Свернуть сгенерированный вектор int32 в замкнутой форме
+     *
+     * Постоянный вектор и арифметическая прогрессия, элементы которой
+     * не выходят за пределы int32, сворачиваются формулами над __int128
+     * за O(1). Сумма с насыщением принимается, только если частичные
+     * суммы заведомо не выходят за пределы int32 (SumAccumulator::addBounded).
+     * Вызывается сразу после begin().
+     *
+     * @param generator Генератор вектора из remaining() элементов
+     * @return false - замкнутой формы нет, вектор нужно построить generate()
+     */
+    bool reduceClosedForm(const VectorGenerator& generator);
+
+    /**
+     * @brief Построить фрагмент сгенерированного вектора int32 блоками и свернуть
+     *
+     * Блоки остаются в кэше L1; весь вектор в памяти не хранится.
+     * Фрагменты строятся по порядку, начиная сразу после begin(), пока
+     * isComplete() не вернет true.
+     *
+     * @param generator Генератор вектора
+     * @param offset Номер первого элемента фрагмента
+     * @param count Количество элементов (не больше remaining())
+     */
+    void generate(const VectorGenerator& generator, uint64_t offset, uint64_t count);
+
+    /**
+     * @brief Проверить, что приняты все байты вектора
+     * @return true - сумма готова
+     */
+    bool isComplete() const { return remaining_ == 0; }
+
+    /**
+     * @brief Получить накопитель с результатом вектора
+     * @return Накопитель (сумма, признак насыщения)
+     */
+    const SumAccumulator& sum() const { return accumulator_; }
+
+    /**
+     * @brief Получить сумму вектора в int32 (см. SumAccumulator::result)
+     * @return Сумма
+     */
+    int32_t result() const { return accumulator_.result(); }
+
+    /**
+     * @brief Получить операцию текущего вектора
+     * @return Операция
+     */
+    ReduceOp op() const { return op_; }
+
+    /**
+     * @brief Получить тип элементов текущего вектора
+     * @return Тип элемента
+     */
+    ElementType type() const { return type_; }
+
+    /**
+     * @brief Проверить, что результат считает SumAccumulator (сумма целых)
+     * @return true - результат в sum(), иначе в state()
+     */
+    bool usesAccumulator() const { return function_ == nullptr; }
+
+    /**
+     * @brief Получить состояние свертки (кроме суммы целых)
+     * @return Состояние
+     */
+    const ReduceState& state() const { return state_; }
+
+    /**
+     * @brief Количество еще не принятых элементов
+     * @return Количество элементов (с учетом принятого частично)
+     */
+    uint64_t remaining() const { return remaining_; }
+
+    /**
+     * @brief Свертка фрагмента: элементы в порядке байт
+     *        (хостовом или little-endian - по выбору специализации)
+     */
+    typedef void (*Function)(ReduceState& state, const unsigned char* bytes, size_t count);
+
+private:
+    ReduceOp op_;
+    ElementType type_;
+    size_t elementSize_;
+    SumAccumulator accumulator_;
+    ReduceState state_;
+    Function function_;             ///< Специализация операции (кроме суммы целых)
+    uint64_t remaining_;            ///< Элементов, еще не добавленных в сумму
+    unsigned char carry_[8];        ///< Начало элемента, разрезанного порциями
+    size_t carryLength_;
+
+    /**
+     * @brief Добавить элементы в little-endian
+     * @param bytes Байты элементов
+     * @param count Количество элементов
+     */
+    void add(const unsigned char* bytes, size_t count);
+};
+
+/**
+ * @brief Распаковка сжатого вектора по мере приема (см. PackedKernels)
+ *
+ * Сжатые байты подаются порциями произвольного размера; группа,
+ * разрезанная порциями, запоминается до следующей порции. Распакованные
+ * элементы собираются в небольшой блок (остается в кэше L1) и сразу
+ * передаются свертке, поэтому отдельного прохода распаковки по всему
+ * вектору нет.
+ */
+class PackedDecoder {
+public:
+    /// Размер блока распакованных элементов
+    static const size_t BLOCK_ELEMENTS = 256;
+
+    /**
+     * @brief Конструктор (пустой вектор)
+     */
+    PackedDecoder();
+
+    /**
+     * @brief Начать новый вектор
+     * @param count Количество элементов
+     */
+    void begin(uint64_t count);
+
+    /**
+     * @brief Распаковать очередную порцию сжатых байт
+     * @param bytes Байты
+     * @param size Размер порции
+     * @param reduction Свертка, получающая распакованные элементы
+     * @return Количество использованных байт: меньше size, если порция
+     *         содержит байты после конца вектора или вектор некорректен
+     */
+    size_t feed(const void* bytes, size_t size, VectorReduction& reduction);
+
+    /**
+     * @brief Проверить, что распакованы все элементы
+     * @return true - вектор принят
+     */
+    bool isComplete() const { return remaining_ == 0; }
+
+    /**
+     * @brief Проверить корректность принятых байт
+     * @return false - в ключе последней группы заданы длины несуществующих элементов
+     */
+    bool isValid() const { return valid_; }
+
+private:
+    uint64_t remaining_;            ///< Элементов, еще не распакованных
+    uint32_t previous_;             ///< Последний распакованный элемент
+    bool valid_;
+    unsigned char carry_[PackedKernels::MAX_GROUP_BYTES];  ///< Группа, разрезанная порциями
+    size_t carryLength_;
+    int32_t block_[BLOCK_ELEMENTS];
+    size_t blockLength_;
+
+    /**
+     * @brief Распаковать одну группу поэлементно
+     * @param group Байты группы, начиная с ключа
+     * @param elements Количество элементов группы
+     */
+    void decodeGroup(const unsigned char* group, size_t elements);
+
+    /**
+     * @brief Передать блок распакованных элементов свертке
+     * @param reduction Свертка
+     */
+    void flush(VectorReduction& reduction);
+};
+
+/**
+ * @brief Поэлементное преобразование вектора по мере приема
+ *
+ * Элементы подаются порциями произвольной длины, результат каждой порции
+ * сразу записывается в little-endian и может уходить клиенту, пока
+ * остаток вектора еще не принят. Результат вычисляется в int64 и
+ * приводится по политике переполнения: SATURATE - насыщение каждого
+ * элемента (префиксная сумма, как и SumAccumulator, после насыщения
+ * остается на пределе), WRAP - по модулю 2^32, WIDEN - int64 без потерь.
+ * Политика ERROR не поддерживается.
+ */
+class VectorTransform {
+public:
+    /**
+     * @brief Конструктор
+     */
+    VectorTransform();
+
+    /**
+     * @brief Начать преобразование очередного вектора
+     * @param op Операция
+     * @param policy Политика переполнения (кроме ERROR)
+     * @param operand ADD - вектор-слагаемое не короче преобразуемого,
+     *                SCALE - {множитель}, CLAMP - {low, high}, PREFIX_SUM - не используется
+     */
+    void begin(TransformOp op, OverflowPolicy policy, const int32_t* operand);
+
+    /**
+     * @brief Размер элемента результата
+     * @return 8 для WIDEN, иначе 4 байта
+     */
+    size_t outputSize() const { return (policy_ == OverflowPolicy::WIDEN) ? sizeof(int64_t)
+                                                                          : sizeof(int32_t); }
+
+    /**
+     * @brief Преобразовать очередную порцию элементов
+     * @param values Элементы в хостовом порядке байт
+     * @param count Количество элементов
+     * @param output Результат в little-endian, count * outputSize() байт
+     */
+    void apply(const int32_t* values, size_t count, unsigned char* output);
+
+private:
+    TransformOp op_;
+    OverflowPolicy policy_;
+    const int32_t* operand_;
+    size_t position_;       ///< Количество уже преобразованных элементов
+    int64_t prefix_;        ///< Текущая префиксная сумма
+    bool saturated_;        ///< Префиксная сумма насыщена (SATURATE)
+
+    /**
+     * @brief Записать результат элемента по политике переполнения
+     * @param value Точный результат
+     * @param output Место элемента результата
+     */
+    void store(int64_t value, unsigned char* output) const;
+};
+
+class WorkStealingPool;
 
 /**
  * @brief Класс обработки векторов
  */
 class VectorProcessor {
 public:
+    /// Размер фрагмента, на которые делится большой вектор при параллельной сумме
+    static const size_t PARALLEL_CHUNK_ELEMENTS = 1 << 16;
+
+    /// Примерное количество элементов на одну задачу пула при обработке пакета
+    static const size_t PARALLEL_GRAIN_ELEMENTS = 1 << 15;
+
+    /// Ширина блока столбцов матричных операций (отрезок строки - 2 КБ)
+    static const size_t MATRIX_BLOCK_COLUMNS = 512;
+
+    /// Высота блока строк матричных операций
+    static const size_t MATRIX_BLOCK_ROWS = 32;
+
     /**
      * @brief Вычислить сумму вектора
      * @param vector Вектор для обработки
      * @return Сумма элементов
      */
     static int32_t calculateSum(const std::vector<int32_t>& vector);
-    
+
+    /**
+     * @brief Вычислить сумму элементов непрерывного участка памяти
+     * @param values Указатель на первый элемент
+     * @param count Количество элементов
+     * @return Сумма элементов
+     */
+    static int32_t calculateSum(const int32_t* values, size_t count);
+
+    /**
+     * @brief Вычислить сумму вектора прямо из принятых байт
+     * @param bytes Значения в little-endian (выравнивание не требуется)
+     * @param count Количество элементов
+     * @return Сумма элементов
+     */
+    static int32_t sumLE(const void* bytes, size_t count);
+
+    /**
+     * @brief Свернуть элементы непрерывного участка памяти
+     * @param op Операция (SUM - точная сумма без политики переполнения)
+     * @param type Тип элементов
+     * @param values Указатель на первый элемент (хостовый порядок байт)
+     * @param count Количество элементов
+     * @return Состояние свертки
+     */
+    static ReduceState reduce(ReduceOp op, ElementType type, const void* values, size_t count);
+
+    /**
+     * @brief Свернуть элементы int32 непрерывного участка памяти
+     * @param op Операция
+     * @param values Указатель на первый элемент
+     * @param count Количество элементов
+     * @return Состояние свертки
+     */
+    static ReduceState reduce(ReduceOp op, const int32_t* values, size_t count) {
+        return reduce(op, ElementType::INT32, values, count);
+    }
+
+    /**
+     * @brief Получить специализацию свертки из реестра
+     * @param op Операция
+     * @param type Тип элементов
+     * @param littleEndian true - элементы в little-endian, false - в хостовом порядке
+     * @return Функция свертки фрагмента
+     */
+    static VectorReduction::Function reduction(ReduceOp op, ElementType type,
+                                               bool littleEndian);
+
+    /**
+     * @brief Размер элемента
+     * @param type Тип элемента
+     * @return Количество байт
+     */
+    static size_t elementSize(ElementType type);
+
+    /**
+     * @brief Проверить, что тип элемента целый
+     * @param type Тип элемента
+     * @return true - INT8, INT16, INT32, INT64
+     */
+    static bool isInteger(ElementType type);
+
+    /**
+     * @brief Название типа элемента
+     * @param type Тип элемента
+     * @return Название для журнала
+     */
+    static const char* typeName(ElementType type);
+
+    /**
+     * @brief Название операции свертки
+     * @param op Операция
+     * @return Название для журнала
+     */
+    static const char* opName(ReduceOp op);
+
     /**
      * @brief Обработать массив векторов
      * @param vectors Массив векторов
@@ -32,18 +728,185 @@ public:
      */
     static std::vector<int32_t> processVectors(
         const std::vector<std::vector<int32_t>>& vectors);
-    
-private:
-    static const int32_t MAX_INT32 = INT_MAX;      // 2^31-1
-    static const int32_t MIN_INT32 = INT_MIN;      // -2^31
-    
+
+    /**
+     * @brief Обработать пакет векторов, при наличии пула - параллельно
+     *
+     * Векторы раздаются задачам пула группами примерно по
+     * PARALLEL_GRAIN_ELEMENTS элементов; вектор больше двух фрагментов
+     * PARALLEL_CHUNK_ELEMENTS суммируется параллельно по фрагментам
+     * (см. sumParallel). Порядок результатов совпадает с порядком векторов.
+     *
+     * @param batch Пакет
+     * @param policy Политика переполнения
+     * @param results Суммы векторов (выходной параметр, емкость сохраняется)
+     * @param pool Пул потоков или nullptr - в текущем потоке
+     */
+    static void processVectors(const VectorBatch& batch, OverflowPolicy policy,
+                               std::vector<SumAccumulator>& results,
+                               WorkStealingPool* pool = nullptr);
+
+    /**
+     * @brief Сумма вектора, параллельно по фрагментам
+     *
+     * Фрагменты независимо дают точную сумму и сумму модулей (из них
+     * следуют суммы положительных и отрицательных элементов), затем
+     * суммы фрагментов складываются по порядку через
+     * SumAccumulator::addBounded. Фрагмент, внутри которого возможно
+     * насыщение, проходит поэлементно, поэтому результат совпадает
+     * с последовательной суммой при любой политике.
+     *
+     * @param values Указатель на первый элемент
+     * @param count Количество элементов
+     * @param policy Политика переполнения
+     * @param pool Пул потоков или nullptr - последовательно
+     * @return Накопитель с суммой
+     */
+    static SumAccumulator sumParallel(const int32_t* values, size_t count,
+                                      OverflowPolicy policy, WorkStealingPool* pool);
+
+    /**
+     * @brief Суммы по столбцам матрицы
+     *
+     * Столбцы обрабатываются блоками по MATRIX_BLOCK_COLUMNS: суммы
+     * блока остаются в кэше L1, пока через них проходят все строки.
+     * Суммы точные (rows < 2^32).
+     *
+     * @param matrix Матрица rows x cols по строкам
+     * @param rows Количество строк
+     * @param cols Количество столбцов
+     * @param sums Суммы (выходной параметр, cols значений)
+     * @param pool Пул потоков или nullptr - в текущем потоке
+     */
+    static void columnSums(const int32_t* matrix, size_t rows, size_t cols,
+                           std::vector<int64_t>& sums, WorkStealingPool* pool = nullptr);
+
+    /**
+     * @brief Попарные скалярные произведения строк (матрица Грама)
+     *
+     * Результат - верхний треугольник с диагональю по строкам:
+     * (0,0), (0,1) ... (0,rows-1), (1,1) ... - всего rows*(rows+1)/2
+     * значений. Строки перебираются плитками по MATRIX_BLOCK_ROWS,
+     * столбцы - блоками по MATRIX_BLOCK_COLUMNS, так что отрезки двух
+     * плиток помещаются в кэш L2. Произведения берутся по модулю 2^64.
+     *
+     * @param matrix Матрица rows x cols по строкам
+     * @param rows Количество строк
+     * @param cols Количество столбцов
+     * @param dots Произведения (выходной параметр)
+     * @param pool Пул потоков или nullptr - в текущем потоке
+     */
+    static void gram(const int32_t* matrix, size_t rows, size_t cols,
+                     std::vector<int64_t>& dots, WorkStealingPool* pool = nullptr);
+
+    /**
+     * @brief Произведение матрицы на вектор
+     *
+     * Отрезок вектора длиной MATRIX_BLOCK_COLUMNS остается в кэше,
+     * пока с ним умножаются все строки. Произведения берутся
+     * по модулю 2^64.
+     *
+     * @param matrix Матрица rows x cols по строкам
+     * @param rows Количество строк
+     * @param cols Количество столбцов
+     * @param x Вектор из cols элементов
+     * @param result Произведение (выходной параметр, rows значений)
+     * @param pool Пул потоков или nullptr - в текущем потоке
+     */
+    static void matVec(const int32_t* matrix, size_t rows, size_t cols, const int32_t* x,
+                       std::vector<int64_t>& result, WorkStealingPool* pool = nullptr);
+
+    /**
+     * @brief Свертка разреженного вектора без восстановления нулей
+     *
+     * Явно переданные значения сворачиваются теми же ядрами, что и
+     * плотный вектор, остальные size - count элементов учитываются
+     * как нули (ReduceState::addZeros). Работа пропорциональна count.
+     *
+     * @param op Операция
+     * @param type Тип элементов
+     * @param size Полная длина вектора
+     * @param values Явно переданные значения в хостовом порядке байт
+     * @param count Количество значений (не больше size)
+     * @return Состояние свертки
+     */
+    static ReduceState reduceSparse(ReduceOp op, ElementType type, uint64_t size,
+                                    const void* values, size_t count);
+
+    /**
+     * @brief Построить фрагмент сгенерированного вектора
+     * @param generator Генератор
+     * @param offset Номер первого элемента фрагмента
+     * @param count Количество элементов
+     * @param values Элементы (выходной параметр)
+     */
+    static void generate(const VectorGenerator& generator, uint64_t offset, size_t count,
+                         int32_t* values);
+
+    /**
+     * @brief Сжать вектор: zigzag-дельты в group varint (см. PackedKernels)
+     * @param values Элементы
+     * @param count Количество элементов
+     * @param output Сжатые байты (дописываются в конец)
+     */
+    static void encodePacked(const int32_t* values, size_t count, std::vector<unsigned char>& output);
+
+    /**
+     * @brief Проверить индексы разреженного вектора
+     * @param bytes Индексы uint32 в little-endian (выравнивание не требуется)
+     * @param count Количество индексов
+     * @param next Наименьший допустимый индекс (обновляется: последний + 1)
+     * @param size Длина вектора
+     * @return true - индексы строго возрастают и меньше size
+     */
+    static bool checkIndices(const void* bytes, size_t count, uint64_t& next, uint64_t size);
+
+    /**
+     * @brief Количество установленных битов
+     * @param bytes Битовая маска
+     * @param size Размер маски в байтах
+     * @return Количество единиц
+     */
+    static uint64_t countBits(const void* bytes, size_t size);
+
+    /**
+     * @brief Название матричной операции для журнала
+     * @param op Операция
+     * @return Название
+     */
+    static const char* matrixOpName(MatrixOp op);
+
+    /**
+     * @brief Название операции преобразования для журнала
+     * @param op Операция
+     * @return Название
+     */
+    static const char* transformOpName(TransformOp op);
+
+    /**
+     * @brief Выбрать ядра суммирования и сверток
+     *
+     * Вызывается при запуске, до появления рабочих потоков.
+     * Если процессор не поддерживает запрошенный набор инструкций,
+     * выбирается лучший из поддерживаемых.
+     *
+     * @param requested Запрошенный набор инструкций (AUTO - по cpuid)
+     * @return Фактически выбранный набор инструкций
+     */
+    static SimdLevel selectKernel(SimdLevel requested);
+
+    /**
+     * @brief Получить текущее ядро суммирования
+     * @return Набор инструкций
+     */
+    static SimdLevel getKernel();
+
     /**
-     * @brief Проверить переполнение
-     * @param a Первое слагаемое
-     * @param b Второе слагаемое
-     * @return true - будет переполнение
+     * @brief Название набора инструкций
+     * @param level Набор инструкций
+     * @return Название для журнала и справки
      */
-    static bool willOverflowAdd(int32_t a, int32_t b);
+    static const char* kernelName(SimdLevel level);
 };
 
 #endif // VECTORPROCESSOR_H
@@ -0,0 +1,448 @@
+#include "VectorStore.h"
+#include "VectorProcessor.h"
+#include "Xxh64.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+/**
+ * @brief Запись вектора (разметка версии 1 файла хранилища)
+ *
+ * @code
+ *   StoredRecord
+ *   char user[userLength], name[nameLength]     - до границы 16 байт
+ *   int32 values[size]                          - до границы 16 байт
+ *   PrefixIndex::Node index[size + 1]           - если indexed
+ * @endcode
+ * Контрольная сумма защищает неизменяемую часть заголовка и ключ;
+ * агрегаты, значения и индекс изменяются на месте. Она записывается
+ * последней, когда значения и индекс уже скопированы: запись, прерванная
+ * сбоем процесса, при загрузке отбрасывается. Номер записи различает
+ * оригинал и копию одного вектора, если сбой пришелся между записью
+ * копии и освобождением оригинала.
+ */
+struct StoredRecord {
+    uint64_t checksum;          ///< XXH64 полей от userLength до serial и ключа
+    uint32_t userLength;
+    uint32_t nameLength;
+    uint64_t size;
+    uint32_t indexed;
+    uint32_t serial;            ///< Номер записи (растет по кругу; 0 - записи прежних версий)
+    StoredAggregates aggregates;
+};
+
+/// Выравнивание частей записи
+static const size_t RECORD_ALIGN = 16;
+
+static size_t alignRecord(size_t bytes) {
+    return (bytes + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+}
+
+static size_t recordBytes(size_t keyBytes, uint64_t size, bool indexed) {
+    return alignRecord(sizeof(StoredRecord) + keyBytes) + alignRecord(size * sizeof(int32_t)) +
+           (indexed ? PrefixIndex::bytes(size) : 0);
+}
+
+static char* recordKey(StoredRecord* record) {
+    return reinterpret_cast<char*>(record + 1);
+}
+
+static int32_t* recordValues(StoredRecord* record) {
+    return reinterpret_cast<int32_t*>(reinterpret_cast<char*>(record) +
+           alignRecord(sizeof(StoredRecord) + record->userLength + record->nameLength));
+}
+
+static PrefixIndex recordIndex(StoredRecord* record) {
+    char* nodes = reinterpret_cast<char*>(recordValues(record)) +
+                  alignRecord(record->size * sizeof(int32_t));
+    return PrefixIndex(reinterpret_cast<PrefixIndex::Node*>(nodes), record->size);
+}
+
+static uint64_t recordChecksum(StoredRecord* record) {
+    Xxh64 hasher;
+    hasher.reset(0);
+    hasher.update(&record->userLength,
+                  offsetof(StoredRecord, aggregates) - offsetof(StoredRecord, userLength));
+    hasher.update(recordKey(record), record->userLength + record->nameLength);
+    return hasher.digest();
+}
+
+/**
+ * @brief Проверить, записана ли запись a раньше записи b
+ */
+static bool isOlder(const StoredRecord* a, const StoredRecord* b) {
+    return static_cast<int32_t>(a->serial - b->serial) < 0;
+}
+
+/**
+ * @brief Учтенная память вектора с индексом
+ */
+static size_t accountedBytes(const std::string& name, const StoredRecord* record) {
+    return VectorStore::entryBytes(name, record->size) +
+           (record->indexed ? PrefixIndex::bytes(record->size) : 0);
+}
+
+const size_t VectorStore::ENTRY_OVERHEAD;
+
+VectorStore::VectorStore(size_t budget)
+    : budget_(budget), bytes_(0), evictions_(0), nextSerial_(1) {
+}
+
+VectorStore::~VectorStore() {
+    close();
+}
+
+bool VectorStore::openFile(const std::string& path, Logger& logger) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Файл может вырасти на новые векторы и на свободные промежутки между ними
+    std::unique_ptr<StoreFile> file(new StoreFile(logger));
+    if (!file->open(path, 4 * budget_)) {
+        return false;
+    }
+    file_ = std::move(file);
+
+    bool verify = !file_->wasClean();
+    size_t loaded = 0;
+    size_t dropped = 0;
+    std::vector<void*> blocks = file_->loaded();
+    for (void* data : blocks) {
+        StoredRecord* record = static_cast<StoredRecord*>(data);
+        size_t capacity = file_->capacity(data);
+        bool valid = capacity >= sizeof(StoredRecord) && record->indexed <= 1 &&
+                     record->userLength + uint64_t(record->nameLength) <= capacity &&
+                     record->size <= capacity / sizeof(int32_t) &&
+                     recordBytes(record->userLength + record->nameLength, record->size,
+                                 record->indexed != 0) <= capacity &&
+                     record->checksum == recordChecksum(record);
+        if (!valid) {
+            file_->release(data);
+            dropped++;
+            continue;
+        }
+        std::string user(recordKey(record), record->userLength);
+        std::string name(recordKey(record) + record->userLength, record->nameLength);
+
+        // Повтор ключа остается после сбоя между записью копии и освобождением
+        // оригинала: команда не завершилась, поэтому остается оригинал
+        Entry* existing = find(user, name);
+        if (existing != nullptr && !isOlder(record, existing->record)) {
+            file_->release(data);
+            dropped++;
+            continue;
+        }
+        if (existing != nullptr) {
+            UserSpace& space = users_[user];
+            erase(space, space.entries.begin());
+            dropped++;
+            loaded--;
+        }
+        if (static_cast<int32_t>(record->serial - nextSerial_) >= 0) {
+            nextSerial_ = record->serial + 1;
+        }
+
+        if (verify) {
+            int32_t* values = recordValues(record);
+            record->aggregates = StoredAggregates();
+            record->aggregates.size = record->size;
+            for (uint64_t k = 0; k < record->size; k++) {
+                record->aggregates.account(values[k], 1);
+            }
+            if (record->indexed) {
+                recordIndex(record).build(values);
+            }
+        }
+        insert(user, name, record);
+        loaded++;
+    }
+
+    uint64_t evictions = evictions_;
+    while (bytes_ > budget_ && evictOne()) {
+    }
+
+    logger.log(LogLevel::INFO, "Хранилище векторов загружено",
+               "векторов: " + std::to_string(loaded) +
+               ", отброшено записей: " + std::to_string(dropped) +
+               ", вытеснено: " + std::to_string(evictions_ - evictions) +
+               (verify ? ", агрегаты пересчитаны" : ""));
+    return true;
+}
+
+void VectorStore::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        for (auto& space : users_) {
+            for (Entry& entry : space.second.entries) {
+                releaseRecord(entry.record);
+            }
+        }
+    }
+    users_.clear();
+    bytes_ = 0;
+    file_.reset();
+}
+
+StoredRecord* VectorStore::allocateRecord(const std::string& user, const std::string& name,
+                                          size_t size, bool indexed) {
+    size_t bytes = recordBytes(user.size() + name.size(), size, indexed);
+    void* data = nullptr;
+    if (file_) {
+        data = file_->allocate(bytes);
+    } else if (posix_memalign(&data, RECORD_ALIGN, bytes) != 0) {
+        data = nullptr;
+    }
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    // Блок мог принадлежать другой записи: ее контрольная сумма стирается первой
+    StoredRecord* record = static_cast<StoredRecord*>(data);
+    record->checksum = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    record->userLength = static_cast<uint32_t>(user.size());
+    record->nameLength = static_cast<uint32_t>(name.size());
+    record->size = size;
+    record->indexed = indexed ? 1 : 0;
+    record->serial = nextSerial_++;
+    record->aggregates = StoredAggregates();
+    record->aggregates.size = size;
+    memcpy(recordKey(record), user.data(), user.size());
+    memcpy(recordKey(record) + user.size(), name.data(), name.size());
+    return record;
+}
+
+void VectorStore::sealRecord(StoredRecord* record) {
+    // Контрольная сумма попадает в отображение после значений и индекса
+    std::atomic_thread_fence(std::memory_order_release);
+    record->checksum = recordChecksum(record);
+}
+
+void VectorStore::releaseRecord(StoredRecord* record) {
+    if (file_) {
+        file_->release(record);
+    } else {
+        free(record);
+    }
+}
+
+void VectorStore::insert(const std::string& user, const std::string& name, StoredRecord* record) {
+    UserSpace& space = users_[user];
+    Entry entry;
+    entry.name = name;
+    entry.record = record;
+    entry.bytes = accountedBytes(name, record);
+    space.entries.push_front(entry);
+    space.index[name] = space.entries.begin();
+    space.bytes += entry.bytes;
+    bytes_ += entry.bytes;
+}
+
+VectorStore::Entry* VectorStore::find(const std::string& user, const std::string& name) {
+    auto space = users_.find(user);
+    if (space == users_.end()) {
+        return nullptr;
+    }
+    auto found = space->second.index.find(name);
+    if (found == space->second.index.end()) {
+        return nullptr;
+    }
+    std::list<Entry>& entries = space->second.entries;
+    entries.splice(entries.begin(), entries, found->second);
+    return &*found->second;
+}
+
+void VectorStore::erase(UserSpace& space, std::list<Entry>::iterator entry) {
+    space.bytes -= entry->bytes;
+    bytes_ -= entry->bytes;
+    releaseRecord(entry->record);
+    space.index.erase(entry->name);
+    space.entries.erase(entry);
+}
+
+bool VectorStore::evictOne(const Entry* keep) {
+    auto largest = users_.end();
+    for (auto space = users_.begin(); space != users_.end(); ++space) {
+        // keep - первый в списке своего пользователя: давним он будет, только если один
+        if (!space->second.entries.empty() && &space->second.entries.back() != keep &&
+            (largest == users_.end() || space->second.bytes > largest->second.bytes)) {
+            largest = space;
+        }
+    }
+    if (largest == users_.end()) {
+        return false;
+    }
+
+    UserSpace& space = largest->second;
+    erase(space, std::prev(space.entries.end()));
+    if (space.entries.empty()) {
+        users_.erase(largest);
+    }
+    evictions_++;
+    return true;
+}
+
+StoreResult VectorStore::create(const std::string& user, const std::string& name,
+                                const std::vector<int32_t>& values) {
+    size_t bytes = entryBytes(name, values.size());
+    if (bytes > budget_) {
+        return StoreResult::NO_SPACE;
+    }
+
+    StoredAggregates aggregates = StoredAggregates();
+    aggregates.size = values.size();
+    for (int32_t value : values) {
+        aggregates.account(value, 1);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Прежний вектор удаляется, только когда новый полностью записан
+    Entry* old = find(user, name);
+    size_t replaced = (old != nullptr) ? old->bytes : 0;
+    while (bytes_ - replaced + bytes > budget_ && evictOne(old)) {
+    }
+    if (bytes_ - replaced + bytes > budget_) {
+        return StoreResult::NO_SPACE;
+    }
+
+    StoredRecord* record = allocateRecord(user, name, values.size(), false);
+    if (record == nullptr) {
+        return StoreResult::NO_SPACE;
+    }
+    memcpy(recordValues(record), values.data(), values.size() * sizeof(int32_t));
+    record->aggregates = aggregates;
+    sealRecord(record);
+    if (old != nullptr) {
+        UserSpace& space = users_[user];
+        erase(space, space.entries.begin());
+    }
+    insert(user, name, record);
+    return StoreResult::OK;
+}
+
+StoreResult VectorStore::patch(const std::string& user, const std::string& name,
+                               const StorePatch* patches, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = find(user, name);
+    if (entry == nullptr) {
+        return StoreResult::NOT_FOUND;
+    }
+    StoredRecord* record = entry->record;
+    for (size_t i = 0; i < count; i++) {
+        if (patches[i].index >= record->size) {
+            return StoreResult::BAD_INDEX;
+        }
+    }
+
+    int32_t* values = recordValues(record);
+    PrefixIndex index = recordIndex(record);
+    for (size_t i = 0; i < count; i++) {
+        int32_t& element = values[patches[i].index];
+        record->aggregates.account(element, -1);
+        if (record->indexed) {
+            index.update(patches[i].index, element, patches[i].value);
+        }
+        element = patches[i].value;
+        record->aggregates.account(element, 1);
+    }
+    return StoreResult::OK;
+}
+
+StoreResult VectorStore::buildIndex(const std::string& user, const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = find(user, name);
+    if (entry == nullptr) {
+        return StoreResult::NOT_FOUND;
+    }
+    StoredRecord* old = entry->record;
+    if (old->indexed) {
+        return StoreResult::OK;
+    }
+
+    size_t bytes = PrefixIndex::bytes(old->size);
+    if (entry->bytes + bytes > budget_) {
+        return StoreResult::NO_SPACE;
+    }
+    while (bytes_ + bytes > budget_ && evictOne(entry)) {
+    }
+    if (bytes_ + bytes > budget_) {
+        return StoreResult::NO_SPACE;
+    }
+
+    // Индекс добавляется копированием в запись большего размера:
+    // оригинал освобождается, только когда копия полностью записана
+    StoredRecord* record = allocateRecord(user, name, old->size, true);
+    if (record == nullptr) {
+        return StoreResult::NO_SPACE;
+    }
+    memcpy(recordValues(record), recordValues(old), old->size * sizeof(int32_t));
+    record->aggregates = old->aggregates;
+    recordIndex(record).build(recordValues(record));
+    sealRecord(record);
+    releaseRecord(old);
+
+    entry->record = record;
+    entry->bytes += bytes;
+    users_[user].bytes += bytes;
+    bytes_ += bytes;
+    return StoreResult::OK;
+}
+
+StoreResult VectorStore::rangeSum(const std::string& user, const std::string& name,
+                                  size_t begin, size_t end, SumAccumulator& sum) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = find(user, name);
+    if (entry == nullptr) {
+        return StoreResult::NOT_FOUND;
+    }
+    StoredRecord* record = entry->record;
+    if (begin > end || end > record->size) {
+        return StoreResult::BAD_INDEX;
+    }
+
+    const int32_t* values = recordValues(record);
+    if (!record->indexed) {
+        sum.add(values + begin, end - begin);
+    } else {
+        recordIndex(record).addRange(values, begin, end, sum);
+    }
+    return StoreResult::OK;
+}
+
+StoreResult VectorStore::query(const std::string& user, const std::string& name,
+                               StoredAggregates& aggregates) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = find(user, name);
+    if (entry == nullptr) {
+        return StoreResult::NOT_FOUND;
+    }
+    aggregates = entry->record->aggregates;
+    return StoreResult::OK;
+}
+
+StoreResult VectorStore::remove(const std::string& user, const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (find(user, name) == nullptr) {
+        return StoreResult::NOT_FOUND;
+    }
+    auto space = users_.find(user);
+    erase(space->second, space->second.entries.begin());
+    if (space->second.entries.empty()) {
+        users_.erase(space);
+    }
+    return StoreResult::OK;
+}
+
+VectorStore::Stats VectorStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.users = users_.size();
+    stats.vectors = 0;
+    for (const auto& space : users_) {
+        stats.vectors += space.second.entries.size();
+    }
+    stats.bytes = bytes_;
+    stats.evictions = evictions_;
+    stats.fileBytes = file_ ? file_->size() : 0;
+    return stats;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file VectorStore.h
+ * @brief Хранилище именованных векторов пользователей с инкрементными агрегатами
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef VECTORSTORE_H
+#define VECTORSTORE_H
+
+#include "Logger.h"
+#include "PrefixIndex.h"
+#include "StoreFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class SumAccumulator;
+struct StoredRecord;
+
+/**
+ * @brief Результат команды хранилища (совпадает с Protocol::StoreStatus)
+ */
+enum class StoreResult {
+    OK,         ///< Команда выполнена
+    NOT_FOUND,  ///< Вектора с таким именем нет
+    BAD_INDEX,  ///< Индекс или диапазон за пределами вектора (вектор не изменен)
+    NO_SPACE    ///< Вектор больше всего хранилища
+};
+
+/**
+ * @brief Агрегаты хранимого вектора
+ *
+ * Поддерживаются при каждом изменении элемента за O(1): новое значение
+ * прибавляется, старое вычитается. Накопители точные (элементы int32,
+ * длина вектора ограничена), поэтому порядок изменений не влияет на
+ * результат.
+ */
+struct StoredAggregates {
+    uint64_t size;              ///< Количество элементов
+    __int128 sum;               ///< Сумма
+    __int128 magnitude;         ///< Сумма модулей (L1)
+    unsigned __int128 squares;  ///< Сумма квадратов (L2)
+    uint64_t nonZero;           ///< Количество ненулевых элементов
+
+    /**
+     * @brief Учесть элемент
+     * @param value Значение
+     * @param sign +1 - добавить, -1 - убрать
+     */
+    void account(int32_t value, int sign) {
+        __int128 square = static_cast<__int128>(static_cast<int64_t>(value) * value);
+        sum += sign * static_cast<__int128>(value);
+        magnitude += sign * (value < 0 ? -static_cast<__int128>(value) : static_cast<__int128>(value));
+        squares += static_cast<unsigned __int128>(sign * square);
+        nonZero += static_cast<uint64_t>(sign * (value != 0));
+    }
+};
+
+/**
+ * @brief Изменение одного элемента хранимого вектора
+ */
+struct StorePatch {
+    uint32_t index;
+    int32_t value;
+};
+
+/**
+ * @brief Хранилище именованных векторов, общее для всех потоков сервера
+ *
+ * Пространство имен у каждого логина свое (логин - идентичность клиента
+ * из Database, под которой сеанс прошел аутентификацию). Клиент создает
+ * вектор один раз, затем присылает заплатки (индекс, значение); агрегаты
+ * обновляются вместе с элементами, поэтому запрос агрегатов стоит O(1),
+ * а заплатка - O(количества изменений).
+ *
+ * Память учитывается по векторам: значения, имя и постоянная добавка
+ * ENTRY_OVERHEAD на узлы списков и индексов. Когда новый вектор не
+ * помещается в бюджет, вытесняется давно не использованный вектор
+ * пользователя, занимающего больше всех памяти: один клиент не может
+ * вытеснить векторы остальных, пока сам занимает меньше них.
+ *
+ * По запросу к вектору строится индекс сумм диапазонов (PrefixIndex),
+ * который учитывается в памяти вектора и поддерживается заплатками.
+ *
+ * Вектор хранится одной записью: заголовок с ключом и агрегатами,
+ * значения, узлы индекса. Записи выделяются в куче или, после
+ * openFile(), в блоках отображенного файла StoreFile; заплатки
+ * изменяют запись прямо в отображении. При запуске с тем же файлом
+ * хранилище проверяет только заголовки записей и готово к работе без
+ * повторной загрузки значений; агрегаты и индексы пересчитываются,
+ * только если файл не был закрыт корректно.
+ *
+ * Все операции выполняются под одним мьютексом: самые долгие из них
+ * (создание и построение индекса) проходят вектор один раз.
+ */
+class VectorStore {
+public:
+    /**
+     * @brief Счетчики хранилища
+     */
+    struct Stats {
+        size_t vectors;         ///< Векторов сейчас
+        size_t users;           ///< Пользователей с векторами
+        size_t bytes;           ///< Учтенная память
+        uint64_t evictions;     ///< Вытеснено векторов
+        uint64_t fileBytes;     ///< Размер файла хранилища (0 - без файла)
+    };
+
+    /**
+     * @brief Конструктор
+     * @param budget Бюджет памяти в байтах
+     */
+    explicit VectorStore(size_t budget);
+
+    /**
+     * @brief Деструктор (закрывает файл хранилища)
+     */
+    ~VectorStore();
+
+    VectorStore(const VectorStore&) = delete;
+    VectorStore& operator=(const VectorStore&) = delete;
+
+    /**
+     * @brief Хранить векторы в файле и загрузить сохраненные в нем
+     *
+     * Вызывается до первой команды. Записи с неверной контрольной суммой
+     * отбрасываются; если сохраненные векторы не помещаются в бюджет,
+     * лишние вытесняются (и удаляются из файла).
+     *
+     * @param path Путь к файлу (создается, если его нет)
+     * @param logger Журнал
+     * @return false - файл не открыт (причина записана в журнал)
+     */
+    bool openFile(const std::string& path, Logger& logger);
+
+    /**
+     * @brief Закрыть файл хранилища (векторы остаются в нем) или освободить память
+     *
+     * После вызова хранилище пусто.
+     */
+    void close();
+
+    /**
+     * @brief Создать или заменить вектор
+     * @param user Логин
+     * @param name Имя вектора
+     * @param values Значения
+     * @return OK или NO_SPACE
+     */
+    StoreResult create(const std::string& user, const std::string& name,
+                       const std::vector<int32_t>& values);
+
+    /**
+     * @brief Изменить элементы вектора
+     *
+     * Изменения применяются по порядку (при повторе индекса остается
+     * последнее значение) и только если все индексы в пределах вектора.
+     *
+     * @param user Логин
+     * @param name Имя вектора
+     * @param patches Изменения
+     * @param count Количество изменений
+     * @return OK, NOT_FOUND или BAD_INDEX
+     */
+    StoreResult patch(const std::string& user, const std::string& name,
+                      const StorePatch* patches, size_t count);
+
+    /**
+     * @brief Построить индекс сумм диапазонов вектора
+     *
+     * Память индекса добавляется к памяти вектора; при нехватке
+     * вытесняются другие векторы. Повторный вызов ничего не делает.
+     *
+     * @param user Логин
+     * @param name Имя вектора
+     * @return OK, NOT_FOUND или NO_SPACE
+     */
+    StoreResult buildIndex(const std::string& user, const std::string& name);
+
+    /**
+     * @brief Добавить сумму диапазона вектора в накопитель
+     *
+     * Результат совпадает с поэлементным суммированием диапазона по
+     * политике накопителя. С индексом сумма считается за O(log n), пока
+     * частичные суммы не приближаются к насыщению, без индекса - проходом
+     * по диапазону.
+     *
+     * @param user Логин
+     * @param name Имя вектора
+     * @param begin Первый элемент
+     * @param end Элемент за последним (не меньше begin, не больше размера)
+     * @param sum Накопитель
+     * @return OK, NOT_FOUND или BAD_INDEX
+     */
+    StoreResult rangeSum(const std::string& user, const std::string& name,
+                         size_t begin, size_t end, SumAccumulator& sum);
+
+    /**
+     * @brief Получить агрегаты вектора
+     * @param user Логин
+     * @param name Имя вектора
+     * @param aggregates Агрегаты (выходной параметр)
+     * @return OK или NOT_FOUND
+     */
+    StoreResult query(const std::string& user, const std::string& name,
+                      StoredAggregates& aggregates);
+
+    /**
+     * @brief Удалить вектор
+     * @param user Логин
+     * @param name Имя вектора
+     * @return OK или NOT_FOUND
+     */
+    StoreResult remove(const std::string& user, const std::string& name);
+
+    /**
+     * @brief Получить счетчики
+     * @return Счетчики на момент вызова
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Бюджет памяти
+     * @return Байт
+     */
+    size_t budget() const { return budget_; }
+
+    /**
+     * @brief Учтенный размер вектора
+     * @param name Имя
+     * @param size Количество элементов
+     * @return Байт
+     */
+    static size_t entryBytes(const std::string& name, size_t size) {
+        return size * sizeof(int32_t) + name.size() + ENTRY_OVERHEAD;
+    }
+
+    /// Учитываемые накладные расходы на вектор (заголовок записи, узлы списка и индексов)
+    static const size_t ENTRY_OVERHEAD = 128;
+
+private:
+    /**
+     * @brief Хранимый вектор
+     */
+    struct Entry {
+        std::string name;
+        StoredRecord* record;       ///< Запись в куче или в файле
+        size_t bytes;
+    };
+
+    /**
+     * @brief Векторы одного пользователя: от недавно использованных к давним
+     */
+    struct UserSpace {
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        size_t bytes;
+
+        UserSpace() : bytes(0) {}
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, UserSpace> users_;
+    size_t budget_;
+    size_t bytes_;
+    uint64_t evictions_;
+    std::unique_ptr<StoreFile> file_;   ///< Файл записей или nullptr (записи в куче)
+    uint32_t nextSerial_;               ///< Номер следующей записи
+
+    /**
+     * @brief Найти вектор и отметить его использование
+     * @return Вектор или nullptr
+     */
+    Entry* find(const std::string& user, const std::string& name);
+
+    /**
+     * @brief Удалить вектор пользователя
+     * @param space Векторы пользователя
+     * @param entry Вектор
+     */
+    void erase(UserSpace& space, std::list<Entry>::iterator entry);
+
+    /**
+     * @brief Вытеснить давний вектор пользователя, занимающего больше всех памяти
+     * @param keep Вектор, который вытеснять нельзя (недавний у своего пользователя)
+     * @return false - вытеснять нечего
+     */
+    bool evictOne(const Entry* keep = nullptr);
+
+    /**
+     * @brief Выделить запись с заполненным ключом и нулевыми агрегатами
+     *
+     * Контрольная сумма не записывается: до sealRecord() запись считается
+     * неполной.
+     *
+     * @param user Логин
+     * @param name Имя вектора
+     * @param size Количество элементов
+     * @param indexed Выделить место под индекс сумм диапазонов
+     * @return Запись или nullptr - нет места в файле
+     */
+    StoredRecord* allocateRecord(const std::string& user, const std::string& name,
+                                 size_t size, bool indexed);
+
+    /**
+     * @brief Записать контрольную сумму после значений и индекса
+     */
+    void sealRecord(StoredRecord* record);
+
+    /**
+     * @brief Освободить запись
+     */
+    void releaseRecord(StoredRecord* record);
+
+    /**
+     * @brief Добавить запись как недавно использованный вектор
+     */
+    void insert(const std::string& user, const std::string& name, StoredRecord* record);
+};
+
+#endif // VECTORSTORE_H
@@ -0,0 +1,138 @@
+#include "WorkStealingPool.h"
+
+/// Пул и номер потока пула, которому принадлежит текущий поток
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local size_t currentIndex = 0;
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+    : queued_(0),
+      steals_(0),
+      stopping_(false) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (unsigned int i = 0; i <= threads; i++) {
+        queues_.emplace_back(new Queue());
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t begin, size_t end, size_t grain, const Body& body) {
+    if (begin >= end) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    std::atomic<size_t> pending(end - begin);
+    size_t queue = ownQueue();
+    execute(queue, Task{&body, begin, end, grain, &pending});
+
+    // Пока чужие потоки дорабатывают наши половины, помогаем им
+    while (pending.load(std::memory_order_acquire) > 0) {
+        Task task;
+        if (take(queue, task)) {
+            execute(queue, task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t WorkStealingPool::ownQueue() const {
+    return (currentPool == this) ? currentIndex : threads_.size();
+}
+
+void WorkStealingPool::push(size_t queue, const Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+        queues_[queue]->tasks.push_back(task);
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        // Захват мьютекса исключает потерю пробуждения между проверкой
+        // queued_ потоком и его засыпанием
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wakeup_.notify_one();
+}
+
+bool WorkStealingPool::take(size_t queue, Task& task) {
+    if (queued_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    {
+        // Своя очередь - с конца: последняя отложенная половина еще в кэше
+        Queue& own = *queues_[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues_.size(); offset++) {
+        Queue& victim = *queues_[(queue + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            // Чужая очередь - с начала: там самые крупные диапазоны
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::execute(size_t queue, Task task) {
+    while (task.end - task.begin > task.grain) {
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        Task right = task;
+        right.begin = middle;
+        push(queue, right);
+        task.end = middle;
+    }
+
+    (*task.body)(task.begin, task.end);
+    task.pending->fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        Task task;
+        if (take(index, task)) {
+            execute(index, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeup_.wait(lock, [this]() {
+            return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_) {
+            return;
+        }
+    }
+}
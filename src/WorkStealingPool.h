@@ -0,0 +1,149 @@
+/**
+ * @file WorkStealingPool.h
+ * @brief Пул потоков с перехватом задач для параллельной обработки векторов
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Пул потоков с перехватом задач (work stealing)
+ *
+ * Работа задается диапазоном индексов. Поток, выполняющий диапазон
+ * больше порога grain, делит его пополам и кладет правую половину
+ * в свою очередь, а левую продолжает делить сам. Свободные потоки
+ * забирают задачи с противоположного конца чужих очередей - самые
+ * крупные, поэтому перехватов мало. Вызвавший parallelFor поток
+ * не простаивает: до завершения своего диапазона он выполняет задачи
+ * наравне с потоками пула, так что вложенные вызовы (диапазон внутри
+ * задачи) не приводят к взаимной блокировке.
+ *
+ * Очереди защищены собственными мьютексами: задача - это крупный
+ * диапазон, и захват мьютекса на ее фоне незаметен.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Тело параллельного цикла
+     * @param begin Начало поддиапазона
+     * @param end Конец поддиапазона (не включается)
+     */
+    typedef std::function<void(size_t begin, size_t end)> Body;
+
+    /**
+     * @brief Конструктор: запускает потоки
+     * @param threads Количество потоков пула (не меньше 1)
+     */
+    explicit WorkStealingPool(unsigned int threads);
+
+    /**
+     * @brief Деструктор: дожидается завершения потоков
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Выполнить body над диапазоном [begin, end) параллельно
+     *
+     * Возвращает управление после выполнения всех поддиапазонов.
+     * Допускаются одновременные и вложенные вызовы из любых потоков.
+     *
+     * @param begin Начало диапазона
+     * @param end Конец диапазона
+     * @param grain Максимальный размер поддиапазона одного вызова body
+     * @param body Тело цикла
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain, const Body& body);
+
+    /**
+     * @brief Количество потоков пула
+     * @return Количество потоков
+     */
+    unsigned int size() const { return static_cast<unsigned int>(threads_.size()); }
+
+    /**
+     * @brief Количество задач, перехваченных из чужих очередей
+     * @return Счетчик за время жизни пула
+     */
+    uint64_t getSteals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Задача: поддиапазон одного вызова parallelFor
+     */
+    struct Task {
+        const Body* body;
+        size_t begin;
+        size_t end;
+        size_t grain;
+        std::atomic<size_t>* pending;   ///< Невыполненных индексов вызова
+    };
+
+    /**
+     * @brief Очередь задач потока
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<Queue>> queues_;   ///< По потокам пула, последняя - для внешних
+    std::mutex sleepMutex_;
+    std::condition_variable wakeup_;
+    std::atomic<size_t> queued_;        ///< Задач во всех очередях
+    std::atomic<uint64_t> steals_;
+    bool stopping_;
+
+    /**
+     * @brief Цикл потока пула
+     * @param index Номер потока
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * @brief Очередь текущего потока
+     * @return Своя очередь для потока пула, общая внешняя - для прочих
+     */
+    size_t ownQueue() const;
+
+    /**
+     * @brief Положить задачу в очередь и разбудить спящий поток
+     * @param queue Номер очереди
+     * @param task Задача
+     */
+    void push(size_t queue, const Task& task);
+
+    /**
+     * @brief Взять задачу: сначала из своей очереди, затем перехватить
+     * @param queue Своя очередь
+     * @param task Задача (выходной параметр)
+     * @return true - задача получена
+     */
+    bool take(size_t queue, Task& task);
+
+    /**
+     * @brief Выполнить задачу, отдавая половины диапазона в очередь
+     * @param queue Своя очередь
+     * @param task Задача
+     */
+    void execute(size_t queue, Task task);
+};
+
+#endif // WORKSTEALINGPOOL_H
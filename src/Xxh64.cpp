@@ -0,0 +1,136 @@
+#include "Xxh64.h"
+#include <algorithm>
+#include <cstring>
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotate(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t load64(const unsigned char* bytes) {
+    uint64_t value = 0;
+    for (size_t b = 0; b < sizeof(value); b++) {
+        value |= static_cast<uint64_t>(bytes[b]) << (8 * b);
+    }
+    return value;
+}
+
+static inline uint32_t load32(const unsigned char* bytes) {
+    uint32_t value = 0;
+    for (size_t b = 0; b < sizeof(value); b++) {
+        value |= static_cast<uint32_t>(bytes[b]) << (8 * b);
+    }
+    return value;
+}
+
+static inline uint64_t round(uint64_t lane, uint64_t input) {
+    lane += input * PRIME2;
+    return rotate(lane, 31) * PRIME1;
+}
+
+static inline uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+    hash ^= round(0, lane);
+    return hash * PRIME1 + PRIME4;
+}
+
+void Xxh64::reset(uint64_t seed) {
+    seed_ = seed;
+    lanes_[0] = seed + PRIME1 + PRIME2;
+    lanes_[1] = seed + PRIME2;
+    lanes_[2] = seed;
+    lanes_[3] = seed - PRIME1;
+    length_ = 0;
+    buffered_ = 0;
+}
+
+void Xxh64::update(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    length_ += size;
+
+    // Дополнение полосы, начатой в предыдущей порции
+    if (buffered_ > 0) {
+        size_t take = std::min(sizeof(buffer_) - buffered_, size);
+        memcpy(buffer_ + buffered_, bytes, take);
+        buffered_ += take;
+        bytes += take;
+        size -= take;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        for (size_t i = 0; i < 4; i++) {
+            lanes_[i] = round(lanes_[i], load64(buffer_ + 8 * i));
+        }
+        buffered_ = 0;
+    }
+
+    uint64_t v0 = lanes_[0], v1 = lanes_[1], v2 = lanes_[2], v3 = lanes_[3];
+    while (size >= sizeof(buffer_)) {
+        v0 = round(v0, load64(bytes));
+        v1 = round(v1, load64(bytes + 8));
+        v2 = round(v2, load64(bytes + 16));
+        v3 = round(v3, load64(bytes + 24));
+        bytes += sizeof(buffer_);
+        size -= sizeof(buffer_);
+    }
+    lanes_[0] = v0;
+    lanes_[1] = v1;
+    lanes_[2] = v2;
+    lanes_[3] = v3;
+
+    memcpy(buffer_, bytes, size);
+    buffered_ = size;
+}
+
+uint64_t Xxh64::digest() const {
+    uint64_t hash;
+    if (length_ >= sizeof(buffer_)) {
+        hash = rotate(lanes_[0], 1) + rotate(lanes_[1], 7) +
+               rotate(lanes_[2], 12) + rotate(lanes_[3], 18);
+        for (size_t i = 0; i < 4; i++) {
+            hash = mergeRound(hash, lanes_[i]);
+        }
+    } else {
+        hash = seed_ + PRIME5;
+    }
+    hash += length_;
+
+    // Хвост короче полосы
+    const unsigned char* bytes = buffer_;
+    size_t size = buffered_;
+    while (size >= 8) {
+        hash ^= round(0, load64(bytes));
+        hash = rotate(hash, 27) * PRIME1 + PRIME4;
+        bytes += 8;
+        size -= 8;
+    }
+    if (size >= 4) {
+        hash ^= static_cast<uint64_t>(load32(bytes)) * PRIME1;
+        hash = rotate(hash, 23) * PRIME2 + PRIME3;
+        bytes += 4;
+        size -= 4;
+    }
+    while (size > 0) {
+        hash ^= (*bytes) * PRIME5;
+        hash = rotate(hash, 11) * PRIME1;
+        bytes++;
+        size--;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t Xxh64::hash(const void* data, size_t size, uint64_t seed) {
+    Xxh64 state(seed);
+    state.update(data, size);
+    return state.digest();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file Xxh64.h
+ * @brief Хеш-функция xxHash64 для ключей кэша результатов
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#ifndef XXH64_H
+#define XXH64_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Потоковое вычисление xxHash64
+ *
+ * Результат совпадает с эталонной реализацией XXH64 при любом разбиении
+ * данных на порции: неполная полоса 32 байт запоминается до следующей
+ * порции. Клиент может вычислить тот же хеш любой библиотекой xxHash.
+ */
+class Xxh64 {
+public:
+    /**
+     * @brief Конструктор
+     * @param seed Зерно
+     */
+    explicit Xxh64(uint64_t seed = 0) { reset(seed); }
+
+    /**
+     * @brief Начать новый хеш
+     * @param seed Зерно
+     */
+    void reset(uint64_t seed);
+
+    /**
+     * @brief Добавить порцию данных
+     * @param data Данные
+     * @param size Размер порции
+     */
+    void update(const void* data, size_t size);
+
+    /**
+     * @brief Получить хеш добавленных данных
+     * @return Хеш (состояние не меняется, можно продолжать update)
+     */
+    uint64_t digest() const;
+
+    /**
+     * @brief Хеш блока данных
+     * @param data Данные
+     * @param size Размер
+     * @param seed Зерно
+     * @return Хеш
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+
+private:
+    uint64_t seed_;
+    uint64_t lanes_[4];         ///< Накопители полос
+    uint64_t length_;           ///< Всего добавлено байт
+    unsigned char buffer_[32];  ///< Неполная полоса
+    size_t buffered_;
+};
+
+#endif // XXH64_H
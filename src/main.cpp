@@ -11,17 +11,25 @@
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
+#include <unistd.h>
 
 Server* serverInstance = nullptr;
 
 /**
  * @brief Обработчик сигнала Ctrl+C
+ *
+ * Сигнал может прийти в любой поток, в том числе держащий мьютекс
+ * журнала, поэтому обработчик только выводит сообщение вызовом write()
+ * и сбрасывает флаг работы; остальное делает основной поток.
+ *
  * @param signal Номер сигнала
  */
 void signalHandler(int signal) {
     if (signal == SIGINT && serverInstance != nullptr) {
-        std::cout << "\nПолучен сигнал Ctrl+C, остановка сервера..." << std::endl;
-        serverInstance->stop();
+        static const char message[] = "\nПолучен сигнал Ctrl+C, остановка сервера...\n";
+        ssize_t written = write(STDOUT_FILENO, message, sizeof(message) - 1);
+        (void)written;
+        serverInstance->requestStop();
     }
 }
 
@@ -48,10 +56,13 @@ int main(int argc, char** argv) {
         std::cout << "  База клиентов: " << config.getClientDbPath() << std::endl;
         std::cout << "  Файл журнала:  " << config.getLogFilePath() << std::endl;
         std::cout << "  Порт:          " << config.getPort() << std::endl;
+        std::cout << "  Потоков:       " << config.getThreads() << std::endl;
         std::cout << "=========================================" << std::endl;
         std::cout << std::endl;
         
-        if (!server.start()) {
+        bool started = server.start();
+        serverInstance = nullptr;
+        if (!started) {
             std::cerr << "Ошибка запуска сервера" << std::endl;
             return EXIT_FAILURE;
         }
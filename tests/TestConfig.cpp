@@ -284,7 +284,194 @@ TEST(Config_ParseCommandLine_BoundaryPortMax) {
     CHECK_EQUAL(65535, config.getPort());
 }
 
-// === 12. Тест метода showHelp (не падает) ===
+// === 12. Тест количества рабочих потоков ===
+TEST(Config_ParseCommandLine_Threads) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--threads", "8"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK_EQUAL(1u, config.getThreads()); // По умолчанию
+    
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    CHECK(result);
+    CHECK_EQUAL(8u, config.getThreads());
+}
+
+TEST(Config_ParseCommandLine_InvalidThreads) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "-t", "0"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    // Перенаправляем stderr
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::stringstream errorBuffer;
+    std::cerr.rdbuf(errorBuffer.rdbuf());
+    
+    Config config;
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    std::cerr.rdbuf(oldCerr);
+    
+    CHECK(!result);
+}
+
+// === 13. Тест параметров шардирования ===
+TEST(Config_ParseCommandLine_Shards) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--shards", "4",
+        "--backlog", "1024",
+        "--pin-cpu"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK_EQUAL(0u, config.getShards()); // По умолчанию
+    CHECK_EQUAL(10, config.getBacklog());
+    CHECK(!config.getPinCpu());
+    
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    CHECK(result);
+    CHECK_EQUAL(4u, config.getShards());
+    CHECK_EQUAL(1024, config.getBacklog());
+    CHECK(config.getPinCpu());
+}
+
+TEST(Config_ParseCommandLine_ShardsWithThreads) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--shards", "2",
+        "--threads", "4"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::stringstream errorBuffer;
+    std::cerr.rdbuf(errorBuffer.rdbuf());
+    
+    Config config;
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    std::cerr.rdbuf(oldCerr);
+    
+    CHECK(!result);
+}
+
+// === 14. Тест выбора бэкенда ввода-вывода ===
+TEST(Config_ParseCommandLine_IoBackend) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--io-backend", "io_uring"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK(config.getIoBackend() == IoBackend::EPOLL); // По умолчанию
+    
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    CHECK(result);
+    CHECK(config.getIoBackend() == IoBackend::IO_URING);
+}
+
+TEST(Config_ParseCommandLine_InvalidIoBackend) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--io-backend", "kqueue"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    std::streambuf* oldCerr = std::cerr.rdbuf();
+    std::stringstream errorBuffer;
+    std::cerr.rdbuf(errorBuffer.rdbuf());
+    
+    Config config;
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    std::cerr.rdbuf(oldCerr);
+    
+    CHECK(!result);
+}
+
+TEST(Config_ParseCommandLine_KeepAliveTimeout) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--keepalive-timeout", "120"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK_EQUAL(30, config.getKeepAliveTimeout()); // По умолчанию
+    
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    CHECK(result);
+    CHECK_EQUAL(120, config.getKeepAliveTimeout());
+}
+
+TEST(Config_ParseCommandLine_FlushModes) {
+    resetGetopt();
+    
+    const char* argv[] = {
+        "testprogram",
+        "--flush", "batch,immediate",
+        "--flush-bytes", "4096",
+        "--flush-delay", "2"
+    };
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK(config.getFlushMode(0) == ResponseFlush::IMMEDIATE); // По умолчанию
+    
+    bool result = config.parseCommandLine(argc, const_cast<char**>(argv));
+    
+    CHECK(result);
+    CHECK(config.getFlushMode(0) == ResponseFlush::BATCH);
+    CHECK(config.getFlushMode(1) == ResponseFlush::IMMEDIATE);
+    CHECK(config.getFlushMode(5) == ResponseFlush::IMMEDIATE);
+    CHECK_EQUAL(4096u, config.getFlushBytes());
+    CHECK_EQUAL(2, config.getFlushDelayMs());
+}
+
+TEST(Config_ParseCommandLine_Simd) {
+    resetGetopt();
+    
+    const char* argv[] = {"testprogram", "--simd", "avx2"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    
+    Config config;
+    CHECK(config.getSimdLevel() == SimdLevel::AUTO); // По умолчанию
+    CHECK(config.parseCommandLine(argc, const_cast<char**>(argv)));
+    CHECK(config.getSimdLevel() == SimdLevel::AVX2);
+    
+    resetGetopt();
+    const char* invalid[] = {"testprogram", "--simd", "neon"};
+    Config other;
+    CHECK(!other.parseCommandLine(3, const_cast<char**>(invalid)));
+}
+
+// === 15. Тест метода showHelp (не падает) ===
 TEST(Config_ShowHelp) {
     // Перенаправляем вывод
     std::streambuf* oldCout = std::cout.rdbuf();
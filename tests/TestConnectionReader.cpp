@@ -0,0 +1,178 @@
+/**
+ * @file TestConnectionReader.cpp
+ * @brief Модульные тесты для класса ConnectionReader
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/ConnectionReader.h"
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const std::string DELIMITERS("\0 \n\r", 4);
+
+// === 1. Тест чтения строки до разделителя ===
+TEST(ConnectionReader_ReadUntil) {
+    ConnectionReader reader;
+    reader.append("user\0rest", 9);
+
+    std::string str;
+    CHECK(reader.readUntil(DELIMITERS, 32, str));
+    CHECK_EQUAL("user", str);
+    CHECK_EQUAL(4u, reader.available());
+}
+
+// === 2. Тест разделителя, пришедшего отдельной порцией ===
+TEST(ConnectionReader_ReadUntilSplitDelimiter) {
+    ConnectionReader reader;
+    reader.append("us", 2);
+
+    std::string str;
+    CHECK(!reader.readUntil(DELIMITERS, 32, str));
+    CHECK_EQUAL(2u, reader.available());
+
+    reader.append("er\n", 3);
+    CHECK(reader.readUntil(DELIMITERS, 32, str));
+    CHECK_EQUAL("user", str);
+    CHECK_EQUAL(0u, reader.available());
+}
+
+// === 3. Тест ограничения длины строки ===
+TEST(ConnectionReader_ReadUntilMaxLength) {
+    ConnectionReader reader;
+    reader.append("abcdef ", 7);
+
+    std::string str;
+    CHECK(!reader.readUntil(DELIMITERS, 5, str));
+    CHECK(reader.readUntil(DELIMITERS, 6, str));
+    CHECK_EQUAL("abcdef", str);
+}
+
+// === 4. Тест чтения точного количества байт и uint32 little-endian ===
+TEST(ConnectionReader_ReadExactAndU32) {
+    ConnectionReader reader;
+    const unsigned char bytes[] = {0x78, 0x56, 0x34, 0x12, 0x01};
+    reader.append(reinterpret_cast<const char*>(bytes), 3);
+
+    uint32_t value = 0;
+    CHECK(!reader.readU32LE(value));
+
+    reader.append(reinterpret_cast<const char*>(bytes) + 3, 2);
+    CHECK(reader.readU32LE(value));
+    CHECK_EQUAL(0x12345678u, value);
+
+    unsigned char last = 0;
+    CHECK(reader.readExact(&last, 1));
+    CHECK_EQUAL(1, last);
+    CHECK(!reader.readExact(&last, 1));
+}
+
+// === 5. Тест перехода через границу кольца ===
+TEST(ConnectionReader_Wraparound) {
+    ConnectionReader reader(16);
+    std::string str;
+
+    for (int round = 0; round < 10; round++) {
+        reader.append("0123456789", 10);
+        std::string chunk;
+        CHECK_EQUAL(10u, reader.readSome(chunk, 100));
+        CHECK_EQUAL("0123456789", chunk);
+    }
+    CHECK_EQUAL(16u, reader.capacity());
+}
+
+// === 6. Тест увеличения емкости с сохранением данных ===
+TEST(ConnectionReader_Grow) {
+    ConnectionReader reader(16);
+    reader.append("0123456789", 10);
+    std::string head;
+    reader.readSome(head, 6);
+
+    std::string large(100, 'x');
+    reader.append(large.data(), large.size());
+    CHECK(reader.capacity() >= 104u);
+
+    std::string str;
+    CHECK_EQUAL(104u, reader.readSome(str, 1000));
+    CHECK_EQUAL("6789" + large, str);
+}
+
+// === 7. Тест пропуска разделителей ===
+TEST(ConnectionReader_Skip) {
+    ConnectionReader reader;
+    reader.append("\0\n ABC", 6);
+    CHECK_EQUAL(3u, reader.skip(DELIMITERS));
+    CHECK_EQUAL(3u, reader.available());
+    CHECK_EQUAL(0u, reader.skip(DELIMITERS));
+}
+
+// === 8. Тест чтения из сокета одним вызовом ===
+TEST(ConnectionReader_FillFromSocket) {
+    int sockets[2];
+    CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+
+    ConnectionReader reader(16);
+    bool drained = false;
+
+    // Пустой сокет: EAGAIN
+    CHECK_EQUAL(-1, reader.fill(sockets[0], drained));
+    CHECK(drained);
+
+    // Данных меньше, чем места: одно короткое чтение
+    CHECK_EQUAL(5, write(sockets[1], "hello", 5));
+    CHECK_EQUAL(5, reader.fill(sockets[0], drained));
+    CHECK(drained);
+
+    // Данных больше, чем места: буфер заполнен, сокет еще не вычитан
+    CHECK_EQUAL(20, write(sockets[1], "abcdefghijklmnopqrst", 20));
+    CHECK_EQUAL(11, reader.fill(sockets[0], drained));
+    CHECK(!drained);
+    CHECK_EQUAL(9, reader.fill(sockets[0], drained));
+
+    std::string str;
+    reader.readSome(str, 100);
+    CHECK_EQUAL("helloabcdefghijklmnopqrst", str);
+
+    // Закрытие соединения
+    close(sockets[1]);
+    CHECK_EQUAL(0, reader.fill(sockets[0], drained));
+    close(sockets[0]);
+}
+
+// === 9. Тест непрерывного участка и чтения по смещению ===
+TEST(ConnectionReader_ContiguousAndPeek) {
+    ConnectionReader reader(16);
+    reader.append("0123456789AB", 12);
+    std::string head;
+    reader.readSome(head, 10);
+
+    // Данные переходят через границу кольца: "AB" в конце, "CDEFGH" в начале
+    reader.append("CDEFGH", 6);
+    size_t size = 0;
+    const char* data = reader.contiguous(size);
+    CHECK_EQUAL(6u, size);
+    CHECK_EQUAL(0, memcmp(data, "ABCDEF", 6));
+
+    uint32_t value = 0;
+    CHECK(reader.peekU32LE(4, value));
+    CHECK_EQUAL(0x48474645u, value);       // "EFGH"
+    CHECK(!reader.peekU32LE(5, value));
+    CHECK_EQUAL(8u, reader.available());
+
+    reader.discard(size);
+    data = reader.contiguous(size);
+    CHECK_EQUAL(2u, size);
+    CHECK_EQUAL(0, memcmp(data, "GH", 2));
+}
+
+int main() {
+    std::cout << "=== Тестирование ConnectionReader ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file TestMpmcQueue.cpp
+ * @brief Модульные тесты для очереди MpmcQueue
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/MpmcQueue.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// === 1. Емкость округляется до степени двойки ===
+TEST(MpmcQueue_CapacityRoundedUp) {
+    MpmcQueue<int> queue(100);
+    CHECK_EQUAL(128u, queue.capacity());
+}
+
+// === 2. Порядок FIFO в одном потоке ===
+TEST(MpmcQueue_FifoOrder) {
+    MpmcQueue<int> queue(8);
+    for (int i = 0; i < 5; i++) {
+        CHECK(queue.push(i));
+    }
+    
+    int value = -1;
+    for (int i = 0; i < 5; i++) {
+        CHECK(queue.pop(value));
+        CHECK_EQUAL(i, value);
+    }
+    CHECK(!queue.pop(value));
+}
+
+// === 3. Переполнение ===
+TEST(MpmcQueue_Full) {
+    MpmcQueue<int> queue(4);
+    for (int i = 0; i < 4; i++) {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(4));
+    
+    int value;
+    CHECK(queue.pop(value));
+    CHECK(queue.push(4));
+}
+
+// === 4. Несколько производителей и потребителей ===
+TEST(MpmcQueue_MultiThreaded) {
+    const int producers = 4;
+    const int perProducer = 20000;
+    MpmcQueue<int> queue(1024);
+    std::atomic<long long> consumedSum(0);
+    std::atomic<int> consumedCount(0);
+    
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p, perProducer]() {
+            for (int i = 1; i <= perProducer; i++) {
+                while (!queue.push(p * perProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < 4; c++) {
+        threads.emplace_back([&]() {
+            int value;
+            while (consumedCount < producers * perProducer) {
+                if (queue.pop(value)) {
+                    consumedSum += value;
+                    consumedCount++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    long long total = static_cast<long long>(producers) * perProducer;
+    CHECK_EQUAL(total, consumedCount.load());
+    CHECK_EQUAL(total * (total + 1) / 2, consumedSum.load());
+}
+
+int main() {
+    std::cout << "=== Тестирование MpmcQueue ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file TestResponseBuilder.cpp
+ * @brief Модульные тесты для класса ResponseBuilder
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/ResponseBuilder.h"
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Прочитать из сокета все доступные данные
+ */
+static std::string readAll(int socket) {
+    std::string data;
+    char buffer[65536];
+    ssize_t received;
+    while ((received = recv(socket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        data.append(buffer, received);
+    }
+    return data;
+}
+
+// === 1. Тест накопления через границу блоков ===
+TEST(ResponseBuilder_AppendAcrossBlocks) {
+    ResponseBuilder builder;
+    CHECK(builder.empty());
+
+    std::string data(ResponseBuilder::BLOCK_SIZE * 2 + 100, 'a');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+    builder.append(data.data(), 10);
+    builder.append(data.data() + 10, data.size() - 10);
+    CHECK_EQUAL(data.size(), builder.pending());
+
+    std::string taken;
+    builder.take(taken);
+    CHECK(taken == data);
+    CHECK(builder.empty());
+}
+
+// === 2. Тест отправки нескольких блоков одним вызовом ===
+TEST(ResponseBuilder_FlushSingleCall) {
+    int sockets[2];
+    CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+    ResponseBuilder builder;
+    for (int32_t i = 0; i < 3000; i++) {
+        builder.append(&i, sizeof(i));
+    }
+    CHECK(builder.flush(sockets[0]));
+    CHECK(builder.empty());
+    CHECK_EQUAL(1u, builder.getSendCalls());
+
+    std::string received = readAll(sockets[1]);
+    CHECK_EQUAL(3000u * sizeof(int32_t), received.size());
+    int32_t last = 0;
+    received.copy(reinterpret_cast<char*>(&last), sizeof(last), received.size() - sizeof(last));
+    CHECK_EQUAL(2999, last);
+
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+// === 3. Тест частичной отправки при заполненном буфере сокета ===
+TEST(ResponseBuilder_PartialFlush) {
+    int sockets[2];
+    CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+    int small = 4096;
+    setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+
+    ResponseBuilder builder;
+    std::string data(1 << 20, 'x');
+    builder.append(data.data(), data.size());
+
+    CHECK(builder.flush(sockets[0]));
+    CHECK(!builder.empty());
+
+    // Читаем и досылаем остаток, пока накопитель не опустеет
+    size_t total = 0;
+    for (int round = 0; round < 10000 && !builder.empty(); round++) {
+        total += readAll(sockets[1]).size();
+        CHECK(builder.flush(sockets[0]));
+    }
+    total += readAll(sockets[1]).size();
+    CHECK(builder.empty());
+    CHECK_EQUAL(data.size(), total);
+
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+// === 4. Тест ошибки отправки в закрытое соединение ===
+TEST(ResponseBuilder_FlushError) {
+    int sockets[2];
+    CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    close(sockets[1]);
+
+    ResponseBuilder builder;
+    builder.append("OK", 3);
+    CHECK(!builder.flush(sockets[0]));
+
+    close(sockets[0]);
+}
+
+// === 5. Тест снятия TCP_CORK при неполной отправке ===
+TEST(ResponseBuilder_UncorkOnPartialFlush) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    CHECK_EQUAL(0, bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)));
+    CHECK_EQUAL(0, listen(listener, 1));
+    getsockname(listener, reinterpret_cast<struct sockaddr*>(&address), &length);
+
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    int small = 4096;
+    setsockopt(client, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    CHECK_EQUAL(0, connect(client, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)));
+    int server = accept(listener, nullptr, nullptr);
+    fcntl(server, F_SETFL, O_NONBLOCK);
+    setsockopt(server, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+
+    // Ответ не помещается в буферы сокетов: остаток ждет готовности к записи
+    ResponseBuilder builder;
+    std::string data(4 << 20, 'x');
+    builder.append(data.data(), data.size());
+    CHECK(builder.flush(server));
+    CHECK(!builder.empty());
+
+    // Уже переданные ядру байты не ждут таймера пробки
+    int corked = 1;
+    socklen_t size = sizeof(corked);
+    CHECK_EQUAL(0, getsockopt(server, IPPROTO_TCP, TCP_CORK, &corked, &size));
+    CHECK_EQUAL(0, corked);
+
+    close(client);
+    close(server);
+    close(listener);
+}
+
+int main() {
+    std::cout << "=== Тестирование ResponseBuilder ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
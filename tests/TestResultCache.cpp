@@ -0,0 +1,157 @@
+/**
+ * @file TestResultCache.cpp
+ * @brief Модульные тесты для кэша результатов ResultCache и хеша Xxh64
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/ResultCache.h"
+#include "../src/Xxh64.h"
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static CachedResult result(uint32_t value) {
+    CachedResult cached;
+    cached.size = sizeof(value);
+    memcpy(cached.bytes, &value, sizeof(value));
+    return cached;
+}
+
+static uint32_t value(const CachedResult& cached) {
+    uint32_t stored = 0;
+    memcpy(&stored, cached.bytes, sizeof(stored));
+    return stored;
+}
+
+// === 1. Эталонные значения XXH64 ===
+TEST(Xxh64_ReferenceValues) {
+    CHECK_EQUAL(0xEF46DB3751D8E999ull, Xxh64::hash("", 0));
+    CHECK_EQUAL(0xD24EC4F1A98C6E5Bull, Xxh64::hash("a", 1));
+    CHECK_EQUAL(0x44BC2CF5AD770999ull, Xxh64::hash("abc", 3));
+    const std::string text = "Nobody inspects the spammish repetition";
+    CHECK_EQUAL(0xFBCEA83C8A378BF1ull, Xxh64::hash(text.data(), text.size()));
+    CHECK(Xxh64::hash("abc", 3, 1) != Xxh64::hash("abc", 3));
+}
+
+// === 2. Хеш не зависит от разбиения на порции ===
+TEST(Xxh64_Chunked) {
+    std::string data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(static_cast<char>(i * 7 + 3));
+    }
+    for (size_t length : {0u, 5u, 31u, 32u, 33u, 100u, 1000u}) {
+        uint64_t expected = Xxh64::hash(data.data(), length, 42);
+        for (size_t step : {1u, 3u, 32u, 45u}) {
+            Xxh64 state(42);
+            for (size_t offset = 0; offset < length; offset += step) {
+                state.update(data.data() + offset, std::min(step, length - offset));
+            }
+            CHECK_EQUAL(expected, state.digest());
+        }
+    }
+}
+
+// === 3. Поиск, замена и счетчики ===
+TEST(ResultCache_LookupAndStats) {
+    ResultCache cache(64, 4);
+    CHECK_EQUAL(64u, cache.capacity());
+
+    CachedResult found;
+    CHECK(!cache.lookup(1, found));
+    cache.insert(1, result(10));
+    cache.insert(2, result(20));
+    CHECK(cache.lookup(1, found));
+    CHECK_EQUAL(10u, value(found));
+    CHECK_EQUAL(4u, found.size);
+
+    cache.insert(1, result(11));
+    CHECK(cache.lookup(1, found));
+    CHECK_EQUAL(11u, value(found));
+
+    ResultCache::Stats stats = cache.stats();
+    CHECK_EQUAL(2u, stats.hits);
+    CHECK_EQUAL(1u, stats.misses);
+    CHECK_EQUAL(2u, stats.insertions);
+    CHECK_EQUAL(0u, stats.evictions);
+    CHECK_EQUAL(2u, stats.entries);
+}
+
+// === 4. Вытеснение CLOCK сохраняет недавно использованные записи ===
+TEST(ResultCache_ClockEviction) {
+    ResultCache cache(4, 1);
+    for (uint64_t key = 0; key < 4; key++) {
+        cache.insert(key, result(static_cast<uint32_t>(key)));
+    }
+
+    CachedResult found;
+    CHECK(cache.lookup(0, found));
+    CHECK(cache.lookup(2, found));
+    cache.insert(10, result(10));   // Вытесняет 1: у 0 был бит обращения
+    cache.insert(11, result(11));   // Вытесняет 3: у 2 был бит обращения
+
+    CHECK(cache.lookup(0, found));
+    CHECK(cache.lookup(2, found));
+    CHECK(cache.lookup(10, found));
+    CHECK(cache.lookup(11, found));
+    CHECK(!cache.lookup(1, found));
+    CHECK(!cache.lookup(3, found));
+
+    ResultCache::Stats stats = cache.stats();
+    CHECK_EQUAL(2u, stats.evictions);
+    CHECK_EQUAL(4u, stats.entries);
+}
+
+// === 5. Одновременный доступ из разных потоков ===
+TEST(ResultCache_Concurrent) {
+    ResultCache cache(1024);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t]() {
+            CachedResult found;
+            for (uint32_t i = 0; i < 20000; i++) {
+                uint64_t key = Xxh64::hash(&i, sizeof(i), static_cast<uint64_t>(t % 2));
+                if (cache.lookup(key, found)) {
+                    CHECK_EQUAL(i, value(found));
+                } else {
+                    cache.insert(key, result(i));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ResultCache::Stats stats = cache.stats();
+    CHECK_EQUAL(80000u, stats.hits + stats.misses);
+    CHECK(stats.entries <= cache.capacity());
+    CHECK_EQUAL(stats.insertions - stats.evictions, stats.entries);
+}
+
+// === 6. Ключи разных пользователей не совпадают ===
+TEST(ResultCache_ScopedKeys) {
+    ResultCache cache(64);
+    uint64_t key = Xxh64::hash("vector", 6);
+    CHECK_EQUAL(cache.scopedKey("user", key), cache.scopedKey("user", key));
+    CHECK(cache.scopedKey("user", key) != cache.scopedKey("other", key));
+    CHECK(cache.scopedKey("user", key) != cache.scopedKey("user", key + 1));
+
+    // Секрет у каждого кэша свой: ключ нельзя посчитать вне сервера
+    ResultCache another(64);
+    CHECK(cache.scopedKey("user", key) != another.scopedKey("user", key));
+
+    CachedResult result = {1, {42}};
+    cache.insert(cache.scopedKey("other", key), result);
+    CHECK(!cache.lookup(cache.scopedKey("user", key), result));
+    CHECK(cache.lookup(cache.scopedKey("other", key), result));
+}
+
+int main() {
+    std::cout << "=== Тестирование ResultCache ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,1368 @@
+/**
+ * @file TestSession.cpp
+ * @brief Модульные тесты для класса Session (протокол без сети)
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/Session.h"
+#include "../src/Authenticator.h"
+#include "../src/Protocol.h"
+#include "../src/WorkStealingPool.h"
+#include "../src/ResultCache.h"
+#include "../src/Xxh64.h"
+#include "../src/VectorStore.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Окружение теста: база с одним клиентом, журнал и пара сокетов
+ *
+ * Байты передаются сеансу через deliver(), ответ забирается takeOutput(),
+ * поэтому сокет нужен только как дескриптор, который закроет сеанс.
+ */
+struct SessionFixture {
+    Database database;
+    Logger logger;
+    int peerSocket;
+    int sessionSocket;
+
+    SessionFixture() : logger("test_session.log"), peerSocket(-1), sessionSocket(-1) {
+        std::ofstream file("test_session.db");
+        file << "user:P@ssW0rd\n";
+        file.close();
+        database.loadFromFile("test_session.db");
+
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0) {
+            sessionSocket = sockets[0];
+            peerSocket = sockets[1];
+        }
+    }
+
+    ~SessionFixture() {
+        close(peerSocket);
+        std::remove("test_session.db");
+    }
+};
+
+static void deliver(Session& session, const std::string& bytes) {
+    session.deliver(bytes.data(), bytes.size());
+}
+
+static std::string takeOutput(Session& session) {
+    std::string output;
+    session.takeOutput(output);
+    return output;
+}
+
+static std::string u32(uint32_t value) {
+    return std::string(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static std::string vector(const std::vector<int32_t>& values) {
+    std::string bytes = u32(static_cast<uint32_t>(values.size()));
+    bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int32_t));
+    return bytes;
+}
+
+static std::string extendedHeader(uint32_t control, uint32_t numVectors) {
+    return u32(Protocol::BATCH_MAGIC) + u32(control) + u32(numVectors);
+}
+
+static std::string storeCommand(uint32_t command, const std::string& name) {
+    return u32(command) + u32(static_cast<uint32_t>(name.size())) + name;
+}
+
+static std::vector<int32_t> results(const std::string& output) {
+    std::vector<int32_t> values(output.size() / sizeof(int32_t));
+    memcpy(values.data(), output.data(), values.size() * sizeof(int32_t));
+    return values;
+}
+
+/**
+ * @brief Пройти аутентификацию
+ * @return true - сервер ответил OK
+ */
+static bool authenticate(Session& session) {
+    deliver(session, std::string("user", 5));
+    std::string salt = takeOutput(session);
+    if (salt.size() != 16) {
+        return false;
+    }
+    deliver(session, Authenticator::calculateSHA256(salt, "P@ssW0rd"));
+    return takeOutput(session) == std::string("OK", 3);
+}
+
+// === 1. Тест прежнего формата: один пакет, затем закрытие ===
+TEST(Session_LegacyBatch) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    deliver(session, u32(2) + vector({1, 2, 3}) + vector({2147483647, 1, -5}));
+
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(2u, sums.size());
+    CHECK_EQUAL(6, sums[0]);
+    CHECK_EQUAL(2147483647, sums[1]);
+    CHECK(session.isClosing());
+}
+
+// === 2. Тест режима keep-alive: несколько пакетов и маркер конца ===
+TEST(Session_KeepAliveBatches) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    for (int32_t batch = 0; batch < 3; batch++) {
+        deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE, 1) + vector({batch, 10}));
+        std::vector<int32_t> sums = results(takeOutput(session));
+        CHECK_EQUAL(1u, sums.size());
+        CHECK_EQUAL(batch + 10, sums[0]);
+        CHECK(session.getState() == Session::State::NEXT_BATCH);
+    }
+
+    deliver(session, u32(Protocol::END_OF_SESSION));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 3. Тест пакетов, пришедших одним сегментом, и побайтовой доставки ===
+TEST(Session_KeepAlivePipelinedAndSplit) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string stream = extendedHeader(Protocol::FLAG_KEEP_ALIVE, 1) + vector({1}) +
+                         extendedHeader(Protocol::FLAG_KEEP_ALIVE, 2) + vector({2}) + vector({3}) +
+                         extendedHeader(0, 1) + vector({4});
+    for (char byte : stream) {
+        deliver(session, std::string(1, byte));
+    }
+
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(4u, sums.size());
+    CHECK_EQUAL(1, sums[0]);
+    CHECK_EQUAL(4, sums[3]);
+    // Последний пакет без флага keep-alive завершает сеанс
+    CHECK(session.isClosing());
+}
+
+// === 4. Тест некорректного слова управления ===
+TEST(Session_InvalidControlWord) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Неизвестная политика переполнения
+    deliver(session, extendedHeader(0xFFu << Protocol::POLICY_SHIFT, 1) + vector({1}));
+
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 5. Тест: после пакета keep-alive допустим только новый заголовок ===
+TEST(Session_KeepAliveRejectsLegacyCount) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE, 1) + vector({5}));
+    CHECK_EQUAL(1u, results(takeOutput(session)).size());
+
+    deliver(session, u32(1) + vector({5}));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 6. Тест таймаутов: между пакетами действует таймаут keep-alive ===
+TEST(Session_KeepAliveTimeout) {
+    SessionFixture fixture;
+    SessionOptions options;
+    options.keepAliveTimeoutSec = 60;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    time_t now = time(nullptr);
+    CHECK(session.isTimedOut(now + Session::IDLE_TIMEOUT_SEC));
+
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE, 1) + vector({5}));
+    now = time(nullptr);
+    CHECK(!session.isTimedOut(now + Session::IDLE_TIMEOUT_SEC));
+    CHECK(session.isTimedOut(now + 60));
+}
+
+// === 7. Тест разделителя логина, пришедшего отдельным сегментом ===
+TEST(Session_LoginDelimiterInLaterSegment) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+
+    // Логин без разделителя принят, затем приходит запоздавший '\0'
+    deliver(session, "user");
+    std::string salt = takeOutput(session);
+    CHECK_EQUAL(16u, salt.size());
+
+    deliver(session, std::string(1, '\0'));
+    deliver(session, Authenticator::calculateSHA256(salt, "P@ssW0rd").substr(0, 30));
+    CHECK(!session.hasOutput());
+    deliver(session, Authenticator::calculateSHA256(salt, "P@ssW0rd").substr(30));
+    CHECK(takeOutput(session) == std::string("OK", 3));
+}
+
+// === 8. Тест неизвестного логина без разделителя ===
+TEST(Session_UnknownLoginWithoutDelimiter) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+
+    // Как и прежний сервер, отвечаем ERR сразу, а не по таймауту
+    deliver(session, "us");
+    CHECK(takeOutput(session) == std::string("ERR", 4));
+    CHECK(session.isClosing());
+}
+
+// === 9. Тест режима BATCH: ответы уходят в конце пакета ===
+TEST(Session_BatchFlushAtBatchEnd) {
+    SessionFixture fixture;
+    SessionOptions options;
+    options.flushMode = ResponseFlush::BATCH;
+    options.flushDelayMs = 1000;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE, 3) + vector({1}) + vector({2}));
+    CHECK(!session.hasOutput());
+    CHECK(session.hasDeferredOutput());
+
+    deliver(session, vector({3}));
+    CHECK(session.hasOutput());
+    CHECK_EQUAL(3u, results(takeOutput(session)).size());
+}
+
+// === 10. Тест порогов размера и задержки в режиме BATCH ===
+TEST(Session_BatchFlushThresholds) {
+    SessionFixture fixture;
+    SessionOptions options;
+    options.flushMode = ResponseFlush::BATCH;
+    options.flushBytes = 8;
+    options.flushDelayMs = 50;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    // Порог размера: два результата по 4 байта
+    deliver(session, u32(4) + vector({1}));
+    CHECK(!session.hasOutput());
+    deliver(session, vector({2}));
+    CHECK(session.hasOutput());
+    CHECK_EQUAL(2u, results(takeOutput(session)).size());
+
+    // Порог задержки
+    deliver(session, vector({3}));
+    auto now = std::chrono::steady_clock::now();
+    CHECK(!session.pollFlushDeadline(now));
+    CHECK(session.pollFlushDeadline(now + std::chrono::milliseconds(50)));
+    CHECK_EQUAL(1u, results(takeOutput(session)).size());
+}
+
+// === 11. Тест повторного использования буферов между пакетами ===
+TEST(Session_BufferReuseAcrossBatches) {
+    SessionFixture fixture;
+    VectorStore store(1 << 20);
+    SessionOptions options;
+    options.store = &store;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    const uint32_t keep = Protocol::FLAG_KEEP_ALIVE;
+    std::string vectors = vector(std::vector<int32_t>(1000, 1)) +
+                          vector(std::vector<int32_t>(500, 2)) +
+                          vector(std::vector<int32_t>(1000, 3));
+    std::string batch = extendedHeader(keep, 3) + vectors;
+    // Пакеты, значения которых копятся в буферах сеанса
+    std::string buffered = extendedHeader(keep | Protocol::FLAG_PARALLEL, 3) + vectors +
+        extendedHeader(keep | (Protocol::OP_COLUMN_SUM << Protocol::OPCODE_SHIFT), 2) +
+            vector(std::vector<int32_t>(1000, 1)) + vector(std::vector<int32_t>(1000, 2)) +
+        extendedHeader(keep | (Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT), 1) +
+            vector(std::vector<int32_t>(1000, 1)) +
+        extendedHeader(keep | Protocol::FLAG_STORE, 1) +
+            storeCommand(Protocol::STORE_CREATE, "reuse") + vector(std::vector<int32_t>(1000, 4));
+
+    // Значения суммируются прямо в буфере приема
+    deliver(session, batch);
+    CHECK_EQUAL(3u, results(takeOutput(session)).size());
+    CHECK_EQUAL(0u, session.getBufferAllocations());
+
+    deliver(session, buffered);
+    takeOutput(session);
+    uint64_t allocations = session.getBufferAllocations();
+    CHECK(allocations > 0);
+
+    for (int round = 0; round < 5; round++) {
+        deliver(session, batch);
+        std::vector<int32_t> sums = results(takeOutput(session));
+        CHECK_EQUAL(3u, sums.size());
+        CHECK_EQUAL(1000, sums[1]);
+
+        deliver(session, buffered);
+        CHECK(!takeOutput(session).empty());
+    }
+    // В установившемся режиме буферы не выделяются заново
+    CHECK_EQUAL(allocations, session.getBufferAllocations());
+}
+
+// === 12. Тест потокового режима без ограничений размера ===
+TEST(Session_StreamingLargeVectors) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Вектор больше MAX_VECTOR_SIZE и нескольких фрагментов, затем насыщение
+    std::vector<int32_t> large(10000, 3);
+    std::vector<int32_t> saturating(9000, 1);
+    saturating[5000] = INT_MAX;
+    saturating[8000] = INT_MIN;
+
+    std::string stream = extendedHeader(Protocol::FLAG_STREAMING, 2) +
+                         vector(large) + vector(saturating);
+    // Порции, не кратные размеру элемента
+    for (size_t offset = 0; offset < stream.size(); offset += 4099) {
+        deliver(session, stream.substr(offset, 4099));
+    }
+
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(2u, sums.size());
+    CHECK_EQUAL(30000, sums[0]);
+    CHECK_EQUAL(INT_MAX, sums[1]);
+    CHECK(session.isClosing());
+}
+
+TEST(Session_StreamingRejectsHashRefSize) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Размер HASH_REF зарезервирован за ссылкой FLAG_CACHED и длиной не бывает
+    deliver(session, extendedHeader(Protocol::FLAG_STREAMING, 1) + u32(Protocol::HASH_REF) +
+                     vector({1, 2}));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+TEST(Session_StreamingManyVectors) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string stream = extendedHeader(Protocol::FLAG_STREAMING, 250);
+    for (int32_t i = 0; i < 250; i++) {
+        stream += vector({i, 1});
+    }
+    deliver(session, stream);
+
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(250u, sums.size());
+    CHECK_EQUAL(250, sums[249]);
+}
+
+// === 13. Тест готовности результата сразу после последнего байта ===
+TEST(Session_ResultReadyOnLastByte) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string batch = u32(1) + vector(std::vector<int32_t>(1000, 7));
+    deliver(session, batch.substr(0, batch.size() - 1));
+    CHECK(!session.hasOutput());
+
+    deliver(session, batch.substr(batch.size() - 1));
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(1u, sums.size());
+    CHECK_EQUAL(7000, sums[0]);
+}
+
+// === 14. Тест политик переполнения ===
+TEST(Session_OverflowPolicies) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string data = vector({INT_MAX, 1, -5}) + vector({1, 2});
+
+    // Сумма по модулю 2^32
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::POLICY_WRAP << Protocol::POLICY_SHIFT), 2) + data);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(2u, sums.size());
+    CHECK_EQUAL(INT_MAX - 4, sums[0]);      // Без насыщения на префиксе
+    CHECK_EQUAL(3, sums[1]);
+
+    // Точная сумма, 8 байт на вектор
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::POLICY_INT64 << Protocol::POLICY_SHIFT), 2) + data);
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(16u, output.size());
+    int64_t wide[2];
+    memcpy(wide, output.data(), sizeof(wide));
+    CHECK_EQUAL(static_cast<int64_t>(INT_MAX) - 4, wide[0]);
+    CHECK_EQUAL(3, wide[1]);
+
+    // Статус переполнения перед суммой
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::POLICY_ERROR << Protocol::POLICY_SHIFT), 2) + data);
+    output = takeOutput(session);
+    CHECK_EQUAL(10u, output.size());
+    int32_t value = 0;
+    CHECK_EQUAL(Protocol::STATUS_OVERFLOW, static_cast<uint8_t>(output[0]));
+    memcpy(&value, output.data() + 1, sizeof(value));
+    CHECK_EQUAL(INT_MAX, value);
+    CHECK_EQUAL(Protocol::STATUS_OK, static_cast<uint8_t>(output[5]));
+    memcpy(&value, output.data() + 6, sizeof(value));
+    CHECK_EQUAL(3, value);
+
+    // Неизвестная политика завершает сеанс
+    deliver(session, extendedHeader(4u << Protocol::POLICY_SHIFT, 1) + vector({1}));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 15. Тест операций свертки ===
+TEST(Session_ReduceOperations) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string data = vector({3, -7, 0, INT_MIN, 5}) + vector({3, 4});
+    struct {
+        uint32_t opcode;
+        size_t size;        // Размер ответа на вектор
+    } cases[] = {
+        {Protocol::OP_MIN, 4}, {Protocol::OP_MAX, 4}, {Protocol::OP_MEAN, 8},
+        {Protocol::OP_L1, 8}, {Protocol::OP_L2, 8}, {Protocol::OP_COUNT_NZ, 8}
+    };
+
+    std::string outputs[7];
+    for (const auto& item : cases) {
+        deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                        (item.opcode << Protocol::OPCODE_SHIFT), 2) + data);
+        outputs[item.opcode] = takeOutput(session);
+        CHECK_EQUAL(2 * item.size, outputs[item.opcode].size());
+    }
+
+    std::vector<int32_t> values = results(outputs[Protocol::OP_MIN]);
+    CHECK_EQUAL(INT_MIN, values[0]);
+    CHECK_EQUAL(3, values[1]);
+    values = results(outputs[Protocol::OP_MAX]);
+    CHECK_EQUAL(5, values[0]);
+    CHECK_EQUAL(4, values[1]);
+
+    double real[2];
+    memcpy(real, outputs[Protocol::OP_MEAN].data(), sizeof(real));
+    CHECK_CLOSE((1.0 + INT_MIN) / 5, real[0], 1e-6);
+    CHECK_CLOSE(3.5, real[1], 1e-12);
+    memcpy(real, outputs[Protocol::OP_L2].data(), sizeof(real));
+    CHECK_CLOSE(5.0, real[1], 1e-12);
+
+    uint64_t counts[2];
+    memcpy(counts, outputs[Protocol::OP_L1].data(), sizeof(counts));
+    CHECK_EQUAL(15u + 2147483648u, counts[0]);
+    CHECK_EQUAL(7u, counts[1]);
+    memcpy(counts, outputs[Protocol::OP_COUNT_NZ].data(), sizeof(counts));
+    CHECK_EQUAL(4u, counts[0]);
+    CHECK_EQUAL(2u, counts[1]);
+
+    // Политика переполнения допустима только для суммы
+    deliver(session, extendedHeader((Protocol::OP_MAX << Protocol::OPCODE_SHIFT) |
+                                    (Protocol::POLICY_WRAP << Protocol::POLICY_SHIFT), 1) +
+                     vector({1}));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 16. Тест неизвестной операции ===
+TEST(Session_UnknownOperation) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    deliver(session, extendedHeader((Protocol::MAX_OPCODE + 1) << Protocol::OPCODE_SHIFT, 1) +
+                     vector({1}));
+
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 17. Тест типов элементов ===
+TEST(Session_ElementTypes) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // int16: вдвое меньше байт на элемент, ответ как для int32
+    std::vector<int16_t> narrow = {30000, 30000, -5, 7};
+    std::string data = u32(static_cast<uint32_t>(narrow.size())) +
+        std::string(reinterpret_cast<const char*>(narrow.data()), narrow.size() * sizeof(int16_t));
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::TYPE_INT16 << Protocol::TYPE_SHIFT), 1) + data);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(1u, sums.size());
+    CHECK_EQUAL(60002, sums[0]);
+
+    // int64: минимум передается 8 байтами
+    std::vector<int64_t> wide = {INT64_MAX, -(int64_t(1) << 40), 5};
+    data = u32(static_cast<uint32_t>(wide.size())) +
+        std::string(reinterpret_cast<const char*>(wide.data()), wide.size() * sizeof(int64_t));
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::OP_MIN << Protocol::OPCODE_SHIFT) |
+                                    (Protocol::TYPE_INT64 << Protocol::TYPE_SHIFT), 1) + data);
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(8u, output.size());
+    int64_t minimum = 0;
+    memcpy(&minimum, output.data(), sizeof(minimum));
+    CHECK_EQUAL(-(int64_t(1) << 40), minimum);
+
+    // float32: сумма с компенсацией, ответ float64
+    std::vector<float> real = {0.5f, 0.25f, -2.0f};
+    data = u32(static_cast<uint32_t>(real.size())) +
+        std::string(reinterpret_cast<const char*>(real.data()), real.size() * sizeof(float));
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::TYPE_FLOAT32 << Protocol::TYPE_SHIFT), 1) + data);
+    output = takeOutput(session);
+    CHECK_EQUAL(8u, output.size());
+    double sum = 0;
+    memcpy(&sum, output.data(), sizeof(sum));
+    CHECK_EQUAL(-1.25, sum);
+
+    // Политика переполнения для вещественной суммы не задается
+    deliver(session, extendedHeader((Protocol::POLICY_WRAP << Protocol::POLICY_SHIFT) |
+                                    (Protocol::TYPE_FLOAT64 << Protocol::TYPE_SHIFT), 1));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 18. Тест неизвестного типа элементов ===
+TEST(Session_UnknownElementType) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    deliver(session, extendedHeader((Protocol::MAX_TYPE + 1) << Protocol::TYPE_SHIFT, 1) +
+                     vector({1}));
+
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 19. Тест параллельной обработки пакета ===
+TEST(Session_ParallelBatch) {
+    SessionFixture fixture;
+    WorkStealingPool pool(2);
+    SessionOptions options;
+    options.pool = &pool;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    // Большой вектор делится на фрагменты, насыщение внутри одного из них
+    std::vector<int32_t> large(3 * VectorProcessor::PARALLEL_CHUNK_ELEMENTS, 1);
+    large[100000] = INT_MAX;
+    large[150000] = INT_MIN;
+    uint32_t control = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_STREAMING |
+                       Protocol::FLAG_PARALLEL;
+    std::string stream = extendedHeader(control, 3) +
+                         vector({1, 2, 3}) + vector(large) + vector({INT_MAX, 1, -5});
+    // Порции, не кратные размеру элемента; ответ только после всего пакета
+    for (size_t offset = 0; offset < stream.size(); offset += 4099) {
+        CHECK(!session.hasOutput());
+        deliver(session, stream.substr(offset, 4099));
+    }
+
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(3u, sums.size());
+    CHECK_EQUAL(6, sums[0]);
+    CHECK_EQUAL(INT_MAX, sums[1]);          // Насыщение не снимается
+    CHECK_EQUAL(INT_MAX, sums[2]);
+
+    // Следующий пакет в том же сеансе, с другой политикой
+    deliver(session, extendedHeader(Protocol::FLAG_PARALLEL |
+                                    (Protocol::POLICY_WRAP << Protocol::POLICY_SHIFT), 1) +
+                     vector({INT_MAX, 1, -5}));
+    sums = results(takeOutput(session));
+    CHECK_EQUAL(1u, sums.size());
+    CHECK_EQUAL(INT_MAX - 4, sums[0]);
+    CHECK(session.isClosing());
+}
+
+TEST(Session_ParallelRequiresInt32Sum) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    deliver(session, extendedHeader(Protocol::FLAG_PARALLEL |
+                                    (Protocol::OP_MAX << Protocol::OPCODE_SHIFT), 1) +
+                     vector({1}));
+
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 20. Тест матричных операций ===
+
+/**
+ * @brief Разобрать ответ матричной операции: количество, затем int64
+ */
+static std::vector<int64_t> matrixResult(const std::string& output) {
+    uint32_t count = 0;
+    if (output.size() < sizeof(count)) {
+        return std::vector<int64_t>();
+    }
+    memcpy(&count, output.data(), sizeof(count));
+    std::vector<int64_t> values(count);
+    if (output.size() != sizeof(count) + count * sizeof(int64_t)) {
+        return std::vector<int64_t>();
+    }
+    memcpy(values.data(), output.data() + sizeof(count), count * sizeof(int64_t));
+    return values;
+}
+
+TEST(Session_MatrixOperations) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::string rows = vector({1, 2, 3}) + vector({4, 5, 6}) + vector({INT_MAX, INT_MAX, -1});
+
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::OP_COLUMN_SUM << Protocol::OPCODE_SHIFT), 3) + rows);
+    std::vector<int64_t> values = matrixResult(takeOutput(session));
+    CHECK_EQUAL(3u, values.size());
+    CHECK_EQUAL(5 + static_cast<int64_t>(INT_MAX), values[0]);
+    CHECK_EQUAL(7 + static_cast<int64_t>(INT_MAX), values[1]);
+    CHECK_EQUAL(8, values[2]);
+
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE |
+                                    (Protocol::OP_DOT << Protocol::OPCODE_SHIFT), 2) +
+                     vector({1, 2, 3}) + vector({4, 5, 6}));
+    values = matrixResult(takeOutput(session));
+    CHECK_EQUAL(3u, values.size());
+    CHECK_EQUAL(14, values[0]);
+    CHECK_EQUAL(32, values[1]);
+    CHECK_EQUAL(77, values[2]);
+
+    // Первый вектор - множитель; побайтовая доставка
+    std::string stream = extendedHeader(Protocol::OP_MATVEC << Protocol::OPCODE_SHIFT, 4) +
+                         vector({1, 0, -1}) + rows;
+    for (char byte : stream) {
+        deliver(session, std::string(1, byte));
+    }
+    values = matrixResult(takeOutput(session));
+    CHECK_EQUAL(3u, values.size());
+    CHECK_EQUAL(-2, values[0]);
+    CHECK_EQUAL(-2, values[1]);
+    CHECK_EQUAL(static_cast<int64_t>(INT_MAX) + 1, values[2]);
+    CHECK(session.isClosing());
+
+}
+
+TEST(Session_MatrixLongResult) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Ответ длиннее одной порции перевода в little-endian
+    std::vector<int32_t> row(3 * Session::MATRIX_CHUNK_VALUES + 7);
+    for (size_t k = 0; k < row.size(); k++) {
+        row[k] = static_cast<int32_t>(k);
+    }
+    deliver(session, extendedHeader((Protocol::OP_COLUMN_SUM << Protocol::OPCODE_SHIFT) |
+                                    Protocol::FLAG_STREAMING, 2) + vector(row) + vector(row));
+    std::vector<int64_t> values = matrixResult(takeOutput(session));
+    CHECK_EQUAL(row.size(), values.size());
+    if (values.size() == row.size()) {
+        CHECK_EQUAL(0, values[0]);
+        CHECK_EQUAL(2 * static_cast<int64_t>(row.size() - 1), values.back());
+    }
+}
+
+TEST(Session_MatrixRejectsInvalidBatch) {
+    const std::string batches[] = {
+        // Векторы разной длины
+        extendedHeader(Protocol::OP_COLUMN_SUM << Protocol::OPCODE_SHIFT, 2) +
+            vector({1, 2}) + vector({1}),
+        // Произведение без строк матрицы
+        extendedHeader(Protocol::OP_MATVEC << Protocol::OPCODE_SHIFT, 1) + vector({1}),
+        // Только int32
+        extendedHeader((Protocol::OP_DOT << Protocol::OPCODE_SHIFT) |
+                       (Protocol::TYPE_INT64 << Protocol::TYPE_SHIFT), 1) + vector({1, 0}),
+        // Слишком много векторов для попарных произведений
+        extendedHeader((Protocol::OP_DOT << Protocol::OPCODE_SHIFT) | Protocol::FLAG_STREAMING,
+                       Protocol::MAX_GRAM_VECTORS + 1),
+        // Слишком много произведений для потока сеанса (пула нет)
+        extendedHeader((Protocol::OP_DOT << Protocol::OPCODE_SHIFT) | Protocol::FLAG_STREAMING,
+                       Protocol::MAX_GRAM_VECTORS) + u32(512)
+    };
+
+    for (const std::string& batch : batches) {
+        SessionFixture fixture;
+        Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+        CHECK(authenticate(session));
+
+        deliver(session, batch);
+        CHECK(session.isClosing());
+        CHECK(!session.hasOutput());
+    }
+}
+
+// === 21. Тест операций преобразования ===
+
+/**
+ * @brief Разобрать ответы преобразования: длина, затем элементы int32
+ */
+static std::vector<std::vector<int32_t>> transformResults(const std::string& output) {
+    std::vector<std::vector<int32_t>> vectors;
+    size_t offset = 0;
+    while (offset + sizeof(uint32_t) <= output.size()) {
+        uint32_t count;
+        memcpy(&count, output.data() + offset, sizeof(count));
+        offset += sizeof(count);
+        std::vector<int32_t> values(count);
+        if (offset + count * sizeof(int32_t) > output.size()) {
+            break;
+        }
+        memcpy(values.data(), output.data() + offset, count * sizeof(int32_t));
+        offset += count * sizeof(int32_t);
+        vectors.push_back(values);
+    }
+    return vectors;
+}
+
+TEST(Session_TransformOperations) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    const uint32_t keep = Protocol::FLAG_KEEP_ALIVE;
+    deliver(session, extendedHeader(keep | (Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT), 2) +
+                     vector({1, 2, 3}) + vector({INT_MAX, 1, -5}));
+    std::vector<std::vector<int32_t>> vectors = transformResults(takeOutput(session));
+    CHECK_EQUAL(2u, vectors.size());
+    CHECK(vectors[0] == std::vector<int32_t>({1, 3, 6}));
+    CHECK(vectors[1] == std::vector<int32_t>({INT_MAX, INT_MAX, INT_MAX}));
+
+    // Операнд - первый вектор, ответа на него нет
+    deliver(session, extendedHeader(keep | (Protocol::OP_ADD << Protocol::OPCODE_SHIFT) |
+                                    (Protocol::POLICY_WRAP << Protocol::POLICY_SHIFT), 3) +
+                     vector({10, 20, INT_MAX}) + vector({1, 2, 1}) + vector({-10, -20, 0}));
+    vectors = transformResults(takeOutput(session));
+    CHECK_EQUAL(2u, vectors.size());
+    CHECK(vectors[0] == std::vector<int32_t>({11, 22, INT_MIN}));
+    CHECK(vectors[1] == std::vector<int32_t>({0, 0, INT_MAX}));
+
+    deliver(session, extendedHeader(keep | (Protocol::OP_SCALE << Protocol::OPCODE_SHIFT), 2) +
+                     vector({-2}) + vector({1, -3, INT_MAX}));
+    vectors = transformResults(takeOutput(session));
+    CHECK_EQUAL(1u, vectors.size());
+    CHECK(vectors[0] == std::vector<int32_t>({-2, 6, INT_MIN}));
+
+    deliver(session, extendedHeader(keep | (Protocol::OP_CLAMP << Protocol::OPCODE_SHIFT), 2) +
+                     vector({-5, 5}) + vector({-100, 0, 3, 100}));
+    vectors = transformResults(takeOutput(session));
+    CHECK_EQUAL(1u, vectors.size());
+    CHECK(vectors[0] == std::vector<int32_t>({-5, 0, 3, 5}));
+
+    // Элементы int64 без потерь
+    deliver(session, extendedHeader((Protocol::OP_SCALE << Protocol::OPCODE_SHIFT) |
+                                    (Protocol::POLICY_INT64 << Protocol::POLICY_SHIFT), 2) +
+                     vector({INT_MIN}) + vector({INT_MIN, 1}));
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(sizeof(uint32_t) + 2 * sizeof(int64_t), output.size());
+    int64_t wide[2];
+    memcpy(wide, output.data() + sizeof(uint32_t), sizeof(wide));
+    CHECK_EQUAL(static_cast<int64_t>(INT_MIN) * INT_MIN, wide[0]);
+    CHECK_EQUAL(static_cast<int64_t>(INT_MIN), wide[1]);
+    CHECK(session.isClosing());
+}
+
+TEST(Session_TransformStreamsOutput) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Результат начала вектора готов до приема его конца
+    std::string header = extendedHeader(Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT, 1);
+    std::string data = vector(std::vector<int32_t>(1000, 1));
+    size_t split = sizeof(uint32_t) + 500 * sizeof(int32_t) + 1;
+    deliver(session, header + data.substr(0, split));
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(sizeof(uint32_t) + 500 * sizeof(int32_t), output.size());
+
+    deliver(session, data.substr(split));
+    output += takeOutput(session);
+    std::vector<std::vector<int32_t>> vectors = transformResults(output);
+    CHECK_EQUAL(1u, vectors.size());
+    CHECK_EQUAL(1000u, vectors[0].size());
+    CHECK_EQUAL(1000, vectors[0][999]);
+    CHECK(session.isClosing());
+}
+
+TEST(Session_TransformOutputBounded) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Ответ в 4 раза больше порога: разбор останавливается, пока ответ не заберут
+    const size_t count = Session::OUTPUT_HIGH_WATER;
+    deliver(session, extendedHeader(Protocol::FLAG_STREAMING |
+                                    (Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT), 1) +
+                     vector(std::vector<int32_t>(count, 1)));
+
+    std::string output;
+    size_t rounds = 0;
+    while (!session.isFinished() && rounds < 100) {
+        std::string part = takeOutput(session);
+        CHECK(part.size() <= Session::OUTPUT_HIGH_WATER +
+                             Session::TRANSFORM_CHUNK_ELEMENTS * sizeof(int32_t));
+        output += part;
+        session.resume();
+        rounds++;
+    }
+    CHECK(rounds >= 4);
+
+    std::vector<std::vector<int32_t>> vectors = transformResults(output);
+    CHECK_EQUAL(1u, vectors.size());
+    CHECK_EQUAL(count, vectors[0].size());
+    CHECK_EQUAL(static_cast<int32_t>(count), vectors[0].back());
+}
+
+TEST(Session_TransformRejectsInvalidBatch) {
+    const std::string batches[] = {
+        // Политика с признаком переполнения
+        extendedHeader((Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT) |
+                       (Protocol::POLICY_ERROR << Protocol::POLICY_SHIFT), 1) + vector({1}),
+        // Слагаемое другой длины
+        extendedHeader(Protocol::OP_ADD << Protocol::OPCODE_SHIFT, 2) +
+            vector({1, 2}) + vector({1}),
+        // Диапазон с low > high
+        extendedHeader(Protocol::OP_CLAMP << Protocol::OPCODE_SHIFT, 2) +
+            vector({5, -5}) + vector({1}),
+        // Операнд без векторов
+        extendedHeader(Protocol::OP_SCALE << Protocol::OPCODE_SHIFT, 1) + vector({2})
+    };
+
+    for (const std::string& batch : batches) {
+        SessionFixture fixture;
+        Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+        CHECK(authenticate(session));
+
+        deliver(session, batch);
+        CHECK(session.isClosing());
+        CHECK(!session.hasOutput());
+    }
+}
+
+// === 22. Тест разреженных векторов ===
+
+/**
+ * @brief Разреженный вектор int32 в кодировке COO
+ */
+static std::string cooVector(uint32_t size, const std::vector<uint32_t>& indices,
+                             const std::vector<int32_t>& values) {
+    std::string bytes = u32(size) + u32(Protocol::ENC_COO) +
+                        u32(static_cast<uint32_t>(values.size()));
+    for (uint32_t index : indices) bytes += u32(index);
+    bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int32_t));
+    return bytes;
+}
+
+/**
+ * @brief Разреженный вектор int32 в кодировке битовой маски
+ */
+static std::string bitmapVector(uint32_t size, const std::string& mask, uint32_t nnz,
+                                const std::vector<int32_t>& values) {
+    std::string bytes = u32(size) + u32(Protocol::ENC_BITMAP) + u32(nnz) + mask;
+    bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int32_t));
+    return bytes;
+}
+
+TEST(Session_SparseVectors) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    const uint32_t sparse = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_SPARSE;
+    // Кодировки смешиваются в одном пакете; длинный вектор - в потоковом режиме
+    std::string batch = extendedHeader(sparse | Protocol::FLAG_STREAMING, 3) +
+        cooVector(1000000, {5, 70000, 999999}, {7, -2, 10}) +
+        bitmapVector(10, std::string("\x05\x02", 2), 3, {1, 2, 3}) +
+        u32(2) + u32(Protocol::ENC_DENSE) + u32(2) + vector({4, 5}).substr(sizeof(uint32_t));
+    deliver(session, batch);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(3u, sums.size());
+    CHECK_EQUAL(15, sums[0]);
+    CHECK_EQUAL(6, sums[1]);
+    CHECK_EQUAL(9, sums[2]);
+
+    // Побайтовая доставка
+    for (char byte : batch) {
+        deliver(session, std::string(1, byte));
+    }
+    CHECK(results(takeOutput(session)) == sums);
+
+    // Неявные нули участвуют в минимуме и среднем; вектор без значений
+    deliver(session, extendedHeader(sparse | (Protocol::OP_MIN << Protocol::OPCODE_SHIFT), 2) +
+                     cooVector(4, {1, 2}, {3, 8}) + cooVector(4, {}, {}));
+    sums = results(takeOutput(session));
+    CHECK_EQUAL(2u, sums.size());
+    CHECK_EQUAL(0, sums[0]);
+    CHECK_EQUAL(0, sums[1]);
+    deliver(session, extendedHeader(sparse | (Protocol::OP_MEAN << Protocol::OPCODE_SHIFT), 1) +
+                     cooVector(8, {0, 7}, {6, 10}));
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(sizeof(double), output.size());
+    double mean = 0;
+    memcpy(&mean, output.data(), sizeof(mean));
+    CHECK_EQUAL(2.0, mean);
+
+    // Другие типы элементов
+    std::vector<double> real = {0.5, -1.5};
+    std::string data = u32(5) + u32(Protocol::ENC_COO) + u32(2) + u32(1) + u32(3) +
+        std::string(reinterpret_cast<const char*>(real.data()), real.size() * sizeof(double));
+    deliver(session, extendedHeader(sparse | (Protocol::TYPE_FLOAT64 << Protocol::TYPE_SHIFT), 1) +
+                     data);
+    output = takeOutput(session);
+    CHECK_EQUAL(sizeof(double), output.size());
+    double sum = 0;
+    memcpy(&sum, output.data(), sizeof(sum));
+    CHECK_EQUAL(-1.0, sum);
+}
+
+TEST(Session_SparseRejectsInvalidVector) {
+    const uint32_t sum = Protocol::FLAG_SPARSE;
+    const std::string cases[] = {
+        // Индексы не возрастают, повторяются или выходят за длину
+        extendedHeader(sum, 1) + cooVector(10, {4, 2}, {1, 1}),
+        extendedHeader(sum, 1) + cooVector(10, {3, 3}, {1, 1}),
+        extendedHeader(sum, 1) + cooVector(10, {10}, {1}),
+        // Количество единиц маски не совпадает с nnz, лишние биты маски
+        extendedHeader(sum, 1) + bitmapVector(10, std::string("\x07\x00", 2), 2, {1, 1}),
+        extendedHeader(sum, 1) + bitmapVector(10, std::string("\x01\x04", 2), 2, {1, 1}),
+        // Неизвестная кодировка, nnz больше длины, плотный вектор с nnz != size
+        extendedHeader(sum, 1) + u32(2) + u32(Protocol::MAX_ENCODING + 1) + u32(2),
+        extendedHeader(sum, 1) + cooVector(1, {0, 1}, {1, 1}),
+        extendedHeader(sum, 1) + u32(2) + u32(Protocol::ENC_DENSE) + u32(1),
+        // Флаг допустим только для сверток и не вместе с FLAG_PARALLEL
+        extendedHeader(sum | (Protocol::OP_DOT << Protocol::OPCODE_SHIFT), 1),
+        extendedHeader(sum | Protocol::FLAG_PARALLEL, 1)
+    };
+
+    for (const std::string& request : cases) {
+        SessionFixture fixture;
+        Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+        CHECK(authenticate(session));
+
+        deliver(session, request);
+        CHECK(session.isClosing());
+        CHECK(!session.hasOutput());
+    }
+}
+
+// === 23. Тест сжатых векторов ===
+static std::string packedVector(const std::vector<int32_t>& values) {
+    std::vector<unsigned char> packed;
+    VectorProcessor::encodePacked(values.data(), values.size(), packed);
+    return u32(static_cast<uint32_t>(values.size())) +
+           std::string(reinterpret_cast<const char*>(packed.data()), packed.size());
+}
+
+TEST(Session_PackedVectors) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    std::vector<int32_t> series(1000);
+    for (size_t i = 0; i < series.size(); i++) {
+        series[i] = 5000 + static_cast<int32_t>(i % 3);
+    }
+    std::string batch = extendedHeader(Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_PACKED, 3) +
+                        packedVector(series) + packedVector({INT_MAX, 1, -7}) +
+                        packedVector({-3, INT_MIN, 0, 4, 9});
+    CHECK(batch.size() < 1500);
+    deliver(session, batch);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(3u, sums.size());
+    CHECK_EQUAL(5000999, sums[0]);
+    CHECK_EQUAL(INT_MAX, sums[1]);
+    CHECK_EQUAL(INT_MIN, sums[2]);
+
+    // Побайтовая доставка
+    for (char byte : batch) {
+        deliver(session, std::string(1, byte));
+    }
+    CHECK(results(takeOutput(session)) == sums);
+
+    deliver(session, extendedHeader(Protocol::FLAG_PACKED |
+                                    (Protocol::OP_MAX << Protocol::OPCODE_SHIFT), 1) +
+                     packedVector({-3, 12, 4}));
+    sums = results(takeOutput(session));
+    CHECK_EQUAL(1u, sums.size());
+    CHECK_EQUAL(12, sums[0]);
+}
+
+TEST(Session_PackedRejectsInvalidBatch) {
+    const std::string cases[] = {
+        // Длина несуществующего элемента в ключе последней группы
+        extendedHeader(Protocol::FLAG_PACKED, 1) + u32(1) + std::string("\x04\x02\x00", 3),
+        // Только свертки int32, без FLAG_PARALLEL и FLAG_SPARSE
+        extendedHeader(Protocol::FLAG_PACKED | (Protocol::TYPE_INT16 << Protocol::TYPE_SHIFT), 1),
+        extendedHeader(Protocol::FLAG_PACKED | (Protocol::OP_PREFIX_SUM << Protocol::OPCODE_SHIFT), 1),
+        extendedHeader(Protocol::FLAG_PACKED | Protocol::FLAG_PARALLEL, 1),
+        extendedHeader(Protocol::FLAG_PACKED | Protocol::FLAG_SPARSE, 1)
+    };
+
+    for (const std::string& request : cases) {
+        SessionFixture fixture;
+        Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+        CHECK(authenticate(session));
+
+        deliver(session, request);
+        CHECK(session.isClosing());
+        CHECK(!session.hasOutput());
+    }
+}
+
+// === 24. Тест сгенерированных векторов ===
+static std::string generatedVector(uint32_t size, uint32_t generator, int32_t first,
+                                   int32_t second, uint64_t seed) {
+    return u32(size) + u32(generator) + u32(static_cast<uint32_t>(first)) +
+           u32(static_cast<uint32_t>(second)) + u32(static_cast<uint32_t>(seed)) +
+           u32(static_cast<uint32_t>(seed >> 32));
+}
+
+TEST(Session_GeneratedVectors) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Ответ совпадает с ответом на развернутые значения
+    const VectorGenerator random = {GeneratorKind::RANDOM, -100, 100, 99};
+    std::vector<int32_t> expanded(1000);
+    VectorProcessor::generate(random, 0, expanded.size(), expanded.data());
+    deliver(session, extendedHeader(Protocol::FLAG_KEEP_ALIVE, 1) + vector(expanded));
+    std::vector<int32_t> expected = results(takeOutput(session));
+
+    const uint32_t generated = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_GENERATED;
+    std::string batch = extendedHeader(generated, 4) +
+                        generatedVector(1000, Protocol::GEN_RANDOM, -100, 100, 99) +
+                        generatedVector(10, Protocol::GEN_CONSTANT, -7, 0, 0) +
+                        generatedVector(100, Protocol::GEN_ARANGE, 1, 1, 0) +
+                        generatedVector(1000, Protocol::GEN_CONSTANT, 3000000, 0, 0);
+    deliver(session, batch);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(4u, sums.size());
+    CHECK_EQUAL(expected[0], sums[0]);
+    CHECK_EQUAL(-70, sums[1]);
+    CHECK_EQUAL(5050, sums[2]);
+    CHECK_EQUAL(INT_MAX, sums[3]);
+
+    // Побайтовая доставка
+    for (char byte : batch) {
+        deliver(session, std::string(1, byte));
+    }
+    CHECK(results(takeOutput(session)) == sums);
+
+    // Длинная прогрессия в потоковом режиме сворачивается без построения
+    deliver(session, extendedHeader(generated | Protocol::FLAG_STREAMING |
+                                    (Protocol::OP_MEAN << Protocol::OPCODE_SHIFT), 1) +
+                     generatedVector(4000000000u, Protocol::GEN_ARANGE, -1000000000, 0, 0));
+    std::string output = takeOutput(session);
+    CHECK_EQUAL(sizeof(double), output.size());
+    double mean = 0;
+    memcpy(&mean, output.data(), sizeof(mean));
+    CHECK_EQUAL(-1000000000.0, mean);
+}
+
+TEST(Session_GeneratedRejectsInvalidBatch) {
+    const uint32_t generated = Protocol::FLAG_GENERATED;
+    const std::string cases[] = {
+        // Неизвестный генератор, обратные границы, ненулевые неиспользуемые параметры
+        extendedHeader(generated, 1) + generatedVector(5, Protocol::MAX_GENERATOR + 1, 0, 0, 0),
+        extendedHeader(generated, 1) + generatedVector(5, Protocol::GEN_RANDOM, 3, -3, 1),
+        extendedHeader(generated, 1) + generatedVector(5, Protocol::GEN_CONSTANT, 1, 2, 0),
+        // Поэлементное построение слишком длинного вектора
+        extendedHeader(generated | Protocol::FLAG_STREAMING, 1) +
+            generatedVector(Protocol::MAX_GENERATED_SIZE + 1, Protocol::GEN_RANDOM, 0, 1, 1),
+        // Только свертки int32, без других кодировок значений
+        extendedHeader(generated | (Protocol::OP_DOT << Protocol::OPCODE_SHIFT), 1),
+        extendedHeader(generated | (Protocol::TYPE_INT64 << Protocol::TYPE_SHIFT), 1),
+        extendedHeader(generated | Protocol::FLAG_PACKED, 1)
+    };
+
+    for (const std::string& request : cases) {
+        SessionFixture fixture;
+        Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+        CHECK(authenticate(session));
+
+        deliver(session, request);
+        CHECK(session.isClosing());
+        CHECK(!session.hasOutput());
+    }
+}
+
+TEST(Session_GeneratedInSteps) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Длинный вектор строится частями, между которыми сеанс уступает циклу
+    const uint32_t size = 3 * Session::STEP_GENERATED_ELEMENTS + 5;
+    deliver(session, extendedHeader(Protocol::FLAG_GENERATED | Protocol::FLAG_STREAMING, 1) +
+                     generatedVector(size, Protocol::GEN_RANDOM, 1, 1, 7));
+    CHECK(!session.hasOutput());
+    CHECK(session.hasPendingWork());
+
+    int steps = 0;
+    while (session.hasPendingWork() && steps < 10) {
+        session.resume();
+        ++steps;
+    }
+    CHECK_EQUAL(3, steps);
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(1u, sums.size());
+    if (!sums.empty()) {
+        CHECK_EQUAL(static_cast<int32_t>(size), sums[0]);
+    }
+    CHECK(session.isClosing());
+}
+
+TEST(Session_GeneratedBatchBudget) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Пакет целиком не строит больше MAX_BATCH_GENERATED элементов
+    const uint32_t count = Protocol::MAX_BATCH_GENERATED / Protocol::MAX_GENERATED_SIZE;
+    std::string batch = extendedHeader(Protocol::FLAG_GENERATED | Protocol::FLAG_STREAMING,
+                                       count + 1);
+    for (uint32_t i = 0; i <= count; ++i) {
+        batch += generatedVector(Protocol::MAX_GENERATED_SIZE, Protocol::GEN_CONSTANT, 1, 0, 0);
+    }
+    deliver(session, batch);
+    // Постоянные векторы сворачиваются без построения и в бюджет не входят
+    std::vector<int32_t> sums = results(takeOutput(session));
+    CHECK_EQUAL(count + 1, sums.size());
+
+    SessionFixture limited;
+    Session rejected(limited.sessionSocket, "test", limited.database, limited.logger);
+    CHECK(authenticate(rejected));
+    batch = extendedHeader(Protocol::FLAG_GENERATED | Protocol::FLAG_STREAMING, count + 1);
+    for (uint32_t i = 0; i <= count; ++i) {
+        batch += generatedVector(Protocol::MAX_GENERATED_SIZE, Protocol::GEN_RANDOM, 0, 0, i);
+    }
+    deliver(rejected, batch);
+    while (rejected.hasPendingWork()) {
+        rejected.resume();
+    }
+    CHECK_EQUAL(count, results(takeOutput(rejected)).size());
+    CHECK(rejected.isClosing());
+}
+
+// === 25. Тест кэша результатов ===
+static std::string hashRef(uint64_t key) {
+    return u32(Protocol::HASH_REF) + u32(static_cast<uint32_t>(key)) +
+           u32(static_cast<uint32_t>(key >> 32));
+}
+
+static uint64_t cacheKey(uint32_t control, const std::vector<int32_t>& values) {
+    uint64_t seed = static_cast<uint64_t>(control & (Protocol::OPCODE_MASK | Protocol::POLICY_MASK |
+                                                     Protocol::TYPE_MASK)) << 32;
+    return Xxh64::hash(values.data(), values.size() * sizeof(int32_t), seed | values.size());
+}
+
+TEST(Session_CachedResults) {
+    SessionFixture fixture;
+    ResultCache cache(128);
+    SessionOptions options;
+    options.cache = &cache;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    const uint32_t control = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_CACHED;
+    std::vector<int32_t> baseline = {INT_MAX, 5, -7, 100};
+    deliver(session, extendedHeader(control, 1) + vector(baseline));
+    CHECK(takeOutput(session) == std::string(1, '\0') + u32(INT_MAX));
+
+    // Ссылка по ключу вместо значений; неизвестный ключ
+    std::string batch = extendedHeader(control, 3) + hashRef(cacheKey(control, baseline)) +
+                        hashRef(12345) + vector({1, 2});
+    deliver(session, batch);
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_HIT) + u32(INT_MAX) +
+                                 std::string(1, Protocol::CACHE_UNKNOWN) +
+                                 std::string(1, Protocol::CACHE_COMPUTED) + u32(3));
+
+    // Побайтовая доставка
+    for (char byte : batch) {
+        deliver(session, std::string(1, byte));
+    }
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_HIT) + u32(INT_MAX) +
+                                 std::string(1, Protocol::CACHE_UNKNOWN) +
+                                 std::string(1, Protocol::CACHE_COMPUTED) + u32(3));
+
+    // Другая политика - другой ключ; ответ сохраняется вместе с байтом статуса политики
+    const uint32_t checked = control | (Protocol::POLICY_ERROR << Protocol::POLICY_SHIFT);
+    deliver(session, extendedHeader(checked, 2) + hashRef(cacheKey(checked, baseline)) +
+                     vector(baseline));
+    std::string overflow = std::string(1, Protocol::STATUS_OVERFLOW) + u32(INT_MAX);
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_UNKNOWN) +
+                                 std::string(1, Protocol::CACHE_COMPUTED) + overflow);
+    deliver(session, extendedHeader(checked, 1) + hashRef(cacheKey(checked, baseline)));
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_HIT) + overflow);
+
+    ResultCache::Stats stats = cache.stats();
+    CHECK_EQUAL(3u, stats.hits);
+    CHECK_EQUAL(3u, stats.misses);
+
+    // Запись, добавленная другим пользователем под тем же ключом, не видна
+    CachedResult planted = {4, {0x7f, 0, 0, 0}};
+    cache.insert(cache.scopedKey("other", cacheKey(control, {7})), planted);
+    deliver(session, extendedHeader(control, 1) + hashRef(cacheKey(control, {7})));
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_UNKNOWN));
+}
+
+TEST(Session_CachedWithoutCache) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    const uint32_t control = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_CACHED;
+    deliver(session, extendedHeader(control, 2) + vector({4, 5}) +
+                     hashRef(cacheKey(control, {4, 5})));
+    CHECK(takeOutput(session) == std::string(1, Protocol::CACHE_COMPUTED) + u32(9) +
+                                 std::string(1, Protocol::CACHE_UNKNOWN));
+
+    // Только свертки, без других кодировок значений
+    deliver(session, extendedHeader(Protocol::FLAG_CACHED | Protocol::FLAG_PACKED, 1));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+}
+
+// === 26. Тест хранилища именованных векторов ===
+static std::string storeAggregates(uint32_t size, int64_t sum, uint64_t l1, uint64_t nonZero,
+                                   double l2) {
+    std::string bytes = std::string(1, Protocol::STORE_OK) + u32(size);
+    bytes.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+    bytes.append(reinterpret_cast<const char*>(&l1), sizeof(l1));
+    bytes.append(reinterpret_cast<const char*>(&nonZero), sizeof(nonZero));
+    bytes.append(reinterpret_cast<const char*>(&l2), sizeof(l2));
+    return bytes;
+}
+
+TEST(Session_VectorStore) {
+    SessionFixture fixture;
+    VectorStore store(1 << 20);
+    SessionOptions options;
+    options.store = &store;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger, options);
+    CHECK(authenticate(session));
+
+    const uint32_t control = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_STORE;
+    std::string ok(1, Protocol::STORE_OK);
+    deliver(session, extendedHeader(control, 2) +
+                     storeCommand(Protocol::STORE_CREATE, "weights") + vector({3, 0, -4}) +
+                     storeCommand(Protocol::STORE_QUERY, "weights"));
+    CHECK(takeOutput(session) == ok + storeAggregates(3, -1, 7, 2, 5.0));
+
+    // Заплатка (последнее изменение индекса побеждает), затем запрос; побайтовая доставка
+    std::string batch = extendedHeader(control, 2) +
+                        storeCommand(Protocol::STORE_PATCH, "weights") + u32(3) +
+                        u32(1) + u32(7) + u32(2) + u32(0) + u32(1) + u32(static_cast<uint32_t>(-2)) +
+                        storeCommand(Protocol::STORE_QUERY, "weights");
+    for (char byte : batch) {
+        deliver(session, std::string(1, byte));
+    }
+    CHECK(takeOutput(session) == ok + storeAggregates(3, 1, 5, 2, std::sqrt(13.0)));
+
+    // Индекс за пределами вектора, неизвестное имя, удаление
+    deliver(session, extendedHeader(control, 4) +
+                     storeCommand(Protocol::STORE_PATCH, "weights") + u32(1) + u32(3) + u32(1) +
+                     storeCommand(Protocol::STORE_QUERY, "missing") +
+                     storeCommand(Protocol::STORE_DELETE, "weights") +
+                     storeCommand(Protocol::STORE_QUERY, "weights"));
+    CHECK(takeOutput(session) == std::string(1, Protocol::STORE_BAD_INDEX) +
+                                 std::string(1, Protocol::STORE_NOT_FOUND) + ok +
+                                 std::string(1, Protocol::STORE_NOT_FOUND));
+
+    // Суммы диапазонов с индексом и политикой переполнения пакета
+    const uint32_t checked = control | (Protocol::POLICY_ERROR << Protocol::POLICY_SHIFT);
+    deliver(session, extendedHeader(checked, 5) +
+                     storeCommand(Protocol::STORE_CREATE, "big") + vector({INT_MAX, 1, -2, 5}) +
+                     storeCommand(Protocol::STORE_INDEX, "big") +
+                     storeCommand(Protocol::STORE_RANGE, "big") + u32(1) + u32(4) +
+                     storeCommand(Protocol::STORE_RANGE, "big") + u32(0) + u32(3) +
+                     storeCommand(Protocol::STORE_RANGE, "big") + u32(2) + u32(5));
+    CHECK(takeOutput(session) == ok + ok +
+                                 ok + std::string(1, Protocol::STATUS_OK) + u32(4) +
+                                 ok + std::string(1, Protocol::STATUS_OVERFLOW) + u32(INT_MAX) +
+                                 std::string(1, Protocol::STORE_BAD_INDEX));
+
+    // Векторы хранятся под логином клиента
+    store.create("user", "shared", {2, 2});
+    deliver(session, extendedHeader(Protocol::FLAG_STORE, 1) +
+                     storeCommand(Protocol::STORE_QUERY, "shared"));
+    CHECK(takeOutput(session) == storeAggregates(2, 4, 4, 2, std::sqrt(8.0)));
+    CHECK(session.isClosing());
+}
+
+TEST(Session_VectorStoreInvalid) {
+    SessionFixture fixture;
+    Session session(fixture.sessionSocket, "test", fixture.database, fixture.logger);
+    CHECK(authenticate(session));
+
+    // Хранилище выключено: команда принимается, ответ STORE_DISABLED
+    const uint32_t control = Protocol::FLAG_KEEP_ALIVE | Protocol::FLAG_STORE;
+    deliver(session, extendedHeader(control, 1) +
+                     storeCommand(Protocol::STORE_CREATE, "v") + vector({1}));
+    CHECK(takeOutput(session) == std::string(1, Protocol::STORE_DISABLED));
+    deliver(session, extendedHeader(control, 1) +
+                     storeCommand(Protocol::STORE_PATCH, "v") + u32(1) + u32(0) + u32(1));
+    CHECK(takeOutput(session) == std::string(1, Protocol::STORE_DISABLED));
+
+    // Пустое имя
+    deliver(session, extendedHeader(control, 1) + storeCommand(Protocol::STORE_QUERY, ""));
+    CHECK(session.isClosing());
+    CHECK(!session.hasOutput());
+
+    // Другие флаги вместе с FLAG_STORE
+    SessionFixture other;
+    Session second(other.sessionSocket, "test", other.database, other.logger);
+    CHECK(authenticate(second));
+    deliver(second, extendedHeader(Protocol::FLAG_STORE | Protocol::FLAG_STREAMING, 1));
+    CHECK(second.isClosing());
+    CHECK(!second.hasOutput());
+
+    // Вектор больше хранилища: данные пропускаются, сеанс продолжается
+    SessionFixture small;
+    VectorStore store(1024);
+    SessionOptions options;
+    options.store = &store;
+    Session third(small.sessionSocket, "test", small.database, small.logger, options);
+    CHECK(authenticate(third));
+    deliver(third, extendedHeader(control, 2) +
+                   storeCommand(Protocol::STORE_CREATE, "big") + vector(std::vector<int32_t>(1000, 1)) +
+                   storeCommand(Protocol::STORE_QUERY, "big"));
+    CHECK(takeOutput(third) == std::string(1, Protocol::STORE_NO_SPACE) +
+                               std::string(1, Protocol::STORE_NOT_FOUND));
+    CHECK(!third.isClosing());
+}
+
+int main() {
+    std::cout << "=== Тестирование Session ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
@@ -8,10 +8,16 @@
 
 #include "/usr/include/UnitTest++/UnitTest++.h"
 #include "../src/VectorProcessor.h"
+#include "../src/WorkStealingPool.h"
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <climits>
 #include <cstdint>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <string>
 
 // === 1. Базовые тесты суммы вектора ===
 TEST(CalculateSum_EmptyVector) {
@@ -82,6 +88,950 @@ TEST(CalculateSum_ZeroVector) {
     CHECK_EQUAL(0, VectorProcessor::calculateSum(vec));
 }
 
+// === 5. Сумма участка памяти ===
+TEST(CalculateSum_Span) {
+    const int32_t values[] = {1, 2, 3, INT_MAX, 5};
+    CHECK_EQUAL(6, VectorProcessor::calculateSum(values, 3));
+    CHECK_EQUAL(INT_MAX, VectorProcessor::calculateSum(values, 5));
+    CHECK_EQUAL(0, VectorProcessor::calculateSum(values, 0));
+}
+
+// === 6. Накопление суммы фрагментами ===
+TEST(SumAccumulator_MatchesWholeVector) {
+    std::vector<int32_t> vec;
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back((i % 7 - 3) * 1000000);
+    }
+    vec[500] = INT_MAX;      // Насыщение посреди вектора
+    vec[501] = INT_MIN;      // После насыщения на результат не влияет
+
+    std::vector<int32_t> cases[] = {vec, std::vector<int32_t>(vec.begin(), vec.begin() + 500)};
+    for (const auto& values : cases) {
+        int32_t expected = VectorProcessor::calculateSum(values);
+        for (size_t chunk = 1; chunk <= values.size(); chunk += 37) {
+            SumAccumulator accumulator;
+            for (size_t offset = 0; offset < values.size(); offset += chunk) {
+                size_t count = std::min(chunk, values.size() - offset);
+                accumulator.add(values.data() + offset, count);
+            }
+            CHECK_EQUAL(expected, accumulator.result());
+        }
+    }
+}
+
+TEST(SumAccumulator_Saturation) {
+    const int32_t up[] = {INT_MAX - 1, 1};
+    const int32_t more[] = {1, -100};
+    SumAccumulator accumulator;
+    accumulator.add(up, 2);
+    CHECK(!accumulator.isSaturated());
+    accumulator.add(more, 2);
+    CHECK(accumulator.isSaturated());
+    CHECK_EQUAL(INT_MAX, accumulator.result());
+
+    accumulator.reset();
+    accumulator.add(more, 2);
+    CHECK_EQUAL(-99, accumulator.result());
+}
+
+// === 7. Сверка SIMD-ядер с эталонной реализацией ===
+
+/**
+ * @brief Эталон: прежняя поэлементная реализация calculateSum
+ */
+static int32_t referenceSum(const std::vector<int32_t>& vector) {
+    int64_t sum = 0;
+    for (int32_t value : vector) {
+        int32_t current = static_cast<int32_t>(sum);
+        bool overflow = (value > 0) ? current > INT_MAX - value : current < INT_MIN - value;
+        if (overflow) {
+            return value > 0 ? INT_MAX : INT_MIN;
+        }
+        sum += value;
+    }
+    return static_cast<int32_t>(sum);
+}
+
+/**
+ * @brief Случайные векторы разной формы: малые значения, весь диапазон,
+ *        длинные серии одного знака и значения у границ
+ */
+static std::vector<std::vector<int32_t>> randomVectors() {
+    std::mt19937 random(20250101);
+    std::vector<std::vector<int32_t>> vectors;
+    const size_t sizes[] = {0, 1, 3, 63, 64, 65, 127, 128, 200, 1000, 4099};
+
+    for (size_t size : sizes) {
+        for (int shape = 0; shape < 6; shape++) {
+            std::vector<int32_t> vec(size);
+            for (size_t i = 0; i < size; i++) {
+                switch (shape) {
+                    case 0: vec[i] = static_cast<int32_t>(random() % 2001) - 1000; break;
+                    case 1: vec[i] = static_cast<int32_t>(random()); break;
+                    case 2: vec[i] = static_cast<int32_t>(random() % 50000000); break;
+                    case 3: vec[i] = -static_cast<int32_t>(random() % 50000000); break;
+                    case 4: vec[i] = (random() % 2) ? INT_MAX - static_cast<int32_t>(random() % 3)
+                                                    : INT_MIN + static_cast<int32_t>(random() % 3); break;
+                    default: vec[i] = (i % 128 < 64) ? 40000000 : -40000000; break;
+                }
+            }
+            vectors.push_back(vec);
+        }
+    }
+
+    // Насыщение на границах блоков и сразу после них
+    for (size_t position : {0u, 62u, 63u, 64u, 65u, 127u, 128u}) {
+        std::vector<int32_t> vec(200, 1);
+        vec[position] = INT_MAX;
+        vectors.push_back(vec);
+        vec[position] = INT_MIN;
+        vectors.push_back(vec);
+    }
+    vectors.push_back({INT_MAX, 1, -5});
+    return vectors;
+}
+
+TEST(SumKernels_MatchReference) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    SimdLevel original = VectorProcessor::getKernel();
+    std::vector<std::vector<int32_t>> vectors = randomVectors();
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) {
+            std::cout << "Ядро " << VectorProcessor::kernelName(level)
+                      << " не поддерживается, пропущено" << std::endl;
+            continue;
+        }
+
+        for (const auto& vec : vectors) {
+            int32_t expected = referenceSum(vec);
+            CHECK_EQUAL(expected, VectorProcessor::calculateSum(vec));
+
+            // Фрагменты, не кратные блоку ядра
+            SumAccumulator accumulator;
+            for (size_t offset = 0; offset < vec.size(); offset += 100) {
+                accumulator.add(vec.data() + offset, std::min<size_t>(100, vec.size() - offset));
+            }
+            CHECK_EQUAL(expected, accumulator.result());
+
+            // Сетевые байты little-endian по невыровненному адресу
+            std::vector<unsigned char> wire(vec.size() * 4 + 1);
+            for (size_t i = 0; i < vec.size(); i++) {
+                uint32_t value = static_cast<uint32_t>(vec[i]);
+                for (int b = 0; b < 4; b++) {
+                    wire[1 + i * 4 + b] = static_cast<unsigned char>(value >> (8 * b));
+                }
+            }
+            CHECK_EQUAL(expected, VectorProcessor::sumLE(wire.data() + 1, vec.size()));
+        }
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+TEST(SumKernels_AutoSelectsSupported) {
+    SimdLevel original = VectorProcessor::getKernel();
+    SimdLevel level = VectorProcessor::selectKernel(SimdLevel::AUTO);
+    CHECK(level != SimdLevel::AUTO);
+    CHECK(level == VectorProcessor::getKernel());
+    VectorProcessor::selectKernel(original);
+}
+
+// === 8. Суммирование по мере приема байт ===
+TEST(VectorReduction_ArbitraryChunks) {
+    std::mt19937 random(7);
+    std::vector<std::vector<int32_t>> vectors = randomVectors();
+
+    for (const auto& vec : vectors) {
+        if (vec.empty()) continue;
+        std::string wire(reinterpret_cast<const char*>(vec.data()), vec.size() * 4);
+        wire += "tail";     // Байты следующего поля не относятся к вектору
+
+        VectorReduction reduction;
+        reduction.begin(vec.size());
+        size_t offset = 0;
+        while (!reduction.isComplete()) {
+            size_t chunk = std::min<size_t>(1 + random() % 7, wire.size() - offset);
+            offset += reduction.feed(wire.data() + offset, chunk);
+        }
+        CHECK_EQUAL(vec.size() * 4, offset);
+        CHECK_EQUAL(referenceSum(vec), reduction.result());
+    }
+}
+
+TEST(VectorReduction_SplitElement) {
+    const unsigned char wire[] = {0x01, 0x02, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF};
+    VectorReduction reduction;
+    reduction.begin(2);
+
+    CHECK_EQUAL(3u, reduction.feed(wire, 3));
+    CHECK_EQUAL(2u, reduction.remaining());
+    CHECK_EQUAL(4u, reduction.feed(wire + 3, 4));
+    CHECK(!reduction.isComplete());
+    CHECK_EQUAL(1u, reduction.feed(wire + 7, 1));
+    CHECK(reduction.isComplete());
+    CHECK_EQUAL(0x0201 - 1, reduction.result());
+}
+
+// === 9. Политики переполнения ===
+TEST(SumKernels_OverflowPolicies) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    SimdLevel original = VectorProcessor::getKernel();
+    std::vector<std::vector<int32_t>> vectors = randomVectors();
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) continue;
+
+        for (const auto& vec : vectors) {
+            int64_t exact = 0;
+            for (int32_t value : vec) exact += value;
+            int32_t saturated = referenceSum(vec);
+            // Эталон насытился, если его результат разошелся с точной суммой
+            bool overflow = exact != saturated;
+
+            SumAccumulator wrap(OverflowPolicy::WRAP);
+            SumAccumulator widen(OverflowPolicy::WIDEN);
+            SumAccumulator error(OverflowPolicy::ERROR);
+            for (size_t offset = 0; offset < vec.size(); offset += 100) {
+                size_t count = std::min<size_t>(100, vec.size() - offset);
+                wrap.add(vec.data() + offset, count);
+                widen.addLE(vec.data() + offset, count);
+                error.add(vec.data() + offset, count);
+            }
+
+            CHECK_EQUAL(static_cast<int32_t>(static_cast<uint32_t>(exact)), wrap.result());
+            CHECK_EQUAL(exact, widen.result64());
+            CHECK(!widen.isSaturated());
+            CHECK_EQUAL(saturated, error.result());
+            CHECK_EQUAL(overflow, error.isSaturated());
+        }
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+// === 10. Операции свертки ===
+
+/**
+ * @brief Эталонная свертка: поэлементно, в точной арифметике
+ */
+static ReduceState referenceReduce(ReduceOp op, const std::vector<int32_t>& vec) {
+    ReduceState state;
+    state.reset(op);
+    for (int32_t value : vec) {
+        int64_t wide = value;
+        switch (op) {
+            case ReduceOp::SUM:
+            case ReduceOp::MEAN:     state.total += wide; break;
+            case ReduceOp::MIN:      state.value = std::min(state.value, wide); break;
+            case ReduceOp::MAX:      state.value = std::max(state.value, wide); break;
+            case ReduceOp::L1:       state.total += wide < 0 ? -wide : wide; break;
+            case ReduceOp::L2:       state.squares += static_cast<uint64_t>(wide * wide); break;
+            case ReduceOp::COUNT_NZ: state.value += value != 0; break;
+        }
+    }
+    state.count = vec.size();
+    return state;
+}
+
+TEST(ReduceOps_MatchReference) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    const ReduceOp ops[] = {ReduceOp::SUM, ReduceOp::MIN, ReduceOp::MAX, ReduceOp::MEAN,
+                            ReduceOp::L1, ReduceOp::L2, ReduceOp::COUNT_NZ};
+    SimdLevel original = VectorProcessor::getKernel();
+    std::vector<std::vector<int32_t>> vectors = randomVectors();
+    vectors.push_back(std::vector<int32_t>(100, 0));
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) continue;
+
+        for (const auto& vec : vectors) {
+            for (ReduceOp op : ops) {
+                ReduceState expected = referenceReduce(op, vec);
+                ReduceState state = VectorProcessor::reduce(op, vec.data(), vec.size());
+                CHECK_EQUAL(expected.value, state.value);
+                CHECK(expected.total == state.total);
+                CHECK(expected.squares == state.squares);
+                CHECK_EQUAL(expected.count, state.count);
+            }
+        }
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+TEST(ReduceOps_ChunkedAndResults) {
+    std::mt19937 random(11);
+    std::vector<int32_t> vec = {3, -7, 0, INT_MIN, 5, 0, INT_MAX, 1, 2, 3};
+    std::string wire(reinterpret_cast<const char*>(vec.data()), vec.size() * 4);
+
+    const ReduceOp ops[] = {ReduceOp::MIN, ReduceOp::MAX, ReduceOp::MEAN,
+                            ReduceOp::L1, ReduceOp::L2, ReduceOp::COUNT_NZ};
+    for (ReduceOp op : ops) {
+        VectorReduction reduction;
+        reduction.begin(vec.size(), OverflowPolicy::SATURATE, op);
+        size_t offset = 0;
+        while (!reduction.isComplete()) {
+            size_t chunk = std::min<size_t>(1 + random() % 9, wire.size() - offset);
+            offset += reduction.feed(wire.data() + offset, chunk);
+        }
+        ReduceState expected = referenceReduce(op, vec);
+        CHECK(op == reduction.op());
+        CHECK(!reduction.usesAccumulator());
+        CHECK_EQUAL(expected.value, reduction.state().value);
+        CHECK(expected.total == reduction.state().total);
+        CHECK_EQUAL(vec.size(), reduction.state().count);
+    }
+
+    ReduceState mean = VectorProcessor::reduce(ReduceOp::MEAN, vec.data(), vec.size());
+    CHECK_CLOSE(6.0 / 10, mean.mean(), 1e-12);
+    std::vector<int32_t> triangle = {3, 4};
+    CHECK_CLOSE(5.0, VectorProcessor::reduce(ReduceOp::L2, triangle.data(), 2).norm(), 1e-12);
+
+    // Норма не теряет точности там, где сумма квадратов не помещается в 64 бита
+    std::vector<int32_t> large(16, INT_MIN);
+    CHECK_CLOSE(4.0 * 2147483648.0,
+                VectorProcessor::reduce(ReduceOp::L2, large.data(), large.size()).norm(), 1e-3);
+}
+
+// === 11. Типы элементов ===
+
+/**
+ * @brief Случайные значения типа T во всем его диапазоне и около нуля
+ */
+template <typename T>
+static std::vector<T> randomValues(std::mt19937& random, size_t size, int shape) {
+    std::vector<T> values(size);
+    for (size_t i = 0; i < size; i++) {
+        uint64_t bits = (static_cast<uint64_t>(random()) << 32) | random();
+        T value;
+        memcpy(&value, &bits, sizeof(value));
+        values[i] = (shape == 0) ? value : static_cast<T>(static_cast<int>(bits % 201) - 100);
+    }
+    return values;
+}
+
+/**
+ * @brief Проверить сумму с политиками и свертки целого типа T
+ */
+template <typename T>
+static void checkIntegerType(ElementType type) {
+    std::mt19937 random(sizeof(T));
+    const size_t sizes[] = {1, 7, 64, 65, 300, 4099};
+    const ReduceOp ops[] = {ReduceOp::SUM, ReduceOp::MIN, ReduceOp::MAX, ReduceOp::MEAN,
+                            ReduceOp::L1, ReduceOp::COUNT_NZ};
+
+    for (size_t size : sizes) {
+        for (int shape = 0; shape < 2; shape++) {
+            std::vector<T> vec = randomValues<T>(random, size, shape);
+
+            // Эталон: поэлементная сумма с насыщением на первом выходе за int32
+            __int128 exact = 0;
+            int64_t saturated = 0;
+            bool overflow = false;
+            for (T value : vec) {
+                exact += value;
+                if (!overflow && (exact > INT_MAX || exact < INT_MIN)) {
+                    saturated = exact > 0 ? INT_MAX : INT_MIN;
+                    overflow = true;
+                }
+            }
+            if (!overflow) saturated = static_cast<int64_t>(exact);
+
+            SumAccumulator checked(OverflowPolicy::ERROR);
+            SumAccumulator widen;
+            checked.reset(OverflowPolicy::ERROR, type);
+            widen.reset(OverflowPolicy::WIDEN, type);
+            checked.addLE(vec.data(), vec.size());
+            widen.addLE(vec.data(), vec.size());
+            CHECK_EQUAL(saturated, checked.result64());
+            CHECK_EQUAL(overflow, checked.isSaturated());
+            CHECK_EQUAL(static_cast<int64_t>(static_cast<uint64_t>(exact)), widen.result64());
+
+            for (ReduceOp op : ops) {
+                ReduceState state = VectorProcessor::reduce(op, type, vec.data(), vec.size());
+                switch (op) {
+                    case ReduceOp::SUM:
+                    case ReduceOp::MEAN:
+                        CHECK(exact == state.total);
+                        break;
+                    case ReduceOp::MIN:
+                        CHECK_EQUAL(*std::min_element(vec.begin(), vec.end()), state.value);
+                        break;
+                    case ReduceOp::MAX:
+                        CHECK_EQUAL(*std::max_element(vec.begin(), vec.end()), state.value);
+                        break;
+                    case ReduceOp::L1: {
+                        __int128 l1 = 0;
+                        for (T value : vec) l1 += value < 0 ? -static_cast<__int128>(value) : value;
+                        CHECK(l1 == state.total);
+                        break;
+                    }
+                    default:
+                        CHECK_EQUAL(static_cast<int64_t>(
+                            std::count_if(vec.begin(), vec.end(), [](T v) { return v != 0; })),
+                            state.value);
+                        break;
+                }
+            }
+        }
+    }
+}
+
+TEST(ElementTypes_IntegerReductions) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    SimdLevel original = VectorProcessor::getKernel();
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) continue;
+        checkIntegerType<int8_t>(ElementType::INT8);
+        checkIntegerType<int16_t>(ElementType::INT16);
+        checkIntegerType<int32_t>(ElementType::INT32);
+        checkIntegerType<int64_t>(ElementType::INT64);
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+TEST(ElementTypes_FloatReductions) {
+    // Компенсация округления: 1 не теряется на фоне 1e16
+    std::vector<double> cancel = {1e16, 1.0, -1e16};
+    CHECK_EQUAL(1.0, VectorProcessor::reduce(ReduceOp::SUM, ElementType::FLOAT64,
+                                             cancel.data(), cancel.size()).sum());
+
+    std::vector<float> values = {1.5f, -4.0f, 0.0f, -0.0f, 3.0f};
+    ReduceState state = VectorProcessor::reduce(ReduceOp::MEAN, ElementType::FLOAT32,
+                                                values.data(), values.size());
+    CHECK_CLOSE(0.1, state.mean(), 1e-12);
+    CHECK_EQUAL(-4.0, VectorProcessor::reduce(ReduceOp::MIN, ElementType::FLOAT32,
+                                              values.data(), values.size()).real);
+    CHECK_EQUAL(3.0, VectorProcessor::reduce(ReduceOp::MAX, ElementType::FLOAT32,
+                                             values.data(), values.size()).real);
+    CHECK_CLOSE(8.5, VectorProcessor::reduce(ReduceOp::L1, ElementType::FLOAT32,
+                                             values.data(), values.size()).sum(), 1e-12);
+    CHECK_CLOSE(std::sqrt(27.25), VectorProcessor::reduce(ReduceOp::L2, ElementType::FLOAT32,
+                                                          values.data(), values.size()).norm(), 1e-12);
+    CHECK_EQUAL(3, VectorProcessor::reduce(ReduceOp::COUNT_NZ, ElementType::FLOAT32,
+                                           values.data(), values.size()).value);
+
+    // NaN распространяется в экстремум
+    std::vector<double> nan = {1.0, std::nan(""), -1.0};
+    CHECK(std::isnan(VectorProcessor::reduce(ReduceOp::MAX, ElementType::FLOAT64,
+                                             nan.data(), nan.size()).real));
+
+    // Порции, разрезающие элементы float64
+    std::string wire(reinterpret_cast<const char*>(cancel.data()), cancel.size() * sizeof(double));
+    VectorReduction reduction;
+    reduction.begin(cancel.size(), OverflowPolicy::SATURATE, ReduceOp::SUM, ElementType::FLOAT64);
+    CHECK(!reduction.usesAccumulator());
+    for (size_t offset = 0; offset < wire.size(); offset += 3) {
+        reduction.feed(wire.data() + offset, std::min<size_t>(3, wire.size() - offset));
+    }
+    CHECK(reduction.isComplete());
+    CHECK_EQUAL(1.0, reduction.state().sum());
+}
+
+// === 12. Плоский пакет и параллельная обработка ===
+TEST(VectorBatch_Layout) {
+    VectorBatch batch;
+    CHECK(batch.empty());
+    batch.addVector(std::vector<int32_t>{1, 2, 3});
+    int32_t* data = batch.addVector(2);
+    data[0] = 10;
+    data[1] = 20;
+    batch.addVector(std::vector<int32_t>(1000, 7));
+
+    CHECK_EQUAL(3u, batch.size());
+    CHECK_EQUAL(1005u, batch.totalElements());
+    CHECK_EQUAL(2u, batch.vectorSize(1));
+    CHECK_EQUAL(3, batch.data(0)[2]);
+    CHECK_EQUAL(20, batch.data(1)[1]);
+    CHECK_EQUAL(7, batch.data(2)[999]);
+    // Векторы лежат подряд
+    CHECK(batch.data(1) == batch.data(0) + 3);
+
+    size_t capacity = batch.capacity();
+    batch.clear();
+    CHECK(batch.empty());
+    CHECK_EQUAL(0u, batch.totalElements());
+    CHECK_EQUAL(capacity, batch.capacity());
+}
+
+TEST(VectorBatch_GrowsAsFilled) {
+    VectorBatch batch;
+    batch.addVector(std::vector<int32_t>{1, 2});
+    size_t capacity = batch.capacity();
+
+    // Объявленный размер памяти не занимает
+    batch.declareVector(1u << 24);
+    CHECK_EQUAL(capacity, batch.capacity());
+    CHECK_EQUAL(2u, batch.offset(1));
+
+    // Буфер растет по мере заполнения, заполненные значения сохраняются
+    int32_t* values = batch.reserve(2 + 3, 2);
+    values[2] = 30;
+    values[3] = 40;
+    values[4] = 50;
+    values = batch.reserve(2 + 1000, 5);
+    CHECK(batch.capacity() >= 1002u && batch.capacity() < 4096u);
+    CHECK_EQUAL(2, values[1]);
+    CHECK_EQUAL(50, values[4]);
+    CHECK(batch.data(1) == values + 2);
+
+    batch.clear();
+    batch.shrink(1u << 16);
+    CHECK(batch.capacity() >= 1002u);
+    batch.shrink(100);
+    CHECK_EQUAL(0u, batch.capacity());
+    batch.addVector(std::vector<int32_t>{7});
+    CHECK_EQUAL(7, batch.data(0)[0]);
+}
+
+TEST(ProcessVectors_ParallelMatchesSerial) {
+    const OverflowPolicy policies[] = {OverflowPolicy::SATURATE, OverflowPolicy::WRAP,
+                                       OverflowPolicy::WIDEN, OverflowPolicy::ERROR};
+    const size_t chunk = VectorProcessor::PARALLEL_CHUNK_ELEMENTS;
+
+    VectorBatch batch;
+    for (const auto& vec : randomVectors()) {
+        if (!vec.empty()) batch.addVector(vec);
+    }
+    // Большие векторы делятся на фрагменты
+    std::mt19937 random(20250216);
+    std::vector<int32_t> big(5 * chunk + 123);
+    for (auto& value : big) value = static_cast<int32_t>(random() % 2001) - 1000;
+    batch.addVector(big);
+    for (auto& value : big) value = static_cast<int32_t>(random());
+    batch.addVector(big);
+    // Насыщение внутри второго фрагмента, затем сумма уходит вниз
+    std::fill(big.begin(), big.end(), 0);
+    big[chunk + 10] = INT_MAX;
+    big[chunk + 11] = 5;
+    big[3 * chunk] = INT_MIN;
+    batch.addVector(big);
+    // Частичные суммы близки к пределу, но не выходят за него
+    std::fill(big.begin(), big.end(), 0);
+    big[0] = INT_MAX - 1;
+    big[chunk + 1] = 1;
+    big[2 * chunk] = -5;
+    big[2 * chunk + 1] = 5;
+    batch.addVector(big);
+
+    WorkStealingPool pool(3);
+    for (OverflowPolicy policy : policies) {
+        std::vector<SumAccumulator> serial;
+        std::vector<SumAccumulator> parallel;
+        VectorProcessor::processVectors(batch, policy, serial);
+        VectorProcessor::processVectors(batch, policy, parallel, &pool);
+
+        CHECK_EQUAL(batch.size(), parallel.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            SumAccumulator expected(policy);
+            expected.add(batch.data(i), batch.vectorSize(i));
+            CHECK_EQUAL(expected.result64(), serial[i].result64());
+            CHECK_EQUAL(expected.result64(), parallel[i].result64());
+            CHECK_EQUAL(expected.result(), parallel[i].result());
+            CHECK_EQUAL(expected.isSaturated(), parallel[i].isSaturated());
+        }
+    }
+}
+
+// === 13. Матричные операции ===
+
+/**
+ * @brief Случайная матрица rows x cols; shape 1 - крайние значения int32
+ */
+static std::vector<int32_t> randomMatrix(std::mt19937& random, size_t rows, size_t cols, int shape) {
+    std::vector<int32_t> matrix(rows * cols);
+    for (auto& value : matrix) {
+        value = shape ? ((random() % 2) ? INT_MAX : INT_MIN)
+                      : static_cast<int32_t>(random() % 200001) - 100000;
+    }
+    return matrix;
+}
+
+/**
+ * @brief Эталонное скалярное произведение по модулю 2^64
+ */
+static int64_t referenceDot(const int32_t* a, const int32_t* b, size_t count) {
+    uint64_t dot = 0;
+    for (size_t k = 0; k < count; k++) {
+        dot += static_cast<uint64_t>(static_cast<int64_t>(a[k]) * b[k]);
+    }
+    return static_cast<int64_t>(dot);
+}
+
+TEST(MatrixOps_MatchReference) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    const size_t shapes[][2] = {{1, 1}, {1, 7}, {3, 17}, {5, 513}, {33, 40}, {70, 1100}};
+    SimdLevel original = VectorProcessor::getKernel();
+    std::mt19937 random(20250317);
+    WorkStealingPool pool(3);
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) continue;
+
+        for (const auto& shape : shapes) {
+            size_t rows = shape[0];
+            size_t cols = shape[1];
+            for (int values = 0; values < 2; values++) {
+                std::vector<int32_t> matrix = randomMatrix(random, rows, cols, values);
+                std::vector<int32_t> x = randomMatrix(random, 1, cols, values);
+
+                std::vector<int64_t> sums;
+                std::vector<int64_t> dots;
+                std::vector<int64_t> product;
+                for (WorkStealingPool* threads : {static_cast<WorkStealingPool*>(nullptr), &pool}) {
+                    VectorProcessor::columnSums(matrix.data(), rows, cols, sums, threads);
+                    VectorProcessor::gram(matrix.data(), rows, cols, dots, threads);
+                    VectorProcessor::matVec(matrix.data(), rows, cols, x.data(), product, threads);
+
+                    CHECK_EQUAL(cols, sums.size());
+                    for (size_t k = 0; k < cols; k++) {
+                        int64_t sum = 0;
+                        for (size_t r = 0; r < rows; r++) sum += matrix[r * cols + k];
+                        CHECK_EQUAL(sum, sums[k]);
+                    }
+
+                    CHECK_EQUAL(rows * (rows + 1) / 2, dots.size());
+                    size_t index = 0;
+                    for (size_t i = 0; i < rows; i++) {
+                        for (size_t j = i; j < rows; j++) {
+                            CHECK_EQUAL(referenceDot(&matrix[i * cols], &matrix[j * cols], cols),
+                                        dots[index++]);
+                        }
+                    }
+
+                    CHECK_EQUAL(rows, product.size());
+                    for (size_t r = 0; r < rows; r++) {
+                        CHECK_EQUAL(referenceDot(&matrix[r * cols], x.data(), cols), product[r]);
+                    }
+                }
+            }
+        }
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+// === 14. Преобразования вектора ===
+
+/**
+ * @brief Эталонное преобразование: точный результат каждого элемента
+ */
+static std::vector<int64_t> referenceTransform(TransformOp op, OverflowPolicy policy,
+                                               const std::vector<int32_t>& vec,
+                                               const std::vector<int32_t>& operand) {
+    std::vector<int64_t> result;
+    SumAccumulator prefix(policy);
+    for (size_t i = 0; i < vec.size(); i++) {
+        int64_t value = 0;
+        switch (op) {
+            case TransformOp::PREFIX_SUM:
+                prefix.add(&vec[i], 1);
+                value = prefix.result64();
+                break;
+            case TransformOp::ADD:   value = static_cast<int64_t>(operand[i]) + vec[i]; break;
+            case TransformOp::SCALE: value = static_cast<int64_t>(operand[0]) * vec[i]; break;
+            case TransformOp::CLAMP: value = std::min(std::max(vec[i], operand[0]), operand[1]); break;
+        }
+        if (policy == OverflowPolicy::WRAP) {
+            value = static_cast<int32_t>(static_cast<uint32_t>(value));
+        } else if (policy == OverflowPolicy::SATURATE) {
+            value = std::min<int64_t>(std::max<int64_t>(value, INT_MIN), INT_MAX);
+        }
+        result.push_back(value);
+    }
+    return result;
+}
+
+TEST(VectorTransform_MatchReference) {
+    const TransformOp ops[] = {TransformOp::PREFIX_SUM, TransformOp::ADD,
+                               TransformOp::SCALE, TransformOp::CLAMP};
+    const OverflowPolicy policies[] = {OverflowPolicy::SATURATE, OverflowPolicy::WRAP,
+                                       OverflowPolicy::WIDEN};
+    std::mt19937 random(20250418);
+
+    for (const auto& vec : randomVectors()) {
+        std::vector<int32_t> addend(vec.size());
+        for (auto& value : addend) value = static_cast<int32_t>(random());
+        for (TransformOp op : ops) {
+            std::vector<int32_t> operand = addend;
+            if (op == TransformOp::SCALE) operand = {-3};
+            if (op == TransformOp::CLAMP) operand = {-1000000, 1000000};
+
+            for (OverflowPolicy policy : policies) {
+                std::vector<int64_t> expected = referenceTransform(op, policy, vec, operand);
+                VectorTransform transform;
+                transform.begin(op, policy, operand.data());
+                size_t width = transform.outputSize();
+                std::vector<unsigned char> output(vec.size() * width);
+
+                // Порции разной длины
+                for (size_t offset = 0, step = 1; offset < vec.size(); offset += step, step += 7) {
+                    size_t count = std::min(step, vec.size() - offset);
+                    transform.apply(vec.data() + offset, count, output.data() + offset * width);
+                }
+
+                for (size_t i = 0; i < vec.size(); i++) {
+                    int64_t value;
+                    if (width == sizeof(int64_t)) {
+                        memcpy(&value, &output[i * width], sizeof(value));
+                    } else {
+                        int32_t narrow;
+                        memcpy(&narrow, &output[i * width], sizeof(narrow));
+                        value = narrow;
+                    }
+                    CHECK_EQUAL(expected[i], value);
+                }
+            }
+        }
+    }
+}
+
+// === 15. Разреженные векторы ===
+TEST(ReduceSparse_MatchesDense) {
+    const ReduceOp ops[] = {ReduceOp::SUM, ReduceOp::MIN, ReduceOp::MAX, ReduceOp::MEAN,
+                            ReduceOp::L1, ReduceOp::L2, ReduceOp::COUNT_NZ};
+    std::mt19937 random(20250419);
+
+    for (size_t size : {1u, 7u, 64u, 1000u}) {
+        // Только положительные и только отрицательные значения проверяют,
+        // что неявные нули участвуют в экстремуме
+        for (int sign : {1, -1, 0}) {
+            std::vector<int32_t> dense(size, 0);
+            std::vector<int32_t> values;
+            std::vector<double> realDense(size, 0.0);
+            std::vector<double> realValues;
+            for (size_t i = 0; i < size; i++) {
+                if (random() % 5 != 0) continue;
+                int32_t value = static_cast<int32_t>(random() % 1000) + 1;
+                if (sign < 0 || (sign == 0 && random() % 2)) value = -value;
+                dense[i] = value;
+                values.push_back(value);
+                realDense[i] = value / 4.0;
+                realValues.push_back(value / 4.0);
+            }
+
+            for (ReduceOp op : ops) {
+                ReduceState expected = VectorProcessor::reduce(op, ElementType::INT32,
+                                                               dense.data(), size);
+                ReduceState state = VectorProcessor::reduceSparse(op, ElementType::INT32, size,
+                                                                  values.data(), values.size());
+                CHECK(expected.total == state.total);
+                CHECK(expected.squares == state.squares);
+                CHECK_EQUAL(expected.value, state.value);
+                CHECK_EQUAL(expected.count, state.count);
+
+                expected = VectorProcessor::reduce(op, ElementType::FLOAT64,
+                                                   realDense.data(), size);
+                state = VectorProcessor::reduceSparse(op, ElementType::FLOAT64, size,
+                                                      realValues.data(), realValues.size());
+                CHECK_CLOSE(expected.sum(), state.sum(), 1e-9);
+                CHECK_CLOSE(expected.mean(), state.mean(), 1e-9);
+                CHECK_CLOSE(expected.norm(), state.norm(), 1e-9);
+                CHECK_EQUAL(expected.value, state.value);
+                if (op == ReduceOp::MIN || op == ReduceOp::MAX) {
+                    CHECK_EQUAL(expected.real, state.real);
+                }
+            }
+        }
+    }
+}
+
+TEST(SparseIndices_CheckAndCount) {
+    std::vector<uint32_t> indices = {0, 3, 4, 99};
+    uint64_t next = 0;
+    CHECK(VectorProcessor::checkIndices(indices.data(), 2, next, 100));
+    CHECK_EQUAL(4u, next);
+    CHECK(VectorProcessor::checkIndices(indices.data() + 2, 2, next, 100));
+    CHECK_EQUAL(100u, next);
+
+    // Повтор, убывание и выход за длину вектора
+    next = 0;
+    std::vector<uint32_t> repeated = {1, 1};
+    CHECK(!VectorProcessor::checkIndices(repeated.data(), 2, next, 100));
+    next = 0;
+    std::vector<uint32_t> descending = {5, 2};
+    CHECK(!VectorProcessor::checkIndices(descending.data(), 2, next, 100));
+    next = 0;
+    CHECK(!VectorProcessor::checkIndices(indices.data(), 4, next, 99));
+
+    // Подсчет единиц: ядро и хвост, невыровненное начало
+    std::mt19937 random(20250420);
+    std::vector<unsigned char> mask(1000);
+    for (auto& byte : mask) byte = static_cast<unsigned char>(random());
+    for (size_t offset : {0u, 1u, 3u}) {
+        for (size_t size : {0u, 1u, 7u, 8u, 31u, 64u, 997u}) {
+            uint64_t expected = 0;
+            for (size_t i = 0; i < size; i++) expected += __builtin_popcount(mask[offset + i]);
+            CHECK_EQUAL(expected, VectorProcessor::countBits(mask.data() + offset, size));
+        }
+    }
+}
+
+// === 16. Сжатые векторы ===
+TEST(PackedDecoder_MatchesDense) {
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE41,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    const ReduceOp ops[] = {ReduceOp::SUM, ReduceOp::MIN, ReduceOp::MAX, ReduceOp::COUNT_NZ};
+    SimdLevel original = VectorProcessor::getKernel();
+    std::vector<std::vector<int32_t>> vectors = randomVectors();
+
+    for (SimdLevel level : levels) {
+        if (VectorProcessor::selectKernel(level) != level) continue;
+
+        for (const auto& vec : vectors) {
+            std::vector<unsigned char> packed;
+            VectorProcessor::encodePacked(vec.data(), vec.size(), packed);
+
+            for (ReduceOp op : ops) {
+                VectorReduction expected;
+                expected.begin(vec.size(), OverflowPolicy::SATURATE, op);
+                expected.feed(vec.data(), vec.size() * sizeof(int32_t));
+
+                // Порции разной длины, в том числе разрезающие группы
+                VectorReduction reduction;
+                PackedDecoder decoder;
+                reduction.begin(vec.size(), OverflowPolicy::SATURATE, op);
+                decoder.begin(vec.size());
+                size_t offset = 0;
+                for (size_t step = 1; offset < packed.size(); step = step * 3 % 97 + 1) {
+                    size_t size = std::min(step, packed.size() - offset);
+                    offset += decoder.feed(packed.data() + offset, size, reduction);
+                }
+                CHECK_EQUAL(packed.size(), offset);
+                CHECK(decoder.isValid());
+                CHECK(decoder.isComplete());
+                CHECK(reduction.isComplete());
+                CHECK_EQUAL(expected.sum().result64(), reduction.sum().result64());
+                CHECK_EQUAL(expected.state().value, reduction.state().value);
+            }
+        }
+    }
+
+    VectorProcessor::selectKernel(original);
+}
+
+TEST(PackedDecoder_Format) {
+    // Медленно меняющийся ряд: по байту на элемент и ключ на группу
+    std::vector<int32_t> series(1000);
+    for (size_t i = 0; i < series.size(); i++) {
+        series[i] = 1000000 + static_cast<int32_t>(i % 7) * 10 - 30;
+    }
+    std::vector<unsigned char> packed;
+    VectorProcessor::encodePacked(series.data(), series.size(), packed);
+    CHECK(packed.size() < series.size() * 5 / 4 + 8);
+
+    // Разности -1, 1, INT_MAX - 1, 1 (по модулю 2^32) дают zigzag 1, 2, 0xFFFFFFFE, 2
+    std::vector<int32_t> values = {-1, 0, INT_MAX, INT_MIN, 5};
+    packed.clear();
+    VectorProcessor::encodePacked(values.data(), values.size(), packed);
+    CHECK_EQUAL(0x30, packed[0]);
+    CHECK_EQUAL(1, packed[1]);
+    CHECK_EQUAL(2, packed[2]);
+    CHECK_EQUAL(0xFE, packed[3]);
+    CHECK_EQUAL(2, packed[7]);
+    CHECK_EQUAL(0x03, packed[8]);
+    CHECK_EQUAL(13u, packed.size());
+
+    // Длина несуществующего элемента в ключе последней группы
+    VectorReduction reduction;
+    PackedDecoder decoder;
+    reduction.begin(1);
+    decoder.begin(1);
+    unsigned char invalid[] = {0x04, 0x02, 0x00};
+    decoder.feed(invalid, sizeof(invalid), reduction);
+    CHECK(!decoder.isValid());
+}
+
+// === 17. Сгенерированные векторы ===
+TEST(VectorGenerator_ClosedFormMatchesData) {
+    const ReduceOp ops[] = {ReduceOp::SUM, ReduceOp::MIN, ReduceOp::MAX, ReduceOp::MEAN,
+                            ReduceOp::L1, ReduceOp::L2, ReduceOp::COUNT_NZ};
+    const OverflowPolicy policies[] = {OverflowPolicy::SATURATE, OverflowPolicy::ERROR,
+                                       OverflowPolicy::WRAP, OverflowPolicy::WIDEN};
+    struct {
+        VectorGenerator generator;
+        bool closed;            // Сворачивается в замкнутой форме (для суммы - без насыщения)
+    } cases[] = {
+        {{GeneratorKind::CONSTANT, 7, 0, 0}, true},
+        {{GeneratorKind::CONSTANT, 0, 0, 0}, true},
+        {{GeneratorKind::CONSTANT, -40000000, 0, 0}, false},   // Насыщение суммы
+        {{GeneratorKind::ARANGE, -500, 3, 0}, true},
+        {{GeneratorKind::ARANGE, 1000, -7, 0}, true},
+        {{GeneratorKind::ARANGE, -999, 1, 0}, true},            // Проходит через ноль
+        {{GeneratorKind::ARANGE, INT_MAX - 10, 1, 0}, false},   // Элементы переполняются
+        {{GeneratorKind::RANDOM, -1000, 1000, 42}, false},
+        {{GeneratorKind::RANDOM, INT_MIN, INT_MAX, 7}, false}
+    };
+
+    std::vector<int32_t> values(3000);
+    for (const auto& item : cases) {
+        VectorProcessor::generate(item.generator, 0, values.size(), values.data());
+        for (ReduceOp op : ops) {
+            for (OverflowPolicy policy : policies) {
+                if (op != ReduceOp::SUM && policy != OverflowPolicy::SATURATE) continue;
+
+                VectorReduction expected;
+                expected.begin(values.size(), policy, op);
+                expected.feed(values.data(), values.size() * sizeof(int32_t));
+
+                VectorReduction reduction;
+                reduction.begin(values.size(), policy, op);
+                bool closed = reduction.reduceClosedForm(item.generator);
+                if (!closed) {
+                    // Фрагментами, как при разборе с бюджетом шага
+                    reduction.generate(item.generator, 0, 1000);
+                    CHECK(!reduction.isComplete());
+                    reduction.generate(item.generator, 1000, values.size());
+                }
+                bool saturating = (op == ReduceOp::SUM && (policy == OverflowPolicy::SATURATE ||
+                                                           policy == OverflowPolicy::ERROR));
+                CHECK(closed == item.closed || (!saturating && closed));
+                CHECK(reduction.isComplete());
+                CHECK_EQUAL(expected.sum().result64(), reduction.sum().result64());
+                CHECK_EQUAL(expected.sum().isSaturated(), reduction.sum().isSaturated());
+                CHECK(expected.state().total == reduction.state().total);
+                CHECK(expected.state().squares == reduction.state().squares);
+                CHECK_EQUAL(expected.state().value, reduction.state().value);
+                CHECK_EQUAL(expected.state().count, reduction.state().count);
+            }
+        }
+    }
+}
+
+TEST(VectorGenerator_Fragments) {
+    // Фрагмент строится по номеру первого элемента независимо от остальных
+    const VectorGenerator generators[] = {
+        {GeneratorKind::ARANGE, 5, -3, 0},
+        {GeneratorKind::RANDOM, -3, 3, 12345}
+    };
+    for (const auto& generator : generators) {
+        std::vector<int32_t> whole(1000);
+        VectorProcessor::generate(generator, 0, whole.size(), whole.data());
+        std::vector<int32_t> part(100);
+        VectorProcessor::generate(generator, 437, part.size(), part.data());
+        CHECK(std::equal(part.begin(), part.end(), whole.begin() + 437));
+    }
+
+    // Случайные значения в пределах [first, second] и принимают крайние значения
+    std::vector<int32_t> random(10000);
+    VectorProcessor::generate({GeneratorKind::RANDOM, -3, 3, 1}, 0, random.size(), random.data());
+    CHECK_EQUAL(-3, *std::min_element(random.begin(), random.end()));
+    CHECK_EQUAL(3, *std::max_element(random.begin(), random.end()));
+
+    // Шаг по модулю 2^32
+    int32_t wrapped[2];
+    VectorProcessor::generate({GeneratorKind::ARANGE, INT_MAX, 1, 0}, 0, 2, wrapped);
+    CHECK_EQUAL(INT_MIN, wrapped[1]);
+}
+
 int main() {
     std::cout << "=== Тестирование VectorProcessor ===" << std::endl;
     return UnitTest::RunAllTests();
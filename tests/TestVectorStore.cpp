@@ -0,0 +1,506 @@
+/**
+ * @file TestVectorStore.cpp
+ * @brief Модульные тесты для хранилища именованных векторов VectorStore и файла StoreFile
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/VectorStore.h"
+#include "../src/VectorProcessor.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Агрегаты, посчитанные заново по значениям
+ */
+static StoredAggregates recompute(const std::vector<int32_t>& values) {
+    StoredAggregates aggregates = StoredAggregates();
+    aggregates.size = values.size();
+    for (int32_t value : values) {
+        aggregates.account(value, 1);
+    }
+    return aggregates;
+}
+
+static bool sameAggregates(const StoredAggregates& a, const StoredAggregates& b) {
+    return a.size == b.size && a.sum == b.sum && a.magnitude == b.magnitude &&
+           a.squares == b.squares && a.nonZero == b.nonZero;
+}
+
+// === 1. Создание, запрос и удаление ===
+TEST(VectorStore_CreateQueryRemove) {
+    VectorStore store(1 << 20);
+    StoredAggregates aggregates;
+    CHECK(store.query("user", "v", aggregates) == StoreResult::NOT_FOUND);
+
+    CHECK(store.create("user", "v", {3, -4, 0, INT_MIN}) == StoreResult::OK);
+    CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+    CHECK_EQUAL(4u, aggregates.size);
+    CHECK(aggregates.sum == static_cast<__int128>(INT_MIN) - 1);
+    CHECK(aggregates.magnitude == static_cast<__int128>(7) + 2147483648LL);
+    CHECK(aggregates.squares == static_cast<unsigned __int128>(25) + 4611686018427387904ULL);
+    CHECK_EQUAL(3u, aggregates.nonZero);
+
+    // Пространства имен пользователей не пересекаются
+    CHECK(store.query("other", "v", aggregates) == StoreResult::NOT_FOUND);
+    CHECK(store.remove("other", "v") == StoreResult::NOT_FOUND);
+
+    CHECK(store.remove("user", "v") == StoreResult::OK);
+    CHECK(store.query("user", "v", aggregates) == StoreResult::NOT_FOUND);
+    VectorStore::Stats stats = store.stats();
+    CHECK_EQUAL(0u, stats.vectors);
+    CHECK_EQUAL(0u, stats.users);
+    CHECK_EQUAL(0u, stats.bytes);
+}
+
+// === 2. Заплатки поддерживают агрегаты инкрементно ===
+TEST(VectorStore_PatchMatchesRecompute) {
+    VectorStore store(1 << 20);
+    std::vector<int32_t> values(1000);
+    std::mt19937 random(7);
+    for (auto& value : values) value = static_cast<int32_t>(random());
+    CHECK(store.create("user", "v", std::vector<int32_t>(values)) == StoreResult::OK);
+
+    for (int round = 0; round < 50; round++) {
+        std::vector<StorePatch> patches(20);
+        for (auto& patch : patches) {
+            patch.index = random() % values.size();
+            // Повторы индексов, нули и крайние значения
+            switch (random() % 4) {
+                case 0:  patch.value = 0; break;
+                case 1:  patch.value = (random() % 2) ? INT_MAX : INT_MIN; break;
+                default: patch.value = static_cast<int32_t>(random()); break;
+            }
+            values[patch.index] = patch.value;
+        }
+        CHECK(store.patch("user", "v", patches.data(), patches.size()) == StoreResult::OK);
+
+        StoredAggregates aggregates;
+        CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+        CHECK(sameAggregates(recompute(values), aggregates));
+    }
+}
+
+// === 3. Заплатка с индексом за пределами вектора не применяется ===
+TEST(VectorStore_PatchOutOfRange) {
+    VectorStore store(1 << 20);
+    CHECK(store.create("user", "v", {1, 2, 3}) == StoreResult::OK);
+
+    StorePatch patches[] = {{0, 100}, {3, 5}};
+    CHECK(store.patch("user", "v", patches, 2) == StoreResult::BAD_INDEX);
+    CHECK(store.patch("user", "w", patches, 1) == StoreResult::NOT_FOUND);
+
+    StoredAggregates aggregates;
+    CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+    CHECK(aggregates.sum == 6);
+
+    // Создание с тем же именем заменяет вектор
+    CHECK(store.create("user", "v", {10}) == StoreResult::OK);
+    CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+    CHECK_EQUAL(1u, aggregates.size);
+    CHECK(aggregates.sum == 10);
+    CHECK_EQUAL(1u, store.stats().vectors);
+}
+
+// === 4. Учет памяти и вытеснение у самого крупного пользователя ===
+TEST(VectorStore_Eviction) {
+    const size_t entry = VectorStore::entryBytes("a0", 100);
+    VectorStore store(4 * entry);
+
+    CHECK(store.create("small", "a0", std::vector<int32_t>(100, 1)) == StoreResult::OK);
+    CHECK(store.create("big", "a0", std::vector<int32_t>(100, 2)) == StoreResult::OK);
+    CHECK(store.create("big", "a1", std::vector<int32_t>(100, 3)) == StoreResult::OK);
+    CHECK(store.create("big", "a2", std::vector<int32_t>(100, 4)) == StoreResult::OK);
+    CHECK_EQUAL(4 * entry, store.stats().bytes);
+
+    // Использованный вектор становится недавним
+    StoredAggregates aggregates;
+    CHECK(store.query("big", "a0", aggregates) == StoreResult::OK);
+
+    // Новый вектор вытесняет давний вектор пользователя big, а не small
+    CHECK(store.create("small", "a1", std::vector<int32_t>(100, 5)) == StoreResult::OK);
+    CHECK(store.query("big", "a1", aggregates) == StoreResult::NOT_FOUND);
+    CHECK(store.query("big", "a0", aggregates) == StoreResult::OK);
+    CHECK(store.query("small", "a0", aggregates) == StoreResult::OK);
+
+    VectorStore::Stats stats = store.stats();
+    CHECK_EQUAL(4u, stats.vectors);
+    CHECK_EQUAL(2u, stats.users);
+    CHECK_EQUAL(4 * entry, stats.bytes);
+    CHECK_EQUAL(1u, stats.evictions);
+
+    // Вектор больше всего хранилища не принимается и ничего не вытесняет
+    CHECK(store.create("big", "huge", std::vector<int32_t>(500, 0)) == StoreResult::NO_SPACE);
+    CHECK_EQUAL(4u, store.stats().vectors);
+}
+
+// === 5. Одновременные команды разных пользователей ===
+TEST(VectorStore_Concurrent) {
+    VectorStore store(1 << 22);
+    const int users = 4;
+
+    std::vector<std::thread> threads;
+    for (int u = 0; u < users; u++) {
+        threads.emplace_back([&store, u]() {
+            std::string user = "user" + std::to_string(u);
+            store.create(user, "v", std::vector<int32_t>(64, 0));
+            for (uint32_t k = 0; k < 1000; k++) {
+                StorePatch patch = {k % 64, static_cast<int32_t>(k)};
+                store.patch(user, "v", &patch, 1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Последние 64 изменения: значения 936..999
+    for (int u = 0; u < users; u++) {
+        StoredAggregates aggregates;
+        CHECK(store.query("user" + std::to_string(u), "v", aggregates) == StoreResult::OK);
+        CHECK(aggregates.sum == 64 * (936 + 999) / 2);
+    }
+}
+
+// === 6. Суммы диапазонов совпадают с поэлементным суммированием ===
+TEST(VectorStore_RangeSumMatchesLinear) {
+    VectorStore store(1 << 24);
+    std::mt19937 random(11);
+    std::vector<int32_t> values(5000);
+    for (auto& value : values) {
+        // Крупные значения с дрейфом: частичные суммы пересекают границы int32
+        value = static_cast<int32_t>(random() % 2000000) - 900000;
+    }
+    CHECK(store.create("user", "v", std::vector<int32_t>(values)) == StoreResult::OK);
+    CHECK(store.buildIndex("user", "v") == StoreResult::OK);
+
+    const OverflowPolicy policies[] = {OverflowPolicy::SATURATE, OverflowPolicy::WRAP,
+                                       OverflowPolicy::WIDEN, OverflowPolicy::ERROR};
+    for (int round = 0; round < 200; round++) {
+        if (round % 20 == 10) {
+            StorePatch patch = {static_cast<uint32_t>(random() % values.size()),
+                                (random() % 2) ? INT_MAX : INT_MIN};
+            values[patch.index] = patch.value;
+            CHECK(store.patch("user", "v", &patch, 1) == StoreResult::OK);
+        }
+        size_t begin = random() % values.size();
+        size_t end = begin + random() % (values.size() - begin + 1);
+        for (OverflowPolicy policy : policies) {
+            SumAccumulator expected(policy);
+            expected.add(values.data() + begin, end - begin);
+            SumAccumulator actual(policy);
+            CHECK(store.rangeSum("user", "v", begin, end, actual) == StoreResult::OK);
+            CHECK_EQUAL(expected.result64(), actual.result64());
+            CHECK_EQUAL(expected.isSaturated(), actual.isSaturated());
+        }
+    }
+
+    SumAccumulator sum;
+    CHECK(store.rangeSum("user", "v", 10, 9, sum) == StoreResult::BAD_INDEX);
+    CHECK(store.rangeSum("user", "v", 0, values.size() + 1, sum) == StoreResult::BAD_INDEX);
+    CHECK(store.rangeSum("user", "w", 0, 1, sum) == StoreResult::NOT_FOUND);
+    CHECK(store.rangeSum("user", "v", 7, 7, sum) == StoreResult::OK);
+    CHECK_EQUAL(0, sum.result64());
+}
+
+// === 7. Индекс учитывается в памяти и вытесняет другие векторы ===
+TEST(VectorStore_IndexAccounting) {
+    const size_t entry = VectorStore::entryBytes("v", 1000);
+    const size_t index = PrefixIndex::bytes(1000);
+    VectorStore store(2 * entry + index);
+
+    CHECK(store.create("user", "v", std::vector<int32_t>(1000, 1)) == StoreResult::OK);
+    CHECK(store.create("user", "w", std::vector<int32_t>(1000, 2)) == StoreResult::OK);
+    CHECK(store.buildIndex("user", "v") == StoreResult::OK);
+    CHECK(store.buildIndex("user", "v") == StoreResult::OK);
+    CHECK_EQUAL(2 * entry + index, store.stats().bytes);
+
+    // Второй индекс не помещается: вытесняется v, индексируемый w остается
+    CHECK(store.buildIndex("user", "w") == StoreResult::OK);
+    StoredAggregates aggregates;
+    CHECK(store.query("user", "v", aggregates) == StoreResult::NOT_FOUND);
+    CHECK_EQUAL(entry + index, store.stats().bytes);
+
+    SumAccumulator sum;
+    CHECK(store.rangeSum("user", "w", 100, 600, sum) == StoreResult::OK);
+    CHECK_EQUAL(1000, sum.result64());
+
+    // Вектор с индексом больше бюджета
+    VectorStore tight(entry);
+    CHECK(tight.create("user", "v", std::vector<int32_t>(1000, 1)) == StoreResult::OK);
+    CHECK(tight.buildIndex("user", "v") == StoreResult::NO_SPACE);
+    CHECK(tight.rangeSum("user", "v", 0, 1000, sum) == StoreResult::OK);
+}
+
+// === 8. Блоки файла: повторное использование, объединение и обрезка хвоста ===
+TEST(StoreFile_Blocks) {
+    Logger logger("test_store.log");
+    const char* path = "test_store.bin";
+    std::remove(path);
+    {
+        StoreFile file(logger);
+        CHECK(file.open(path, 1 << 20));
+        CHECK(file.wasClean());
+        CHECK_EQUAL(StoreFile::HEADER_BYTES, file.size());
+
+        void* a = file.allocate(100);
+        void* b = file.allocate(1000);
+        void* c = file.allocate(100);
+        CHECK(a != nullptr && b != nullptr && c != nullptr);
+        CHECK_EQUAL(0u, reinterpret_cast<uintptr_t>(b) % 16);
+        CHECK(file.capacity(b) >= 1000);
+        memset(b, 0x5A, 1000);
+        uint64_t size = file.size();
+
+        // Освобожденный блок переиспользуется без роста файла
+        file.release(b);
+        void* d = file.allocate(500);
+        CHECK(d == b);
+        CHECK_EQUAL(size, file.size());
+
+        // Соседние свободные блоки объединяются, свободный хвост отрезается
+        file.release(d);
+        file.release(a);
+        file.release(c);
+        CHECK_EQUAL(StoreFile::HEADER_BYTES, file.size());
+
+        CHECK(file.allocate(100) != nullptr);
+        CHECK(file.allocate(200) != nullptr);
+        // Резерв адресов исчерпан
+        CHECK(file.allocate(2 << 20) == nullptr);
+    }
+
+    // Второй процесс (и второй дескриптор) файл не откроет, пока он открыт
+    StoreFile first(logger);
+    CHECK(first.open(path, 1 << 20));
+    CHECK_EQUAL(2u, first.loaded().size());
+    StoreFile second(logger);
+    CHECK(!second.open(path, 1 << 20));
+    first.close();
+    std::remove(path);
+}
+
+// === 9. Векторы, агрегаты и индексы сохраняются между запусками ===
+TEST(VectorStore_PersistAndReload) {
+    Logger logger("test_store.log");
+    const char* path = "test_store.bin";
+    std::remove(path);
+
+    std::vector<int32_t> values(3000);
+    for (size_t k = 0; k < values.size(); k++) values[k] = static_cast<int32_t>(k * 7919 % 2001) - 1000;
+    {
+        VectorStore store(1 << 22);
+        CHECK(store.openFile(path, logger));
+        CHECK(store.create("user", "v", values) == StoreResult::OK);
+        CHECK(store.create("user", "w", {1, 2, 3}) == StoreResult::OK);
+        CHECK(store.create("other", "v", {-5}) == StoreResult::OK);
+        CHECK(store.create("other", "gone", {9}) == StoreResult::OK);
+        CHECK(store.remove("other", "gone") == StoreResult::OK);
+        CHECK(store.buildIndex("user", "v") == StoreResult::OK);
+        StorePatch patches[] = {{5, INT_MAX}, {2999, INT_MIN}};
+        CHECK(store.patch("user", "v", patches, 2) == StoreResult::OK);
+        values[5] = INT_MAX;
+        values[2999] = INT_MIN;
+        CHECK(store.stats().fileBytes > values.size() * sizeof(int32_t));
+    }
+
+    VectorStore store(1 << 22);
+    CHECK(store.openFile(path, logger));
+    VectorStore::Stats stats = store.stats();
+    CHECK_EQUAL(3u, stats.vectors);
+    CHECK_EQUAL(2u, stats.users);
+
+    StoredAggregates aggregates;
+    CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+    CHECK(sameAggregates(recompute(values), aggregates));
+    CHECK(store.query("other", "gone", aggregates) == StoreResult::NOT_FOUND);
+    CHECK(store.query("other", "v", aggregates) == StoreResult::OK);
+    CHECK(aggregates.sum == -5);
+
+    // Индекс загружен вместе с вектором и продолжает обновляться
+    SumAccumulator expected(OverflowPolicy::WIDEN);
+    expected.add(values.data() + 3, 2990);
+    SumAccumulator sum(OverflowPolicy::WIDEN);
+    CHECK(store.rangeSum("user", "v", 3, 2993, sum) == StoreResult::OK);
+    CHECK_EQUAL(expected.result64(), sum.result64());
+    // Индекс уже есть: память не растет
+    size_t bytes = store.stats().bytes;
+    CHECK(store.buildIndex("user", "v") == StoreResult::OK);
+    CHECK_EQUAL(bytes, store.stats().bytes);
+
+    store.close();
+    std::remove(path);
+}
+
+/**
+ * @brief Прочитать файл целиком
+ */
+static std::string readFile(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const char* path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// === 10. Файл после сбоя, поврежденные записи и чужие версии ===
+TEST(VectorStore_DamagedFile) {
+    Logger logger("test_store.log");
+    const char* path = "test_store.bin";
+    const char* copy = "test_store_copy.bin";
+    std::remove(path);
+
+    std::string crashed;
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(path, logger));
+        CHECK(store.create("user", "victim", {1, 2, 3}) == StoreResult::OK);
+        CHECK(store.create("user", "kept", {4, 5}) == StoreResult::OK);
+        CHECK(store.buildIndex("user", "kept") == StoreResult::OK);
+        // Снимок открытого файла - как после аварийного завершения процесса
+        crashed = readFile(path);
+    }
+
+    // Незакрытый файл: агрегаты и индексы пересчитываются по значениям
+    writeFile(copy, crashed);
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(copy, logger));
+        StoredAggregates aggregates;
+        CHECK(store.query("user", "kept", aggregates) == StoreResult::OK);
+        CHECK(aggregates.sum == 9);
+        SumAccumulator sum;
+        CHECK(store.rangeSum("user", "kept", 1, 2, sum) == StoreResult::OK);
+        CHECK_EQUAL(5, sum.result64());
+    }
+
+    // Испорченный ключ записи: запись отбрасывается, остальные загружаются
+    std::string damaged = readFile(path);
+    size_t at = damaged.find("victim");
+    CHECK(at != std::string::npos);
+    damaged[at] = 'V';
+    writeFile(copy, damaged);
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(copy, logger));
+        StoredAggregates aggregates;
+        CHECK(store.query("user", "victim", aggregates) == StoreResult::NOT_FOUND);
+        CHECK(store.query("user", "Victim", aggregates) == StoreResult::NOT_FOUND);
+        CHECK(store.query("user", "kept", aggregates) == StoreResult::OK);
+        CHECK_EQUAL(1u, store.stats().vectors);
+    }
+
+    // Файл более новой версии и чужой файл не открываются и не изменяются
+    std::string newer = readFile(path);
+    uint32_t version = StoreFile::FILE_VERSION + 1;
+    memcpy(&newer[8], &version, sizeof(version));
+    writeFile(copy, newer);
+    VectorStore store(1 << 20);
+    CHECK(!store.openFile(copy, logger));
+    CHECK(readFile(copy) == newer);
+    writeFile(copy, std::string(4096, 'x'));
+    CHECK(!store.openFile(copy, logger));
+
+    std::remove(path);
+    std::remove(copy);
+}
+
+// === 11. Сохраненные векторы сверх бюджета вытесняются при загрузке ===
+TEST(VectorStore_ReloadWithSmallerBudget) {
+    Logger logger("test_store.log");
+    const char* path = "test_store.bin";
+    std::remove(path);
+    const size_t entry = VectorStore::entryBytes("a", 1000);
+    {
+        VectorStore store(10 * entry);
+        CHECK(store.openFile(path, logger));
+        for (char name = 'a'; name < 'e'; name++) {
+            CHECK(store.create("user", std::string(1, name), std::vector<int32_t>(1000, name)) ==
+                  StoreResult::OK);
+        }
+    }
+    uint64_t fileBytes;
+    {
+        VectorStore store(2 * entry);
+        CHECK(store.openFile(path, logger));
+        VectorStore::Stats stats = store.stats();
+        CHECK_EQUAL(2u, stats.vectors);
+        CHECK_EQUAL(2u, stats.evictions);
+        fileBytes = stats.fileBytes;
+    }
+    VectorStore store(10 * entry);
+    CHECK(store.openFile(path, logger));
+    CHECK_EQUAL(2u, store.stats().vectors);
+    CHECK_EQUAL(fileBytes, store.stats().fileBytes);
+    store.close();
+    std::remove(path);
+}
+
+// === 12. Сбой при замене вектора: остается оригинал ===
+TEST(VectorStore_CrashDuringReplace) {
+    Logger logger("test_store.log");
+    const char* path = "test_store.bin";
+    const char* copy = "test_store_copy.bin";
+    std::remove(path);
+
+    std::string before, after;
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(path, logger));
+        // Блок "p" того же размера освобождается, и копия "v" ложится в него - перед оригиналом
+        CHECK(store.create("user", "p", {0, 0, 0}) == StoreResult::OK);
+        CHECK(store.create("user", "v", {1, 2, 3}) == StoreResult::OK);
+        CHECK(store.remove("user", "p") == StoreResult::OK);
+        before = readFile(path);
+        CHECK(store.create("user", "v", {4, 5, 6}) == StoreResult::OK);
+        after = readFile(path);
+    }
+    CHECK(after.size() < before.size());
+
+    // Файл в момент между записью копии и освобождением оригинала
+    std::string crashed = before.substr(0, StoreFile::HEADER_BYTES) +
+                          after.substr(StoreFile::HEADER_BYTES) + before.substr(after.size());
+    writeFile(copy, crashed);
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(copy, logger));
+        StoredAggregates aggregates;
+        CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+        CHECK(aggregates.sum == 6);
+        CHECK_EQUAL(1u, store.stats().vectors);
+    }
+
+    // Копия без контрольной суммы (значения дописаны не до конца) отбрасывается
+    const size_t checksumAt = StoreFile::HEADER_BYTES + 16;
+    memset(&crashed[checksumAt], 0, sizeof(uint64_t));
+    writeFile(copy, crashed);
+    {
+        VectorStore store(1 << 20);
+        CHECK(store.openFile(copy, logger));
+        StoredAggregates aggregates;
+        CHECK(store.query("user", "v", aggregates) == StoreResult::OK);
+        CHECK(aggregates.sum == 6);
+        CHECK_EQUAL(1u, store.stats().vectors);
+    }
+
+    std::remove(path);
+    std::remove(copy);
+}
+
+int main() {
+    std::cout << "=== Тестирование VectorStore ===" << std::endl;
+    return UnitTest::RunAllTests();
+}
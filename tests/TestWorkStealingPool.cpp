@@ -0,0 +1,98 @@
+/**
+ * @file TestWorkStealingPool.cpp
+ * @brief Модульные тесты для пула потоков WorkStealingPool
+ * @author Судариков А.В.
+ * @version 1.0
+ * @date 2025
+ */
+
+#include <UnitTest++/UnitTest++.h>
+#include "../src/WorkStealingPool.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// === 1. Каждый индекс выполняется ровно один раз ===
+TEST(WorkStealingPool_CoversRangeOnce) {
+    WorkStealingPool pool(4);
+    CHECK_EQUAL(4u, pool.size());
+
+    const size_t grains[] = {1, 3, 64, 100000};
+    for (size_t grain : grains) {
+        std::vector<std::atomic<int>> hits(10007);
+        for (auto& hit : hits) hit = 0;
+
+        pool.parallelFor(0, hits.size(), grain, [&](size_t begin, size_t end) {
+            CHECK(end - begin <= grain);
+            for (size_t i = begin; i < end; i++) {
+                hits[i]++;
+            }
+        });
+
+        for (size_t i = 0; i < hits.size(); i++) {
+            CHECK_EQUAL(1, hits[i].load());
+        }
+    }
+}
+
+// === 2. Пустой диапазон и поддиапазон со смещением ===
+TEST(WorkStealingPool_EmptyAndOffsetRange) {
+    WorkStealingPool pool(2);
+    std::atomic<int> calls(0);
+    pool.parallelFor(5, 5, 1, [&](size_t, size_t) { calls++; });
+    CHECK_EQUAL(0, calls.load());
+
+    std::atomic<long long> sum(0);
+    pool.parallelFor(100, 200, 7, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) sum += static_cast<long long>(i);
+    });
+    CHECK_EQUAL(14950LL, sum.load());
+}
+
+// === 3. Вложенные вызовы не блокируют пул ===
+TEST(WorkStealingPool_Nested) {
+    WorkStealingPool pool(2);
+    std::atomic<long long> sum(0);
+
+    pool.parallelFor(0, 16, 1, [&](size_t begin, size_t end) {
+        for (size_t outer = begin; outer < end; outer++) {
+            pool.parallelFor(0, 1000, 10, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; i++) sum += static_cast<long long>(i);
+            });
+        }
+    });
+    CHECK_EQUAL(16LL * 499500, sum.load());
+}
+
+// === 4. Одновременные вызовы из разных потоков ===
+TEST(WorkStealingPool_ConcurrentCallers) {
+    WorkStealingPool pool(3);
+    const int callers = 4;
+    std::vector<long long> sums(callers, 0);
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < callers; c++) {
+        threads.emplace_back([&pool, &sums, c]() {
+            for (int round = 0; round < 50; round++) {
+                std::atomic<long long> sum(0);
+                pool.parallelFor(0, 5000, 16, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) sum += static_cast<long long>(i);
+                });
+                sums[c] += sum;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int c = 0; c < callers; c++) {
+        CHECK_EQUAL(50LL * 12497500, sums[c]);
+    }
+}
+
+int main() {
+    std::cout << "=== Тестирование WorkStealingPool ===" << std::endl;
+    return UnitTest::RunAllTests();
+}